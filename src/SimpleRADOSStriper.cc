@@ -61,6 +61,9 @@ enum {
   P_SHRINK_BYTES,
   P_LOCK,
   P_UNLOCK,
+  P_READAHEAD,
+  P_READAHEAD_HIT,
+  P_WRITE_COMBINED,
   P_LAST,
 };
 
@@ -75,6 +78,9 @@ int SimpleRADOSStriper::config_logger(CephContext* cct, std::string_view name, s
   plb.add_u64_counter(P_SHRINK_BYTES, "shrink_bytes", "Bytes shrunk");
   plb.add_u64_counter(P_LOCK, "lock", "Number of locks");
   plb.add_u64_counter(P_UNLOCK, "unlock", "Number of unlocks");
+  plb.add_u64_counter(P_READAHEAD, "readahead", "Number of read-ahead fetches");
+  plb.add_u64_counter(P_READAHEAD_HIT, "readahead_hit", "Reads served from the read-ahead buffer");
+  plb.add_u64_counter(P_WRITE_COMBINED, "write_combined", "Writes merged into a pending write");
   l->reset(plb.create_perf_counters());
   return 0;
 }
@@ -120,6 +126,10 @@ int SimpleRADOSStriper::remove()
     return -EBLOCKLISTED;
   }
 
+  /* the data is going away, don't bother writing it */
+  pending_write_bl.clear();
+  readahead_bl.clear();
+
   if (int rc = wait_for_aios(true); rc < 0) {
     aios_failure = 0;
     return rc;
@@ -148,6 +158,11 @@ int SimpleRADOSStriper::truncate(uint64_t size)
     return -EBLOCKLISTED;
   }
 
+  if (int rc = submit_pending_write(); rc < 0) {
+    return rc;
+  }
+  readahead_bl.clear();
+
   /* TODO: (not currently used by SQLite) handle growth + sparse */
   if (int rc = set_metadata(size, true); rc < 0) {
     return rc;
@@ -189,6 +204,10 @@ int SimpleRADOSStriper::flush()
     return -EBLOCKLISTED;
   }
 
+  if (int rc = submit_pending_write(); rc < 0) {
+    return rc;
+  }
+
   if (size_dirty) {
     if (int rc = set_metadata(size, true); rc < 0) {
       return rc;
@@ -203,6 +222,42 @@ int SimpleRADOSStriper::flush()
   return 0;
 }
 
+int SimpleRADOSStriper::submit_pending_write()
+{
+  if (pending_write_bl.length() == 0) {
+    return 0;
+  }
+
+  d(15) << pending_write_off << "~" << pending_write_bl.length() << dendl;
+
+  const size_t len = pending_write_bl.length();
+  size_t w = 0;
+  int rc = 0;
+  while ((len-w) > 0) {
+    auto ext = get_next_extent(pending_write_off+w, len-w);
+    auto aiocp = aiocompletionptr(librados::Rados::aio_create_completion());
+    bufferlist bl;
+    bl.substr_of(pending_write_bl, w, ext.len);
+    if (rc = ioctx.aio_write(ext.soid, aiocp.get(), bl, ext.len, ext.off); rc < 0) {
+      d(1) << " write failure: " << cpp_strerror(rc) << dendl;
+      break;
+    }
+    aios.emplace(std::move(aiocp));
+    w += ext.len;
+  }
+  pending_write_bl.clear();
+  return rc;
+}
+
+int SimpleRADOSStriper::maybe_submit_pending_write(uint64_t off, size_t len)
+{
+  const auto pend = pending_write_off + pending_write_bl.length();
+  if (pending_write_bl.length() && off < pend && pending_write_off < off+len) {
+    return submit_pending_write();
+  }
+  return 0;
+}
+
 int SimpleRADOSStriper::stat(uint64_t* s)
 {
   d(5) << dendl;
@@ -455,17 +510,33 @@ ssize_t SimpleRADOSStriper::write(const void* data, size_t len, uint64_t off)
     }
   }
 
-  size_t w = 0;
-  while ((len-w) > 0) {
-    auto ext = get_next_extent(off+w, len-w);
-    auto aiocp = aiocompletionptr(librados::Rados::aio_create_completion());
-    bufferlist bl;
-    bl.append((const char*)data+w, ext.len);
-    if (int rc = ioctx.aio_write(ext.soid, aiocp.get(), bl, ext.len, ext.off); rc < 0) {
-      break;
+  if (readahead_bl.length() &&
+      off < readahead_off+readahead_bl.length() && readahead_off < off+len) {
+    readahead_bl.clear();
+  }
+
+  /* Merge contiguous writes (SQLite writes page by page) into one pending
+   * buffer, submitted once it is full, when a write is not contiguous, or
+   * when the data is needed (read, truncate, flush).
+   */
+  if (pending_write_bl.length() &&
+      (off != pending_write_off+pending_write_bl.length() ||
+       pending_write_bl.length()+len > write_combine_max)) {
+    if (int rc = submit_pending_write(); rc < 0) {
+      return rc;
+    }
+  }
+  if (pending_write_bl.length() == 0) {
+    pending_write_off = off;
+  } else if (logger) {
+    logger->inc(P_WRITE_COMBINED);
+  }
+  pending_write_bl.append((const char*)data, len);
+  size_t w = len;
+  if (pending_write_bl.length() >= write_combine_max) {
+    if (int rc = submit_pending_write(); rc < 0) {
+      return rc;
     }
-    aios.emplace(std::move(aiocp));
-    w += ext.len;
   }
 
   wait_for_aios(false); // clean up finished completions
@@ -487,6 +558,39 @@ ssize_t SimpleRADOSStriper::read(void* data, size_t len, uint64_t off)
     return -EBLOCKLISTED;
   }
 
+  if (readahead_bl.length() &&
+      off >= readahead_off && off+len <= readahead_off+readahead_bl.length()) {
+    readahead_bl.begin(off-readahead_off).copy(len, (char*)data);
+    last_read_end = off+len;
+    if (logger) {
+      logger->inc(P_READAHEAD_HIT);
+    }
+    return len;
+  }
+
+  if (readahead_max && off == last_read_end && off+len < size) {
+    const size_t ralen = std::min<uint64_t>(len+readahead_max, size-off);
+    if (int rc = maybe_submit_pending_write(off, ralen); rc < 0) {
+      return rc;
+    }
+    bufferlist bl;
+    if (int rc = read_extents(&bl, ralen, off); rc < 0) {
+      return rc;
+    }
+    readahead_off = off;
+    readahead_bl = std::move(bl);
+    readahead_bl.begin().copy(len, (char*)data);
+    last_read_end = off+len;
+    if (logger) {
+      logger->inc(P_READAHEAD);
+    }
+    return len;
+  }
+
+  if (int rc = maybe_submit_pending_write(off, len); rc < 0) {
+    return rc;
+  }
+
   size_t r = 0;
   // Don't use std::vector to store bufferlists (e.g for parallelizing aio_reads),
   // as they are being moved whenever the vector resizes
@@ -513,10 +617,44 @@ ssize_t SimpleRADOSStriper::read(void* data, size_t len, uint64_t off)
     r += bl.length();
   }
   ceph_assert(r <= len);
+  last_read_end = off+r;
 
   return r;
 }
 
+/* Read off~len, which must lie within the file size, into out. Unlike
+ * read(), stripes that are shorter than the extent (never written) are
+ * zero-filled so that the buffer stays aligned with the file offsets.
+ */
+int SimpleRADOSStriper::read_extents(bufferlist* out, size_t len, uint64_t off)
+{
+  std::deque<std::tuple<bufferlist, aiocompletionptr, size_t>> reads;
+  size_t r = 0;
+  while ((len-r) > 0) {
+    auto ext = get_next_extent(off+r, len-r);
+    auto& [bl, aiocp, elen] = reads.emplace_back();
+    aiocp = aiocompletionptr(librados::Rados::aio_create_completion());
+    elen = ext.len;
+    if (int rc = ioctx.aio_read(ext.soid, aiocp.get(), &bl, ext.len, ext.off); rc < 0) {
+      d(1) << " read failure: " << cpp_strerror(rc) << dendl;
+      return rc;
+    }
+    r += ext.len;
+  }
+
+  for (auto& [bl, aiocp, elen] : reads) {
+    if (int rc = aiocp->wait_for_complete(); rc < 0 && rc != -ENOENT) {
+      d(1) << " read failure: " << cpp_strerror(rc) << dendl;
+      return rc;
+    }
+    if (bl.length() < elen) {
+      bl.append_zero(elen-bl.length());
+    }
+    out->claim_append(bl);
+  }
+  return 0;
+}
+
 int SimpleRADOSStriper::print_lockers(std::ostream& out)
 {
   int exclusive;
@@ -725,6 +863,9 @@ int SimpleRADOSStriper::lock(uint64_t timeoutms)
     lock_keeper = std::thread(&SimpleRADOSStriper::lock_keeper_main, this);
   }
 
+  /* another client may have changed the database while we were unlocked */
+  readahead_bl.clear();
+
   if (int rc = open(); rc < 0) {
     d(1) << " open failed: " << cpp_strerror(rc) << dendl;
     return rc;
@@ -765,6 +906,7 @@ int SimpleRADOSStriper::unlock()
     return rc;
   }
   locked = false;
+  readahead_bl.clear();
 
   d(5) << " = 0" << dendl;
   if (logger) {
@@ -79,6 +79,14 @@ public:
   void set_blocklist_the_dead(bool b) {
     blocklist_the_dead = b;
   }
+  /* bytes read past a sequential read; 0 disables read-ahead */
+  void set_readahead(uint64_t bytes) {
+    readahead_max = bytes;
+  }
+  /* bytes of contiguous writes merged before submission; 0 disables merging */
+  void set_write_combine(uint64_t bytes) {
+    write_combine_max = bytes;
+  }
 
 protected:
   struct extent {
@@ -93,6 +101,9 @@ protected:
   int shrink_alloc(uint64_t a);
   int maybe_shrink_alloc();
   int wait_for_aios(bool block);
+  int submit_pending_write();
+  int maybe_submit_pending_write(uint64_t off, size_t len);
+  int read_extents(ceph::bufferlist* out, size_t len, uint64_t off);
   int recover_lock();
   extent get_next_extent(uint64_t off, size_t len) const;
   extent get_first_extent() const {
@@ -133,6 +144,15 @@ private:
   bool blocklist_the_dead = true;
   std::queue<aiocompletionptr> aios;
   int aios_failure = 0;
+  /* read-ahead buffer, only valid while the lock is held */
+  uint64_t readahead_max = 0;
+  uint64_t readahead_off = 0;
+  ceph::bufferlist readahead_bl;
+  uint64_t last_read_end = 0;
+  /* contiguous writes not yet submitted, flushed before read/truncate/flush */
+  uint64_t write_combine_max = 0;
+  uint64_t pending_write_off = 0;
+  ceph::bufferlist pending_write_bl;
   std::string myaddrs;
 };
 
@@ -6,7 +6,15 @@
 
 class DummyAuthClientServer : public AuthClient,
 			      public AuthServer {
+  // fixed per-connection key for secure mode; only good for benchmarks
+  static std::string dummy_connection_secret(size_t len) {
+    return std::string(len, 'k');
+  }
+
 public:
+  /// mode the client side asks for; the server side follows the peer
+  uint32_t preferred_mode = CEPH_CON_MODE_CRC;
+
   DummyAuthClientServer(CephContext *cct) : AuthServer(cct) {}
 
   // client
@@ -17,7 +25,7 @@ public:
     std::vector<uint32_t> *preferred_modes,
     bufferlist *out) override {
     *method = CEPH_AUTH_NONE;
-    *preferred_modes = { CEPH_CON_MODE_CRC };
+    *preferred_modes = { preferred_mode };
     return 0;
   }
 
@@ -37,6 +45,9 @@ public:
     const bufferlist& bl,
     CryptoKey *session_key,
     std::string *connection_secret) {
+    auth_meta->con_mode = con_mode;
+    *connection_secret = dummy_connection_secret(
+      auth_meta->get_connection_secret_length());
     return 0;
   }
 
@@ -58,6 +69,8 @@ public:
     uint32_t auth_method,
     const bufferlist& bl,
     bufferlist *reply) override {
+    auth_meta->connection_secret = dummy_connection_secret(
+      auth_meta->get_connection_secret_length());
     return 1;
   }
 };
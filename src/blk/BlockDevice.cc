@@ -55,6 +55,17 @@ std::ostream& operator<<(std::ostream& os, const blk_access_mode_t buffered)
   return os;
 }
 
+const char* blk_io_class_name(blk_io_class_t c)
+{
+  switch (c) {
+  case blk_io_class_t::CLIENT: return "client";
+  case blk_io_class_t::DEFERRED: return "deferred";
+  case blk_io_class_t::KV: return "kv";
+  case blk_io_class_t::COMPACTION: return "compaction";
+  default: return "???";
+  }
+}
+
 
 
 void IOContext::aio_wait()
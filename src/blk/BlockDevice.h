@@ -72,6 +72,16 @@ enum struct blk_access_mode_t {
 blk_access_mode_t buffermode(bool buffered);
 std::ostream& operator<<(std::ostream& os, const blk_access_mode_t buffered);
 
+/// who an IOContext's ios are for; devices may prioritize and account by it
+enum struct blk_io_class_t : uint8_t {
+  CLIENT = 0,   ///< foreground object data
+  DEFERRED,     ///< flushes of deferred writes
+  KV,           ///< BlueFS/RocksDB log and foreground reads
+  COMPACTION,   ///< BlueFS/RocksDB background (sst writes, read-ahead)
+  MAX
+};
+const char* blk_io_class_name(blk_io_class_t c);
+
 /// track in-flight io
 struct IOContext {
   enum {
@@ -100,6 +110,7 @@ public:
   std::atomic_int num_running = {0};
   bool allow_eio;
   uint32_t flags = 0;               // FLAG_*
+  blk_io_class_t io_class = blk_io_class_t::CLIENT;
 
   explicit IOContext(CephContext* cct, void *p, bool allow_eio = false)
     : cct(cct), priv(p), allow_eio(allow_eio)
@@ -15,6 +15,7 @@
 #include <boost/intrusive/list.hpp>
 #include <boost/container/small_vector.hpp>
 
+#include "common/ceph_time.h"
 #include "include/buffer.h"
 #include "include/types.h"
 
@@ -34,6 +35,9 @@ struct aio_t {
   boost::container::small_vector<iovec,4> iov;
   uint64_t offset, length;
   long rval;
+  int fixed_buf = -1;     ///< io_uring registered buffer bouncing this io, if any
+  int ioprio = -1;        ///< ioprio(2) value, if any
+  ceph::mono_time submit_stamp;
   ceph::buffer::list bl;  ///< write payload (so that it remains stable for duration)
 
   boost::intrusive::list_member_hook<> queue_item;
@@ -79,6 +83,15 @@ struct aio_t {
 #endif
   }
 
+  /// must follow pwritev()/preadv(), which reset the iocb
+  void set_ioprio(int prio) {
+    ioprio = prio;
+#if defined(HAVE_LIBAIO) && defined(IOCB_FLAG_IOPRIO)
+    iocb.u.c.flags |= IOCB_FLAG_IOPRIO;
+    iocb.aio_reqprio = prio;
+#endif
+  }
+
   long get_return_value() {
     return rval;
   }
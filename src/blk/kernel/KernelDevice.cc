@@ -42,6 +42,7 @@
 
 #include "global/global_context.h"
 #include "io_uring.h"
+#include "common/perf_counters.h"
 
 #define dout_context cct
 #define dout_subsys ceph_subsys_bdev
@@ -78,7 +79,11 @@ KernelDevice::KernelDevice(CephContext* cct, aio_callback_t cb, void *cbpriv, ai
   if (use_ioring && ioring_queue_t::supported()) {
     bool use_ioring_hipri = cct->_conf.get_val<bool>("bdev_ioring_hipri");
     bool use_ioring_sqthread_poll = cct->_conf.get_val<bool>("bdev_ioring_sqthread_poll");
-    io_queue = std::make_unique<ioring_queue_t>(iodepth, use_ioring_hipri, use_ioring_sqthread_poll);
+    io_queue = std::make_unique<ioring_queue_t>(
+      iodepth, use_ioring_hipri, use_ioring_sqthread_poll,
+      cct->_conf.get_val<uint64_t>("bdev_ioring_sqthread_idle"),
+      cct->_conf.get_val<uint64_t>("bdev_ioring_fixed_buffers"),
+      cct->_conf.get_val<Option::size_t>("bdev_ioring_fixed_buffer_size"));
   } else {
     static bool once;
     if (use_ioring && !once) {
@@ -88,6 +93,7 @@ KernelDevice::KernelDevice(CephContext* cct, aio_callback_t cb, void *cbpriv, ai
     }
     io_queue = std::make_unique<aio_queue_t>(iodepth);
   }
+  _parse_io_classes();
 }
 
 KernelDevice::~KernelDevice()
@@ -281,8 +287,10 @@ int KernelDevice::open(const string& p)
     goto out_fail;
   }
 
+  _logger_create();
   r = _aio_start();
   if (r < 0) {
+    _logger_destroy();
     goto out_fail;
   }
 
@@ -339,6 +347,7 @@ void KernelDevice::close()
   if (_discard_started()) {
     _discard_stop();
   }
+  _logger_destroy();
   _pre_close();
 
   extblkdev::release_device(ebd_impl);
@@ -510,6 +519,11 @@ int KernelDevice::_aio_start()
 {
   if (aio) {
     dout(10) << __func__ << dendl;
+    auto ioring = dynamic_cast<ioring_queue_t*>(io_queue.get());
+    if (ioring) {
+      _ioring_logger_create();
+      ioring->set_logger(ioring_logger);
+    }
     int r = io_queue->init(fd_directs);
     if (r < 0) {
       if (r == -EAGAIN) {
@@ -518,8 +532,14 @@ int KernelDevice::_aio_start()
       } else {
 	derr << __func__ << " io_setup(2) failed: " << cpp_strerror(r) << dendl;
       }
+      _ioring_logger_destroy();
       return r;
     }
+    if (ioring && ioring->fixed_buffers &&
+	ioring->get_fixed_buffers() == 0) {
+      derr << __func__ << " failed to register " << ioring->fixed_buffers
+	   << " io_uring buffers; check RLIMIT_MEMLOCK" << dendl;
+    }
     aio_thread.create("bstore_aio");
   }
   return 0;
@@ -533,6 +553,195 @@ void KernelDevice::_aio_stop()
     aio_thread.join();
     aio_stop = false;
     io_queue->shutdown();
+    _ioring_logger_destroy();
+  }
+}
+
+void KernelDevice::_ioring_logger_create()
+{
+  std::string name = "bdev-ioring-" + (devname.empty() ? path : devname);
+  PerfCountersBuilder b(cct, name,
+			l_bdev_ioring_first, l_bdev_ioring_last);
+  b.add_u64_counter(l_bdev_ioring_submit, "submit",
+		    "io_uring_submit calls");
+  b.add_u64_counter(l_bdev_ioring_submitted, "submitted",
+		    "IOs submitted");
+  b.add_u64_counter(l_bdev_ioring_sq_full, "sq_full",
+		    "Submission waits on a full submission queue");
+  b.add_u64_counter(l_bdev_ioring_fixed, "fixed",
+		    "IOs done through registered buffers");
+  b.add_u64_counter(l_bdev_ioring_fixed_miss, "fixed_miss",
+		    "IOs that found no free registered buffer");
+  b.add_u64_counter(l_bdev_ioring_reap, "reap",
+		    "Completion batches reaped");
+  b.add_u64_counter(l_bdev_ioring_completed, "completed",
+		    "IOs reaped");
+  ioring_logger = b.create_perf_counters();
+  cct->get_perfcounters_collection()->add(ioring_logger);
+}
+
+void KernelDevice::_ioring_logger_destroy()
+{
+  if (ioring_logger) {
+    auto ioring = dynamic_cast<ioring_queue_t*>(io_queue.get());
+    ceph_assert(ioring);
+    ioring->set_logger(nullptr);
+    cct->get_perfcounters_collection()->remove(ioring_logger);
+    delete ioring_logger;
+    ioring_logger = nullptr;
+  }
+}
+
+void KernelDevice::_logger_create()
+{
+  // Latency axis configuration for io histograms, values are in nanoseconds
+  PerfHistogramCommon::axis_config_d lat_x_axis_config{
+    "Latency (usec)",
+    PerfHistogramCommon::SCALE_LOG2, ///< Latency in logarithmic scale
+    0,                               ///< Start at 0
+    10000,                           ///< Quantization unit is 10usec
+    24,                              ///< Enough to cover ~80s
+  };
+  // IO size axis configuration for io histograms, values are in bytes
+  PerfHistogramCommon::axis_config_d size_y_axis_config{
+    "IO size (bytes)",
+    PerfHistogramCommon::SCALE_LOG2, ///< IO size in logarithmic scale
+    0,                               ///< Start at 0
+    4096,                            ///< Quantization unit is 4KiB
+    16,                              ///< Enough to cover 128MiB
+  };
+
+  std::string name = "bdev-" + (devname.empty() ? path : devname);
+  PerfCountersBuilder b(cct, name, l_bdev_first, l_bdev_last);
+  // counter names must outlive the logger
+  static const char* class_counter_names[][2] = {
+    { "client_lat", "client_lat_histogram" },
+    { "deferred_lat", "deferred_lat_histogram" },
+    { "kv_lat", "kv_lat_histogram" },
+    { "compaction_lat", "compaction_lat_histogram" },
+  };
+  static_assert(std::size(class_counter_names) ==
+		(size_t)blk_io_class_t::MAX);
+  for (unsigned c = 0; c < (unsigned)blk_io_class_t::MAX; ++c) {
+    b.add_time_avg(l_bdev_client_lat + 2 * c,
+		   class_counter_names[c][0],
+		   "Average latency of ios of this class");
+    b.add_u64_counter_histogram(
+      l_bdev_client_lat_hist + 2 * c,
+      class_counter_names[c][1],
+      lat_x_axis_config, size_y_axis_config,
+      "Histogram of io latency + size for this class");
+  }
+  b.add_time_avg(l_bdev_throttle_lat, "throttle_lat",
+		 "Time submitters waited on a per-class in-flight limit");
+  b.add_u64_counter(l_bdev_discard_bytes, "discard_bytes",
+		    "Bytes discarded by the async discard threads",
+		    NULL, 0, unit_t(UNIT_BYTES));
+  b.add_time_avg(l_bdev_discard_wait_lat, "discard_wait_lat",
+		 "Time async discards were held back by pacing or client latency");
+  logger = b.create_perf_counters();
+  cct->get_perfcounters_collection()->add(logger);
+}
+
+void KernelDevice::_logger_destroy()
+{
+  if (logger) {
+    cct->get_perfcounters_collection()->remove(logger);
+    delete logger;
+    logger = nullptr;
+  }
+}
+
+/*
+ * Parse bdev_io_class_ioprio ("deferred=be:4,compaction=idle") and
+ * bdev_io_class_max_inflight ("compaction=16") into io_classes.
+ */
+void KernelDevice::_parse_io_classes()
+{
+  auto find_class = [](const std::string& name) -> int {
+    for (unsigned c = 0; c < (unsigned)blk_io_class_t::MAX; ++c) {
+      if (name == blk_io_class_name((blk_io_class_t)c)) {
+	return c;
+      }
+    }
+    return -1;
+  };
+  // see linux/ioprio.h
+  constexpr int IOPRIO_CLASS_SHIFT = 13;
+  for (auto& [k, v] : get_str_map(
+	 cct->_conf.get_val<std::string>("bdev_io_class_ioprio"), ",")) {
+    int c = find_class(k);
+    std::string cls = v.substr(0, v.find(':'));
+    int level = v.find(':') == std::string::npos ?
+      0 : atoi(v.substr(v.find(':') + 1).c_str());
+    int ioprio_class =
+      cls == "rt" ? 1 : cls == "be" ? 2 : cls == "idle" ? 3 : -1;
+    if (c < 0 || ioprio_class < 0 || level < 0 || level > 7) {
+      derr << __func__ << " ignoring bad bdev_io_class_ioprio entry "
+	   << k << "=" << v << dendl;
+      continue;
+    }
+    io_classes[c].ioprio = (ioprio_class << IOPRIO_CLASS_SHIFT) | level;
+  }
+  for (auto& [k, v] : get_str_map(
+	 cct->_conf.get_val<std::string>("bdev_io_class_max_inflight"), ",")) {
+    int c = find_class(k);
+    int n = atoi(v.c_str());
+    if (c < 0 || n < 0) {
+      derr << __func__ << " ignoring bad bdev_io_class_max_inflight entry "
+	   << k << "=" << v << dendl;
+      continue;
+    }
+    io_classes[c].max_inflight = n;
+  }
+  for (unsigned c = 0; c < (unsigned)blk_io_class_t::MAX; ++c) {
+    dout(10) << __func__ << " " << blk_io_class_name((blk_io_class_t)c)
+	     << " ioprio " << io_classes[c].ioprio
+	     << " max_inflight " << io_classes[c].max_inflight << dendl;
+  }
+}
+
+void KernelDevice::_io_class_start(IOContext *ioc, int pending)
+{
+  auto& cs = io_classes[(unsigned)ioc->io_class];
+  // never block the completion thread: it is the one that would wake us.
+  // a batch larger than the limit still goes out once the class is idle.
+  if (cs.max_inflight && !aio_thread.am_self()) {
+    std::unique_lock l(io_class_lock);
+    if (cs.inflight > 0 && cs.inflight + pending > cs.max_inflight) {
+      auto start = mono_clock::now();
+      io_class_cond.wait(l, [&] {
+	return cs.inflight == 0 || cs.inflight + pending <= cs.max_inflight;
+      });
+      if (logger) {
+	logger->tinc(l_bdev_throttle_lat, mono_clock::now() - start);
+      }
+    }
+    cs.inflight += pending;
+  } else {
+    cs.inflight += pending;
+  }
+}
+
+void KernelDevice::_io_class_finish(IOContext *ioc, const aio_t& aio)
+{
+  unsigned c = (unsigned)ioc->io_class;
+  auto& cs = io_classes[c];
+  if (cs.max_inflight) {
+    std::lock_guard l(io_class_lock);
+    --cs.inflight;
+    io_class_cond.notify_all();
+  } else {
+    --cs.inflight;
+  }
+  auto lat = mono_clock::now() - aio.submit_stamp;
+  if (ioc->io_class == blk_io_class_t::CLIENT) {
+    _note_client_lat(lat);
+  }
+  if (logger) {
+    logger->tinc(l_bdev_client_lat + 2 * c, lat);
+    logger->hinc(l_bdev_client_lat_hist + 2 * c,
+		 std::chrono::nanoseconds(lat).count(), aio.length);
   }
 }
 
@@ -571,6 +780,7 @@ void KernelDevice::_discard_stop()
     }
 
     discard_cond.notify_all();
+    discard_pace_cond.notify_all();
   }
 
   // Threads are shared pointers and are cleaned up for us
@@ -591,9 +801,13 @@ void KernelDevice::discard_drain()
 {
   dout(10) << __func__ << dendl;
   std::unique_lock l(discard_lock);
+  // whoever waits for the queue to empty should not wait for the pacing
+  ++discard_draining;
+  discard_pace_cond.notify_all();
   while (!discard_queued.empty() || discard_running) {
     discard_cond.wait(l);
   }
+  --discard_draining;
 }
 
 static bool is_expected_ioerr(const int r)
@@ -629,6 +843,7 @@ void KernelDevice::_aio_thread()
       for (int i = 0; i < r; ++i) {
 	IOContext *ioc = static_cast<IOContext*>(aio[i]->priv);
 	_aio_log_finish(ioc, aio[i]->offset, aio[i]->length);
+	_io_class_finish(ioc, *aio[i]);
 	if (aio[i]->queue_item.is_linked()) {
 	  std::lock_guard l(debug_queue_lock);
 	  debug_aio_unlink(*aio[i]);
@@ -755,29 +970,120 @@ void KernelDevice::_discard_thread(uint64_t tid)
       discard_cond.wait(l);
       dout(20) << __func__ << " wake" << dendl;
     } else {
-      // Swap the queued discards for a local list we'll process here
-      // without caring about thread fairness.  This allows the current
-      // thread to wait on the discard running while other threads pick
-      // up the next-in-queue, and do the same, ultimately issuing more
-      // discards in parallel, which is the goal.
-      discard_processing.swap(discard_queued);
-      discard_running = true;
+      // Take the queued discards (or the lowest batch of them) into a
+      // local list we'll process here without caring about thread
+      // fairness.  This allows the current thread to wait on the discard
+      // running while other threads pick up the next-in-queue, and do the
+      // same, ultimately issuing more discards in parallel, which is the
+      // goal.  The queue is an interval_set, so released extents arrive
+      // here already coalesced and sorted.
+      uint64_t batch = cct->_conf.get_val<Option::size_t>(
+	"bdev_async_discard_batch_bytes");
+      if (batch == 0) {
+	discard_processing.swap(discard_queued);
+      } else {
+	uint64_t taken = 0;
+	while (!discard_queued.empty() && taken < batch) {
+	  auto p = discard_queued.begin();
+	  uint64_t off = p.get_start();
+	  uint64_t len = std::min(p.get_len(), batch - taken);
+	  discard_queued.erase(off, len);
+	  discard_processing.insert(off, len);
+	  taken += len;
+	}
+      }
+      ++discard_running;
       l.unlock();
       dout(20) << __func__ << " finishing" << dendl;
       for (auto p = discard_processing.begin(); p != discard_processing.end(); ++p) {
-        _discard(p.get_start(), p.get_len());
+	uint64_t off = p.get_start();
+	uint64_t left = p.get_len();
+	while (left > 0) {
+	  // split so that pacing works on bounded pieces
+	  uint64_t len = batch ? std::min(left, batch) : left;
+	  _discard_wait(thr, len);
+	  _discard(off, len);
+	  if (logger) {
+	    logger->inc(l_bdev_discard_bytes, len);
+	  }
+	  off += len;
+	  left -= len;
+	}
       }
 
       discard_callback(discard_callback_priv, static_cast<void*>(&discard_processing));
       discard_processing.clear();
       l.lock();
-      discard_running = false;
+      --discard_running;
     }
   }
 
   dout(10) << __func__ << " thread " << tid << " finish" << dendl;
 }
 
+/*
+ * Hold a discard of len bytes back while clients see high latency (up to
+ * bdev_async_discard_max_defer) and until the bytes/sec budget allows
+ * it.  Neither applies once the thread is told to stop or someone drains.
+ */
+void KernelDevice::_discard_wait(const std::shared_ptr<DiscardThread>& thr,
+				 uint64_t len)
+{
+  uint64_t rate = cct->_conf.get_val<Option::size_t>(
+    "bdev_async_discard_max_bytes_per_sec");
+  uint64_t defer_lat_ns = cct->_conf.get_val<std::chrono::milliseconds>(
+    "bdev_async_discard_defer_latency").count() * 1000000ull;
+  if (!rate && !defer_lat_ns) {
+    return;
+  }
+  // wait in slices so that a missed wakeup costs little
+  constexpr auto slice = std::chrono::milliseconds(100);
+  std::unique_lock l(discard_lock);
+  auto stopping = [&] { return thr->stop || discard_draining > 0; };
+  auto start = mono_clock::now();
+
+  if (defer_lat_ns) {
+    auto deadline = start + make_timespan(
+      cct->_conf.get_val<double>("bdev_async_discard_max_defer"));
+    auto client_busy = [&] {
+      // the average only means something while clients are doing io
+      uint64_t now_ns = std::chrono::nanoseconds(
+	mono_clock::now().time_since_epoch()).count();
+      return client_lat_avg_ns > defer_lat_ns &&
+	now_ns - client_lat_stamp_ns < 1000000000ull;
+    };
+    while (!stopping() && client_busy() && mono_clock::now() < deadline) {
+      discard_pace_cond.wait_for(l, std::chrono::milliseconds(10));
+    }
+  }
+  if (rate) {
+    auto now = mono_clock::now();
+    if (discard_next_issue < now) {
+      discard_next_issue = now;
+    }
+    auto mine = discard_next_issue;
+    discard_next_issue += make_timespan((double)len / rate);
+    while (!stopping() && (now = mono_clock::now()) < mine) {
+      discard_pace_cond.wait_for(l, std::min<ceph::timespan>(mine - now, slice));
+    }
+  }
+  if (logger) {
+    logger->tinc(l_bdev_discard_wait_lat, mono_clock::now() - start);
+  }
+}
+
+void KernelDevice::_note_client_lat(ceph::timespan lat)
+{
+  // approximate moving average over the last ~16 client ios; racing
+  // updaters may lose a sample, which is fine for a throttle hint
+  uint64_t ns = std::chrono::nanoseconds(lat).count();
+  uint64_t avg = client_lat_avg_ns.load(std::memory_order_relaxed);
+  client_lat_avg_ns.store(avg - avg / 16 + ns / 16, std::memory_order_relaxed);
+  client_lat_stamp_ns.store(
+    std::chrono::nanoseconds(mono_clock::now().time_since_epoch()).count(),
+    std::memory_order_relaxed);
+}
+
 // this is private and is expected that the caller checks that discard
 // threads are running via _discard_started()
 void KernelDevice::_queue_discard(interval_set<uint64_t> &to_release)
@@ -887,6 +1193,8 @@ void KernelDevice::aio_submit(IOContext *ioc)
     return;
   }
 
+  _io_class_start(ioc, ioc->num_pending.load());
+
   // move these aside, and get our end iterator position now, as the
   // aios might complete as soon as they are submitted and queue more
   // wal aio's.
@@ -908,6 +1216,17 @@ void KernelDevice::aio_submit(IOContext *ioc)
     }
   }
 
+  {
+    auto now = mono_clock::now();
+    int ioprio = io_classes[(unsigned)ioc->io_class].ioprio;
+    for (auto p = ioc->running_aios.begin(); p != e; ++p) {
+      p->submit_stamp = now;
+      if (ioprio >= 0) {
+	p->set_ioprio(ioprio);
+      }
+    }
+  }
+
   void *priv = static_cast<void*>(ioc);
   int r, retries = 0;
   // num of pending aios should not overflow when passed to submit_batch()
@@ -1323,6 +1642,16 @@ int KernelDevice::read(uint64_t off, uint64_t len, bufferlist *pbl,
   }
   ceph_assert((uint64_t)r == len);
   pbl->push_back(std::move(p));
+  if (ioc->io_class == blk_io_class_t::CLIENT) {
+    _note_client_lat(mono_clock::now() - start1);
+  }
+  if (logger) {
+    unsigned c = (unsigned)ioc->io_class;
+    auto lat = mono_clock::now() - start1;
+    logger->tinc(l_bdev_client_lat + 2 * c, lat);
+    logger->hinc(l_bdev_client_lat_hist + 2 * c,
+		 std::chrono::nanoseconds(lat).count(), len);
+  }
 
   dout(40) << "data:\n"; 
   pbl->hexdump(*_dout);
@@ -15,6 +15,7 @@
 #ifndef CEPH_BLK_KERNELDEVICE_H
 #define CEPH_BLK_KERNELDEVICE_H
 
+#include <array>
 #include <atomic>
 
 #include "include/types.h"
@@ -29,6 +30,23 @@
 
 #define RW_IO_MAX (INT_MAX & CEPH_PAGE_MASK)
 
+enum {
+  l_bdev_first = 35100,
+  // one latency avg + histogram pair per blk_io_class_t, in order
+  l_bdev_client_lat,
+  l_bdev_client_lat_hist,
+  l_bdev_deferred_lat,
+  l_bdev_deferred_lat_hist,
+  l_bdev_kv_lat,
+  l_bdev_kv_lat_hist,
+  l_bdev_compaction_lat,
+  l_bdev_compaction_lat_hist,
+  l_bdev_throttle_lat,
+  l_bdev_discard_bytes,
+  l_bdev_discard_wait_lat,
+  l_bdev_last,
+};
+
 class KernelDevice : public BlockDevice,
                      public md_config_obs_t {
 protected:
@@ -49,14 +67,33 @@ private:
   ceph::mutex flush_mutex = ceph::make_mutex("KernelDevice::flush_mutex");
 
   std::unique_ptr<io_queue_t> io_queue;
+  PerfCounters *ioring_logger = nullptr;  ///< only with the io_uring engine
+  PerfCounters *logger = nullptr;         ///< while open
+
+  struct io_class_state_t {
+    int ioprio = -1;         ///< ioprio(2) value; -1 leaves it to the kernel
+    int max_inflight = 0;    ///< aios in flight before submitters wait; 0 = no limit
+    std::atomic<int> inflight = {0};
+  };
+  std::array<io_class_state_t, (size_t)blk_io_class_t::MAX> io_classes;
+  ceph::mutex io_class_lock = ceph::make_mutex("KernelDevice::io_class_lock");
+  ceph::condition_variable io_class_cond;
   aio_callback_t discard_callback;
   void *discard_callback_priv;
   bool aio_stop;
 
   ceph::mutex discard_lock = ceph::make_mutex("KernelDevice::discard_lock");
   ceph::condition_variable discard_cond;
-  bool discard_running = false;
+  unsigned discard_running = 0;     ///< threads issuing a batch
+  unsigned discard_draining = 0;    ///< drainers; pacing is off while > 0
   interval_set<uint64_t> discard_queued;
+  /// wakes threads waiting for the rate limit or for client latency
+  ceph::condition_variable discard_pace_cond;
+  ceph::mono_time discard_next_issue;  ///< rate limit: next discard slot
+
+  /// moving average of client io latency, and when it was last updated
+  std::atomic<uint64_t> client_lat_avg_ns = {0};
+  std::atomic<uint64_t> client_lat_stamp_ns = {0};
 
   struct AioCompletionThread : public Thread {
     KernelDevice *bdev;
@@ -87,11 +124,21 @@ private:
 
   void _aio_thread();
   void _discard_thread(uint64_t tid);
+  void _discard_wait(const std::shared_ptr<DiscardThread>& thr, uint64_t len);
+  void _note_client_lat(ceph::timespan lat);
   void _queue_discard(interval_set<uint64_t> &to_release);
   bool try_discard(interval_set<uint64_t> &to_release, bool async = true) override;
 
   int _aio_start();
   void _aio_stop();
+  void _ioring_logger_create();
+  void _ioring_logger_destroy();
+  void _logger_create();
+  void _logger_destroy();
+
+  void _parse_io_classes();
+  void _io_class_start(IOContext *ioc, int pending);
+  void _io_class_finish(IOContext *ioc, const aio_t& aio);
 
   void _discard_start();
   void _discard_stop();
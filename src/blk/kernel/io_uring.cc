@@ -7,6 +7,9 @@
 
 #include "liburing.h"
 #include <sys/epoll.h>
+#include <sys/mman.h>
+
+#include "common/perf_counters.h"
 
 using std::list;
 using std::make_unique;
@@ -17,8 +20,45 @@ struct ioring_data {
   pthread_mutex_t sq_mutex;
   int epoll_fd = -1;
   std::map<int, int> fixed_fds_map;
+
+  // registered bounce buffers; one iovec (and buffer index) per slot
+  void *fixed_base = nullptr;
+  size_t fixed_len = 0;
+  uint64_t fixed_slot_size = 0;
+  std::vector<int> fixed_free;
+  pthread_mutex_t fixed_mutex;
 };
 
+static inline void ioring_inc(PerfCounters *logger, int idx, uint64_t v = 1)
+{
+  if (logger)
+    logger->inc(idx, v);
+}
+
+static char *fixed_buf_addr(struct ioring_data *d, int slot)
+{
+  return (char *)d->fixed_base + (uint64_t)slot * d->fixed_slot_size;
+}
+
+static int get_fixed_buf(struct ioring_data *d)
+{
+  int slot = -1;
+  pthread_mutex_lock(&d->fixed_mutex);
+  if (!d->fixed_free.empty()) {
+    slot = d->fixed_free.back();
+    d->fixed_free.pop_back();
+  }
+  pthread_mutex_unlock(&d->fixed_mutex);
+  return slot;
+}
+
+static void put_fixed_buf(struct ioring_data *d, int slot)
+{
+  pthread_mutex_lock(&d->fixed_mutex);
+  d->fixed_free.push_back(slot);
+  pthread_mutex_unlock(&d->fixed_mutex);
+}
+
 static int ioring_get_cqe(struct ioring_data *d, unsigned int max,
 			  struct aio_t **paio)
 {
@@ -31,6 +71,14 @@ static int ioring_get_cqe(struct ioring_data *d, unsigned int max,
     struct aio_t *io = (struct aio_t *)(uintptr_t) io_uring_cqe_get_data(cqe);
     io->rval = cqe->res;
 
+    if (io->fixed_buf >= 0) {
+      if (io->iocb.aio_lio_opcode == IO_CMD_PREADV && cqe->res > 0)
+	memcpy(io->iov[0].iov_base, fixed_buf_addr(d, io->fixed_buf),
+	       cqe->res);
+      put_fixed_buf(d, io->fixed_buf);
+      io->fixed_buf = -1;
+    }
+
     paio[nr++] = io;
 
     if (nr == max)
@@ -50,51 +98,116 @@ static int find_fixed_fd(struct ioring_data *d, int real_fd)
   return it->second;
 }
 
-static void init_sqe(struct ioring_data *d, struct io_uring_sqe *sqe,
-		     struct aio_t *io)
+/*
+ * A single-segment io that fits in a slot goes through a registered
+ * buffer, which saves the kernel from pinning the user pages on every
+ * submission.  Writes are copied in here, reads are copied out when
+ * reaped.
+ */
+static bool init_fixed_sqe(struct ioring_data *d, PerfCounters *logger,
+			   struct io_uring_sqe *sqe, struct aio_t *io,
+			   int fixed_fd)
+{
+  if (!d->fixed_base || io->iov.size() != 1 ||
+      io->iov[0].iov_len > d->fixed_slot_size)
+    return false;
+
+  int slot = get_fixed_buf(d);
+  if (slot < 0) {
+    ioring_inc(logger, l_bdev_ioring_fixed_miss);
+    return false;
+  }
+  io->fixed_buf = slot;
+  char *buf = fixed_buf_addr(d, slot);
+  unsigned len = io->iov[0].iov_len;
+  if (io->iocb.aio_lio_opcode == IO_CMD_PWRITEV) {
+    memcpy(buf, io->iov[0].iov_base, len);
+    io_uring_prep_write_fixed(sqe, fixed_fd, buf, len, io->offset, slot);
+  } else {
+    io_uring_prep_read_fixed(sqe, fixed_fd, buf, len, io->offset, slot);
+  }
+  ioring_inc(logger, l_bdev_ioring_fixed);
+  return true;
+}
+
+static void init_sqe(struct ioring_data *d, PerfCounters *logger,
+		     struct io_uring_sqe *sqe, struct aio_t *io)
 {
   int fixed_fd = find_fixed_fd(d, io->fd);
 
   ceph_assert(fixed_fd != -1);
 
-  if (io->iocb.aio_lio_opcode == IO_CMD_PWRITEV)
-    io_uring_prep_writev(sqe, fixed_fd, &io->iov[0],
-			 io->iov.size(), io->offset);
-  else if (io->iocb.aio_lio_opcode == IO_CMD_PREADV)
-    io_uring_prep_readv(sqe, fixed_fd, &io->iov[0],
-			io->iov.size(), io->offset);
-  else
+  if (io->iocb.aio_lio_opcode != IO_CMD_PWRITEV &&
+      io->iocb.aio_lio_opcode != IO_CMD_PREADV)
     ceph_assert(0);
 
+  if (!init_fixed_sqe(d, logger, sqe, io, fixed_fd)) {
+    if (io->iocb.aio_lio_opcode == IO_CMD_PWRITEV)
+      io_uring_prep_writev(sqe, fixed_fd, &io->iov[0],
+			   io->iov.size(), io->offset);
+    else
+      io_uring_prep_readv(sqe, fixed_fd, &io->iov[0],
+			  io->iov.size(), io->offset);
+  }
+
+  if (io->ioprio >= 0)
+    sqe->ioprio = io->ioprio;
   io_uring_sqe_set_data(sqe, io);
   io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
 }
 
-static int ioring_queue(struct ioring_data *d, void *priv,
-			list<aio_t>::iterator beg, list<aio_t>::iterator end)
+static int ioring_queue(struct ioring_data *d, PerfCounters *logger,
+			void *priv, list<aio_t>::iterator beg,
+			list<aio_t>::iterator end, int *retries)
 {
   struct io_uring *ring = &d->io_uring;
-  struct aio_t *io = nullptr;
+  // same back-off as aio_queue_t::submit_batch
+  int attempts = 16;
+  int delay = 125;
+  int queued = 0;
+  int submitted = 0;
 
   ceph_assert(beg != end);
 
-  do {
+  while (beg != end) {
     struct io_uring_sqe *sqe = io_uring_get_sqe(ring);
-    if (!sqe)
-      break;
-
-    io = &*beg;
+    if (!sqe) {
+      /* SQ is full: push out what we have and wait for the kernel to
+       * consume it */
+      if (queued) {
+	int r = io_uring_submit(ring);
+	ioring_inc(logger, l_bdev_ioring_submit);
+	if (r < 0)
+	  return r;
+	submitted += r;
+	queued = 0;
+	continue;
+      }
+      if (attempts-- == 0)
+	return -EAGAIN;
+      ioring_inc(logger, l_bdev_ioring_sq_full);
+      (*retries)++;
+      usleep(delay);
+      delay *= 2;
+      continue;
+    }
+
+    struct aio_t *io = &*beg;
     io->priv = priv;
+    init_sqe(d, logger, sqe, io);
+    ++queued;
+    ++beg;
+    attempts = 16;
+  }
 
-    init_sqe(d, sqe, io);
-
-  } while (++beg != end);
-
-  if (!io)
-    /* Queue is full, go and reap something first */
-    return 0;
-
-  return io_uring_submit(ring);
+  /* one submission (and, without SQPOLL, one syscall) for the batch */
+  int r = io_uring_submit(ring);
+  ioring_inc(logger, l_bdev_ioring_submit);
+  if (r < 0)
+    return r;
+  submitted += r;
+  ioring_inc(logger, l_bdev_ioring_submitted, submitted);
+  return submitted;
 }
 
 static void build_fixed_fds_map(struct ioring_data *d,
@@ -106,11 +219,62 @@ static void build_fixed_fds_map(struct ioring_data *d,
   }
 }
 
-ioring_queue_t::ioring_queue_t(unsigned iodepth_, bool hipri_, bool sq_thread_) :
+static void release_fixed_buffers(struct ioring_data *d)
+{
+  if (d->fixed_base) {
+    munmap(d->fixed_base, d->fixed_len);
+    d->fixed_base = nullptr;
+  }
+  d->fixed_len = 0;
+  d->fixed_free.clear();
+}
+
+/*
+ * Registered buffers are pinned and count against RLIMIT_MEMLOCK, so a
+ * failure here just leaves the queue on the plain readv/writev path.
+ */
+static void register_fixed_buffers(struct ioring_data *d, unsigned count,
+				   uint64_t slot_size)
+{
+  slot_size = p2roundup<uint64_t>(slot_size, CEPH_PAGE_SIZE);
+  if (!count || !slot_size)
+    return;
+
+  size_t len = count * slot_size;
+  void *base = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+		    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED)
+    return;
+
+  std::vector<struct iovec> iov(count);
+  for (unsigned i = 0; i < count; ++i) {
+    iov[i].iov_base = (char *)base + i * slot_size;
+    iov[i].iov_len = slot_size;
+  }
+  if (io_uring_register_buffers(&d->io_uring, iov.data(), count) < 0) {
+    munmap(base, len);
+    return;
+  }
+
+  d->fixed_base = base;
+  d->fixed_len = len;
+  d->fixed_slot_size = slot_size;
+  d->fixed_free.reserve(count);
+  for (int i = count - 1; i >= 0; --i)
+    d->fixed_free.push_back(i);
+}
+
+ioring_queue_t::ioring_queue_t(unsigned iodepth_, bool hipri_, bool sq_thread_,
+			       unsigned sq_thread_idle_ms_,
+			       unsigned fixed_buffers_,
+			       uint64_t fixed_buffer_size_) :
   d(make_unique<ioring_data>()),
   iodepth(iodepth_),
   hipri(hipri_),
-  sq_thread(sq_thread_)
+  sq_thread(sq_thread_),
+  sq_thread_idle_ms(sq_thread_idle_ms_),
+  fixed_buffers(fixed_buffers_),
+  fixed_buffer_size(fixed_buffer_size_)
 {
 }
 
@@ -118,19 +282,28 @@ ioring_queue_t::~ioring_queue_t()
 {
 }
 
+unsigned ioring_queue_t::get_fixed_buffers() const
+{
+  return d->fixed_base ? d->fixed_len / d->fixed_slot_size : 0;
+}
+
 int ioring_queue_t::init(std::vector<int> &fds)
 {
-  unsigned flags = 0;
+  struct io_uring_params params;
 
   pthread_mutex_init(&d->cq_mutex, NULL);
   pthread_mutex_init(&d->sq_mutex, NULL);
+  pthread_mutex_init(&d->fixed_mutex, NULL);
 
+  memset(&params, 0, sizeof(params));
   if (hipri)
-    flags |= IORING_SETUP_IOPOLL;
-  if (sq_thread)
-    flags |= IORING_SETUP_SQPOLL;
+    params.flags |= IORING_SETUP_IOPOLL;
+  if (sq_thread) {
+    params.flags |= IORING_SETUP_SQPOLL;
+    params.sq_thread_idle = sq_thread_idle_ms;
+  }
 
-  int ret = io_uring_queue_init(iodepth, &d->io_uring, flags);
+  int ret = io_uring_queue_init_params(iodepth, &d->io_uring, &params);
   if (ret < 0)
     return ret;
 
@@ -142,6 +315,7 @@ int ioring_queue_t::init(std::vector<int> &fds)
   }
 
   build_fixed_fds_map(d.get(), fds);
+  register_fixed_buffers(d.get(), fixed_buffers, fixed_buffer_size);
 
   d->epoll_fd = epoll_create1(0);
   if (d->epoll_fd < 0) {
@@ -163,6 +337,7 @@ close_epoll_fd:
   close(d->epoll_fd);
 close_ring_fd:
   io_uring_queue_exit(&d->io_uring);
+  release_fixed_buffers(d.get());
 
   return ret;
 }
@@ -173,6 +348,7 @@ void ioring_queue_t::shutdown()
   close(d->epoll_fd);
   d->epoll_fd = -1;
   io_uring_queue_exit(&d->io_uring);
+  release_fixed_buffers(d.get());
 }
 
 int ioring_queue_t::submit_batch(aio_iter beg, aio_iter end,
@@ -180,10 +356,9 @@ int ioring_queue_t::submit_batch(aio_iter beg, aio_iter end,
                                  int *retries)
 {
   (void)aios_size;
-  (void)retries;
 
   pthread_mutex_lock(&d->sq_mutex);
-  int rc = ioring_queue(d.get(), priv, beg, end);
+  int rc = ioring_queue(d.get(), logger, priv, beg, end, retries);
   pthread_mutex_unlock(&d->sq_mutex);
 
   return rc;
@@ -204,6 +379,9 @@ get_cqe:
     else if (ret > 0)
       /* Time to reap */
       goto get_cqe;
+  } else {
+    ioring_inc(logger, l_bdev_ioring_reap);
+    ioring_inc(logger, l_bdev_ioring_completed, events);
   }
 
   return events;
@@ -224,7 +402,15 @@ bool ioring_queue_t::supported()
 
 struct ioring_data {};
 
-ioring_queue_t::ioring_queue_t(unsigned iodepth_, bool hipri_, bool sq_thread_)
+ioring_queue_t::ioring_queue_t(unsigned iodepth_, bool hipri_, bool sq_thread_,
+			       unsigned sq_thread_idle_ms_,
+			       unsigned fixed_buffers_,
+			       uint64_t fixed_buffer_size_)
+{
+  ceph_assert(0);
+}
+
+unsigned ioring_queue_t::get_fixed_buffers() const
 {
   ceph_assert(0);
 }
@@ -5,9 +5,22 @@
 
 #include "acconfig.h"
 
+#include "include/common_fwd.h"
 #include "include/types.h"
 #include "aio/aio.h"
 
+enum {
+  l_bdev_ioring_first = 35000,
+  l_bdev_ioring_submit,
+  l_bdev_ioring_submitted,
+  l_bdev_ioring_sq_full,
+  l_bdev_ioring_fixed,
+  l_bdev_ioring_fixed_miss,
+  l_bdev_ioring_reap,
+  l_bdev_ioring_completed,
+  l_bdev_ioring_last,
+};
+
 struct ioring_data;
 
 struct ioring_queue_t final : public io_queue_t {
@@ -15,15 +28,30 @@ struct ioring_queue_t final : public io_queue_t {
   unsigned iodepth = 0;
   bool hipri = false;
   bool sq_thread = false;
+  unsigned sq_thread_idle_ms = 0;
+  unsigned fixed_buffers = 0;
+  uint64_t fixed_buffer_size = 0;
+  PerfCounters *logger = nullptr;
 
   typedef std::list<aio_t>::iterator aio_iter;
 
   // Returns true if arch is x86-64 and kernel supports io_uring
   static bool supported();
 
-  ioring_queue_t(unsigned iodepth_, bool hipri_, bool sq_thread_);
+  ioring_queue_t(unsigned iodepth_, bool hipri_, bool sq_thread_,
+		 unsigned sq_thread_idle_ms_ = 0,
+		 unsigned fixed_buffers_ = 0,
+		 uint64_t fixed_buffer_size_ = 0);
   ~ioring_queue_t() final;
 
+  /// optional; must be set before init() and outlive shutdown()
+  void set_logger(PerfCounters *l) {
+    logger = l;
+  }
+  /// number of registered bounce buffers actually in use (0 if the
+  /// kernel refused to register them)
+  unsigned get_fixed_buffers() const;
+
   int init(std::vector<int> &fds) final;
   void shutdown() final;
 
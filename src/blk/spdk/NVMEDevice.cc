@@ -153,6 +153,8 @@ class SharedDriverQueueData {
   int alloc_buf_from_pool(Task *t, bool write);
 
   public:
+    /// a qpair must not be used by two threads at once
+    ceph::mutex lock = ceph::make_mutex("SharedDriverQueueData::lock");
     uint32_t current_queue_depth = 0;
     std::atomic_ulong completed_op_seq, queue_op_seq;
     bi::slist<data_cache_buf, bi::constant_time_size<true>> data_buf_list;
@@ -712,6 +714,10 @@ NVMEDevice::NVMEDevice(CephContext* cct, aio_callback_t cb, void *cbpriv)
 {
 }
 
+NVMEDevice::~NVMEDevice()
+{
+}
+
 bool NVMEDevice::support(const std::string& path)
 {
   char buf[PATH_MAX + 1];
@@ -757,6 +763,12 @@ int NVMEDevice::open(const string& p)
   //nvme is non-rotational device.
   rotational = false;
 
+  unsigned num_queues = std::max<uint64_t>(
+    1, cct->_conf.get_val<uint64_t>("bluestore_spdk_qpairs"));
+  for (unsigned i = 0; i < num_queues; ++i) {
+    queues.emplace_back(std::make_unique<SharedDriverQueueData>(this, driver));
+  }
+
   // round size down to an even block
   size &= ~(block_size - 1);
 
@@ -773,6 +785,7 @@ void NVMEDevice::close()
   dout(1) << __func__ << dendl;
 
   name.clear();
+  queues.clear();
   driver->remove_device(this);
 
   dout(1) << __func__ << " end" << dendl;
@@ -810,8 +823,14 @@ void NVMEDevice::aio_submit(IOContext *ioc)
     // Only need to push the first entry
     ioc->nvme_task_first = ioc->nvme_task_last = nullptr;
 
-    thread_local SharedDriverQueueData queue_t = SharedDriverQueueData(this, driver);
-    queue_t._aio_handle(t, ioc);
+    // Threads are spread over the device's qpairs round robin and keep
+    // theirs, so with at least as many qpairs as OSD op shard threads
+    // every shard submits to and polls its own qpair inline.
+    static std::atomic<unsigned> next_queue_slot = {0};
+    thread_local unsigned queue_slot = next_queue_slot++;
+    auto& queue = *queues[queue_slot % queues.size()];
+    std::lock_guard l(queue.lock);
+    queue._aio_handle(t, ioc);
   }
 }
 
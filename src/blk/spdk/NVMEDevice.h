@@ -17,9 +17,11 @@
 #ifndef CEPH_BLK_NVMEDEVICE
 #define CEPH_BLK_NVMEDEVICE
 
+#include <memory>
 #include <queue>
 #include <map>
 #include <limits>
+#include <vector>
 
 // since _Static_assert introduced in c11
 #define _Static_assert static_assert
@@ -46,11 +48,14 @@ class NVMEDevice : public BlockDevice {
    */
   SharedDriverData *driver;
   std::string name;
+  /// io qpairs, one per submitting thread if there are enough of them
+  std::vector<std::unique_ptr<SharedDriverQueueData>> queues;
 
  public:
   SharedDriverData *get_driver() { return driver; }
 
   NVMEDevice(CephContext* cct, aio_callback_t cb, void *cbpriv);
+  ~NVMEDevice() override;
 
   bool supported_bdev_label() override { return false; }
 
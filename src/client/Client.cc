@@ -9461,16 +9461,23 @@ int Client::readdir_r_cb(dir_result_t* d,
   unsigned flags,
   bool getref)
 {
-  auto fill_readdir_cb = [](dir_result_t* dirp,
-			    MetaRequest* req,
-			    InodeRef& diri,
-			    frag_t fg) {
+  auto fill_readdir_cb = [this](dir_result_t* dirp,
+				MetaRequest* req,
+				InodeRef& diri,
+				frag_t fg) {
     filepath path;
     diri->make_nosnap_relative_path(path);
     req->set_filepath(path);
     req->set_inode(diri.get());
     req->head.args.readdir.frag = fg;
     req->head.args.readdir.flags = CEPH_READDIR_REPLY_BITFLAGS;
+    // both limits go out as 32-bit fields; don't let large values wrap
+    req->head.args.readdir.max_bytes = std::min<uint64_t>(
+      cct->_conf.get_val<Option::size_t>("client_readdir_max_bytes"),
+      std::numeric_limits<uint32_t>::max());
+    req->head.args.readdir.max_entries = std::min<uint64_t>(
+      cct->_conf.get_val<uint64_t>("client_readdir_max_entries"),
+      std::numeric_limits<uint32_t>::max());
     if (dirp->last_name.length()) {
       req->path2.set_path(dirp->last_name);
     } else if (dirp->hash_order()) {
@@ -12014,6 +12021,44 @@ int Client::_fsync(Inode *in, bool syncdataonly)
 {
   ceph_assert(ceph_mutex_is_locked_by_me(client_lock));
 
+  if (!cct->_conf.get_val<bool>("client_fsync_group_commit"))
+    return _do_fsync(in, syncdataonly);
+
+  /*
+   * Group commit: concurrent fsyncs on an inode wait for the flush in
+   * progress to finish and then share a single flush that covers
+   * everything dirtied while they waited.  Our writes are only covered
+   * by a flush that starts after we got here.
+   */
+  InodeRef ref(in);
+  uint64_t target = in->fsync_started + 1;
+  if (!syncdataonly)
+    in->fsync_want_metadata = true;
+
+  while (in->fsync_done < target) {
+    if (in->fsync_started == in->fsync_done) {
+      uint64_t gen = ++in->fsync_started;
+      bool dataonly = !in->fsync_want_metadata;
+      in->fsync_want_metadata = false;
+      ldout(cct, 10) << __func__ << " " << *in << " leading group fsync "
+		     << gen << dendl;
+      int r = _do_fsync(in, dataonly);
+      in->fsync_done = gen;
+      in->fsync_result = r;
+      signal_context_list(in->waitfor_fsync);
+      return r;
+    }
+    ldout(cct, 10) << __func__ << " " << *in << " waiting for group fsync "
+		   << in->fsync_started << dendl;
+    wait_on_context_list(in->waitfor_fsync);
+  }
+  return in->fsync_result;
+}
+
+int Client::_do_fsync(Inode *in, bool syncdataonly)
+{
+  ceph_assert(ceph_mutex_is_locked_by_me(client_lock));
+
   int r = 0;
   std::unique_ptr<C_SaferCond> object_cacher_completion = nullptr;
   ceph_tid_t flush_tid = 0;
@@ -243,6 +243,13 @@ struct Inode : RefCountedObject {
   std::list<Context*> waitfor_commit;
   std::list<ceph::condition_variable*> waitfor_deleg;
 
+  // fsync group commit, see Client::_fsync()
+  uint64_t fsync_started = 0;
+  uint64_t fsync_done = 0;
+  int fsync_result = 0;
+  bool fsync_want_metadata = false;
+  std::list<Context*> waitfor_fsync;
+
   Dentry *get_first_parent() {
     ceph_assert(!dentries.empty());
     return *dentries.begin();
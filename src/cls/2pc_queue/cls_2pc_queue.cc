@@ -325,6 +325,124 @@ static int cls_2pc_queue_commit(cls_method_context_t hctx, bufferlist *in, buffe
   return queue_write_head(hctx, head);
 }
 
+// commit several reservations in one call
+// head and xattrs are read and written once for the whole batch, and the batch
+// is validated before anything is enqueued, so either all reservations are committed or none
+static int cls_2pc_queue_commit_batch(cls_method_context_t hctx, bufferlist *in, bufferlist *out) {
+  cls_2pc_queue_commit_batch_op batch_op;
+  try {
+    auto in_iter = in->cbegin();
+    decode(batch_op, in_iter);
+  } catch (ceph::buffer::error& err) {
+    CLS_LOG(1, "ERROR: cls_2pc_queue_commit_batch: failed to decode entry: %s", err.what());
+    return -EINVAL;
+  }
+
+  // get head
+  cls_queue_head head;
+  int ret = queue_read_head(hctx, head);
+  if (ret < 0) {
+    return ret;
+  }
+
+  cls_2pc_urgent_data urgent_data;
+  try {
+    auto in_iter = head.bl_urgent_data.cbegin();
+    decode(urgent_data, in_iter);
+  } catch (ceph::buffer::error& err) {
+    CLS_LOG(1, "ERROR: cls_2pc_queue_commit_batch: failed to decode entry: %s", err.what());
+    return -EINVAL;
+  }
+
+  cls_2pc_reservations xattr_reservations;
+  bool xattrs_loaded = false;
+  bool xattrs_modified = false;
+  cls_queue_enqueue_op enqueue_op;
+  for (auto& commit_op : batch_op.commits) {
+    auto it = urgent_data.reservations.find(commit_op.id);
+    bool in_xattrs = false;
+    if (it == urgent_data.reservations.end()) {
+      if (!urgent_data.has_xattrs) {
+        CLS_LOG(1, "ERROR: cls_2pc_queue_commit_batch: reservation does not exist: %u", commit_op.id);
+        return -ENOENT;
+      }
+      if (!xattrs_loaded) {
+        // try to look for the reservation in xattrs
+        bufferlist bl_xattrs;
+        ret = cls_cxx_getxattr(hctx, CLS_QUEUE_URGENT_DATA_XATTR_NAME, &bl_xattrs);
+        if (ret < 0 && ret != -ENOENT && ret != -ENODATA) {
+          CLS_LOG(1, "ERROR: cls_2pc_queue_commit_batch: failed to read xattrs with: %d", ret);
+          return ret;
+        }
+        if (ret >= 0) {
+          auto iter = bl_xattrs.cbegin();
+          try {
+            decode(xattr_reservations, iter);
+          } catch (ceph::buffer::error& err) {
+            CLS_LOG(1, "ERROR: cls_2pc_queue_commit_batch: failed to decode xattrs urgent data map");
+            return -EINVAL;
+          }
+        }
+        xattrs_loaded = true;
+      }
+      it = xattr_reservations.find(commit_op.id);
+      if (it == xattr_reservations.end()) {
+        CLS_LOG(1, "ERROR: cls_2pc_queue_commit_batch: reservation does not exist: %u", commit_op.id);
+        return -ENOENT;
+      }
+      in_xattrs = true;
+    }
+
+    auto& res = it->second;
+    const auto actual_size = std::accumulate(commit_op.bl_data_vec.begin(),
+            commit_op.bl_data_vec.end(), 0UL, [] (uint64_t sum, const bufferlist& bl) {
+              return sum + bl.length();
+            });
+
+    if (res.size < actual_size) {
+      CLS_LOG(1, "ERROR: cls_2pc_queue_commit_batch: trying to commit %lu bytes to a %lu bytes reservation",
+              actual_size,
+              res.size);
+      return -EINVAL;
+    }
+
+    urgent_data.reserved_size -= res.size;
+    urgent_data.committed_entries += res.entries;
+    if (in_xattrs) {
+      xattr_reservations.erase(it);
+      xattrs_modified = true;
+    } else {
+      urgent_data.reservations.erase(it);
+    }
+    std::move(commit_op.bl_data_vec.begin(), commit_op.bl_data_vec.end(),
+              std::back_inserter(enqueue_op.bl_data_vec));
+  }
+
+  // commit the data of all reservations to the queue
+  ret = queue_enqueue(hctx, enqueue_op, head);
+  if (ret < 0) {
+    return ret;
+  }
+
+  if (xattrs_modified) {
+    bufferlist bl_xattrs;
+    encode(xattr_reservations, bl_xattrs);
+    ret = cls_cxx_setxattr(hctx, CLS_QUEUE_URGENT_DATA_XATTR_NAME, &bl_xattrs);
+    if (ret < 0) {
+      CLS_LOG(1, "ERROR: cls_2pc_queue_commit_batch: failed to write xattrs with: %d", ret);
+      return ret;
+    }
+  }
+
+  CLS_LOG(20, "INFO: cls_2pc_queue_commit_batch: committed %lu reservations", batch_op.commits.size());
+  CLS_LOG(20, "INFO: cls_2pc_queue_commit_batch: current reservations: %lu (bytes)", urgent_data.reserved_size);
+
+  // write back head
+  head.bl_urgent_data.clear();
+  encode(urgent_data, head.bl_urgent_data);
+  return queue_write_head(hctx, head);
+}
+
 static int cls_2pc_queue_abort(cls_method_context_t hctx, bufferlist *in, bufferlist *out) {
   cls_2pc_queue_abort_op abort_op;
   try {
@@ -655,6 +773,7 @@ CLS_INIT(2pc_queue)
   cls_method_handle_t h_2pc_queue_get_topic_stats;
   cls_method_handle_t h_2pc_queue_reserve;
   cls_method_handle_t h_2pc_queue_commit;
+  cls_method_handle_t h_2pc_queue_commit_batch;
   cls_method_handle_t h_2pc_queue_abort;
   cls_method_handle_t h_2pc_queue_list_reservations;
   cls_method_handle_t h_2pc_queue_list_entries;
@@ -668,6 +787,7 @@ CLS_INIT(2pc_queue)
   cls_register_cxx_method(h_class, TPC_QUEUE_GET_TOPIC_STATS, CLS_METHOD_RD, cls_2pc_queue_get_topic_stats, &h_2pc_queue_get_topic_stats);
   cls_register_cxx_method(h_class, TPC_QUEUE_RESERVE, CLS_METHOD_RD | CLS_METHOD_WR, cls_2pc_queue_reserve, &h_2pc_queue_reserve);
   cls_register_cxx_method(h_class, TPC_QUEUE_COMMIT, CLS_METHOD_RD | CLS_METHOD_WR, cls_2pc_queue_commit, &h_2pc_queue_commit);
+  cls_register_cxx_method(h_class, TPC_QUEUE_COMMIT_BATCH, CLS_METHOD_RD | CLS_METHOD_WR, cls_2pc_queue_commit_batch, &h_2pc_queue_commit_batch);
   cls_register_cxx_method(h_class, TPC_QUEUE_ABORT, CLS_METHOD_RD | CLS_METHOD_WR, cls_2pc_queue_abort, &h_2pc_queue_abort);
   cls_register_cxx_method(h_class, TPC_QUEUE_LIST_RESERVATIONS, CLS_METHOD_RD, cls_2pc_queue_list_reservations, &h_2pc_queue_list_reservations);
   cls_register_cxx_method(h_class, TPC_QUEUE_LIST_ENTRIES, CLS_METHOD_RD, cls_2pc_queue_list_entries, &h_2pc_queue_list_entries);
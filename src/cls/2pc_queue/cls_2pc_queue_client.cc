@@ -138,6 +138,20 @@ void cls_2pc_queue_commit(ObjectWriteOperation& op, std::vector<bufferlist> bl_d
   op.exec(TPC_QUEUE_CLASS, TPC_QUEUE_COMMIT, in);
 }
 
+void cls_2pc_queue_commit_batch(ObjectWriteOperation& op,
+        std::vector<std::pair<cls_2pc_reservation::id_t, std::vector<bufferlist>>> commits) {
+  bufferlist in;
+  cls_2pc_queue_commit_batch_op batch_op;
+  batch_op.commits.reserve(commits.size());
+  for (auto& [res_id, bl_data_vec] : commits) {
+    auto& commit_op = batch_op.commits.emplace_back();
+    commit_op.id = res_id;
+    commit_op.bl_data_vec = std::move(bl_data_vec);
+  }
+  encode(batch_op, in);
+  op.exec(TPC_QUEUE_CLASS, TPC_QUEUE_COMMIT_BATCH, in);
+}
+
 void cls_2pc_queue_abort(ObjectWriteOperation& op, cls_2pc_reservation::id_t res_id) {
   bufferlist in;
   cls_2pc_queue_abort_op abort_op;
@@ -64,6 +64,13 @@ int cls_2pc_queue_reserve_result(const bufferlist& bl, cls_2pc_reservation::id_t
 void cls_2pc_queue_commit(librados::ObjectWriteOperation& op, std::vector<bufferlist> bl_data_vec, 
         cls_2pc_reservation::id_t res_id);
 
+// commit data for several reservations in a single call
+// each pair holds a reservation id and the data to commit to it, with the same restrictions as cls_2pc_queue_commit
+// the queue head is read and written once for the whole batch
+// if any of the reservations does not exist or is too small, nothing is committed
+void cls_2pc_queue_commit_batch(librados::ObjectWriteOperation& op,
+        std::vector<std::pair<cls_2pc_reservation::id_t, std::vector<bufferlist>>> commits);
+
 // abort a reservation
 // res_id must be allocated using cls_2pc_queue_reserve
 void cls_2pc_queue_abort(librados::ObjectWriteOperation& op, 
@@ -7,6 +7,7 @@
 #define TPC_QUEUE_GET_TOPIC_STATS "2pc_queue_get_topic_stats"
 #define TPC_QUEUE_RESERVE "2pc_queue_reserve"
 #define TPC_QUEUE_COMMIT "2pc_queue_commit"
+#define TPC_QUEUE_COMMIT_BATCH "2pc_queue_commit_batch"
 #define TPC_QUEUE_ABORT "2pc_queue_abort"
 #define TPC_QUEUE_LIST_RESERVATIONS "2pc_queue_list_reservations"
 #define TPC_QUEUE_LIST_ENTRIES "2pc_queue_list_entries"
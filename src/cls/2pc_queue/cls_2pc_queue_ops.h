@@ -100,6 +100,39 @@ struct cls_2pc_queue_commit_op {
 };
 WRITE_CLASS_ENCODER(cls_2pc_queue_commit_op)
 
+struct cls_2pc_queue_commit_batch_op {
+  std::vector<cls_2pc_queue_commit_op> commits; // reservations to commit, in order
+
+  void encode(ceph::buffer::list& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(commits, bl);
+    ENCODE_FINISH(bl);
+  }
+
+  void decode(ceph::buffer::list::const_iterator& bl) {
+    DECODE_START(1, bl);
+    decode(commits, bl);
+    DECODE_FINISH(bl);
+  }
+
+  void dump(ceph::Formatter *f) const {
+    encode_json("commits", commits, f);
+  }
+
+  static void generate_test_instances(std::list<cls_2pc_queue_commit_batch_op*>& ls) {
+    ls.push_back(new cls_2pc_queue_commit_batch_op);
+    ls.push_back(new cls_2pc_queue_commit_batch_op);
+    ls.back()->commits.resize(2);
+    ls.back()->commits[0].id = 1;
+    ls.back()->commits[0].bl_data_vec.push_back(ceph::buffer::list());
+    ls.back()->commits[0].bl_data_vec.back().append("foo");
+    ls.back()->commits[1].id = 2;
+    ls.back()->commits[1].bl_data_vec.push_back(ceph::buffer::list());
+    ls.back()->commits[1].bl_data_vec.back().append("bar");
+  }
+};
+WRITE_CLASS_ENCODER(cls_2pc_queue_commit_batch_op)
+
 struct cls_2pc_queue_abort_op {
   cls_2pc_reservation::id_t id; // reservation to abort
 
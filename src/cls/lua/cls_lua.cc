@@ -3,8 +3,12 @@
  */
 #include <errno.h>
 #include <setjmp.h>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <sstream>
+#include <unordered_map>
 #include <lua.hpp>
 #include "include/types.h"
 #include "objclass/objclass.h"
@@ -827,6 +831,80 @@ static int unpack_json_command(lua_State *L, struct clslua_hctx *ctx,
   return 0;
 }
 
+/*
+ * Cache of compiled chunks.
+ *
+ * Compiling the script is the bulk of the fixed cost of a call for small
+ * handlers, and clients tend to send the same script over and over. The
+ * first time a script is seen it is compiled from source and the resulting
+ * bytecode is kept here, keyed by the script text; later calls load the
+ * bytecode directly. The Lua state itself is still created per call so
+ * scripts cannot observe globals left behind by other callers.
+ */
+#define CLSLUA_CHUNK_CACHE_MAX_ENTRIES 64
+#define CLSLUA_CHUNK_CACHE_MAX_SCRIPT (64 << 10)
+
+struct clslua_chunk {
+  std::shared_ptr<const std::string> bytecode;
+  std::list<const std::string*>::iterator lru_pos;
+};
+
+static std::mutex clslua_chunk_cache_lock;
+static std::unordered_map<std::string, clslua_chunk> clslua_chunk_cache;
+static std::list<const std::string*> clslua_chunk_lru; /* front is newest */
+
+static int clslua_chunk_writer(lua_State *L, const void *p, size_t sz, void *ud)
+{
+  static_cast<std::string*>(ud)->append(static_cast<const char*>(p), sz);
+  return 0;
+}
+
+/*
+ * Push the compiled chunk for @script, as luaL_loadstring would.
+ */
+static int clslua_load_chunk(lua_State *L, const std::string& script)
+{
+  std::shared_ptr<const std::string> bytecode;
+  {
+    std::lock_guard l(clslua_chunk_cache_lock);
+    auto it = clslua_chunk_cache.find(script);
+    if (it != clslua_chunk_cache.end()) {
+      clslua_chunk_lru.splice(clslua_chunk_lru.begin(), clslua_chunk_lru,
+          it->second.lru_pos);
+      bytecode = it->second.bytecode;
+    }
+  }
+
+  if (bytecode) {
+    CLS_LOG(20, "using cached chunk (%zu bytes)", bytecode->size());
+    return luaL_loadbufferx(L, bytecode->data(), bytecode->size(),
+        "=cls_lua", "b");
+  }
+
+  int ret = luaL_loadstring(L, script.c_str());
+  if (ret || script.size() > CLSLUA_CHUNK_CACHE_MAX_SCRIPT)
+    return ret;
+
+  /* keep debug info so error messages match the uncached path */
+  auto dumped = std::make_shared<std::string>();
+  if (lua_dump(L, clslua_chunk_writer, dumped.get(), 0))
+    return 0;
+
+  std::lock_guard l(clslua_chunk_cache_lock);
+  auto [it, inserted] = clslua_chunk_cache.try_emplace(script);
+  if (!inserted)
+    return 0; /* raced with another caller compiling the same script */
+  it->second.bytecode = std::move(dumped);
+  clslua_chunk_lru.push_front(&it->first);
+  it->second.lru_pos = clslua_chunk_lru.begin();
+  while (clslua_chunk_cache.size() > CLSLUA_CHUNK_CACHE_MAX_ENTRIES) {
+    auto oldest = clslua_chunk_cache.find(*clslua_chunk_lru.back());
+    clslua_chunk_lru.pop_back();
+    clslua_chunk_cache.erase(oldest);
+  }
+  return 0;
+}
+
 /*
  * Runs the script, and calls handler.
  */
@@ -900,7 +978,7 @@ static int clslua_eval(lua_State *L)
   lua_settable(L, LUA_REGISTRYINDEX);
 
   /* load and compile chunk */
-  if (luaL_loadstring(L, ctx->script.c_str()))
+  if (clslua_load_chunk(L, ctx->script))
     return lua_error(L);
 
   /* execute chunk */
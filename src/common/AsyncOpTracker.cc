@@ -14,16 +14,26 @@ AsyncOpTracker::~AsyncOpTracker() {
 }
 
 void AsyncOpTracker::start_op() {
-  std::lock_guard locker(m_lock);
   ++m_pending_ops;
 }
 
 void AsyncOpTracker::finish_op() {
+  // lockless while other ops remain in flight
+  auto prev = m_pending_ops.load();
+  while (prev > 1) {
+    if (m_pending_ops.compare_exchange_weak(prev, prev - 1)) {
+      return;
+    }
+  }
+
+  // the final decrement and the waiter hand-off happen under m_lock, so
+  // the owner can't see zero and destroy the tracker while we still use it
   Context *on_finish = nullptr;
   {
     std::lock_guard locker(m_lock);
-    ceph_assert(m_pending_ops > 0);
-    if (--m_pending_ops == 0) {
+    prev = m_pending_ops--;
+    ceph_assert(prev > 0);
+    if (prev == 1) {
       std::swap(on_finish, m_on_finish);
     }
   }
@@ -46,7 +56,6 @@ void AsyncOpTracker::wait_for_ops(Context *on_finish) {
 }
 
 bool AsyncOpTracker::empty() {
-  std::lock_guard locker(m_lock);
   return (m_pending_ops == 0);
 }
 
@@ -4,6 +4,7 @@
 #ifndef CEPH_ASYNC_OP_TRACKER_H
 #define CEPH_ASYNC_OP_TRACKER_H
 
+#include <atomic>
 #include "common/ceph_mutex.h"
 #include "include/Context.h"
 
@@ -20,8 +21,10 @@ public:
   bool empty();
 
 private:
+  // start_op/finish_op only touch the counter; m_lock is taken for the
+  // final decrement to zero and the m_on_finish hand-off
   ceph::mutex m_lock = ceph::make_mutex("AsyncOpTracker::m_lock");
-  uint32_t m_pending_ops = 0;
+  std::atomic<uint32_t> m_pending_ops = 0;
   Context *m_on_finish = nullptr;
 
 };
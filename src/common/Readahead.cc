@@ -4,6 +4,8 @@
 #include "common/Readahead.h"
 #include "common/Cond.h"
 
+#include <algorithm>
+
 using std::vector;
 
 Readahead::Readahead()
@@ -11,12 +13,8 @@ Readahead::Readahead()
     m_readahead_min_bytes(0),
     m_readahead_max_bytes(NO_LIMIT),
     m_alignments(),
-    m_nr_consec_read(0),
-    m_consec_read_bytes(0),
-    m_last_pos(0),
-    m_readahead_pos(0),
-    m_readahead_trigger_pos(0),
-    m_readahead_size(0),
+    m_max_streams(1),
+    m_streams(1),
     m_pending(0) {
 }
 
@@ -28,7 +26,8 @@ Readahead::extent_t Readahead::update(const vector<extent_t>& extents, uint64_t
   for (vector<extent_t>::const_iterator p = extents.begin(); p != extents.end(); ++p) {
     _observe_read(p->first, p->second);
   }
-  if (m_readahead_pos >= limit|| m_last_pos >= limit) {
+  const Stream& stream = m_streams.front();
+  if (stream.readahead_pos >= limit || stream.last_pos >= limit) {
     m_lock.unlock();
     return extent_t(0, 0);
   }
@@ -40,7 +39,8 @@ Readahead::extent_t Readahead::update(const vector<extent_t>& extents, uint64_t
 Readahead::extent_t Readahead::update(uint64_t offset, uint64_t length, uint64_t limit) {
   m_lock.lock();
   _observe_read(offset, length);
-  if (m_readahead_pos >= limit || m_last_pos >= limit) {
+  const Stream& stream = m_streams.front();
+  if (stream.readahead_pos >= limit || stream.last_pos >= limit) {
     m_lock.unlock();
     return extent_t(0, 0);
   }
@@ -50,41 +50,49 @@ Readahead::extent_t Readahead::update(uint64_t offset, uint64_t length, uint64_t
 }
 
 void Readahead::_observe_read(uint64_t offset, uint64_t length) {
-  if (offset == m_last_pos) {
-    m_nr_consec_read++;
-    m_consec_read_bytes += length;
+  auto it = std::find_if(m_streams.begin(), m_streams.end(),
+                         [offset](const Stream& stream) {
+                           return stream.last_pos == offset;
+                         });
+  if (it != m_streams.end()) {
+    // continue the stream and move it to the front
+    std::rotate(m_streams.begin(), it, it + 1);
+    Stream& stream = m_streams.front();
+    stream.nr_consec_read++;
+    stream.consec_read_bytes += length;
   } else {
-    m_nr_consec_read = 0;
-    m_consec_read_bytes = 0;
-    m_readahead_trigger_pos = 0;
-    m_readahead_size = 0;
-    m_readahead_pos = 0;
+    // start a new stream, replacing the least recently read one
+    if (m_streams.size() >= m_max_streams) {
+      m_streams.pop_back();
+    }
+    m_streams.insert(m_streams.begin(), Stream{});
   }
-  m_last_pos = offset + length;
+  m_streams.front().last_pos = offset + length;
 }
 
 Readahead::extent_t Readahead::_compute_readahead(uint64_t limit) {
   uint64_t readahead_offset = 0;
   uint64_t readahead_length = 0;
-  if (m_nr_consec_read >= m_trigger_requests) {
+  Stream& stream = m_streams.front();
+  if (stream.nr_consec_read >= m_trigger_requests) {
     // currently reading sequentially
-    if (m_last_pos >= m_readahead_trigger_pos) {
+    if (stream.last_pos >= stream.readahead_trigger_pos) {
       // need to read ahead
-      if (m_readahead_size == 0) {
+      if (stream.readahead_size == 0) {
 	// initial readahead trigger
-	m_readahead_size = m_consec_read_bytes;
-	m_readahead_pos = m_last_pos;
+	stream.readahead_size = stream.consec_read_bytes;
+	stream.readahead_pos = stream.last_pos;
       } else {
 	// continuing readahead trigger
-	m_readahead_size *= 2;
-	if (m_last_pos > m_readahead_pos) {
-	  m_readahead_pos = m_last_pos;
+	stream.readahead_size *= 2;
+	if (stream.last_pos > stream.readahead_pos) {
+	  stream.readahead_pos = stream.last_pos;
 	}
       }
-      m_readahead_size = std::max(m_readahead_size, m_readahead_min_bytes);
-      m_readahead_size = std::min(m_readahead_size, m_readahead_max_bytes);
-      readahead_offset = m_readahead_pos;
-      readahead_length = m_readahead_size;
+      stream.readahead_size = std::max(stream.readahead_size, m_readahead_min_bytes);
+      stream.readahead_size = std::min(stream.readahead_size, m_readahead_max_bytes);
+      readahead_offset = stream.readahead_pos;
+      readahead_length = stream.readahead_size;
 
       // Snap to the first alignment possible
       uint64_t readahead_end = readahead_offset + readahead_length;
@@ -106,15 +114,15 @@ Readahead::extent_t Readahead::_compute_readahead(uint64_t limit) {
 	  readahead_length = align_next - readahead_offset;
 	  break;
 	}
-	// Note that m_readahead_size should remain unadjusted.
+	// Note that stream.readahead_size should remain unadjusted.
       }
 
-      if (m_readahead_pos + readahead_length > limit) {
-	readahead_length = limit - m_readahead_pos;
+      if (stream.readahead_pos + readahead_length > limit) {
+	readahead_length = limit - stream.readahead_pos;
       }
 
-      m_readahead_trigger_pos = m_readahead_pos + readahead_length / 2;
-      m_readahead_pos += readahead_length;
+      stream.readahead_trigger_pos = stream.readahead_pos + readahead_length / 2;
+      stream.readahead_pos += readahead_length;
     }
   }
   return extent_t(readahead_offset, readahead_length);
@@ -167,6 +175,14 @@ void Readahead::set_trigger_requests(int trigger_requests) {
   m_lock.unlock();
 }
 
+void Readahead::set_max_streams(size_t max_streams) {
+  std::lock_guard lock(m_lock);
+  m_max_streams = std::max<size_t>(max_streams, 1);
+  if (m_streams.size() > m_max_streams) {
+    m_streams.resize(m_max_streams);
+  }
+}
+
 uint64_t Readahead::get_min_readahead_size(void) {
   std::lock_guard lock(m_lock);
   return m_readahead_min_bytes;
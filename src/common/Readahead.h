@@ -80,6 +80,13 @@ public:
    */
   void set_trigger_requests(int trigger_requests);
 
+  /**
+     Sets the number of concurrent sequential streams that are tracked.
+     A read that does not continue any tracked stream starts a new one,
+     evicting the least recently used stream if necessary.
+   */
+  void set_max_streams(size_t max_streams);
+
   /**
      Gets the minimum size of a readahead request, in bytes.
    */
@@ -109,6 +116,27 @@ public:
   void set_alignments(const std::vector<uint64_t> &alignments);
 
 private:
+  /// State of a single sequential read stream
+  struct Stream {
+    /// Number of consecutive read requests in the stream
+    int nr_consec_read = 0;
+
+    /// Number of bytes read in the stream
+    uint64_t consec_read_bytes = 0;
+
+    /// Position of the read stream
+    uint64_t last_pos = 0;
+
+    /// Position of the readahead stream
+    uint64_t readahead_pos = 0;
+
+    /// When readahead is already triggered and the read stream crosses this point, readahead is continued
+    uint64_t readahead_trigger_pos = 0;
+
+    /// Size of the next readahead request (barring changes due to alignment, etc.)
+    uint64_t readahead_size = 0;
+  };
+
   /**
      Records that a read request has been received.
      m_lock must be held while calling.
@@ -116,7 +144,7 @@ private:
   void _observe_read(uint64_t offset, uint64_t length);
 
   /**
-     Computes the next readahead request.
+     Computes the next readahead request for the most recently read stream.
      m_lock must be held while calling.
   */
   extent_t _compute_readahead(uint64_t limit);
@@ -136,23 +164,11 @@ private:
   /// Held while reading/modifying any state except m_pending
   ceph::mutex m_lock = ceph::make_mutex("Readahead::m_lock");
 
-  /// Number of consecutive read requests in the current sequential stream
-  int m_nr_consec_read;
-
-  /// Number of bytes read in the current sequenial stream
-  uint64_t m_consec_read_bytes;
-
-  /// Position of the read stream
-  uint64_t m_last_pos;
-
-  /// Position of the readahead stream
-  uint64_t m_readahead_pos;
-
-  /// When readahead is already triggered and the read stream crosses this point, readahead is continued
-  uint64_t m_readahead_trigger_pos;
+  /// Maximum number of tracked streams
+  size_t m_max_streams;
 
-  /// Size of the next readahead request (barring changes due to alignment, etc.)
-  uint64_t m_readahead_size;
+  /// Tracked streams, most recently read first
+  std::vector<Stream> m_streams;
 
   /// Number of pending readahead requests, as determined by inc_pending() and dec_pending()
   int m_pending;
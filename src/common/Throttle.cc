@@ -97,8 +97,11 @@ bool Throttle::_wait(int64_t c, std::unique_lock<std::mutex>& l)
   if (_should_wait(c) || !conds.empty()) { // always wait behind other waiters.
     {
       auto cv = conds.emplace(conds.end());
+      // published before the predicate reads count, see put()
+      ++waiters;
       auto w = make_scope_guard([this, cv]() {
 	  conds.erase(cv);
+	  --waiters;
 	});
       waited = true;
       ldout(cct, 2) << "_wait waiting..." << dendl;
@@ -163,14 +166,18 @@ bool Throttle::get(int64_t c, int64_t m)
     logger->inc(l_throttle_get_started);
   }
   bool waited = false;
-  {
+  // lockless fast path, only taken while nobody queues ahead of us
+  if (m || waiters != 0 || !_try_get(c)) {
     std::unique_lock l(lock);
     if (m) {
       ceph_assert(m > 0);
       _reset_max(m);
     }
-    waited = _wait(c, l);
-    count += c;
+    // a lockless get() may take the slots between _wait() and our add;
+    // wait again if so
+    do {
+      waited |= _wait(c, l);
+    } while (!_try_get(c));
   }
   if (logger) {
     logger->inc(l_throttle_get);
@@ -194,13 +201,12 @@ bool Throttle::get_or_fail(int64_t c)
   bool result = false;
   {
     std::lock_guard l(lock);
-    if (_should_wait(c) || !conds.empty()) {
+    if (!conds.empty() || !_try_get(c)) {
       ldout(cct, 10) << "get_or_fail " << c << " failed" << dendl;
       result = false;
     } else {
-      ldout(cct, 10) << "get_or_fail " << c << " success (" << count.load()
-	<< " -> " << (count.load() + c) << ")" << dendl;
-      count += c;
+      ldout(cct, 10) << "get_or_fail " << c << " success (-> "
+	<< count.load() << ")" << dendl;
       result = true;
     }
   }
@@ -228,16 +234,17 @@ int64_t Throttle::put(int64_t c)
   ceph_assert(c >= 0);
   ldout(cct, 10) << "put " << c << " (" << count.load() << " -> "
 		 << (count.load()-c) << ")" << dendl;
-  int64_t new_count;
-  {
-    std::lock_guard l(lock);
-    new_count = count;
-    if (c) {
+  int64_t new_count = count;
+  if (c) {
+    new_count = count.fetch_sub(c) - c;
+    // if count goes negative, we failed somewhere!
+    ceph_assert(new_count >= 0);
+    // a waiter publishes itself before checking count, so either it sees
+    // the new count or we see it here and wake it up under the lock
+    if (waiters != 0) {
+      std::lock_guard l(lock);
       if (!conds.empty())
 	conds.front().notify_one();
-      // if count goes negative, we failed somewhere!
-      ceph_assert(count >= c);
-      new_count = count -= c;
     }
   }
   if (logger) {
@@ -36,6 +36,8 @@ class Throttle final : public ThrottleInterface {
   std::atomic<int64_t> count = { 0 }, max = { 0 };
   std::mutex lock;
   std::list<std::condition_variable> conds;
+  /// conds.size(), so get() and put() can skip the lock when nobody waits
+  std::atomic<size_t> waiters = { 0 };
   const bool use_perf;
 
 public:
@@ -45,8 +47,10 @@ public:
 private:
   void _reset_max(int64_t m);
   bool _should_wait(int64_t c) const {
+    return _should_wait(c, count);
+  }
+  bool _should_wait(int64_t c, int64_t cur) const {
     int64_t m = max;
-    int64_t cur = count;
     return
       m &&
       ((c <= m && cur + c > m) || // normally stay under max
@@ -54,6 +58,18 @@ private:
   }
 
   bool _wait(int64_t c, std::unique_lock<std::mutex>& l);
+  /// add c to count unless that would exceed max; the only way count grows
+  /// on a bounded throttle, so lockless and locked getters can't both
+  /// pass the check and overshoot max together
+  bool _try_get(int64_t c) {
+    int64_t cur = count;
+    while (!_should_wait(c, cur)) {
+      if (count.compare_exchange_weak(cur, cur + c)) {
+	return true;
+      }
+    }
+    return false;
+  }
 
 public:
   /**
@@ -86,6 +86,10 @@ void OpHistory::_insert_delayed(const utime_t& now, TrackedOpRef op)
   if (shutdown)
     return;
   double opduration = op->get_duration();
+  if (!op->is_sampled() && opduration < history_slow_op_threshold.load()) {
+    // only sampled ops make the regular history, all slow ops are kept
+    return;
+  }
   duration.insert(make_pair(opduration, op));
   arrived.insert(make_pair(op->get_initiated(), op));
   if (opduration >= history_slow_op_threshold.load()) {
@@ -293,6 +297,8 @@ bool OpTracker::register_inflight_op(TrackedOp *i)
     sdata->ops_in_flight_sharded.push_back(*i);
     i->seq = current_seq;
   }
+  const uint32_t rate = sample_rate;
+  i->sampled = rate <= 1 || current_seq % rate == 0;
   return true;
 }
 
@@ -483,6 +489,9 @@ void TrackedOp::mark_event(std::string_view event, utime_t stamp)
 {
   if (!state)
     return;
+  // ops that are not sampled only keep "done", which get_duration() needs
+  if (!sampled && event != "done")
+    return;
 
   {
     std::lock_guard l(lock);
@@ -127,6 +127,7 @@ class OpTracker {
   float complaint_time;
   int log_threshold;
   std::atomic<bool> tracking_enabled;
+  std::atomic<uint32_t> sample_rate = {1};
   ceph::shared_mutex lock = ceph::make_shared_mutex("OpTracker::lock");
 
 public:
@@ -151,6 +152,11 @@ public:
   void set_tracking(bool enable) {
     tracking_enabled = enable;
   }
+  /// record the events of only 1 in rate ops; the others still count
+  /// as in flight and are kept in the history when they are slow
+  void set_sample_rate(uint32_t rate) {
+    sample_rate = rate;
+  }
   static void default_dumper(const TrackedOp& op, Formatter* f);
   bool dump_ops_in_flight(ceph::Formatter *f, bool print_only_blocked = false, std::set<std::string> filters = {""}, bool count_only = false, dumper lambda = default_dumper);
   bool dump_historic_ops(ceph::Formatter *f, bool by_duration = false, std::set<std::string> filters = {""});
@@ -294,6 +300,7 @@ protected:
   };
   std::atomic<int> state = {STATE_UNTRACKED};
   uint64_t flags = 0;
+  bool sampled = true;      ///< events are recorded, see OpTracker::set_sample_rate
 
   void mark_continuous() {
     flags |= FLAG_CONTINUOUS;
@@ -405,6 +412,10 @@ public:
     return initiated_at;
   }
 
+  bool is_sampled() const {
+    return sampled;
+  }
+
   double get_duration() const {
     std::lock_guard l(lock);
     if (!events.empty() && events.rbegin()->compare("done") == 0)
@@ -49,6 +49,7 @@ void bloom_filter::decode(bufferlist::const_iterator& p)
   generate_unique_salt();
   decode(bit_table_, p);
   table_size_ = bit_table_.size();
+  bit_mod_ = fastmod_t(table_size_ << 3);
   DECODE_FINISH(p);
 }
 
@@ -108,11 +109,12 @@ void compressible_bloom_filter::decode(bufferlist::const_iterator& p)
 
   uint32_t s;
   decode(s, p);
-  size_list.resize(s);
+  size_list.clear();
+  size_mods.clear();
   for (unsigned i = 0; i < s; i++) {
     uint64_t v;
     decode(v, p);
-    size_list[i] = v;
+    push_size(v);
   }
 
   DECODE_FINISH(p);
@@ -23,6 +23,7 @@
 #define COMMON_BLOOM_FILTER_HPP
 
 #include <cmath>
+#include <cstdint>
 
 #include "include/encoding.h"
 #include "include/mempool.h"
@@ -40,6 +41,36 @@ static const unsigned char bit_mask[CHAR_BIT] = {
 
 class bloom_filter
 {
+public:
+
+  /**
+   * x % d without a division instruction
+   *
+   * Each probe of the filter takes the remainder of a hash by the table
+   * size in bits, and a hardware division costs more than the rest of
+   * the probe.  Divisors up to 2^32 use a precomputed multiplier (Lemire,
+   * Kaser and Kurz, "Faster Remainder by Direct Computation", 2019),
+   * which gives exactly x % d for any 32-bit x, so the bits set stay the
+   * same and so does the encoding.
+   */
+  struct fastmod_t {
+    uint64_t d = 0;
+    uint64_t m = 0;
+
+    fastmod_t() = default;
+    explicit fastmod_t(uint64_t d)
+      : d(d), m((d && d <= UINT32_MAX) ? UINT64_MAX / d + 1 : 0) {}
+
+    uint64_t operator()(uint64_t x) const {
+      if (d > UINT32_MAX || x > UINT32_MAX) {
+	return x % d;
+      }
+      // high 64 bits of the 96-bit product (m * x mod 2^64) * d
+      uint64_t low = m * x;
+      return ((low >> 32) * d + (((low & UINT32_MAX) * d) >> 32)) >> 32;
+    }
+  };
+
 protected:
 
   using bloom_type = unsigned int;
@@ -53,6 +84,7 @@ protected:
   std::size_t         insert_count_;  ///< insertion count
   std::size_t         target_element_count_;  ///< target number of unique insertions
   std::size_t         random_seed_;  ///< random seed
+  fastmod_t           bit_mod_;      ///< % (table_size_ << 3)
 
 public:
 
@@ -94,6 +126,7 @@ public:
   void init() {
     generate_unique_salt();
     bit_table_.resize(table_size_, static_cast<unsigned char>(0x00));
+    bit_mod_ = fastmod_t(table_size_ << 3);
   }
 
   bloom_filter(const bloom_filter& filter)
@@ -111,6 +144,7 @@ public:
       random_seed_ = filter.random_seed_;
       bit_table_ = filter.bit_table_;
       salt_ = filter.salt_;
+      bit_mod_ = filter.bit_mod_;
     }
     return *this;
   }
@@ -306,7 +340,7 @@ protected:
 		    size_t /* bit */>
   compute_indices(const bloom_type& hash) const
   {
-    size_t bit_index = hash % (table_size_ << 3);
+    size_t bit_index = bit_mod_(hash);
     size_t bit = bit_index & 7;
     return {bit_index, bit};
   }
@@ -484,7 +518,7 @@ public:
 			    const std::size_t& random_seed)
     : bloom_filter(predicted_element_count, false_positive_probability, random_seed)
   {
-    size_list.push_back(table_size_);
+    push_size(table_size_);
   }
 
   compressible_bloom_filter(const std::size_t& salt_count,
@@ -493,7 +527,7 @@ public:
 			    std::size_t target_count)
     : bloom_filter(salt_count, table_size, random_seed, target_count)
   {
-    size_list.push_back(table_size_);
+    push_size(table_size_);
   }
 
   inline std::size_t size() const override
@@ -532,7 +566,7 @@ public:
       }
     }
     std::swap(bit_table_, tmp);
-    size_list.push_back(new_table_size);
+    push_size(new_table_size);
     table_size_ = new_table_size;
 
     return true;
@@ -553,14 +587,20 @@ private:
   compute_indices(const bloom_type& hash) const final
   {
     size_t bit_index = hash;
-    for (auto size : size_list) {
-      bit_index %= size << 3;
+    for (auto& mod : size_mods) {
+      bit_index = mod(bit_index);
     }
     size_t bit = bit_index & 7;
     return {bit_index, bit};
   }
 
+  void push_size(std::size_t size) {
+    size_list.push_back(size);
+    size_mods.emplace_back(size << 3);
+  }
+
   std::vector<std::size_t> size_list;
+  std::vector<fastmod_t> size_mods;  ///< % (size << 3) for each of size_list
 public:
   void encode(ceph::bufferlist& bl) const;
   void decode(ceph::bufferlist::const_iterator& bl);
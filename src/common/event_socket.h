@@ -29,7 +29,7 @@ class EventSocket {
 
  public:
   EventSocket(): socket(-1), type(EVENT_SOCKET_TYPE_NONE) {}
-  bool is_valid() const { return socket != -1; }
+  bool is_valid() const { return type != EVENT_SOCKET_TYPE_NONE; }
   int init(int fd, int t) {
     switch (t) {
       case EVENT_SOCKET_TYPE_PIPE:
@@ -41,6 +41,13 @@ class EventSocket {
         type = t;
         return 0;
       }
+      case EVENT_SOCKET_TYPE_POLL:
+      {
+        // no descriptor; the consumer polls for events itself
+        socket = -1;
+        type = t;
+        return 0;
+      }
     }
     return -EINVAL;
   }
@@ -70,6 +77,11 @@ class EventSocket {
         break;
       }
 #endif
+      case EVENT_SOCKET_TYPE_POLL:
+      {
+        ret = 0;
+        break;
+      }
       default:
       {
         ret = -1;
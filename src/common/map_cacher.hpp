@@ -15,6 +15,8 @@
 #ifndef MAPCACHER_H
 #define MAPCACHER_H
 
+#include <vector>
+
 #include "include/Context.h"
 #include "common/sharedptr_registry.hpp"
 
@@ -65,6 +67,27 @@ public:
     std::pair<K, V> *next_or_current
     ) = 0; ///< @return 0 on success, -ENOENT if there is no next
 
+  /// Returns up to max keys following key, in order
+  virtual int get_next_batch(
+    const K &key,       ///< [in] key after which to start
+    unsigned max,       ///< [in] maximum number of entries to return
+    std::vector<std::pair<K, V>> *out ///< [out] entries found
+    ) {
+    K pos = key;
+    while (out->size() < max) {
+      std::pair<K, V> next;
+      int r = get_next(pos, &next);
+      if (r == -ENOENT) {
+	break;
+      } else if (r < 0) {
+	return r;
+      }
+      pos = next.first;
+      out->push_back(std::move(next));
+    }
+    return out->empty() ? -ENOENT : 0;
+  } ///< @return 0 on success, -ENOENT if there is no next
+
   virtual ~StoreDriver() {}
 };
 
@@ -126,6 +149,53 @@ public:
     return -EINVAL;
   } ///< @return error value, 0 on success, -ENOENT if no more entries
 
+  /**
+   * Fetch up to max key/value pairs following key
+   *
+   * Equivalent to repeated get_next() calls, but lets the driver serve
+   * consecutive entries from a single lookup.
+   */
+  int get_next_batch(
+    K key,               ///< [in] key after which to start
+    unsigned max,        ///< [in] maximum number of entries to return
+    std::vector<std::pair<K, V>> *out ///< [out] entries found
+    ) {
+    out->clear();
+    while (out->size() < max) {
+      const unsigned want = max - out->size();
+      std::vector<std::pair<K, V>> store;
+      int r = driver->get_next_batch(key, want, &store);
+      if (r < 0 && r != -ENOENT) {
+	return r;
+      }
+      // a short batch means the store holds nothing beyond it
+      const bool store_done = store.size() < want;
+      auto s = store.begin();
+      while (out->size() < max) {
+	std::pair<K, boost::optional<V> > cached;
+	bool got_cached = in_progress.get_next(key, &cached);
+	if (s == store.end()) {
+	  if (!store_done) {
+	    break; // refill from the store after key
+	  } else if (!got_cached) {
+	    return out->empty() ? -ENOENT : 0;
+	  }
+	} else if (!got_cached || s->first < cached.first) {
+	  key = s->first;
+	  out->push_back(*s++);
+	  continue;
+	} else if (s->first == cached.first) {
+	  ++s; // superseded by the in progress update
+	}
+	if (cached.second) {
+	  out->push_back(make_pair(cached.first, cached.second.get()));
+	}
+	key = cached.first;
+      }
+    }
+    return 0;
+  } ///< @return error value, 0 on success, -ENOENT if no more entries
+
   /// Adds operation setting keys to Transaction
   void set_keys(
     const std::map<K, V> &keys,  ///< [in] keys/values to std::set
@@ -138,6 +138,37 @@ int get_numa_node_cpu_set(
   return r;
 }
 
+int get_numa_nodes(std::set<int> *nodes)
+{
+  // same list format as a cpulist, e.g. "0-1"
+  int fd = ::open("/sys/devices/system/node/online", O_RDONLY);
+  if (fd < 0) {
+    return -errno;
+  }
+  char buf[1024];
+  int r = safe_read(fd, &buf, sizeof(buf) - 1);
+  if (r < 0) {
+    goto out;
+  }
+  buf[r] = 0;
+  while (r > 0 && ::isspace(buf[--r])) {
+    buf[r] = 0;
+  }
+  {
+    cpu_set_t node_set;
+    size_t node_set_size = 0;
+    r = parse_cpu_set_list(buf, &node_set_size, &node_set);
+    if (r < 0) {
+      goto out;
+    }
+    *nodes = cpu_set_to_set(node_set_size, &node_set);
+  }
+  r = 0;
+ out:
+  ::close(fd);
+  return r;
+}
+
 static int easy_readdir(const std::string& dir, std::set<std::string> *out)
 {
   DIR *h = ::opendir(dir.c_str());
@@ -251,6 +282,11 @@ int get_numa_node_cpu_set(int node,
   return -ENOTSUP;
 }
 
+int get_numa_nodes(std::set<int> *nodes)
+{
+  return -ENOTSUP;
+}
+
 int set_cpu_affinity_all_threads(size_t cpu_set_size,
 				 cpu_set_t *cpu_set)
 {
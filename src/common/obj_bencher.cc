@@ -31,6 +31,44 @@ using std::string;
 using std::unique_lock;
 using std::unique_ptr;
 
+void bench_latency_histogram::record(double seconds)
+{
+  uint64_t v = seconds > 0 ? (uint64_t)(seconds * 1000000.0) : 0;
+  unsigned b;
+  if (v < SUB_BUCKETS) {
+    b = v;
+  } else {
+    unsigned e = 63 - __builtin_clzll(v);
+    b = SUB_BUCKETS * (e - SUB_BITS + 1) +
+      ((v >> (e - SUB_BITS)) & (SUB_BUCKETS - 1));
+  }
+  ++buckets[b];
+  ++count;
+}
+
+double bench_latency_histogram::percentile(double p) const
+{
+  if (!count) {
+    return 0;
+  }
+  uint64_t target = std::max<uint64_t>(1, std::ceil(p * count));
+  uint64_t seen = 0;
+  for (unsigned b = 0; b < buckets.size(); ++b) {
+    seen += buckets[b];
+    if (seen >= target) {
+      uint64_t upper;
+      if (b < SUB_BUCKETS) {
+	upper = b + 1;
+      } else {
+	unsigned e = b / SUB_BUCKETS + SUB_BITS - 1;
+	upper = (uint64_t)(SUB_BUCKETS + b % SUB_BUCKETS + 1) << (e - SUB_BITS);
+      }
+      return upper / 1000000.0;
+    }
+  }
+  return 0;
+}
+
 const std::string BENCH_LASTRUN_METADATA = "benchmark_last_metadata";
 const std::string BENCH_PREFIX = "benchmark_data";
 const std::string BENCH_OBJ_NAME = BENCH_PREFIX + "_%s_%d_object%d";
@@ -92,6 +130,26 @@ ostream& ObjBencher::out(ostream& os, utime_t& t)
     return os;
 }
 
+void ObjBencher::dump_latency_percentiles(size_t label_width)
+{
+  static const std::pair<const char*, double> percentiles[] = {
+    {"50", 0.5}, {"90", 0.9}, {"99", 0.99}, {"99.9", 0.999}
+  };
+  for (auto& [name, p] : percentiles) {
+    // bucket bounds can overshoot the largest sample
+    double lat = std::min(data.lat_hist.percentile(p), data.max_latency);
+    if (!formatter) {
+      string label = string("p") + name + " latency(s):";
+      label.resize(std::max(label.size(), label_width), ' ');
+      out(cout) << label << lat << std::endl;
+    } else {
+      string key = string("latency_p") + name;
+      key.erase(std::remove(key.begin(), key.end(), '.'), key.end());
+      formatter->dump_format(key, "%f", lat);
+    }
+  }
+}
+
 ostream& ObjBencher::out(ostream& os)
 {
   utime_t cur_time = ceph_clock_now();
@@ -295,6 +353,7 @@ int ObjBencher::aio_bench(
   data.max_latency = 0;
   data.avg_latency = 0;
   data.latency_diff_sum = 0;
+  data.lat_hist = {};
   data.object_contents = contentsChars;
   lock.unlock();
 
@@ -515,6 +574,7 @@ int ObjBencher::write_bench(int secondsToRun,
       data.max_latency = data.cur_latency.count();
     if (data.cur_latency.count() < data.min_latency)
       data.min_latency = data.cur_latency.count();
+    data.lat_hist.record(data.cur_latency.count());
     ++data.finished;
     double delta = data.cur_latency.count() - data.avg_latency;
     data.avg_latency = total_latency / data.finished;
@@ -609,6 +669,7 @@ int ObjBencher::write_bench(int secondsToRun,
        << "Stddev Latency(s):      " << latency_stddev << std::endl
        << "Max latency(s):         " << data.max_latency << std::endl
        << "Min latency(s):         " << data.min_latency << std::endl;
+    dump_latency_percentiles(24);
   } else {
     formatter->dump_format("total_time_run", "%f", timePassed.count());
     formatter->dump_format("total_writes_made", "%d", data.finished);
@@ -626,6 +687,7 @@ int ObjBencher::write_bench(int secondsToRun,
     formatter->dump_format("stddev_latency", "%f", latency_stddev);
     formatter->dump_format("max_latency", "%f", data.max_latency);
     formatter->dump_format("min_latency", "%f", data.min_latency);
+    dump_latency_percentiles(0);
   }
   //write object size/number data for read benchmarks
   encode(data.object_size, b_write);
@@ -776,6 +838,7 @@ int ObjBencher::seq_read_bench(
       data.max_latency = data.cur_latency.count();
     if (data.cur_latency.count() < data.min_latency)
       data.min_latency = data.cur_latency.count();
+    data.lat_hist.record(data.cur_latency.count());
     ++data.finished;
     data.avg_latency = total_latency / data.finished;
     --data.in_flight;
@@ -831,6 +894,7 @@ int ObjBencher::seq_read_bench(
        << "Average Latency(s):   " << data.avg_latency << std::endl
        << "Max latency(s):       " << data.max_latency << std::endl
        << "Min latency(s):       " << data.min_latency << std::endl;
+    dump_latency_percentiles(22);
   } else {
     formatter->dump_format("total_time_run", "%f", timePassed.count());
     formatter->dump_format("total_reads_made", "%d", data.finished);
@@ -844,6 +908,7 @@ int ObjBencher::seq_read_bench(
     formatter->dump_format("average_latency", "%f", data.avg_latency);
     formatter->dump_format("max_latency", "%f", data.max_latency);
     formatter->dump_format("min_latency", "%f", data.min_latency);
+    dump_latency_percentiles(0);
   }
 
   completions_done();
@@ -971,6 +1036,7 @@ int ObjBencher::rand_read_bench(
       data.max_latency = data.cur_latency.count();
     if (data.cur_latency.count() < data.min_latency)
       data.min_latency = data.cur_latency.count();
+    data.lat_hist.record(data.cur_latency.count());
     ++data.finished;
     data.avg_latency = total_latency / data.finished;
     --data.in_flight;
@@ -1044,6 +1110,7 @@ int ObjBencher::rand_read_bench(
        << "Average Latency(s):   " << data.avg_latency << std::endl
        << "Max latency(s):       " << data.max_latency << std::endl
        << "Min latency(s):       " << data.min_latency << std::endl;
+    dump_latency_percentiles(22);
   } else {
     formatter->dump_format("total_time_run", "%f", timePassed.count());
     formatter->dump_format("total_reads_made", "%d", data.finished);
@@ -1057,6 +1124,7 @@ int ObjBencher::rand_read_bench(
     formatter->dump_format("average_latency", "%f", data.avg_latency);
     formatter->dump_format("max_latency", "%f", data.max_latency);
     formatter->dump_format("min_latency", "%f", data.min_latency);
+    dump_latency_percentiles(0);
   }
   completions_done();
 
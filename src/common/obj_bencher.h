@@ -18,6 +18,7 @@
 #include "common/ceph_context.h"
 #include "common/Formatter.h"
 #include "ceph_time.h"
+#include <array>
 #include <cfloat>
 
 using ceph::mono_clock;
@@ -35,6 +36,19 @@ struct bench_interval_data {
   double iops_diff_sum = 0;
 };
 
+// log-linear latency histogram: 16 sub-buckets per power of two of
+// microseconds, so percentiles are within ~6% of the true value
+struct bench_latency_histogram {
+  static constexpr unsigned SUB_BITS = 4;
+  static constexpr unsigned SUB_BUCKETS = 1 << SUB_BITS;
+  std::array<uint64_t, SUB_BUCKETS * (64 - SUB_BITS + 1)> buckets = {};
+  uint64_t count = 0;
+
+  void record(double seconds);
+  // upper bound (in seconds) of the bucket holding the p-th quantile
+  double percentile(double p) const;
+};
+
 struct bench_data {
   bool done; //is the benchmark is done
   uint64_t object_size; //the size of the objects
@@ -49,6 +63,7 @@ struct bench_data {
   double avg_latency;
   struct bench_interval_data idata; // data that is updated by time intervals and not by events
   double latency_diff_sum;
+  bench_latency_histogram lat_hist;
   std::chrono::duration<double> cur_latency; //latency of last completed transaction - in seconds by default
   mono_time start_time; //start time for benchmark - use the monotonic clock as we'll measure the passage of time
   char *object_contents; //pointer to the contents written to each object
@@ -106,6 +121,7 @@ protected:
 
   std::ostream& out(std::ostream& os);
   std::ostream& out(std::ostream& os, utime_t& t);
+  void dump_latency_percentiles(size_t label_width);
 public:
   explicit ObjBencher(CephContext *cct_) : show_time(false), cct(cct_), data() {}
   virtual ~ObjBencher() {}
@@ -39,8 +39,10 @@ class SharedLRU {
 #endif
   ceph::mutex lock;
   size_t max_size;
+  size_t max_bytes = 0; ///< 0: entries are only limited by count
   ceph::condition_variable cond;
   unsigned size;
+  size_t bytes = 0;     ///< sum of the charges of the entries in the lru
 public:
   int waiting;
 private:
@@ -48,11 +50,14 @@ private:
   using H = std::hash<K>;
   ceph::unordered_map<K, typename std::list<std::pair<K, VPtr> >::iterator, H> contents;
   std::list<std::pair<K, VPtr> > lru;
+  /// charges given with set_charge(), for the entries in the lru
+  ceph::unordered_map<K, size_t, H> charges;
 
   std::map<K, std::pair<WeakVPtr, V*>, C> weak_refs;
 
   void trim_cache(std::list<VPtr> *to_release) {
-    while (size > max_size) {
+    // the newest entry stays even if it alone exceeds max_bytes
+    while (size > max_size || (max_bytes && bytes > max_bytes && size > 1)) {
       to_release->push_back(lru.back().second);
       lru_remove(lru.back().first);
     }
@@ -65,6 +70,10 @@ private:
     lru.erase(i->second);
     --size;
     contents.erase(i);
+    if (auto c = charges.find(key); c != charges.end()) {
+      bytes -= c->second;
+      charges.erase(c);
+    }
   }
 
   void lru_add(const K& key, const VPtr& val, std::list<VPtr> *to_release) {
@@ -126,6 +135,11 @@ public:
     return size;
   }
 
+  size_t get_bytes() {
+    std::lock_guard locker{lock};
+    return bytes;
+  }
+
   void set_cct(CephContext *c) {
     cct = c;
   }
@@ -209,6 +223,35 @@ public:
     }
   }
 
+  /// bound the lru by the sum of the entries' charges as well (0: don't)
+  void set_max_bytes(size_t new_max_bytes) {
+    std::list<VPtr> to_release;
+    {
+      std::lock_guard l{lock};
+      max_bytes = new_max_bytes;
+      trim_cache(&to_release);
+    }
+  }
+
+  /**
+   * Account for the memory held by a cached entry. Entries default to
+   * a charge of 0, i.e. they are only counted against max_size. The
+   * charge is dropped when the entry leaves the lru.
+   */
+  void set_charge(const K& key, size_t charge) {
+    std::list<VPtr> to_release;
+    {
+      std::lock_guard l{lock};
+      if (!contents.count(key)) {
+	return;
+      }
+      auto& c = charges[key];
+      bytes = bytes - c + charge;
+      c = charge;
+      trim_cache(&to_release);
+    }
+  }
+
   // Returns K key s.t. key <= k for all currently cached k,v
   K cached_key_lower_bound() {
     std::lock_guard l{lock};
@@ -564,6 +564,11 @@ int CrushTester::test(CephContext* cct)
         // create a vector to hold placement results temporarily 
         vector<int> temporary_per ( per.size() );
 
+        // CRUSH placements, mapped a chunk of inputs at a time
+        const int crush_chunk = 1024;
+        vector<vector<int>> chunk_out;
+        int chunk_min = batch_min;
+
         for (int x = batch_min; x <= batch_max; x++) {
           // create a vector to hold the results of a CRUSH placement or RNG simulation
           vector<int> out;
@@ -571,11 +576,19 @@ int CrushTester::test(CephContext* cct)
           if (use_crush) {
             if (output_mappings)
 	      err << "CRUSH"; // prepend CRUSH to placement output
-            uint32_t real_x = x;
-            if (pool_id != -1) {
-              real_x = crush_hash32_2(CRUSH_HASH_RJENKINS1, x, (uint32_t)pool_id);
+            if (x == batch_min || x - chunk_min == crush_chunk) {
+              chunk_min = x;
+              vector<int> real_xs;
+              for (int cx = x; cx <= batch_max && cx - x < crush_chunk; cx++) {
+                uint32_t real_x = cx;
+                if (pool_id != -1) {
+                  real_x = crush_hash32_2(CRUSH_HASH_RJENKINS1, cx, (uint32_t)pool_id);
+                }
+                real_xs.push_back(real_x);
+              }
+              crush.do_rule_many(r, real_xs, chunk_out, nr, weight, 0);
             }
-            crush.do_rule(r, real_x, out, nr, weight, 0);
+            out = std::move(chunk_out[x - chunk_min]);
           } else {
             if (output_mappings)
 	      err << "RNG"; // prepend RNG to placement output to denote simulation
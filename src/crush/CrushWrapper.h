@@ -1625,6 +1625,29 @@ public:
       out[i] = rawout[i];
   }
 
+  /// do_rule for each of xs, sharing one workspace
+  template<typename WeightVector>
+  void do_rule_many(int rule, const std::vector<int>& xs,
+		    std::vector<std::vector<int>>& out, int maxout,
+		    const WeightVector& weight,
+		    uint64_t choose_args_index) const {
+    std::vector<int> rawout(xs.size() * maxout);
+    std::vector<int> numrep(xs.size());
+    std::vector<char> work(crush_work_size(crush, maxout));
+    crush_init_workspace(crush, work.data());
+    crush_choose_arg_map arg_map = choose_args_get_with_fallback(
+      choose_args_index);
+    crush_do_rule_many(crush, rule, xs.data(), xs.size(),
+		       rawout.data(), maxout, numrep.data(),
+		       std::data(weight), std::size(weight),
+		       work.data(), arg_map.args);
+    out.resize(xs.size());
+    for (size_t i = 0; i < xs.size(); ++i) {
+      auto first = rawout.begin() + i * maxout;
+      out[i].assign(first, first + std::max(numrep[i], 0));
+    }
+  }
+
   int _choose_type_stack(
     CephContext *cct,
     const std::vector<std::pair<int,int>>& stack,
@@ -94,6 +94,24 @@ extern int crush_do_rule(const struct crush_map *map,
 			 const __u32 *weights, int weight_max,
 			 void *cwin, const struct crush_choose_arg *choose_args);
 
+/** @ingroup API
+ *
+ * Map each of the __n__ inputs in __x__ as crush_do_rule() would,
+ * storing the items for __x[i]__ in __result[i * result_max,
+ * (i + 1) * result_max[__ and their count in __result_len[i]__.
+ *
+ * The workspace __cwin__ is initialized once by the caller and
+ * reused for every input, so that mapping many inputs does not pay
+ * for setting it up again, and bucket state stays in cache.
+ */
+extern void crush_do_rule_many(const struct crush_map *map,
+			       int ruleno,
+			       const int *x, int n,
+			       int *result, int result_max, int *result_len,
+			       const __u32 *weights, int weight_max,
+			       void *cwin,
+			       const struct crush_choose_arg *choose_args);
+
 /* Returns enough workspace for any crush rule within map to generate
    result_max outputs. The caller can then allocate this much on its own,
    either on the stack, in a per-thread long-lived buffer, or however it likes.*/
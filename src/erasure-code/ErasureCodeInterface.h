@@ -140,6 +140,7 @@
     chunks with cost 6 + 6 = 12. 
  */ 
 
+#include <cstdint>
 #include <map>
 #include <set>
 #include <vector>
@@ -459,6 +460,19 @@ namespace ceph {
      */
     virtual int decode_concat(const std::map<int, bufferlist> &chunks,
 			      bufferlist *decoded) = 0;
+
+    enum {
+      /// **encode_chunks** on the concatenation of the chunks of
+      /// several stripes gives the concatenation of their encodings
+      FLAG_EC_PLUGIN_MULTI_STRIPE_OPTIMIZATION = 1 << 0,
+    };
+
+    /**
+     * Return the FLAG_EC_PLUGIN_* optimizations the code supports.
+     *
+     * @return a mask of FLAG_EC_PLUGIN_* bits
+     */
+    virtual uint64_t get_supported_optimizations() const = 0;
   };
 
   typedef std::shared_ptr<ErasureCodeInterface> ErasureCodeInterfaceRef;
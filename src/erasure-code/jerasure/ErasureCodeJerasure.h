@@ -56,6 +56,12 @@ public:
 
   unsigned int get_chunk_size(unsigned int stripe_width) const override;
 
+  uint64_t get_supported_optimizations() const override {
+    // every technique encodes each w * packetsize block independently
+    // of the others
+    return FLAG_EC_PLUGIN_MULTI_STRIPE_OPTIMIZATION;
+  }
+
   int encode_chunks(const std::set<int> &want_to_encode,
 		    std::map<int, ceph::buffer::list> *encoded) override;
 
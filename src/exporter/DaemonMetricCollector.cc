@@ -84,13 +84,50 @@ std::string boost_string_to_std(boost::json::string js) {
 
 std::string quote(std::string value) { return "\"" + value + "\""; }
 
-void DaemonMetricCollector::parse_asok_metrics(
-    std::string &counter_dump_response, std::string &counter_schema_response,
-    int64_t prio_limit, const std::string &daemon_name) {
+bool counter_schema_matches(const json_object &counter_dump,
+                            const json_object &counter_schema) {
+  if (counter_dump.size() != counter_schema.size()) {
+    return false;
+  }
+  for (auto &perf_group_item : counter_schema) {
+    auto dump_it = counter_dump.find(perf_group_item.key());
+    if (dump_it == counter_dump.end()) {
+      return false;
+    }
+    auto &schema_array = perf_group_item.value().as_array();
+    auto &dump_array = dump_it->value().as_array();
+    if (schema_array.size() != dump_array.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < schema_array.size(); ++i) {
+      auto &schema_entry = schema_array[i].as_object();
+      auto &dump_entry = dump_array[i].as_object();
+      if (schema_entry.at("labels") != dump_entry.at("labels")) {
+        return false;
+      }
+      auto &schema_counters = schema_entry.at("counters").as_object();
+      auto &dump_counters = dump_entry.at("counters").as_object();
+      if (schema_counters.size() != dump_counters.size()) {
+        return false;
+      }
+      for (auto &counter : schema_counters) {
+        if (dump_counters.find(counter.key()) == dump_counters.end()) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool DaemonMetricCollector::parse_asok_metrics(
+    std::string &counter_dump_response, const json_object &counter_schema,
+    bool check_schema, int64_t prio_limit, const std::string &daemon_name) {
   json_object counter_dump =
       boost::json::parse(counter_dump_response).as_object();
-  json_object counter_schema =
-      boost::json::parse(counter_schema_response).as_object();
+  if (check_schema && !counter_schema_matches(counter_dump, counter_schema)) {
+    return false;
+  }
 
   for (auto &perf_group_item : counter_schema) {
     std::string perf_group = {perf_group_item.key().begin(),
@@ -141,6 +178,7 @@ void DaemonMetricCollector::parse_asok_metrics(
       }
     }
   }
+  return true;
 }
 
 
@@ -178,11 +216,18 @@ void DaemonMetricCollector::dump_asok_metrics(bool sort_metrics, int64_t counter
         failures++;
         continue;
     }
-    std::string counter_schema_response = schema_response.size() > 0 ? schema_response :
+    // the schema only changes when counters are added or removed, so
+    // reuse the last one and refetch only when the dump no longer fits it
+    auto cached_schema = schema_response.size() > 0 ? schema_cache.end() :
+      schema_cache.find(daemon_name);
+    std::string counter_schema_response;
+    if (cached_schema == schema_cache.end()) {
+      counter_schema_response = schema_response.size() > 0 ? schema_response :
         asok_request(sock_client, "counter schema", daemon_name);
-    if (counter_schema_response.size() == 0) {
-      failures++;
-      continue;
+      if (counter_schema_response.size() == 0) {
+        failures++;
+        continue;
+      }
     }
 
     try {
@@ -203,15 +248,36 @@ void DaemonMetricCollector::dump_asok_metrics(bool sort_metrics, int64_t counter
       if (!pid_str.empty()) {
         daemon_pids.push_back({daemon_name, std::stoi(pid_str)});
       }
-      parse_asok_metrics(counter_dump_response, counter_schema_response,
+      if (cached_schema != schema_cache.end()) {
+        if (parse_asok_metrics(counter_dump_response, cached_schema->second,
+                               true, prio_limit, daemon_name)) {
+          continue;
+        }
+        dout(10) << "counter schema changed for " << daemon_name << dendl;
+        schema_cache.erase(cached_schema);
+        counter_schema_response =
+          asok_request(sock_client, "counter schema", daemon_name);
+        if (counter_schema_response.size() == 0) {
+          failures++;
+          continue;
+        }
+      }
+      json_object counter_schema =
+        boost::json::parse(counter_schema_response).as_object();
+      parse_asok_metrics(counter_dump_response, counter_schema, false,
                          prio_limit, daemon_name);
+      if (schema_response.size() == 0) {
+        schema_cache[daemon_name] = std::move(counter_schema);
+      }
     } catch (const std::invalid_argument &e) {
       failures++;
+      schema_cache.erase(daemon_name);
       dout(1) << "failed to handle " << daemon_name << ": " << e.what()
               << dendl;
       continue;
     } catch (const std::runtime_error &e) {
       failures++;
+      schema_cache.erase(daemon_name);
       dout(1) << "failed to parse json for " << daemon_name << ": " << e.what()
               << dendl;
       continue;
@@ -427,6 +493,14 @@ void DaemonMetricCollector::update_sockets() {
       }
     }
   }
+  // forget schemas of daemons whose socket went away
+  for (auto it = schema_cache.begin(); it != schema_cache.end();) {
+    if (clients.find(it->first) == clients.end()) {
+      it = schema_cache.erase(it);
+    } else {
+      ++it;
+    }
+  }
 }
 
 void OrderedMetricsBuilder::add(std::string value, std::string name,
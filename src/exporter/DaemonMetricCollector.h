@@ -30,6 +30,11 @@ class Metric;
 
 typedef std::map<std::string, std::string> labels_t;
 
+// true if counter_dump has exactly the groups, labeled instances and
+// counters described by counter_schema
+bool counter_schema_matches(const boost::json::object &counter_dump,
+                            const boost::json::object &counter_schema);
+
 class DaemonMetricCollector {
 public:
   void main();
@@ -46,15 +51,19 @@ public:
 private:
   std::mutex metrics_mutex;
   std::unique_ptr<MetricsBuilder> builder;
+  // last "counter schema" seen per daemon, reused while it still matches
+  // the shape of the daemon's "counter dump"
+  std::map<std::string, boost::json::object> schema_cache;
   void update_sockets();
   void request_loop(boost::asio::steady_timer &timer);
 
   void dump_asok_metric(boost::json::object perf_info,
                         boost::json::value perf_values, std::string name,
                         labels_t labels);
-  void parse_asok_metrics(std::string &counter_dump_response,
-                          std::string &counter_schema_response,
-                          int64_t prio_limit, const std::string &daemon_name);
+  bool parse_asok_metrics(std::string &counter_dump_response,
+                          const boost::json::object &counter_schema,
+                          bool check_schema, int64_t prio_limit,
+                          const std::string &daemon_name);
   void get_process_metrics(std::vector<std::pair<std::string, int>> daemon_pids);
   std::string asok_request(AdminSocketClient &asok, std::string command, std::string daemon_name);
 };
@@ -131,6 +131,9 @@ struct ceph_ll_io_info {
   bool syncdataonly;
 };
 
+/* completion queue for ceph_ll_io_submit(), see ceph_ll_io_queue_create() */
+struct ceph_ll_io_queue;
+
 /* setattr mask bits (up to an int in size) */
 #ifndef CEPH_SETATTR_MODE
 #define CEPH_SETATTR_MODE		(1 << 0)
@@ -1949,6 +1952,57 @@ int64_t ceph_ll_writev(struct ceph_mount_info *cmount, struct Fh *fh,
 		       const struct iovec *iov, int iovcnt, int64_t off);
 int64_t ceph_ll_nonblocking_readv_writev(struct ceph_mount_info *cmount,
 					 struct ceph_ll_io_info *io_info);
+
+/**
+ * Create a completion queue for ceph_ll_io_submit().
+ *
+ * @param cmount the ceph mount handle to use.
+ * @param queue where to store the new queue
+ * @returns 0 on success or a negative error code
+ */
+int ceph_ll_io_queue_create(struct ceph_mount_info *cmount,
+			    struct ceph_ll_io_queue **queue);
+/**
+ * Destroy a completion queue.
+ *
+ * @param cmount the ceph mount handle to use.
+ * @param queue the queue to destroy
+ * @returns 0 on success, -EBUSY if I/O submitted to the queue has not been
+ *          reaped with ceph_ll_io_getevents() yet
+ */
+int ceph_ll_io_queue_destroy(struct ceph_mount_info *cmount,
+			     struct ceph_ll_io_queue *queue);
+/**
+ * Submit a batch of nonblocking reads and writes.
+ *
+ * Each request is handled as by ceph_ll_nonblocking_readv_writev(), except
+ * that its callback is not invoked: the completed ceph_ll_io_info, with its
+ * result filled in, is instead queued on @queue for ceph_ll_io_getevents().
+ *
+ * @param cmount the ceph mount handle to use.
+ * @param queue the completion queue
+ * @param ios array of requests to submit
+ * @param nr number of requests in @ios
+ * @returns number of requests submitted or a negative error code
+ */
+int ceph_ll_io_submit(struct ceph_mount_info *cmount,
+		      struct ceph_ll_io_queue *queue,
+		      struct ceph_ll_io_info **ios, int nr);
+/**
+ * Reap completed requests from a completion queue.
+ *
+ * @param cmount the ceph mount handle to use.
+ * @param queue the completion queue
+ * @param min_nr wait until at least this many requests have completed
+ * @param max_nr maximum number of requests to return in @events
+ * @param events array each reaped ceph_ll_io_info is stored in
+ * @param timeout_ms how long to wait for @min_nr completions; negative waits
+ *        forever
+ * @returns number of requests stored in @events or a negative error code
+ */
+int ceph_ll_io_getevents(struct ceph_mount_info *cmount,
+			 struct ceph_ll_io_queue *queue, int min_nr, int max_nr,
+			 struct ceph_ll_io_info **events, int64_t timeout_ms);
 int ceph_ll_close(struct ceph_mount_info *cmount, struct Fh* filehandle);
 int ceph_ll_iclose(struct ceph_mount_info *cmount, struct Inode *in, int mode);
 /**
@@ -23,6 +23,7 @@
 #include <list>
 #include <mutex>
 #include <typeinfo>
+#include <type_traits>
 #include <boost/container/flat_set.hpp>
 #include <boost/container/flat_map.hpp>
 
@@ -335,8 +336,10 @@ public:
   typedef T value_type;
   typedef value_type *pointer;
   typedef const value_type * const_pointer;
-  typedef value_type& reference;
-  typedef const value_type& const_reference;
+  // add_lvalue_reference so that pool_allocator<void> (as rebound to by
+  // e.g. boost::container::small_vector) stays well-formed
+  typedef std::add_lvalue_reference_t<value_type> reference;
+  typedef std::add_lvalue_reference_t<const value_type> const_reference;
   typedef std::size_t size_type;
   typedef std::ptrdiff_t difference_type;
 
@@ -438,10 +441,6 @@ public:
     p->~U();
   }
 
-  void construct(T* p, const T& val) {
-    ::new ((void *)p) T(val);
-  }
-
   template<class U, class... Args> void construct(U* p,Args&&... args) {
     ::new((void *)p) U(std::forward<Args>(args)...);
   }
@@ -131,10 +131,15 @@ typedef struct {
 /**
  * These types used to in set_image_notification to indicate the type of event
  * socket passed in.
+ *
+ * EVENT_TYPE_POLL takes no descriptor (pass -1): completions are only queued
+ * for rbd_poll_io_events, for callers that poll from their own I/O thread and
+ * do not want a wakeup per completion.
  */
 enum {
   EVENT_TYPE_PIPE = 1,
-  EVENT_TYPE_EVENTFD = 2
+  EVENT_TYPE_EVENTFD = 2,
+  EVENT_TYPE_POLL = 3
 };
 
 typedef struct {
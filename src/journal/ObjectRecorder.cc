@@ -8,6 +8,7 @@
 #include "common/Timer.h"
 #include "common/errno.h"
 #include "cls/journal/cls_journal_client.h"
+#include <optional>
 
 #define dout_subsys ceph_subsys_journaler
 #undef dout_prefix
@@ -65,6 +66,16 @@ void ObjectRecorder::set_append_batch_options(int flush_interval,
   m_flush_age = flush_age;
 }
 
+void ObjectRecorder::set_append_latency_target(double append_latency_target) {
+  ldout(m_cct, 5) << "append_latency_target=" << append_latency_target
+                  << dendl;
+
+  ceph_assert(ceph_mutex_is_locked(*m_lock));
+  m_append_latency_target = append_latency_target;
+  m_adaptive_max_in_flight_appends = 1;
+  m_avg_append_latency = 0;
+}
+
 bool ObjectRecorder::append(AppendBuffers &&append_buffers) {
   ldout(m_cct, 20) << "count=" << append_buffers.size() << dendl;
 
@@ -72,6 +83,9 @@ bool ObjectRecorder::append(AppendBuffers &&append_buffers) {
 
   ceph::ref_t<FutureImpl> last_flushed_future;
   auto flush_handler = get_flush_handler();
+  if (m_pending_buffers.empty()) {
+    m_pending_start_time = ceph::mono_clock::now();
+  }
   for (auto& append_buffer : append_buffers) {
     ldout(m_cct, 20) << *append_buffer.first << ", "
                      << "size=" << append_buffer.second.length() << dendl;
@@ -187,6 +201,13 @@ void ObjectRecorder::handle_append_flushed(uint64_t tid, int r) {
   ceph_assert(tid_iter != m_in_flight_tids.end());
   m_in_flight_tids.erase(tid_iter);
 
+  std::optional<ceph::mono_time> append_start_time;
+  auto time_iter = m_in_flight_append_times.find(tid);
+  if (time_iter != m_in_flight_append_times.end()) {
+    append_start_time = time_iter->second;
+    m_in_flight_append_times.erase(time_iter);
+  }
+
   InFlightAppends::iterator iter = m_in_flight_appends.find(tid);
   ceph_assert(iter != m_in_flight_appends.end());
 
@@ -208,6 +229,10 @@ void ObjectRecorder::handle_append_flushed(uint64_t tid, int r) {
     append_buffers.swap(iter->second);
     ceph_assert(!append_buffers.empty());
 
+    if (r >= 0 && append_start_time) {
+      update_append_latency(*append_start_time, append_buffers.size());
+    }
+
     for (auto& append_buffer : append_buffers) {
       auto length = append_buffer.second.length();
       m_object_bytes += length;
@@ -262,6 +287,48 @@ void ObjectRecorder::append_overflowed() {
                                 m_pending_buffers.begin(),
                                 m_pending_buffers.end());
   restart_append_buffers.swap(m_pending_buffers);
+  m_in_flight_append_times.clear();
+  m_pending_start_time = ceph::mono_clock::now();
+}
+
+void ObjectRecorder::update_append_latency(const ceph::mono_time &start_time,
+                                           size_t batch_size) {
+  ceph_assert(ceph_mutex_is_locked(*m_lock));
+
+  double latency = ceph::to_seconds<double>(ceph::mono_clock::now() -
+                                            start_time);
+  if (m_avg_append_latency == 0) {
+    m_avg_append_latency = latency;
+  } else {
+    m_avg_append_latency = (7 * m_avg_append_latency + latency) / 8;
+  }
+
+  ldout(m_cct, 20) << "batch_size=" << batch_size << ", "
+                   << "latency=" << latency << ", "
+                   << "avg_latency=" << m_avg_append_latency << dendl;
+
+  if (m_append_latency_target <= 0) {
+    return;
+  }
+
+  // batches grow while appends queue up behind a single in-flight append.
+  // If that pushes latency past the target, permit more concurrent appends
+  // so queued events are sent in smaller batches; once latency is well under
+  // the target, shrink back to let the batches grow again
+  int32_t max_in_flight_appends = m_max_in_flight_appends > 0 ?
+    m_max_in_flight_appends : MAX_ADAPTIVE_IN_FLIGHT_APPENDS;
+  if (m_avg_append_latency > m_append_latency_target) {
+    if (m_adaptive_max_in_flight_appends < max_in_flight_appends) {
+      ++m_adaptive_max_in_flight_appends;
+      ldout(m_cct, 10) << "latency above target: max_in_flight_appends="
+                       << m_adaptive_max_in_flight_appends << dendl;
+    }
+  } else if (m_avg_append_latency < m_append_latency_target / 2 &&
+             m_adaptive_max_in_flight_appends > 1) {
+    --m_adaptive_max_in_flight_appends;
+    ldout(m_cct, 10) << "latency below target: max_in_flight_appends="
+                     << m_adaptive_max_in_flight_appends << dendl;
+  }
 }
 
 bool ObjectRecorder::send_appends(bool force, ceph::ref_t<FutureImpl> flush_future) {
@@ -293,7 +360,14 @@ bool ObjectRecorder::send_appends(bool force, ceph::ref_t<FutureImpl> flush_futu
   }
 
   auto max_in_flight_appends = m_max_in_flight_appends;
-  if (m_flush_interval > 0 || m_flush_bytes > 0 || m_flush_age > 0) {
+  if (m_append_latency_target > 0 &&
+      (m_flush_interval > 0 || m_flush_bytes > 0 || m_flush_age > 0)) {
+    if (!force && m_in_flight_tids.empty()) {
+      ldout(m_cct, 20) << "idle, flushing immediately" << dendl;
+      force = true;
+    }
+    max_in_flight_appends = m_adaptive_max_in_flight_appends;
+  } else if (m_flush_interval > 0 || m_flush_bytes > 0 || m_flush_age > 0) {
     if (!force && max_in_flight_appends == 0) {
       ldout(m_cct, 20) << "attempting to batch AIO appends" << dendl;
       max_in_flight_appends = 1;
@@ -356,6 +430,7 @@ bool ObjectRecorder::send_appends(bool force, ceph::ref_t<FutureImpl> flush_futu
     uint64_t append_tid = m_append_tid++;
     m_in_flight_tids.insert(append_tid);
     m_in_flight_appends[append_tid].swap(append_buffers);
+    m_in_flight_append_times[append_tid] = m_pending_start_time;
     m_in_flight_bytes += append_bytes;
 
     ceph_assert(m_pending_bytes >= append_bytes);
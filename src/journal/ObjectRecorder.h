@@ -8,6 +8,7 @@
 #include "include/Context.h"
 #include "include/rados/librados.hpp"
 #include "common/ceph_mutex.h"
+#include "common/ceph_time.h"
 #include "common/RefCountedObj.h"
 #include "common/WorkQueue.h"
 #include "common/Timer.h"
@@ -36,6 +37,7 @@ public:
 
   void set_append_batch_options(int flush_interval, uint64_t flush_bytes,
                                 double flush_age);
+  void set_append_latency_target(double append_latency_target);
 
   inline uint64_t get_object_number() const {
     return m_object_number;
@@ -75,6 +77,9 @@ private:
 
   typedef std::set<uint64_t> InFlightTids;
   typedef std::map<uint64_t, AppendBuffers> InFlightAppends;
+  typedef std::map<uint64_t, ceph::mono_time> InFlightAppendTimes;
+
+  static const int32_t MAX_ADAPTIVE_IN_FLIGHT_APPENDS = 16;
 
   struct FlushHandler : public FutureImpl::FlushHandler {
     ceph::ref_t<ObjectRecorder> object_recorder;
@@ -111,6 +116,10 @@ private:
   double m_flush_age = 0;
   int32_t m_max_in_flight_appends;
 
+  double m_append_latency_target = 0;
+  int32_t m_adaptive_max_in_flight_appends = 1;
+  double m_avg_append_latency = 0;
+
   bool m_compat_mode;
 
   /* So that ObjectRecorder::FlushHandler doesn't create a circular reference: */
@@ -128,11 +137,13 @@ private:
   AppendBuffers m_pending_buffers;
   uint64_t m_pending_bytes = 0;
   utime_t m_last_flush_time;
+  ceph::mono_time m_pending_start_time;
 
   uint64_t m_append_tid = 0;
 
   InFlightTids m_in_flight_tids;
   InFlightAppends m_in_flight_appends;
+  InFlightAppendTimes m_in_flight_append_times;
   uint64_t m_object_bytes = 0;
 
   bool m_overflowed = false;
@@ -149,6 +160,8 @@ private:
   bool send_appends(bool force, ceph::ref_t<FutureImpl> flush_sentinel);
   void handle_append_flushed(uint64_t tid, int r);
   void append_overflowed();
+  void update_append_latency(const ceph::mono_time &start_time,
+                             size_t batch_size);
 
   void wake_up_flushes();
   void notify_handler_unlock(std::unique_lock<ceph::mutex>& locker,
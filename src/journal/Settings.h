@@ -12,6 +12,8 @@ struct Settings {
   double commit_interval = 5;         ///< commit position throttle (in secs)
   uint64_t max_payload_bytes = 0;     ///< 0 implies object size limit
   int max_concurrent_object_sets = 0; ///< 0 implies no limit
+  double append_latency_target = 0;   ///< adaptive append batching target
+                                      ///< (in secs), 0 implies disabled
   std::set<std::string> ignored_laggy_clients;
                                       ///< clients that mustn't be disconnected
 };
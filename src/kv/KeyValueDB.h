@@ -189,6 +189,22 @@ public:
 		  ceph::buffer::list *value) {
     return get(prefix, std::string(key, keylen), value);
   }
+  /// Retrieve a batch of keys of one prefix in a single call.  values
+  /// and rvals (0 or -ENOENT) are filled in the order of keys.
+  /// Backends that can coalesce the lookups override this.
+  virtual int get_batch(
+    const std::string &prefix,                  ///< [in] prefix or CF name
+    const std::vector<std::string> &keys,       ///< [in] keys to retrieve
+    std::vector<ceph::buffer::list> *values,    ///< [out] values
+    std::vector<int> *rvals) {                  ///< [out] per key result
+    values->clear();
+    values->resize(keys.size());
+    rvals->assign(keys.size(), -ENOENT);
+    for (size_t i = 0; i < keys.size(); ++i) {
+      (*rvals)[i] = get(prefix, keys[i], &(*values)[i]);
+    }
+    return 0;
+  }
 
   // This superclass is used both by kv iterators *and* by the ObjectMap
   // omap iterator.  The class hierarchies are unfortunately tied together
@@ -21,7 +21,9 @@
 #include "rocksdb/utilities/table_properties_collectors.h"
 #include "rocksdb/merge_operator.h"
 
+#include "common/admin_socket.h"
 #include "common/perf_counters.h"
+#include "common/perf_counters_key.h"
 #include "common/PriorityCache.h"
 #include "include/common_fwd.h"
 #include "include/scope_guard.h"
@@ -455,11 +457,14 @@ int RocksDBStore::create_and_open(ostream &out,
 }
 
 std::shared_ptr<rocksdb::Cache> RocksDBStore::create_block_cache(
-    const std::string& cache_type, size_t cache_size, double cache_prio_high) {
+    const std::string& cache_type, size_t cache_size, double cache_prio_high,
+    const std::string& cache_name) {
   std::shared_ptr<rocksdb::Cache> cache;
   auto shard_bits = cct->_conf->rocksdb_cache_shard_bits;
   if (cache_type == "binned_lru") {
-    cache = rocksdb_cache::NewBinnedLRUCache(cct, cache_size, shard_bits, false, cache_prio_high);
+    cache = rocksdb_cache::NewBinnedLRUCache(cct, cache_size, shard_bits, false, cache_prio_high,
+					     cct->_conf->rocksdb_cache_probation_ratio,
+					     cache_name);
   } else if (cache_type == "lru") {
     cache = rocksdb::NewLRUCache(cache_size, shard_bits);
   } else if (cache_type == "clock") {
@@ -816,6 +821,7 @@ int RocksDBStore::create_shards(const rocksdb::Options& opt,
     if (r != 0) {
       return r;
     }
+    apply_cf_options_override_at_open(p.name, &cf_opt);
     for (size_t idx = 0; idx < p.shard_cnt; idx++) {
       std::string cf_name;
       if (p.shard_cnt == 1)
@@ -945,6 +951,260 @@ int RocksDBStore::update_column_family_options(const std::string& base_name,
   return 0;
 }
 
+// rocksdb_cf_options_override uses the syntax of bluestore_rocksdb_cfs,
+// without shard counts: "column=options column2=options2 ...".  At open
+// any option applies; at runtime only those RocksDB can change with
+// SetOptions (write buffers, level/file sizing, compaction triggers,
+// block_based_table_factory={block_size=...}, ...).
+void RocksDBStore::apply_cf_options_override_at_open(
+  const std::string& base_name,
+  rocksdb::ColumnFamilyOptions* cf_opt)
+{
+  std::vector<ColumnFamily> overrides;
+  std::string error;
+  if (!parse_sharding_def(
+	cct->_conf.get_val<std::string>("rocksdb_cf_options_override"),
+	overrides, nullptr, &error)) {
+    derr << __func__ << " ignoring invalid rocksdb_cf_options_override: "
+	 << error << dendl;
+    return;
+  }
+  for (auto& o : overrides) {
+    if (o.name == base_name && !o.options.empty()) {
+      rocksdb::ColumnFamilyOptions t(*cf_opt);
+      if (update_column_family_options(base_name, o.options, &t) == 0) {
+	dout(1) << __func__ << " column " << base_name << " override "
+		<< o.options << dendl;
+	*cf_opt = t;
+      } else {
+	derr << __func__ << " ignoring invalid override for column "
+	     << base_name << ": " << o.options << dendl;
+      }
+    }
+  }
+}
+
+int RocksDBStore::apply_cf_options_override(const std::string& spec)
+{
+  std::vector<ColumnFamily> overrides;
+  std::string error;
+  if (!parse_sharding_def(spec, overrides, nullptr, &error)) {
+    derr << __func__ << " invalid spec '" << spec << "': " << error << dendl;
+    return -EINVAL;
+  }
+  int ret = 0;
+  for (auto& o : overrides) {
+    std::vector<rocksdb::ColumnFamilyHandle*> handles;
+    if (o.name == rocksdb::kDefaultColumnFamilyName) {
+      handles.push_back(default_cf);
+    } else if (auto it = cf_handles.find(o.name); it != cf_handles.end()) {
+      handles = it->second.handles;
+    } else {
+      derr << __func__ << " no column family " << o.name << dendl;
+      ret = -ENOENT;
+      continue;
+    }
+    std::unordered_map<std::string, std::string> options_map;
+    std::string block_cache_opt;
+    int r = split_column_family_options(o.options, &options_map, &block_cache_opt);
+    if (r < 0) {
+      ret = r;
+      continue;
+    }
+    if (!block_cache_opt.empty()) {
+      derr << __func__ << " block_cache of " << o.name
+	   << " can only change on restart" << dendl;
+      ret = -EINVAL;
+    }
+    if (options_map.empty()) {
+      continue;
+    }
+    for (auto h : handles) {
+      rocksdb::Status status = db->SetOptions(h, options_map);
+      if (!status.ok()) {
+	derr << __func__ << " cannot set " << o.options << " on "
+	     << h->GetName() << ": " << status.ToString() << dendl;
+	ret = -EINVAL;
+	break;
+      }
+    }
+    dout(1) << __func__ << " column " << o.name << " " << o.options
+	    << (ret < 0 ? " (failed)" : "") << dendl;
+  }
+  return ret;
+}
+
+const char** RocksDBStore::get_tracked_conf_keys() const
+{
+  static const char* KEYS[] = {
+    "rocksdb_cf_options_override",
+    "rocksdb_kv_profile_sample_rate",
+    NULL
+  };
+  return KEYS;
+}
+
+void RocksDBStore::handle_conf_change(const ConfigProxy& conf,
+				      const std::set<std::string>& changed)
+{
+  if (changed.count("rocksdb_cf_options_override") && db) {
+    // entries dropped from the option keep their current value until restart
+    apply_cf_options_override(
+      conf.get_val<std::string>("rocksdb_cf_options_override"));
+  }
+  if (changed.count("rocksdb_kv_profile_sample_rate")) {
+    kv_profile_rate = conf.get_val<uint64_t>("rocksdb_kv_profile_sample_rate");
+  }
+}
+
+class RocksDBStore::SocketHook : public AdminSocketHook {
+  RocksDBStore *db;
+public:
+  explicit SocketHook(RocksDBStore *db) : db(db) {}
+
+  int call(std::string_view command,
+	   const cmdmap_t& cmdmap,
+	   const bufferlist&,
+	   Formatter *f,
+	   std::ostream& ss,
+	   bufferlist& out) override {
+    if (command == "dump_kv_profile") {
+      f->open_object_section("kv_profile");
+      db->dump_kv_profile(f);
+      f->close_section();
+    } else if (command == "reset_kv_profile") {
+      db->reset_kv_profile();
+    } else {
+      ss << "Invalid command" << std::endl;
+      return -ENOSYS;
+    }
+    return 0;
+  }
+};
+
+bool RocksDBStore::kv_profile_sample() const
+{
+  uint64_t rate = kv_profile_rate.load(std::memory_order_relaxed);
+  if (rate == 0) {
+    return false;
+  }
+  static thread_local uint64_t n = 0;
+  return (++n % rate) == 0;
+}
+
+void RocksDBStore::kv_profile_note(const string& prefix, kv_profile_op_t op,
+				   size_t key_len, size_t value_len,
+				   bool miss, utime_t lat)
+{
+  // bound the number of prefixes (and of perf counter sets) we track
+  static const size_t max_prefixes = 64;
+  std::lock_guard l(kv_profile_lock);
+  auto p = kv_profile.find(prefix);
+  if (p == kv_profile.end()) {
+    string name = kv_profile.size() < max_prefixes ? prefix : string("(other)");
+    p = kv_profile.emplace(name, kv_profile_t()).first;
+    if (!p->second.logger) {
+      PerfCountersBuilder plb(
+	cct,
+	ceph::perf_counters::key_create("rocksdb_kv_profile", {{"prefix", name}}),
+	l_rocksdb_kvp_first, l_rocksdb_kvp_last);
+      plb.add_u64_counter(l_rocksdb_kvp_get, "get", "Sampled gets");
+      plb.add_u64_counter(l_rocksdb_kvp_get_miss, "get_miss", "Sampled gets of missing keys");
+      plb.add_u64_counter(l_rocksdb_kvp_set, "set", "Sampled sets");
+      plb.add_u64_counter(l_rocksdb_kvp_rm, "rm", "Sampled removals");
+      plb.add_u64_counter(l_rocksdb_kvp_merge, "merge", "Sampled merges");
+      plb.add_u64_counter(l_rocksdb_kvp_key_bytes, "key_bytes", "Key bytes of sampled ops",
+			  nullptr, 0, unit_t(UNIT_BYTES));
+      plb.add_u64_counter(l_rocksdb_kvp_value_bytes, "value_bytes", "Value bytes of sampled ops",
+			  nullptr, 0, unit_t(UNIT_BYTES));
+      plb.add_time_avg(l_rocksdb_kvp_get_lat, "get_latency", "Latency of sampled gets");
+      p->second.logger = plb.create_perf_counters();
+      cct->get_perfcounters_collection()->add(p->second.logger);
+    }
+  }
+  auto& s = p->second;
+  s.key_bytes += key_len;
+  s.value_bytes += value_len;
+  s.logger->inc(l_rocksdb_kvp_key_bytes, key_len);
+  s.logger->inc(l_rocksdb_kvp_value_bytes, value_len);
+  switch (op) {
+  case KV_PROFILE_GET:
+    {
+      s.gets++;
+      s.logger->inc(l_rocksdb_kvp_get);
+      if (miss) {
+	s.get_misses++;
+	s.logger->inc(l_rocksdb_kvp_get_miss);
+      }
+      s.logger->tinc(l_rocksdb_kvp_get_lat, lat);
+      uint64_t us = lat.to_nsec() / 1000;
+      size_t b = us ? std::min<size_t>(64 - __builtin_clzll(us),
+				       s.get_lat_hist.size() - 1) : 0;
+      s.get_lat_hist[b]++;
+    }
+    break;
+  case KV_PROFILE_SET:
+    s.sets++;
+    s.logger->inc(l_rocksdb_kvp_set);
+    break;
+  case KV_PROFILE_RM:
+    s.rms++;
+    s.logger->inc(l_rocksdb_kvp_rm);
+    break;
+  case KV_PROFILE_MERGE:
+    s.merges++;
+    s.logger->inc(l_rocksdb_kvp_merge);
+    break;
+  }
+  if (op != KV_PROFILE_RM && !miss) {
+    kv_profile_hist.update_hist_entry(kv_profile_hist.key_hist, p->first,
+				      key_len, value_len);
+    kv_profile_hist.value_hist[kv_profile_hist.get_value_slab(value_len)]++;
+  }
+}
+
+void RocksDBStore::dump_kv_profile(Formatter *f)
+{
+  std::lock_guard l(kv_profile_lock);
+  f->dump_unsigned("sample_rate", kv_profile_rate);
+  f->open_array_section("prefixes");
+  for (auto& [prefix, s] : kv_profile) {
+    f->open_object_section("prefix");
+    f->dump_string("prefix", prefix);
+    f->dump_unsigned("get", s.gets);
+    f->dump_unsigned("get_miss", s.get_misses);
+    f->dump_unsigned("set", s.sets);
+    f->dump_unsigned("rm", s.rms);
+    f->dump_unsigned("merge", s.merges);
+    f->dump_unsigned("key_bytes", s.key_bytes);
+    f->dump_unsigned("value_bytes", s.value_bytes);
+    f->open_array_section("get_latency_histogram");
+    for (size_t i = 0; i < s.get_lat_hist.size(); ++i) {
+      if (s.get_lat_hist[i]) {
+	f->open_object_section("bucket");
+	f->dump_unsigned("max_us", i ? (1ull << i) - 1 : 0);
+	f->dump_unsigned("count", s.get_lat_hist[i]);
+	f->close_section();
+      }
+    }
+    f->close_section();
+    f->close_section();
+  }
+  f->close_section();
+  kv_profile_hist.dump(f);
+}
+
+void RocksDBStore::reset_kv_profile()
+{
+  std::lock_guard l(kv_profile_lock);
+  for (auto& p : kv_profile) {
+    cct->get_perfcounters_collection()->remove(p.second.logger);
+    delete p.second.logger;
+  }
+  kv_profile.clear();
+  kv_profile_hist = KeyValueHistogram();
+}
+
 int RocksDBStore::apply_block_cache_options(const std::string& column_name,
 					    const std::string& block_cache_opt,
 					    rocksdb::ColumnFamilyOptions* cf_opt)
@@ -1004,7 +1264,8 @@ int RocksDBStore::apply_block_cache_options(const std::string& column_name,
     column_bbt_opts.no_block_cache = true;
   } else {
     if (require_new_block_cache) {
-      block_cache = create_block_cache(cache_type, cache_size, high_pri_pool_ratio);
+      block_cache = create_block_cache(cache_type, cache_size, high_pri_pool_ratio,
+				       column_name);
       if (!block_cache) {
 	dout(5) << __func__ << " failed to create block cache for params: " << block_cache_opt << dendl;
 	return -EINVAL;
@@ -1076,6 +1337,7 @@ int RocksDBStore::verify_sharding(const rocksdb::Options& opt,
     if (r != 0) {
       return r;
     }
+    apply_cf_options_override_at_open(column.name, &cf_opt);
     if (column.shard_cnt == 1) {
       emplace_cf(column, 0, column.name, cf_opt);
     } else {
@@ -1240,6 +1502,7 @@ int RocksDBStore::do_open(ostream &out,
   
   PerfCountersBuilder plb(cct, "rocksdb", l_rocksdb_first, l_rocksdb_last);
   plb.add_time_avg(l_rocksdb_get_latency, "get_latency", "Get latency");
+  plb.add_u64_counter(l_rocksdb_get_batch_keys, "get_batch_keys", "Keys looked up in batches");
   plb.add_time_avg(l_rocksdb_submit_latency, "submit_latency", "Submit Latency");
   plb.add_time_avg(l_rocksdb_submit_sync_latency, "submit_sync_latency", "Submit Sync Latency");
   plb.add_u64_counter(l_rocksdb_compact, "compact", "Compactions");
@@ -1254,6 +1517,32 @@ int RocksDBStore::do_open(ostream &out,
   logger = plb.create_perf_counters();
   cct->get_perfcounters_collection()->add(logger);
 
+  kv_profile_rate = cct->_conf.get_val<uint64_t>("rocksdb_kv_profile_sample_rate");
+  if (!open_readonly) {
+    cct->_conf.add_observer(this);
+    conf_observer_registered = true;
+  }
+
+  if (AdminSocket *admin_socket = cct->get_admin_socket(); admin_socket) {
+    asok_hook = new SocketHook(this);
+    int r = admin_socket->register_command(
+      "dump_kv_profile", asok_hook,
+      "dump the sampled per-prefix KV access profile");
+    if (r == 0) {
+      r = admin_socket->register_command(
+	"reset_kv_profile", asok_hook,
+	"clear the sampled per-prefix KV access profile");
+    }
+    if (r != 0) {
+      // another store in this process got the commands first
+      dout(5) << __func__ << " cannot register kv profile commands: "
+	      << cpp_strerror(r) << dendl;
+      admin_socket->unregister_commands(asok_hook);
+      delete asok_hook;
+      asok_hook = nullptr;
+    }
+  }
+
   if (compact_on_mount) {
     derr << "Compacting rocksdb store..." << dendl;
     compact();
@@ -1283,6 +1572,17 @@ RocksDBStore::~RocksDBStore()
 
 void RocksDBStore::close()
 {
+  if (conf_observer_registered) {
+    cct->_conf.remove_observer(this);
+    conf_observer_registered = false;
+  }
+  if (asok_hook) {
+    cct->get_admin_socket()->unregister_commands(asok_hook);
+    delete asok_hook;
+    asok_hook = nullptr;
+  }
+  reset_kv_profile();
+
   // stop compaction thread
   compact_queue_lock.lock();
   if (compact_thread.is_started()) {
@@ -1642,6 +1942,9 @@ void RocksDBStore::RocksDBTransactionImpl::set(
   const string &k,
   const bufferlist &to_set_bl)
 {
+  if (db->kv_profile_sample()) {
+    db->kv_profile_note(prefix, KV_PROFILE_SET, k.size(), to_set_bl.length());
+  }
   auto cf = db->get_cf_handle(prefix, k);
   if (cf) {
     put_bat(bat, cf, k, to_set_bl);
@@ -1656,6 +1959,9 @@ void RocksDBStore::RocksDBTransactionImpl::set(
   const char *k, size_t keylen,
   const bufferlist &to_set_bl)
 {
+  if (db->kv_profile_sample()) {
+    db->kv_profile_note(prefix, KV_PROFILE_SET, keylen, to_set_bl.length());
+  }
   auto cf = db->get_cf_handle(prefix, k, keylen);
   if (cf) {
     string key(k, keylen);  // fixme?
@@ -1670,6 +1976,9 @@ void RocksDBStore::RocksDBTransactionImpl::set(
 void RocksDBStore::RocksDBTransactionImpl::rmkey(const string &prefix,
 					         const string &k)
 {
+  if (db->kv_profile_sample()) {
+    db->kv_profile_note(prefix, KV_PROFILE_RM, k.size(), 0);
+  }
   auto cf = db->get_cf_handle(prefix, k);
   if (cf) {
     bat.Delete(cf, rocksdb::Slice(k));
@@ -1682,6 +1991,9 @@ void RocksDBStore::RocksDBTransactionImpl::rmkey(const string &prefix,
 					         const char *k,
 						 size_t keylen)
 {
+  if (db->kv_profile_sample()) {
+    db->kv_profile_note(prefix, KV_PROFILE_RM, keylen, 0);
+  }
   auto cf = db->get_cf_handle(prefix, k, keylen);
   if (cf) {
     bat.Delete(cf, rocksdb::Slice(k, keylen));
@@ -1695,6 +2007,9 @@ void RocksDBStore::RocksDBTransactionImpl::rmkey(const string &prefix,
 void RocksDBStore::RocksDBTransactionImpl::rm_single_key(const string &prefix,
 					                 const string &k)
 {
+  if (db->kv_profile_sample()) {
+    db->kv_profile_note(prefix, KV_PROFILE_RM, k.size(), 0);
+  }
   auto cf = db->get_cf_handle(prefix, k);
   if (cf) {
     bat.SingleDelete(cf, k);
@@ -1818,6 +2133,9 @@ void RocksDBStore::RocksDBTransactionImpl::merge(
   const string &k,
   const bufferlist &to_set_bl)
 {
+  if (db->kv_profile_sample()) {
+    db->kv_profile_note(prefix, KV_PROFILE_MERGE, k.size(), to_set_bl.length());
+  }
   auto cf = db->get_cf_handle(prefix, k);
   if (cf) {
     // bufferlist::c_str() is non-constant, so we can't call c_str()
@@ -1858,39 +2176,75 @@ int RocksDBStore::get(
     const std::set<string> &keys,
     std::map<string, bufferlist> *out)
 {
-  rocksdb::PinnableSlice value;
+  std::vector<string> kv(keys.begin(), keys.end());
+  std::vector<bufferlist> values;
+  std::vector<int> rvals;
+  get_batch(prefix, kv, &values, &rvals);
+  for (size_t i = 0; i < kv.size(); ++i) {
+    if (rvals[i] == 0) {
+      (*out)[kv[i]] = std::move(values[i]);
+    }
+  }
+  return 0;
+}
+
+int RocksDBStore::get_batch(
+    const string &prefix,
+    const std::vector<string> &keys,
+    std::vector<bufferlist> *values,
+    std::vector<int> *rvals)
+{
+  const size_t n = keys.size();
+  values->clear();
+  values->resize(n);
+  rvals->assign(n, -ENOENT);
+  if (n == 0) {
+    return 0;
+  }
   utime_t start = ceph_clock_now();
+  std::vector<rocksdb::ColumnFamilyHandle*> cfs(n);
+  std::vector<string> combined;
+  std::vector<rocksdb::Slice> slices;
+  slices.reserve(n);
   if (cf_handles.count(prefix) > 0) {
-    for (auto& key : keys) {
-      auto cf_handle = get_cf_handle(prefix, key);
-      auto status = db->Get(rocksdb::ReadOptions(),
-			    cf_handle,
-			    rocksdb::Slice(key),
-			    &value);
-      if (status.ok()) {
-	(*out)[key].append(value.data(), value.size());
-      } else if (status.IsIOError()) {
-	ceph_abort_msg(status.getState());
-      }
-      value.Reset();
+    for (size_t i = 0; i < n; ++i) {
+      cfs[i] = get_cf_handle(prefix, keys[i]);
+      slices.emplace_back(keys[i]);
     }
   } else {
-    for (auto& key : keys) {
-      string k = combine_strings(prefix, key);
-      auto status = db->Get(rocksdb::ReadOptions(),
-			    default_cf,
-			    rocksdb::Slice(k),
-			    &value);
-      if (status.ok()) {
-	(*out)[key].append(value.data(), value.size());
-      } else if (status.IsIOError()) {
-	ceph_abort_msg(status.getState());
-      }
-      value.Reset();
+    // reserved up front so that the slices stay valid
+    combined.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+      cfs[i] = default_cf;
+      combined.push_back(combine_strings(prefix, keys[i]));
+      slices.emplace_back(combined.back());
+    }
+  }
+  std::vector<rocksdb::PinnableSlice> pvalues(n);
+  std::vector<rocksdb::Status> statuses(n);
+  // lets rocksdb coalesce the index/filter/data block reads of the batch
+  db->MultiGet(rocksdb::ReadOptions(), n, cfs.data(), slices.data(),
+	       pvalues.data(), statuses.data());
+  for (size_t i = 0; i < n; ++i) {
+    if (statuses[i].ok()) {
+      (*values)[i].append(pvalues[i].data(), pvalues[i].size());
+      (*rvals)[i] = 0;
+    } else if (!statuses[i].IsNotFound()) {
+      ceph_abort_msg(statuses[i].getState());
     }
   }
   utime_t lat = ceph_clock_now() - start;
+  logger->inc(l_rocksdb_get_batch_keys, n);
   logger->tinc(l_rocksdb_get_latency, lat);
+  utime_t key_lat;
+  // the batch shares one latency; charge each key its share
+  key_lat.set_from_double((double)lat / n);
+  for (size_t i = 0; i < n; ++i) {
+    if (kv_profile_sample()) {
+      kv_profile_note(prefix, KV_PROFILE_GET, keys[i].size(),
+		      (*values)[i].length(), (*rvals)[i] < 0, key_lat);
+    }
+  }
   return 0;
 }
 
@@ -1926,6 +2280,10 @@ int RocksDBStore::get(
   }
   utime_t lat = ceph_clock_now() - start;
   logger->tinc(l_rocksdb_get_latency, lat);
+  if (kv_profile_sample()) {
+    kv_profile_note(prefix, KV_PROFILE_GET, key.size(), out->length(),
+		    r < 0, lat);
+  }
   return r;
 }
 
@@ -1963,6 +2321,10 @@ int RocksDBStore::get(
   }
   utime_t lat = ceph_clock_now() - start;
   logger->tinc(l_rocksdb_get_latency, lat);
+  if (kv_profile_sample()) {
+    kv_profile_note(prefix, KV_PROFILE_GET, keylen, out->length(),
+		    r < 0, lat);
+  }
   return r;
 }
 
@@ -6,6 +6,9 @@
 #include "include/types.h"
 #include "include/buffer_fwd.h"
 #include "KeyValueDB.h"
+#include "KeyValueHistogram.h"
+#include <array>
+#include <atomic>
 #include <set>
 #include <map>
 #include <string>
@@ -26,12 +29,14 @@
 #include "common/Formatter.h"
 #include "common/Cond.h"
 #include "common/ceph_context.h"
+#include "common/config_obs.h"
 #include "common/PriorityCache.h"
 #include "common/pretty_binary.h"
 
 enum {
   l_rocksdb_first = 34300,
   l_rocksdb_get_latency,
+  l_rocksdb_get_batch_keys,
   l_rocksdb_submit_latency,
   l_rocksdb_submit_sync_latency,
   l_rocksdb_compact,
@@ -45,6 +50,20 @@ enum {
   l_rocksdb_last,
 };
 
+// per prefix counters of the sampled KV access profile
+enum {
+  l_rocksdb_kvp_first = 34350,
+  l_rocksdb_kvp_get,
+  l_rocksdb_kvp_get_miss,
+  l_rocksdb_kvp_set,
+  l_rocksdb_kvp_rm,
+  l_rocksdb_kvp_merge,
+  l_rocksdb_kvp_key_bytes,
+  l_rocksdb_kvp_value_bytes,
+  l_rocksdb_kvp_get_lat,
+  l_rocksdb_kvp_last,
+};
+
 namespace rocksdb{
   class DB;
   class Env;
@@ -75,7 +94,8 @@ inline rocksdb::Slice make_slice(const std::optional<std::string>& bound) {
 /**
  * Uses RocksDB to implement the KeyValueDB interface
  */
-class RocksDBStore : public KeyValueDB {
+class RocksDBStore : public KeyValueDB,
+		     public md_config_obs_t {
   CephContext *cct;
   PerfCounters *logger;
   std::string path;
@@ -162,7 +182,8 @@ private:
 		      std::vector<std::pair<size_t, RocksDBStore::ColumnFamily> >& existing_cfs_shard,
 		      std::vector<rocksdb::ColumnFamilyDescriptor>& missing_cfs,
 		      std::vector<std::pair<size_t, RocksDBStore::ColumnFamily> >& missing_cfs_shard);
-  std::shared_ptr<rocksdb::Cache> create_block_cache(const std::string& cache_type, size_t cache_size, double cache_prio_high = 0.0);
+  std::shared_ptr<rocksdb::Cache> create_block_cache(const std::string& cache_type, size_t cache_size, double cache_prio_high = 0.0,
+						     const std::string& cache_name = "default");
   int split_column_family_options(const std::string& opts_str,
 				  std::unordered_map<std::string, std::string>* column_opts_map,
 				  std::string* block_cache_opt);
@@ -172,6 +193,40 @@ private:
   int update_column_family_options(const std::string& base_name,
 				   const std::string& more_options,
 				   rocksdb::ColumnFamilyOptions* cf_opt);
+  /// layer rocksdb_cf_options_override for base_name over cf_opt
+  void apply_cf_options_override_at_open(const std::string& base_name,
+					 rocksdb::ColumnFamilyOptions* cf_opt);
+  bool conf_observer_registered = false;
+
+  /// sampled per-prefix access profile, see rocksdb_kv_profile_sample_rate
+  enum kv_profile_op_t {
+    KV_PROFILE_GET,
+    KV_PROFILE_SET,
+    KV_PROFILE_RM,
+    KV_PROFILE_MERGE,
+  };
+  struct kv_profile_t {
+    PerfCounters *logger = nullptr;
+    uint64_t gets = 0;
+    uint64_t get_misses = 0;
+    uint64_t sets = 0;
+    uint64_t rms = 0;
+    uint64_t merges = 0;
+    uint64_t key_bytes = 0;
+    uint64_t value_bytes = 0;
+    std::array<uint64_t, 24> get_lat_hist = {};  ///< log2 buckets of usec
+  };
+  std::atomic<uint64_t> kv_profile_rate = {0};
+  ceph::mutex kv_profile_lock = ceph::make_mutex("RocksDBStore::kv_profile_lock");
+  std::map<std::string, kv_profile_t> kv_profile;  ///< protected by kv_profile_lock
+  KeyValueHistogram kv_profile_hist;               ///< protected by kv_profile_lock
+  class SocketHook;
+  SocketHook *asok_hook = nullptr;
+
+  bool kv_profile_sample() const;
+  void kv_profile_note(const std::string& prefix, kv_profile_op_t op,
+		       size_t key_len, size_t value_len,
+		       bool miss = false, utime_t lat = utime_t());
   // manage async compactions
   ceph::mutex compact_queue_lock =
     ceph::make_mutex("RocksDBStore::compact_thread_lock");
@@ -350,6 +405,11 @@ public:
     const char *key,
     size_t keylen,
     ceph::bufferlist *out) override;
+  int get_batch(
+    const std::string &prefix,
+    const std::vector<std::string> &keys,
+    std::vector<ceph::bufferlist> *values,
+    std::vector<int> *rvals) override;
 
 
   class RocksDBWholeSpaceIteratorImpl :
@@ -544,6 +604,16 @@ public:
     bool   unittest_fail_after_successful_processing = false;
   };
   int reshard(const std::string& new_sharding, const resharding_ctrl* ctrl = nullptr);
+
+  /// change options of open column families, see rocksdb_cf_options_override
+  int apply_cf_options_override(const std::string& spec);
+
+  void dump_kv_profile(ceph::Formatter *f);
+  void reset_kv_profile();
+
+  const char** get_tracked_conf_keys() const override;
+  void handle_conf_change(const ConfigProxy& conf,
+			  const std::set<std::string>& changed) override;
   bool get_sharding(std::string& sharding);
 
 };
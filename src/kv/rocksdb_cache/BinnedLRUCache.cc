@@ -15,8 +15,11 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <iterator>
 #include <string>
 
+#include "common/perf_counters_key.h"
+
 #define dout_context cct
 #define dout_subsys ceph_subsys_rocksdb
 #undef dout_prefix
@@ -102,21 +105,29 @@ void BinnedLRUHandleTable::Resize() {
 }
 
 BinnedLRUCacheShard::BinnedLRUCacheShard(CephContext *c, size_t capacity, bool strict_capacity_limit,
-                             double high_pri_pool_ratio)
+                             double high_pri_pool_ratio, double probation_ratio)
     : cct(c),
       capacity_(0),
       high_pri_pool_usage_(0),
       strict_capacity_limit_(strict_capacity_limit),
       high_pri_pool_ratio_(high_pri_pool_ratio),
       high_pri_pool_capacity_(0),
+      probation_ratio_(probation_ratio),
+      probation_usage_(0),
       usage_(0),
       lru_usage_(0),
-      age_bins(1) {
+      age_bins(1),
+      bin_seq_(0),
+      high_pri_hits_(0),
+      probation_hits_(0),
+      misses_(0),
+      bin_hits_(2, 0) {
   shift_bins();
   // Make empty circular linked list
   lru_.next = &lru_;
   lru_.prev = &lru_;
   lru_low_pri_ = &lru_;
+  lru_probation_ = &lru_;
   SetCapacity(capacity);
 }
 
@@ -203,6 +214,9 @@ void BinnedLRUCacheShard::LRU_Remove(BinnedLRUHandle* e) {
   if (lru_low_pri_ == e) {
     lru_low_pri_ = e->prev;
   }
+  if (lru_probation_ == e) {
+    lru_probation_ = e->prev;
+  }
   e->next->prev = e->prev;
   e->prev->next = e->next;
   e->prev = e->next = nullptr;
@@ -213,6 +227,10 @@ void BinnedLRUCacheShard::LRU_Remove(BinnedLRUHandle* e) {
   } else {
     ceph_assert(*(e->age_bin) >= e->charge);
     *(e->age_bin) -= e->charge;
+    if (e->InProbation()) {
+      ceph_assert(probation_usage_ >= e->charge);
+      probation_usage_ -= e->charge;
+    }
   }
 }
 
@@ -220,6 +238,7 @@ void BinnedLRUCacheShard::LRU_Insert(BinnedLRUHandle* e) {
   ceph_assert(e->next == nullptr);
   ceph_assert(e->prev == nullptr);
   e->age_bin = age_bins.front();
+  e->age_seq = bin_seq_;
 
   if (high_pri_pool_ratio_ > 0 && e->IsHighPri()) {
     // Inset "e" to head of LRU list.
@@ -228,8 +247,24 @@ void BinnedLRUCacheShard::LRU_Insert(BinnedLRUHandle* e) {
     e->prev->next = e;
     e->next->prev = e;
     e->SetInHighPriPool(true);
+    e->SetInProbation(false);
     high_pri_pool_usage_ += e->charge;
     MaintainPoolSize();
+  } else if (probation_ratio_ > 0 && !e->HasHit()) {
+    // Not hit since it was inserted: insert "e" to the head of the
+    // probation segment.
+    e->next = lru_probation_->next;
+    e->prev = lru_probation_;
+    e->prev->next = e;
+    e->next->prev = e;
+    e->SetInHighPriPool(false);
+    e->SetInProbation(true);
+    if (lru_low_pri_ == lru_probation_) {
+      lru_low_pri_ = e;
+    }
+    lru_probation_ = e;
+    probation_usage_ += e->charge;
+    *(e->age_bin) += e->charge;
   } else {
     // Insert "e" to the head of low-pri pool. Note that when
     // high_pri_pool_ratio is 0, head of low-pri pool is also head of LRU list.
@@ -238,10 +273,12 @@ void BinnedLRUCacheShard::LRU_Insert(BinnedLRUHandle* e) {
     e->prev->next = e;
     e->next->prev = e;
     e->SetInHighPriPool(false);
+    e->SetInProbation(false);
     lru_low_pri_ = e;
     *(e->age_bin) += e->charge;
   }
   lru_usage_ += e->charge;
+  MaintainProbationSize();
 }
 
 uint64_t BinnedLRUCacheShard::sum_bins(uint32_t start, uint32_t end) const {
@@ -269,6 +306,23 @@ void BinnedLRUCacheShard::MaintainPoolSize() {
   }
 }
 
+void BinnedLRUCacheShard::MaintainProbationSize() {
+  if (probation_ratio_ <= 0) {
+    return;
+  }
+  double low_pri_capacity = capacity_ - high_pri_pool_capacity_;
+  double protected_capacity = low_pri_capacity * (1.0 - probation_ratio_);
+  while (lru_usage_ - high_pri_pool_usage_ - probation_usage_ >
+         protected_capacity) {
+    // Demote the last protected entry to the probation segment.
+    lru_probation_ = lru_probation_->next;
+    ceph_assert(lru_probation_ != &lru_);
+    ceph_assert(!lru_probation_->InHighPriPool());
+    lru_probation_->SetInProbation(true);
+    probation_usage_ += lru_probation_->charge;
+  }
+}
+
 void BinnedLRUCacheShard::EvictFromLRU(size_t charge,
                                  ceph::autovector<BinnedLRUHandle*>* deleted) {
   while (usage_ + charge > capacity_ && lru_.next != &lru_) {
@@ -291,6 +345,7 @@ void BinnedLRUCacheShard::SetCapacity(size_t capacity) {
     capacity_ = capacity;
     high_pri_pool_capacity_ = capacity_ * high_pri_pool_ratio_;
     EvictFromLRU(0, &last_reference_list);
+    MaintainProbationSize();
   }
   // we free the entries here outside of mutex for
   // performance reasons
@@ -309,11 +364,22 @@ rocksdb::Cache::Handle* BinnedLRUCacheShard::Lookup(const rocksdb::Slice& key, u
   BinnedLRUHandle* e = table_.Lookup(key, hash);
   if (e != nullptr) {
     ceph_assert(e->InCache());
+    if (e->InHighPriPool()) {
+      high_pri_hits_++;
+    } else {
+      uint64_t age = bin_seq_ - e->age_seq;
+      bin_hits_[std::min<uint64_t>(age, bin_hits_.size() - 1)]++;
+      if (e->refs == 1 && e->InProbation()) {
+        probation_hits_++;
+      }
+    }
     if (e->refs == 1) {
       LRU_Remove(e);
     }
     e->refs++;
     e->SetHit();
+  } else {
+    misses_++;
   }
   return reinterpret_cast<rocksdb::Cache::Handle*>(e);
 }
@@ -333,6 +399,7 @@ void BinnedLRUCacheShard::SetHighPriPoolRatio(double high_pri_pool_ratio) {
   high_pri_pool_ratio_ = high_pri_pool_ratio;
   high_pri_pool_capacity_ = capacity_ * high_pri_pool_ratio_;
   MaintainPoolSize();
+  MaintainProbationSize();
 }
 
 bool BinnedLRUCacheShard::Release(rocksdb::Cache::Handle* handle, bool force_erase) {
@@ -392,6 +459,7 @@ rocksdb::Status BinnedLRUCacheShard::Insert(const rocksdb::Slice& key, uint32_t
                  ? 1
                  : 2);  // One from BinnedLRUCache, one for the returned handle
   e->next = e->prev = nullptr;
+  e->age_seq = 0;
   e->SetInCache(true);
   e->SetPriority(priority);
   std::copy_n(key.data(), e->key_length, e->key_data);
@@ -419,6 +487,7 @@ rocksdb::Status BinnedLRUCacheShard::Insert(const rocksdb::Slice& key, uint32_t
       // space was freed
       BinnedLRUHandle* old = table_.Insert(e);
       usage_ += e->charge;
+      e->age_seq = bin_seq_;
       if (old != nullptr) {
         old->SetInCache(false);
         if (Unref(old)) {
@@ -486,6 +555,7 @@ size_t BinnedLRUCacheShard::GetPinnedUsage() const {
 void BinnedLRUCacheShard::shift_bins() {
   std::lock_guard<std::mutex> l(mutex_);
   age_bins.push_front(std::make_shared<uint64_t>(0));
+  bin_seq_++;
 }
 
 uint32_t BinnedLRUCacheShard::get_bin_count() const {
@@ -496,6 +566,24 @@ uint32_t BinnedLRUCacheShard::get_bin_count() const {
 void BinnedLRUCacheShard::set_bin_count(uint32_t count) {
   std::lock_guard<std::mutex> l(mutex_);
   age_bins.set_capacity(count);
+  // one slot per bin, plus one for hits on entries older than all bins
+  bin_hits_.resize(std::max<uint32_t>(count, 1) + 1, 0);
+}
+
+void BinnedLRUCacheShard::add_hit_stats(uint64_t* high_pri_hits,
+                                        std::vector<uint64_t>* bin_hits,
+                                        uint64_t* probation_hits,
+                                        uint64_t* misses) const {
+  std::lock_guard<std::mutex> l(mutex_);
+  *high_pri_hits += high_pri_hits_;
+  *probation_hits += probation_hits_;
+  *misses += misses_;
+  if (bin_hits->size() < bin_hits_.size()) {
+    bin_hits->resize(bin_hits_.size(), 0);
+  }
+  for (size_t i = 0; i < bin_hits_.size(); i++) {
+    (*bin_hits)[i] += bin_hits_[i];
+  }
 }
 
 std::string BinnedLRUCacheShard::GetPrintableOptions() const {
@@ -503,8 +591,10 @@ std::string BinnedLRUCacheShard::GetPrintableOptions() const {
   char buffer[kBufferSize];
   {
     std::lock_guard<std::mutex> l(mutex_);
-    snprintf(buffer, kBufferSize, "    high_pri_pool_ratio: %.3lf\n",
-             high_pri_pool_ratio_);
+    snprintf(buffer, kBufferSize,
+             "    high_pri_pool_ratio: %.3lf\n"
+             "    probation_ratio: %.3lf\n",
+             high_pri_pool_ratio_, probation_ratio_);
   }
   return std::string(buffer);
 }
@@ -519,7 +609,9 @@ BinnedLRUCache::BinnedLRUCache(CephContext *c,
                                size_t capacity, 
                                int num_shard_bits,
                                bool strict_capacity_limit, 
-                               double high_pri_pool_ratio)
+                               double high_pri_pool_ratio,
+                               double probation_ratio,
+                               const std::string& name)
     : ShardedCache(capacity, num_shard_bits, strict_capacity_limit), cct(c) {
   num_shards_ = 1 << num_shard_bits;
   // TODO: Switch over to use mempool
@@ -532,11 +624,39 @@ BinnedLRUCache::BinnedLRUCache(CephContext *c,
   size_t per_shard = (capacity + (num_shards_ - 1)) / num_shards_;
   for (int i = 0; i < num_shards_; i++) {
     new (&shards_[i])
-        BinnedLRUCacheShard(c, per_shard, strict_capacity_limit, high_pri_pool_ratio);
+        BinnedLRUCacheShard(c, per_shard, strict_capacity_limit,
+                            high_pri_pool_ratio, probation_ratio);
+  }
+
+  if (cct) {
+    static const char* hit_names[] = {
+      "hit_pri0", "hit_pri1", "hit_pri2", "hit_pri3", "hit_pri4", "hit_pri5",
+      "hit_pri6", "hit_pri7", "hit_pri8", "hit_pri9", "hit_pri10", "hit_pri11",
+    };
+    static_assert(std::size(hit_names) == PriorityCache::Priority::LAST + 1);
+    // one set per cache, there is one for each column family with a
+    // block cache of its own
+    PerfCountersBuilder b(
+      cct,
+      ceph::perf_counters::key_create("rocksdb_binned_lru", {{"cache", name}}),
+      l_binned_lru_first, l_binned_lru_last);
+    b.add_u64_counter(l_binned_lru_miss, "miss", "Lookups that missed");
+    b.add_u64_counter(l_binned_lru_hit_probation, "hit_probation",
+                      "Hits on entries in the probation segment");
+    for (int i = 0; i <= PriorityCache::Priority::LAST; i++) {
+      b.add_u64_counter(l_binned_lru_hit_pri0 + i, hit_names[i],
+                        "Hits on entries held at this cache priority");
+    }
+    logger = b.create_perf_counters();
+    cct->get_perfcounters_collection()->add(logger);
   }
 }
 
 BinnedLRUCache::~BinnedLRUCache() {
+  if (logger) {
+    cct->get_perfcounters_collection()->remove(logger);
+    delete logger;
+  }
   for (int i = 0; i < num_shards_; i++) {
     shards_[i].~BinnedLRUCacheShard();
   }
@@ -672,6 +792,48 @@ void BinnedLRUCache::shift_bins() {
   for (int s = 0; s < num_shards_; s++) {
     shards_[s].shift_bins();
   }
+  update_perf_counters();
+}
+
+void BinnedLRUCache::get_hit_stats(std::vector<uint64_t>* pri_hits,
+                                   uint64_t* probation_hits,
+                                   uint64_t* misses) const {
+  uint64_t high_pri_hits = 0;
+  std::vector<uint64_t> bin_hits;
+  *probation_hits = 0;
+  *misses = 0;
+  for (int s = 0; s < num_shards_; s++) {
+    shards_[s].add_hit_stats(&high_pri_hits, &bin_hits, probation_hits, misses);
+  }
+  // map age bins to priorities the same way request_cache_bytes() does
+  pri_hits->assign(PriorityCache::Priority::LAST + 1, 0);
+  (*pri_hits)[PriorityCache::Priority::PRI0] = high_pri_hits;
+  for (uint64_t bin = 0; bin < bin_hits.size(); bin++) {
+    int pri = PriorityCache::Priority::LAST;
+    for (int p = 1; p < PriorityCache::Priority::LAST; p++) {
+      auto prev = static_cast<PriorityCache::Priority>(p - 1);
+      if (bin >= get_bins(prev) &&
+          bin < get_bins(static_cast<PriorityCache::Priority>(p))) {
+        pri = p;
+        break;
+      }
+    }
+    (*pri_hits)[pri] += bin_hits[bin];
+  }
+}
+
+void BinnedLRUCache::update_perf_counters() {
+  if (!logger) {
+    return;
+  }
+  std::vector<uint64_t> pri_hits;
+  uint64_t probation_hits, misses;
+  get_hit_stats(&pri_hits, &probation_hits, &misses);
+  logger->set(l_binned_lru_miss, misses);
+  logger->set(l_binned_lru_hit_probation, probation_hits);
+  for (size_t i = 0; i < pri_hits.size(); i++) {
+    logger->set(l_binned_lru_hit_pri0 + i, pri_hits[i]);
+  }
 }
 
 uint64_t BinnedLRUCache::sum_bins(uint32_t start, uint32_t end) const {
@@ -701,7 +863,9 @@ std::shared_ptr<rocksdb::Cache> NewBinnedLRUCache(
     size_t capacity,
     int num_shard_bits,
     bool strict_capacity_limit,
-    double high_pri_pool_ratio) {
+    double high_pri_pool_ratio,
+    double probation_ratio,
+    const std::string& name) {
   if (num_shard_bits >= 20) {
     return nullptr;  // the cache cannot be sharded into too many fine pieces
   }
@@ -709,11 +873,15 @@ std::shared_ptr<rocksdb::Cache> NewBinnedLRUCache(
     // invalid high_pri_pool_ratio
     return nullptr;
   }
+  if (probation_ratio < 0.0 || probation_ratio >= 1.0) {
+    return nullptr;
+  }
   if (num_shard_bits < 0) {
     num_shard_bits = GetDefaultCacheShardBits(capacity);
   }
   return std::make_shared<BinnedLRUCache>(
-      c, capacity, num_shard_bits, strict_capacity_limit, high_pri_pool_ratio);
+      c, capacity, num_shard_bits, strict_capacity_limit, high_pri_pool_ratio,
+      probation_ratio, name);
 }
 
 }  // namespace rocksdb_cache
@@ -12,6 +12,7 @@
 
 #include <string>
 #include <mutex>
+#include <vector>
 #include <boost/circular_buffer.hpp>
 
 #include "ShardedCache.h"
@@ -20,6 +21,15 @@
 #include "include/ceph_assert.h"
 #include "common/ceph_context.h"
 
+enum {
+  l_binned_lru_first = 34400,
+  l_binned_lru_miss,
+  l_binned_lru_hit_probation,
+  l_binned_lru_hit_pri0,
+  l_binned_lru_hit_last = l_binned_lru_hit_pri0 + PriorityCache::Priority::LAST,
+  l_binned_lru_last,
+};
+
 namespace rocksdb_cache {
 
 // LRU cache implementation
@@ -47,13 +57,22 @@ namespace rocksdb_cache {
 // that any successful BinnedLRUCacheShard::Lookup/BinnedLRUCacheShard::Insert have a
 // matching
 // RUCache::Release (to move into state 2) or BinnedLRUCacheShard::Erase (for state 3)
+//
+// With a probation ratio > 0 the low-pri pool is segmented: entries that
+// have not been hit since they were inserted go to a probation segment at
+// the cold end of the LRU, and only entries that were hit again make it to
+// the protected part.  The protected part is kept to (1 - probation ratio)
+// of the low-pri pool, its coldest entries are demoted back to probation.
+// A one-pass scan thus only churns the probation segment.
 
 std::shared_ptr<rocksdb::Cache> NewBinnedLRUCache(
     CephContext *c,
     size_t capacity,
     int num_shard_bits = -1,
     bool strict_capacity_limit = false,
-    double high_pri_pool_ratio = 0.0);
+    double high_pri_pool_ratio = 0.0,
+    double probation_ratio = 0.0,
+    const std::string& name = "default");
 
 struct BinnedLRUHandle {
   std::shared_ptr<uint64_t> age_bin;
@@ -66,11 +85,14 @@ struct BinnedLRUHandle {
   size_t key_length;
   uint32_t refs;     // a number of refs to this entry
                      // cache itself is counted as 1
+  uint64_t age_seq;  // shard bin sequence of age_bin
 
   // Include the following flags:
   //   in_cache:    whether this entry is referenced by the hash table.
   //   is_high_pri: whether this entry is high priority entry.
   //   in_high_pri_pool: whether this entry is in high-pri pool.
+  //   has_hit:     whether this entry was looked up since insertion.
+  //   in_probation: whether this entry is in the probation segment.
   char flags;
 
   uint32_t hash;     // Hash of key(); used for fast sharding and comparisons
@@ -91,6 +113,7 @@ struct BinnedLRUHandle {
   bool IsHighPri() { return flags & 2; }
   bool InHighPriPool() { return flags & 4; }
   bool HasHit() { return flags & 8; }
+  bool InProbation() { return flags & 16; }
 
   void SetInCache(bool in_cache) {
     if (in_cache) {
@@ -118,6 +141,14 @@ struct BinnedLRUHandle {
 
   void SetHit() { flags |= 8; }
 
+  void SetInProbation(bool in_probation) {
+    if (in_probation) {
+      flags |= 16;
+    } else {
+      flags &= ~16;
+    }
+  }
+
   void Free() {
     ceph_assert((refs == 1 && InCache()) || (refs == 0 && !InCache()));
     if (deleter) {
@@ -174,7 +205,7 @@ class BinnedLRUHandleTable {
 class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
  public:
   BinnedLRUCacheShard(CephContext *c, size_t capacity, bool strict_capacity_limit,
-                double high_pri_pool_ratio);
+                double high_pri_pool_ratio, double probation_ratio);
   virtual ~BinnedLRUCacheShard();
 
   // Separate from constructor so caller can easily make an array of BinnedLRUCache
@@ -244,6 +275,13 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
   // Get the byte counts for a range of age bins
   uint64_t sum_bins(uint32_t start, uint32_t end) const;
 
+  // Add this shard's lookup stats.  bin_hits is indexed by the age bin
+  // the entry was in; its last slot collects entries older than all bins.
+  void add_hit_stats(uint64_t* high_pri_hits,
+                     std::vector<uint64_t>* bin_hits,
+                     uint64_t* probation_hits,
+                     uint64_t* misses) const;
+
  private:
   CephContext *cct;
   void LRU_Remove(BinnedLRUHandle* e);
@@ -253,6 +291,10 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
   // high-pri pool is no larger than the size specify by high_pri_pool_pct.
   void MaintainPoolSize();
 
+  // Demote the coldest protected entries to the probation segment until the
+  // protected part of the low-pri pool fits its share.
+  void MaintainProbationSize();
+
   // Just reduce the reference count by 1.
   // Return true if last reference
   bool Unref(BinnedLRUHandle* e);
@@ -279,6 +321,12 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
   // Remember the value to avoid recomputing each time.
   double high_pri_pool_capacity_;
 
+  // Share of the low-pri pool for the probation segment; 0 disables it.
+  double probation_ratio_;
+
+  // Memory size for entries in the probation segment.
+  size_t probation_usage_;
+
   // Dummy head of LRU list.
   // lru.prev is newest entry, lru.next is oldest entry.
   // LRU contains items which can be evicted, ie reference only by cache
@@ -287,6 +335,10 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
   // Pointer to head of low-pri pool in LRU list.
   BinnedLRUHandle* lru_low_pri_;
 
+  // Pointer to head of the probation segment, at the cold end of the
+  // low-pri pool.
+  BinnedLRUHandle* lru_probation_;
+
   // ------------^^^^^^^^^^^^^-----------
   // Not frequently modified data members
   // ------------------------------------
@@ -313,12 +365,22 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
 
   // Circular buffer of byte counters for age binning
   boost::circular_buffer<std::shared_ptr<uint64_t>> age_bins;
+
+  // Number of times the bins were shifted
+  uint64_t bin_seq_;
+
+  // Lookup stats
+  uint64_t high_pri_hits_;
+  uint64_t probation_hits_;
+  uint64_t misses_;
+  std::vector<uint64_t> bin_hits_;
 };
 
 class BinnedLRUCache : public ShardedCache {
  public:
   BinnedLRUCache(CephContext *c, size_t capacity, int num_shard_bits,
-      bool strict_capacity_limit, double high_pri_pool_ratio);
+      bool strict_capacity_limit, double high_pri_pool_ratio,
+      double probation_ratio = 0.0, const std::string& name = "default");
   virtual ~BinnedLRUCache();
   virtual const char* Name() const override { return "BinnedLRUCache"; }
   virtual CacheShard* GetShard(int shard) override;
@@ -351,6 +413,12 @@ class BinnedLRUCache : public ShardedCache {
   uint32_t get_bin_count() const;
   void set_bin_count(uint32_t count);
 
+  // Lookup hits by the priority the entry was held at, plus misses
+  void get_hit_stats(std::vector<uint64_t>* pri_hits,
+                     uint64_t* probation_hits,
+                     uint64_t* misses) const;
+  void update_perf_counters();
+
   virtual std::string get_cache_name() const {
     return "RocksDB Binned LRU Cache";
   }
@@ -359,6 +427,7 @@ class BinnedLRUCache : public ShardedCache {
   CephContext *cct;
   BinnedLRUCacheShard* shards_;
   int num_shards_ = 0;
+  PerfCounters* logger = nullptr;
 };
 
 }  // namespace rocksdb_cache
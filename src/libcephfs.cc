@@ -12,6 +12,7 @@
  *
  */
 
+#include <deque>
 #include <fcntl.h>
 #include <iostream>
 #include <string.h>
@@ -2019,19 +2020,37 @@ extern "C" int64_t ceph_ll_writev(class ceph_mount_info *cmount,
   return (cmount->get_client()->ll_writev(fh, iov, iovcnt, off));
 }
 
+struct ceph_ll_io_queue {
+  ceph::mutex lock = ceph::make_mutex("ceph_ll_io_queue::lock");
+  ceph::condition_variable cond;
+  std::deque<struct ceph_ll_io_info*> completed;
+  uint64_t in_flight = 0;
+
+  void complete(struct ceph_ll_io_info *io_info) {
+    std::lock_guard l(lock);
+    completed.push_back(io_info);
+    cond.notify_all();
+  }
+};
+
 class LL_Onfinish : public Context {
 public:
-  LL_Onfinish(struct ceph_ll_io_info *io_info)
-    : io_info(io_info) {}
+  LL_Onfinish(struct ceph_ll_io_info *io_info,
+              struct ceph_ll_io_queue *queue = nullptr)
+    : io_info(io_info), queue(queue) {}
   bufferlist bl;
 private:
   struct ceph_ll_io_info *io_info;
+  struct ceph_ll_io_queue *queue;
   void finish(int r) override {
     if (!io_info->write && r > 0) {
       copy_bufferlist_to_iovec(io_info->iov, io_info->iovcnt, &bl, r);
     }
     io_info->result = r;
-    io_info->callback(io_info);
+    if (queue)
+      queue->complete(io_info);
+    else
+      io_info->callback(io_info);
   }
 };
 
@@ -2046,6 +2065,76 @@ extern "C" int64_t ceph_ll_nonblocking_readv_writev(class ceph_mount_info *cmoun
 			io_info->fsync, io_info->syncdataonly));
 }
 
+extern "C" int ceph_ll_io_queue_create(class ceph_mount_info *cmount,
+				       struct ceph_ll_io_queue **queue)
+{
+  *queue = new ceph_ll_io_queue;
+  return 0;
+}
+
+extern "C" int ceph_ll_io_queue_destroy(class ceph_mount_info *cmount,
+					struct ceph_ll_io_queue *queue)
+{
+  {
+    std::lock_guard l(queue->lock);
+    if (queue->in_flight)
+      return -CEPHFS_EBUSY;
+  }
+  delete queue;
+  return 0;
+}
+
+extern "C" int ceph_ll_io_submit(class ceph_mount_info *cmount,
+				 struct ceph_ll_io_queue *queue,
+				 struct ceph_ll_io_info **ios, int nr)
+{
+  if (nr < 0)
+    return -CEPHFS_EINVAL;
+
+  {
+    std::lock_guard l(queue->lock);
+    queue->in_flight += nr;
+  }
+  // errors are reported through the queue, so every request is submitted
+  for (int i = 0; i < nr; i++) {
+    struct ceph_ll_io_info *io_info = ios[i];
+    LL_Onfinish *onfinish = new LL_Onfinish(io_info, queue);
+    cmount->get_client()->ll_preadv_pwritev(
+      io_info->fh, io_info->iov, io_info->iovcnt,
+      io_info->off, io_info->write, onfinish, &onfinish->bl,
+      io_info->fsync, io_info->syncdataonly);
+  }
+  return nr;
+}
+
+extern "C" int ceph_ll_io_getevents(class ceph_mount_info *cmount,
+				    struct ceph_ll_io_queue *queue,
+				    int min_nr, int max_nr,
+				    struct ceph_ll_io_info **events,
+				    int64_t timeout_ms)
+{
+  if (min_nr < 0 || max_nr < min_nr)
+    return -CEPHFS_EINVAL;
+
+  std::unique_lock l(queue->lock);
+  auto ready = [&] {
+    return queue->completed.size() >= (size_t)min_nr;
+  };
+  if (timeout_ms < 0) {
+    queue->cond.wait(l, ready);
+  } else {
+    queue->cond.wait_for(l, std::chrono::milliseconds(timeout_ms), ready);
+  }
+
+  int n = 0;
+  while (n < max_nr && !queue->completed.empty()) {
+    events[n++] = queue->completed.front();
+    queue->completed.pop_front();
+  }
+  queue->in_flight -= n;
+  return n;
+}
+
 extern "C" int ceph_ll_close(class ceph_mount_info *cmount, Fh* fh)
 {
   return (cmount->get_client()->ll_release(fh));
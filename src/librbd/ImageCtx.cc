@@ -289,6 +289,11 @@ librados::IoCtx duplicate_io_ctx(librados::IoCtx& io_ctx) {
     plb.add_u64_counter(l_librbd_readahead_bytes, "readahead_bytes", "Data size in read ahead", NULL, 0, unit_t(UNIT_BYTES));
     plb.add_u64_counter(l_librbd_invalidate_cache, "invalidate_cache", "Cache invalidates");
 
+    plb.add_u64_counter(l_librbd_encrypt_bytes, "encrypt_bytes", "Data size encrypted", NULL, 0, unit_t(UNIT_BYTES));
+    plb.add_time_avg(l_librbd_encrypt_latency, "encrypt_latency", "Latency of encryption");
+    plb.add_u64_counter(l_librbd_decrypt_bytes, "decrypt_bytes", "Data size decrypted", NULL, 0, unit_t(UNIT_BYTES));
+    plb.add_time_avg(l_librbd_decrypt_latency, "decrypt_latency", "Latency of decryption");
+
     plb.add_time(l_librbd_opened_time, "opened_time", "Opened time",
                  "ots", perf_prio);
     plb.add_time(l_librbd_lock_acquired_time, "lock_acquired_time",
@@ -1213,6 +1213,8 @@ void Journal<I>::create_journaler() {
     m_image_ctx.config.template get_val<Option::size_t>("rbd_journal_max_payload_bytes");
   settings.max_concurrent_object_sets =
     m_image_ctx.config.template get_val<uint64_t>("rbd_journal_max_concurrent_object_sets");
+  settings.append_latency_target =
+    m_image_ctx.config.template get_val<double>("rbd_journal_object_flush_latency_target");
   // TODO: a configurable filter to exclude certain peers from being
   // disconnected.
   settings.ignored_laggy_clients = {IMAGE_CLIENT_ID};
@@ -39,7 +39,9 @@ ObjectMap<I>::ObjectMap(I &image_ctx, uint64_t snap_id)
   : RefCountedObject(image_ctx.cct),
     m_image_ctx(image_ctx), m_snap_id(snap_id),
     m_lock(ceph::make_shared_mutex(util::unique_lock_name("librbd::ObjectMap::lock", this))),
-    m_update_guard(new UpdateGuard(m_image_ctx.cct)) {
+    m_update_guard(new UpdateGuard(m_image_ctx.cct)),
+    m_merge_sequential_updates(image_ctx.config.template get_val<bool>(
+      "rbd_object_map_merge_sequential_updates")) {
 }
 
 template <typename I>
@@ -267,6 +269,73 @@ void ObjectMap<I>::aio_resize(uint64_t new_size, uint8_t default_object_state,
   req->send();
 }
 
+template <typename I>
+void ObjectMap<I>::queue_aio_update(UpdateOperation &&op) {
+  CephContext *cct = m_image_ctx.cct;
+  ceph_assert(ceph_mutex_is_wlocked(m_lock));
+
+  if (m_pending_update) {
+    auto &pending = *m_pending_update;
+    if (op.start_object_no == pending.end_object_no &&
+        pending.same_transition(op.new_state, op.current_state,
+                                op.ignore_enoent)) {
+      ldout(cct, 20) << "merging into pending update: "
+                     << "start=" << pending.start_object_no << ", "
+                     << "end=" << op.end_object_no << dendl;
+      pending.end_object_no = op.end_object_no;
+      m_pending_update_ctxs.push_back(op.on_finish);
+      // the pending update carries a single tracked op for the batch
+      m_async_op_tracker.finish_op();
+      return;
+    }
+    if (op.start_object_no < pending.end_object_no &&
+        pending.start_object_no < op.end_object_no) {
+      // the held update isn't in the block guard yet; send it now so the
+      // guard orders this overlapping update behind it
+      ldout(cct, 20) << "flushing pending update: "
+                     << "start=" << pending.start_object_no << ", "
+                     << "end=" << pending.end_object_no << dendl;
+      send_pending_aio_update();
+    }
+  } else if (m_merge_sequential_updates && m_updates_in_flight > 0 &&
+             m_last_update &&
+             op.start_object_no == m_last_update->end_object_no &&
+             op.same_transition(m_last_update->new_state,
+                                m_last_update->current_state,
+                                m_last_update->ignore_enoent)) {
+    ldout(cct, 20) << "holding sequential update: "
+                   << "start=" << op.start_object_no << ", "
+                   << "end=" << op.end_object_no << dendl;
+    m_pending_update_ctxs.push_back(op.on_finish);
+    m_pending_update.emplace(std::move(op));
+    return;
+  }
+
+  detained_aio_update(std::move(op));
+}
+
+template <typename I>
+void ObjectMap<I>::send_pending_aio_update() {
+  ceph_assert(ceph_mutex_is_wlocked(m_lock));
+  ceph_assert(m_pending_update);
+
+  auto op = std::move(*m_pending_update);
+  m_pending_update = boost::none;
+
+  auto ctxs = std::move(m_pending_update_ctxs);
+  m_pending_update_ctxs.clear();
+  if (ctxs.size() == 1) {
+    op.on_finish = ctxs.front();
+  } else {
+    op.on_finish = new LambdaContext([ctxs=std::move(ctxs)](int r) {
+        for (auto ctx : ctxs) {
+          ctx->complete(r);
+        }
+      });
+  }
+  detained_aio_update(std::move(op));
+}
+
 template <typename I>
 void ObjectMap<I>::detained_aio_update(UpdateOperation &&op) {
   CephContext *cct = m_image_ctx.cct;
@@ -296,6 +365,9 @@ void ObjectMap<I>::detained_aio_update(UpdateOperation &&op) {
   }
 
   ldout(cct, 20) << "in-flight update cell: " << cell << dendl;
+  ++m_updates_in_flight;
+  m_last_update = LastUpdate{op.end_object_no, op.new_state, op.current_state,
+                             op.ignore_enoent};
   Context *on_finish = op.on_finish;
   Context *ctx = new LambdaContext([this, cell, on_finish](int r) {
       handle_detained_aio_update(cell, r, on_finish);
@@ -316,9 +388,14 @@ void ObjectMap<I>::handle_detained_aio_update(BlockGuardCell *cell, int r,
   {
     std::shared_lock image_locker{m_image_ctx.image_lock};
     std::unique_lock locker{m_lock};
+    ceph_assert(m_updates_in_flight > 0);
+    --m_updates_in_flight;
     for (auto &op : block_ops) {
       detained_aio_update(std::move(op));
     }
+    if (m_pending_update) {
+      send_pending_aio_update();
+    }
   }
 
   on_finish->complete(r);
@@ -114,7 +114,7 @@ public:
                                        ignore_enoent,
                                        util::create_context_callback<T, MF>(
                                          callback_object));
-      detained_aio_update(std::move(update_operation));
+      queue_aio_update(std::move(update_operation));
     } else {
       aio_update(snap_id, start_object_no, end_object_no, new_state,
                  current_state, parent_trace, ignore_enoent,
@@ -147,6 +147,20 @@ private:
         parent_trace(parent_trace), ignore_enoent(ignore_enoent),
         on_finish(on_finish) {
     }
+
+    bool same_transition(uint8_t new_state_,
+                         const boost::optional<uint8_t> &current_state_,
+                         bool ignore_enoent_) const {
+      return (new_state == new_state_ && current_state == current_state_ &&
+              ignore_enoent == ignore_enoent_);
+    }
+  };
+
+  struct LastUpdate {
+    uint64_t end_object_no;
+    uint8_t new_state;
+    boost::optional<uint8_t> current_state;
+    bool ignore_enoent;
   };
 
   typedef BlockGuard<UpdateOperation> UpdateGuard;
@@ -160,6 +174,17 @@ private:
   AsyncOpTracker m_async_op_tracker;
   UpdateGuard *m_update_guard = nullptr;
 
+  // updates for the same object map object are serialized by the OSD, so
+  // an update that continues the range of one still in flight is held and
+  // merged with its successors into a single range update
+  bool m_merge_sequential_updates;
+  uint64_t m_updates_in_flight = 0;
+  boost::optional<LastUpdate> m_last_update;
+  boost::optional<UpdateOperation> m_pending_update;
+  std::vector<Context*> m_pending_update_ctxs;
+
+  void queue_aio_update(UpdateOperation &&update_operation);
+  void send_pending_aio_update();
   void detained_aio_update(UpdateOperation &&update_operation);
   void handle_detained_aio_update(BlockGuardCell *cell, int r,
                                   Context *on_finish);
@@ -52,6 +52,11 @@ enum {
 
   l_librbd_invalidate_cache,
 
+  l_librbd_encrypt_bytes,
+  l_librbd_encrypt_latency,
+  l_librbd_decrypt_bytes,
+  l_librbd_decrypt_latency,
+
   l_librbd_opened_time,
   l_librbd_lock_acquired_time,
 
@@ -287,6 +287,35 @@ std::pair<uint64_t, uint64_t> DiffIterate<I>::calc_object_diff_range() {
   return {object_extents.front().object_no, object_extents.back().object_no + 1};
 }
 
+template <typename I>
+bool DiffIterate<I>::is_period_unchanged(uint64_t period_off,
+                                         uint64_t start_object_no,
+                                         const BitVector<2>& object_diff_state,
+                                         bool from_beginning) {
+  uint64_t stripe_count = m_image_ctx.layout.stripe_count;
+  uint64_t object_set = period_off / m_image_ctx.get_stripe_period();
+  uint64_t object_no = object_set * stripe_count;
+  for (uint64_t i = 0; i < stripe_count; ++i, ++object_no) {
+    if (object_no < start_object_no ||
+        object_no - start_object_no >= object_diff_state.size()) {
+      // outside of the computed range -- not known to be unchanged
+      return false;
+    }
+
+    uint8_t diff_state = object_diff_state[object_no - start_object_no];
+    if (diff_state == object_map::DIFF_STATE_DATA) {
+      continue;
+    } else if (diff_state == object_map::DIFF_STATE_HOLE &&
+               !(from_beginning && m_include_parent)) {
+      // when diffing from the beginning of time, a hole in the child
+      // might still expose parent data
+      continue;
+    }
+    return false;
+  }
+  return true;
+}
+
 template <typename I>
 int DiffIterate<I>::execute() {
   CephContext* cct = m_image_ctx.cct;
@@ -324,7 +353,15 @@ int DiffIterate<I>::execute() {
   uint64_t start_object_no, end_object_no;
   BitVector<2> object_diff_state;
   interval_set<uint64_t> parent_diff;
-  if (m_whole_object) {
+  // the object map diff is also consulted for sub-object diffs so that
+  // objects fast-diff reports as unchanged are not listed individually
+  bool fast_diff_feature = false;
+  {
+    std::shared_lock image_locker{m_image_ctx.image_lock};
+    fast_diff_feature = m_image_ctx.test_features(RBD_FEATURE_FAST_DIFF,
+                                                       m_image_ctx.image_lock);
+  }
+  if (m_whole_object || fast_diff_feature) {
     std::tie(start_object_no, end_object_no) = calc_object_diff_range();
 
     C_SaferCond ctx;
@@ -342,7 +379,7 @@ int DiffIterate<I>::execute() {
       fast_diff_enabled = true;
 
       // check parent overlap only if we are comparing to the beginning of time
-      if (m_include_parent && from_snap_id == 0) {
+      if (m_whole_object && m_include_parent && from_snap_id == 0) {
         std::shared_lock image_locker{m_image_ctx.image_lock};
         uint64_t raw_overlap = 0;
         m_image_ctx.get_parent_overlap(m_image_ctx.snap_id, &raw_overlap);
@@ -378,7 +415,7 @@ int DiffIterate<I>::execute() {
     uint64_t period_off = round_down_to(off, period);
     uint64_t read_len = std::min(period_off + period - off, left);
 
-    if (fast_diff_enabled) {
+    if (fast_diff_enabled && m_whole_object) {
       // map to extents
       std::map<object_t,std::vector<ObjectExtent> > object_extents;
       Striper::file_to_extents(cct, m_image_ctx.format_string,
@@ -434,6 +471,10 @@ int DiffIterate<I>::execute() {
           return r;
         }
       }
+    } else if (fast_diff_enabled &&
+               is_period_unchanged(period_off, start_object_no,
+                                   object_diff_state, from_snap_id == 0)) {
+      ldout(cct, 20) << "skipping unchanged period " << period_off << dendl;
     } else {
       auto diff_object = new C_DiffObject<I>(m_image_ctx, diff_context, off,
                                              read_len);
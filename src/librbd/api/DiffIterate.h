@@ -53,6 +53,9 @@ private:
   }
 
   std::pair<uint64_t, uint64_t> calc_object_diff_range();
+  bool is_period_unchanged(uint64_t period_off, uint64_t start_object_no,
+                           const ceph::BitVector<2>& object_diff_state,
+                           bool from_beginning);
 
   int execute();
 };
@@ -205,6 +205,8 @@ private:
 
   int m_flush_ops_in_flight = 0;
   int m_flush_bytes_in_flight = 0;
+  int m_max_flush_ops_in_flight = IN_FLIGHT_FLUSH_WRITE_LIMIT;
+  int m_max_flush_bytes_in_flight = IN_FLIGHT_FLUSH_BYTES_LIMIT;
   uint64_t m_lowest_flushing_sync_gen = 0;
 
   /* Writes that have left the block guard, but are waiting for resources */
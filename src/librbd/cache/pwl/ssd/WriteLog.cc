@@ -57,6 +57,8 @@ WriteLog<I>::WriteLog(
   : AbstractWriteLog<I>(image_ctx, cache_state, create_builder(),
                         image_writeback, plugin_api)
 {
+  m_retire_ratio = image_ctx.config.template get_val<double>(
+    "rbd_persistent_cache_retire_ratio");
 }
 
 template <typename I>
@@ -644,9 +646,11 @@ void WriteLog<I>::process_work() {
   CephContext *cct = m_image_ctx.cct;
   int max_iterations = 4;
   bool wake_up_requested = false;
-  uint64_t aggressive_high_water_bytes =
-      this->m_bytes_allocated_cap * AGGRESSIVE_RETIRE_HIGH_WATER;
-  uint64_t high_water_bytes = this->m_bytes_allocated_cap * RETIRE_HIGH_WATER;
+  // flushed entries keep serving reads until the cache is m_retire_ratio
+  // full; past that (or the aggressive mark) retire faster to make room
+  uint64_t aggressive_high_water_bytes = this->m_bytes_allocated_cap *
+    std::max(AGGRESSIVE_RETIRE_HIGH_WATER, m_retire_ratio);
+  uint64_t high_water_bytes = this->m_bytes_allocated_cap * m_retire_ratio;
 
   ldout(cct, 20) << dendl;
 
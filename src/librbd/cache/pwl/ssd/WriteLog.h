@@ -103,6 +103,7 @@ private:
   BlockDevice *bdev = nullptr;
   pwl::WriteLogPoolRoot pool_root;
   Builder<This> *m_builderobj;
+  double m_retire_ratio = RETIRE_HIGH_WATER;
 
   Builder<This>* create_builder();
   int create_and_open_bdev();
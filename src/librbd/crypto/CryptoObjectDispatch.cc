@@ -5,6 +5,7 @@
 #include "include/ceph_assert.h"
 #include "include/neorados/RADOS.hpp"
 #include "common/dout.h"
+#include "common/perf_counters.h"
 #include "osdc/Striper.h"
 #include "librbd/ImageCtx.h"
 #include "librbd/Utils.h"
@@ -36,6 +37,34 @@ uint64_t get_file_offset(I* image_ctx, uint64_t object_no,
   return off.first;
 }
 
+template <typename I>
+int encrypt_with_stats(I* image_ctx, CryptoInterface* crypto,
+                       ceph::bufferlist* data, uint64_t image_offset) {
+  auto start_time = ceph::mono_clock::now();
+  auto length = data->length();
+  auto r = crypto->encrypt(data, image_offset);
+  if (r == 0) {
+    image_ctx->perfcounter->inc(l_librbd_encrypt_bytes, length);
+    image_ctx->perfcounter->tinc(l_librbd_encrypt_latency,
+                                 ceph::mono_clock::now() - start_time);
+  }
+  return r;
+}
+
+template <typename I>
+int decrypt_aligned_extent_with_stats(I* image_ctx, CryptoInterface* crypto,
+                                      io::ReadExtent& extent,
+                                      uint64_t image_offset) {
+  auto start_time = ceph::mono_clock::now();
+  auto r = crypto->decrypt_aligned_extent(extent, image_offset);
+  if (r == 0) {
+    image_ctx->perfcounter->inc(l_librbd_decrypt_bytes, extent.bl.length());
+    image_ctx->perfcounter->tinc(l_librbd_decrypt_latency,
+                                 ceph::mono_clock::now() - start_time);
+  }
+  return r;
+}
+
 template <typename I>
 struct C_AlignedObjectReadRequest : public Context {
     I* image_ctx;
@@ -88,8 +117,9 @@ struct C_AlignedObjectReadRequest : public Context {
       if (r >= 0) {
         r = 0;
         for (auto& extent: *extents) {
-          auto crypto_ret = crypto->decrypt_aligned_extent(
-              extent, get_file_offset(image_ctx, object_no, extent.offset));
+          auto crypto_ret = decrypt_aligned_extent_with_stats(
+              image_ctx, crypto, extent,
+              get_file_offset(image_ctx, object_no, extent.offset));
           if (crypto_ret != 0) {
             ceph_assert(crypto_ret < 0);
             r = crypto_ret;
@@ -501,8 +531,9 @@ bool CryptoObjectDispatch<I>::write(
   ceph_assert(m_crypto != nullptr);
 
   if (m_crypto->is_aligned(object_off, data.length())) {
-    auto r = m_crypto->encrypt(
-        &data, get_file_offset(m_image_ctx, object_no, object_off));
+    auto r = encrypt_with_stats(
+        m_image_ctx, m_crypto, &data,
+        get_file_offset(m_image_ctx, object_no, object_off));
     *dispatch_result = r == 0 ? io::DISPATCH_RESULT_CONTINUE
                               : io::DISPATCH_RESULT_COMPLETE;
     on_dispatched->complete(r);
@@ -664,7 +695,8 @@ int CryptoObjectDispatch<I>::prepare_copyup(
         aligned_bl.rebuild(); // to deep copy aligned_bl from current_bl
         position += image_length;
 
-        auto r = m_crypto->encrypt(&aligned_bl, image_offset);
+        auto r = encrypt_with_stats(m_image_ctx, m_crypto, &aligned_bl,
+                                    image_offset);
         if (r != 0) {
           return r;
         }
@@ -150,12 +150,15 @@ void ImageCopyRequest<I>::send_object_copies() {
   bool complete;
   {
     std::lock_guard locker{m_lock};
-    auto max_ops = m_src_image_ctx->config.template get_val<uint64_t>(
+    m_max_ops = m_src_image_ctx->config.template get_val<uint64_t>(
       "rbd_concurrent_management_ops");
+    m_min_ops = m_max_ops;
+    m_adaptive_max_ops = m_src_image_ctx->config.template get_val<uint64_t>(
+      "rbd_deep_copy_max_concurrent_object_copies");
 
     // attempt to schedule at least 'max_ops' initial requests where
     // some objects might be skipped if fast-diff notes no change
-    for (uint64_t i = 0; i < max_ops; i++) {
+    for (uint64_t i = 0; i < m_max_ops; i++) {
       send_next_object_copy();
     }
 
@@ -181,10 +184,6 @@ void ImageCopyRequest<I>::send_next_object_copy() {
   }
 
   uint64_t ono = m_object_no++;
-  Context *ctx = new LambdaContext(
-    [this, ono](int r) {
-      handle_object_copy(ono, r);
-    });
 
   ldout(m_cct, 20) << "object_num=" << ono << dendl;
   ++m_current_ops;
@@ -211,6 +210,10 @@ void ImageCopyRequest<I>::send_next_object_copy() {
 
     if (object_diff_state == object_map::DIFF_STATE_HOLE) {
       ldout(m_cct, 20) << "skipping non-existent object " << ono << dendl;
+      Context *ctx = new LambdaContext(
+        [this, ono](int r) {
+          handle_object_copy(ono, std::nullopt, r);
+        });
       create_async_context_callback(*m_src_image_ctx, ctx)->complete(0);
       return;
     }
@@ -225,6 +228,11 @@ void ImageCopyRequest<I>::send_next_object_copy() {
     flags |= OBJECT_COPY_REQUEST_FLAG_EXISTS_CLEAN;
   }
 
+  auto start_time = ceph::mono_clock::now();
+  Context *ctx = new LambdaContext(
+    [this, ono, start_time](int r) {
+      handle_object_copy(ono, ceph::mono_clock::now() - start_time, r);
+    });
   auto req = ObjectCopyRequest<I>::create(
     m_src_image_ctx, m_dst_image_ctx, m_src_snap_id_start, m_dst_snap_id_start,
     m_snap_map, ono, flags, m_handler, ctx);
@@ -232,7 +240,8 @@ void ImageCopyRequest<I>::send_next_object_copy() {
 }
 
 template <typename I>
-void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
+void ImageCopyRequest<I>::handle_object_copy(
+    uint64_t object_no, const std::optional<ceph::timespan>& latency, int r) {
   ldout(m_cct, 20) << "object_no=" << object_no << ", r=" << r << dendl;
 
   bool complete;
@@ -241,6 +250,10 @@ void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
     ceph_assert(m_current_ops > 0);
     --m_current_ops;
 
+    if (latency && r >= 0) {
+      update_concurrency(*latency);
+    }
+
     if (r < 0 && r != -ENOENT) {
       lderr(m_cct) << "object copy failed: " << cpp_strerror(r) << dendl;
       if (m_ret_val == 0) {
@@ -263,7 +276,13 @@ void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
       }
     }
 
-    send_next_object_copy();
+    while (m_current_ops < m_max_ops) {
+      auto current_ops = m_current_ops;
+      send_next_object_copy();
+      if (m_current_ops == current_ops) {
+        break;
+      }
+    }
     complete = (m_current_ops == 0) && !m_updating_progress;
   }
 
@@ -272,6 +291,46 @@ void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
   }
 }
 
+template <typename I>
+void ImageCopyRequest<I>::update_concurrency(const ceph::timespan& latency) {
+  ceph_assert(ceph_mutex_is_locked(m_lock));
+  if (m_adaptive_max_ops <= m_min_ops) {
+    return;
+  }
+
+  uint64_t latency_ns = std::max<uint64_t>(
+    1, std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+  if (m_min_latency_ns == 0 || latency_ns < m_min_latency_ns) {
+    m_min_latency_ns = latency_ns;
+  }
+  if (m_avg_latency_ns == 0) {
+    m_avg_latency_ns = latency_ns;
+  } else {
+    m_avg_latency_ns = (m_avg_latency_ns * 7 + latency_ns) / 8;
+  }
+
+  // re-evaluate once per window worth of completed copies
+  if (++m_window_completions < m_max_ops) {
+    return;
+  }
+  m_window_completions = 0;
+
+  auto max_ops = m_max_ops;
+  if (m_avg_latency_ns < 2 * m_min_latency_ns) {
+    // copies complete close to the unloaded round trip time
+    m_max_ops = std::min(m_max_ops + 1, m_adaptive_max_ops);
+  } else if (m_avg_latency_ns > 4 * m_min_latency_ns) {
+    // copies are queueing up somewhere -- back off
+    m_max_ops = std::max(m_max_ops * 3 / 4, m_min_ops);
+  }
+  if (m_max_ops != max_ops) {
+    ldout(m_cct, 10) << "concurrent object copies " << max_ops << " -> "
+                     << m_max_ops << " (avg_latency=" << m_avg_latency_ns
+                     << "ns, min_latency=" << m_min_latency_ns << "ns)"
+                     << dendl;
+  }
+}
+
 template <typename I>
 void ImageCopyRequest<I>::finish(int r) {
   ldout(m_cct, 20) << "r=" << r << dendl;
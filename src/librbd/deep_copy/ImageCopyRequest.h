@@ -8,11 +8,13 @@
 #include "include/rados/librados.hpp"
 #include "common/bit_vector.hpp"
 #include "common/ceph_mutex.h"
+#include "common/ceph_time.h"
 #include "common/RefCountedObj.h"
 #include "librbd/Types.h"
 #include "librbd/deep_copy/Types.h"
 #include <functional>
 #include <map>
+#include <optional>
 #include <queue>
 #include <set>
 #include <vector>
@@ -95,6 +97,12 @@ private:
   uint64_t m_object_no = 0;
   uint64_t m_end_object_no = 0;
   uint64_t m_current_ops = 0;
+  uint64_t m_max_ops = 0;
+  uint64_t m_min_ops = 0;
+  uint64_t m_adaptive_max_ops = 0;
+  uint64_t m_min_latency_ns = 0;
+  uint64_t m_avg_latency_ns = 0;
+  uint64_t m_window_completions = 0;
   std::priority_queue<
     uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> m_copied_objects;
   bool m_updating_progress = false;
@@ -110,7 +118,9 @@ private:
 
   void send_object_copies();
   void send_next_object_copy();
-  void handle_object_copy(uint64_t object_no, int r);
+  void handle_object_copy(uint64_t object_no,
+                          const std::optional<ceph::timespan>& latency, int r);
+  void update_concurrency(const ceph::timespan& latency);
 
   void finish(int r);
 };
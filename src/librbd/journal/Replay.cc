@@ -23,9 +23,6 @@ namespace journal {
 
 namespace {
 
-static const uint64_t IN_FLIGHT_IO_LOW_WATER_MARK(32);
-static const uint64_t IN_FLIGHT_IO_HIGH_WATER_MARK(64);
-
 static NoOpProgressContext no_op_progress_callback;
 
 template <typename I, typename E>
@@ -175,7 +172,11 @@ struct C_RefreshIfRequired : public Context {
 
 template <typename I>
 Replay<I>::Replay(I &image_ctx)
-  : m_image_ctx(image_ctx) {
+  : m_image_ctx(image_ctx),
+    m_in_flight_io_high_water_mark(
+      image_ctx.config.template get_val<uint64_t>(
+        "rbd_journal_replay_max_in_flight_ios")),
+    m_in_flight_io_low_water_mark(m_in_flight_io_high_water_mark / 2) {
 }
 
 template <typename I>
@@ -1095,7 +1096,7 @@ Replay<I>::create_aio_modify_completion(Context *on_ready,
   // commit position until safely on-disk
 
   *flush_required = (m_aio_modify_unsafe_contexts.size() ==
-                       IN_FLIGHT_IO_LOW_WATER_MARK);
+                       m_in_flight_io_low_water_mark);
   if (*flush_required) {
     ldout(cct, 10) << ": hit AIO replay low-water mark: scheduling flush"
                    << dendl;
@@ -1106,7 +1107,7 @@ Replay<I>::create_aio_modify_completion(Context *on_ready,
   // * in-flight ops are at a consistent point (snap create has IO flushed,
   //   shrink has adjusted clip boundary, etc) -- should have already been
   //   flagged not-ready
-  if (m_in_flight_aio_modify == IN_FLIGHT_IO_HIGH_WATER_MARK) {
+  if (m_in_flight_aio_modify == m_in_flight_io_high_water_mark) {
     ldout(cct, 10) << ": hit AIO replay high-water mark: pausing replay"
                    << dendl;
     ceph_assert(m_on_aio_ready == nullptr);
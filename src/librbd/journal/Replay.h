@@ -119,6 +119,11 @@ private:
 
   ImageCtxT &m_image_ctx;
 
+  // replay pauses when this many write/discard events are in flight and a
+  // flush is issued every low-water mark worth of unsafe events
+  const uint64_t m_in_flight_io_high_water_mark;
+  const uint64_t m_in_flight_io_low_water_mark;
+
   ceph::mutex m_lock = ceph::make_mutex("Replay<I>::m_lock");
 
   uint64_t m_in_flight_aio_flush = 0;
@@ -374,7 +374,7 @@ public:
   LocalLockC versionlock; // FIXME referenced containers not in mempool
 
   mempool::mds_co::map<client_t,ClientLease*> client_lease_map;
-  std::map<int, std::unique_ptr<BatchOp>> batch_ops;
+  BatchOpMap batch_ops;
 
   ceph_tid_t reintegration_reqid = 0;
 
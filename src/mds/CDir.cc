@@ -1664,9 +1664,13 @@ public:
   map<string, bufferlist> omap;      ///< carry-over from before
   map<string, bufferlist> omap_more; ///< new batch
   int ret;
+  utime_t start = ceph_clock_now();
   C_IO_Dir_OMAP_FetchedMore(CDir *d, version_t v, MDSContext *f) :
     CDirIOContext(d), fin(f), omap_version(v), ret(0) { }
   void finish(int r) {
+    if (dir->mdcache->mds->logger)
+      dir->mdcache->mds->logger->tinc(l_mds_dir_fetch_latency,
+                                      ceph_clock_now() - start);
     if (omap_version < dir->get_committed_version()) {
       omap.clear();
       dir->_omap_fetch(nullptr, fin);
@@ -1703,12 +1707,16 @@ public:
   map<string, bufferlist> omap;
   bufferlist btbl;
   int ret1, ret2, ret3;
+  utime_t start = ceph_clock_now();
 
   C_IO_Dir_OMAP_Fetched(CDir *d, MDSContext *f) :
     CDirIOContext(d), fin(f),
     omap_version(d->get_committing_version()),
     ret1(0), ret2(0), ret3(0) { }
   void finish(int r) override {
+    if (dir->mdcache->mds->logger)
+      dir->mdcache->mds->logger->tinc(l_mds_dir_fetch_latency,
+                                      ceph_clock_now() - start);
     // check the correctness of backtrace
     if (r >= 0 && ret3 != -CEPHFS_ECANCELED)
       dir->inode->verify_diri_backtrace(btbl, ret3);
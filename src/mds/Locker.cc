@@ -243,6 +243,13 @@ bool Locker::acquire_locks(const MDRequestRef& mdr,
 
   MarkEventOnDestruct marker(mdr, "failed to acquire_locks");
 
+  // a previous attempt for this lock set did not complete: we are being
+  // retried after waiting
+  if (mdr->lock_wait_start == utime_t())
+    mdr->lock_wait_start = ceph_clock_now();
+  else
+    mdr->lock_waited = true;
+
   client_t client = mdr->get_client();
 
   if (auth_pin_freeze)
@@ -638,7 +645,16 @@ bool Locker::acquire_locks(const MDRequestRef& mdr,
     }
   }
 
-  mdr->set_mds_stamp(ceph_clock_now());
+  {
+    utime_t now = ceph_clock_now();
+    mdr->set_mds_stamp(now);
+    if (mdr->lock_waited && mds->logger) {
+      mds->logger->inc(l_mds_lock_wait);
+      mds->logger->tinc(l_mds_lock_wait_latency, now - mdr->lock_wait_start);
+    }
+    mdr->lock_wait_start = utime_t();
+    mdr->lock_waited = false;
+  }
   result = true;
   marker.message = "acquired locks";
 
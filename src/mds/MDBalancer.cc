@@ -83,6 +83,7 @@ MDBalancer::MDBalancer(MDSRank *m, Messenger *msgr, MonClient *monc) :
 {
   bal_fragment_dirs = g_conf().get_val<bool>("mds_bal_fragment_dirs");
   bal_fragment_interval = g_conf().get_val<int64_t>("mds_bal_fragment_interval");
+  bal_import_hold_time = g_conf().get_val<double>("mds_bal_import_hold_time");
 }
 
 void MDBalancer::handle_conf_change(const std::set<std::string>& changed, const MDSMap& mds_map)
@@ -93,6 +94,12 @@ void MDBalancer::handle_conf_change(const std::set<std::string>& changed, const
   if (changed.count("mds_bal_fragment_interval")) {
     bal_fragment_interval = g_conf().get_val<int64_t>("mds_bal_fragment_interval");
   }
+  if (changed.count("mds_bal_import_hold_time")) {
+    bal_import_hold_time = g_conf().get_val<double>("mds_bal_import_hold_time");
+    if (bal_import_hold_time <= 0) {
+      recent_imports.clear();
+    }
+  }
 }
 
 bool MDBalancer::test_rank_mask(mds_rank_t rank)
@@ -951,6 +958,7 @@ void MDBalancer::try_rebalance(balance_state_t& state)
   multimap<double, CDir*> import_pop_map;
   multimap<mds_rank_t, pair<CDir*, double> > import_from_map;
 
+  auto now = clock::now();
   for (auto& dir : mds->mdcache->get_fullauth_subtrees()) {
     CInode *diri = dir->get_inode();
     if (diri->is_mdsdir())
@@ -961,6 +969,11 @@ void MDBalancer::try_rebalance(balance_state_t& state)
       continue;  // export pbly already in progress
 
     mds_rank_t from = diri->authority().first;
+    if (from != mds->get_nodeid() && is_import_held(dir, now)) {
+      dout(15) << "  holding recently imported " << *dir << " from mds."
+	       << from << dendl;
+      continue;
+    }
     double pop = dir->pop_auth_subtree.meta_load();
     if (g_conf()->mds_bal_idle_threshold > 0 &&
 	pop < g_conf()->mds_bal_idle_threshold &&
@@ -1386,8 +1399,36 @@ void MDBalancer::subtract_export(CDir *dir)
 }
 
 
+bool MDBalancer::is_import_held(CDir *dir, time now)
+{
+  auto it = recent_imports.find(dir->dirfrag());
+  if (it == recent_imports.end())
+    return false;
+
+  auto hold = std::chrono::duration<double>(bal_import_hold_time);
+  if (now - it->second < hold)
+    return true;
+
+  recent_imports.erase(it);
+  return false;
+}
+
 void MDBalancer::add_import(CDir *dir)
 {
+  if (bal_import_hold_time > 0) {
+    // drop stale entries so imports that were since re-exported, split or
+    // merged don't accumulate
+    auto now = clock::now();
+    auto hold = std::chrono::duration<double>(bal_import_hold_time);
+    for (auto it = recent_imports.begin(); it != recent_imports.end(); ) {
+      if (now - it->second >= hold)
+	it = recent_imports.erase(it);
+      else
+	++it;
+    }
+    recent_imports[dir->dirfrag()] = now;
+  }
+
   dirfrag_load_vec_t subload = dir->pop_auth_subtree;
 
   while (true) {
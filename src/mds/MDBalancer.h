@@ -119,8 +119,11 @@ private:
   void try_rebalance(balance_state_t& state);
   bool test_rank_mask(mds_rank_t rank);
 
+  bool is_import_held(CDir *dir, time now);
+
   bool bal_fragment_dirs;
   int64_t bal_fragment_interval;
+  double bal_import_hold_time;
   static const unsigned int AUTH_TREES_THRESHOLD = 5;
 
   MDSRank *mds;
@@ -135,6 +138,9 @@ private:
   time last_sample = clock::zero();
   time rebalance_time = clock::zero(); //ensure a consistent view of load for rebalance
 
+  // when subtrees were last imported, for mds_bal_import_hold_time
+  std::map<dirfrag_t, time> recent_imports;
+
   time last_get_load = clock::zero();
   uint64_t last_num_requests = 0;
   uint64_t last_cpu_time = 0;
@@ -58,6 +58,7 @@ MDLog::MDLog(MDSRank* m)
   max_events = g_conf().get_val<int64_t>("mds_log_max_events");
   skip_corrupt_events = g_conf().get_val<bool>("mds_log_skip_corrupt_events");
   skip_unbounded_events = g_conf().get_val<bool>("mds_log_skip_unbounded_events");
+  replay_batch_events = g_conf().get_val<uint64_t>("mds_log_replay_batch_events");
   upkeep_thread = std::thread(&MDLog::log_trim_upkeep, this);
 }
 
@@ -92,6 +93,10 @@ void MDLog::create_logger()
   plb.add_u64_counter(l_mdl_replayed, "replayed", "Events replayed",
 		      "repl", PerfCountersBuilder::PRIO_INTERESTING);
   plb.add_time_avg(l_mdl_jlat, "jlat", "Journaler flush latency");
+  plb.add_u64_counter(l_mdl_replay_bytes, "replay_bytes",
+                      "Journal bytes replayed", NULL, 0, unit_t(UNIT_BYTES));
+  plb.add_time_avg(l_mdl_replay_lat, "replay_lat",
+                   "Latency of applying a batch of replayed events");
   plb.add_u64_counter(l_mdl_evex, "evex", "Total expired events");
   plb.add_u64_counter(l_mdl_evtrm, "evtrm", "Trimmed events");
   plb.add_u64_counter(l_mdl_segadd, "segadd", "Segments added");
@@ -1340,12 +1345,49 @@ void MDLog::_replay_thread()
 {
   dout(10) << "_replay_thread start" << dendl;
 
+  // events are read and decoded without mds_lock and then applied in
+  // batches, taking mds_lock once per batch instead of once per event
+  const uint64_t batch_events = std::max<uint64_t>(replay_batch_events, 1);
+  std::vector<std::unique_ptr<LogEvent>> pending;
+  auto replay_pending = [&]() {
+    if (pending.empty()) {
+      return true;
+    }
+    {
+      std::lock_guard l(mds->mds_lock);
+      if (mds->is_daemon_stopping()) {
+        return false;
+      }
+      utime_t start = ceph_clock_now();
+      for (auto& le : pending) {
+        logger->inc(l_mdl_replayed);
+        le->replay(mds);
+      }
+      logger->tinc(l_mdl_replay_lat, ceph_clock_now() - start);
+    }
+    pending.clear();
+    return true;
+  };
+
   // loop
   int r = 0;
   while (1) {
+    // apply what we have before waiting for more to be read
+    if (!pending.empty() &&
+        (pending.size() >= batch_events || !journaler->is_readable())) {
+      if (!replay_pending()) {
+        return;
+      }
+    }
+
     // wait for read?
     journaler->check_isreadable(); 
     if (journaler->get_error()) {
+      // events decoded before the error must be applied before we trim
+      // segments or give up on the journal
+      if (!replay_pending()) {
+        return;
+      }
       r = journaler->get_error();
       dout(0) << "_replay journaler got error " << r << ", aborting" << dendl;
       if (r == -CEPHFS_ENOENT) {
@@ -1448,6 +1490,10 @@ void MDLog::_replay_thread()
 
     events_since_last_major_segment++;
     if (auto sb = dynamic_cast<SegmentBoundary*>(le.get()); sb) {
+      // events still pending belong to the current segment
+      if (!replay_pending()) {
+        return;
+      }
       auto seq = sb->get_seq();
       if (seq > 0) {
         event_seq = seq;
@@ -1488,21 +1534,19 @@ void MDLog::_replay_thread()
     le->_segment->end = journaler->get_read_pos();
     num_events++;
     logger->set(l_mdl_ev, num_events);
+    logger->inc(l_mdl_replay_bytes, bl.length());
 
-    {
-      std::lock_guard l(mds->mds_lock);
-      if (mds->is_daemon_stopping()) {
-        return;
-      }
-      logger->inc(l_mdl_replayed);
-      le->replay(mds);
-    }
+    pending.push_back(std::move(le));
 
     logger->set(l_mdl_rdpos, pos);
     logger->set(l_mdl_expos, journaler->get_expire_pos());
     logger->set(l_mdl_wrpos, journaler->get_write_pos());
   }
 
+  if (!replay_pending()) {
+    return;
+  }
+
   // done!
   if (r == 0) {
     ceph_assert(journaler->get_read_pos() == journaler->get_write_pos());
@@ -1611,6 +1655,9 @@ void MDLog::handle_conf_change(const std::set<std::string>& changed, const MDSMa
   if (changed.count("mds_log_skip_unbounded_events")) {
     skip_unbounded_events = g_conf().get_val<bool>("mds_log_skip_unbounded_events");
   }
+  if (changed.count("mds_log_replay_batch_events")) {
+    replay_batch_events = g_conf().get_val<uint64_t>("mds_log_replay_batch_events");
+  }
   if (changed.count("mds_log_trim_decay_rate")){
     log_trim_counter = DecayCounter(g_conf().get_val<double>("mds_log_trim_decay_rate"));
   }
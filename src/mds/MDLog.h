@@ -38,6 +38,8 @@ enum {
   l_mdl_rdpos,
   l_mdl_jlat,
   l_mdl_replayed,
+  l_mdl_replay_bytes,
+  l_mdl_replay_lat,
   l_mdl_last,
 };
 
@@ -300,6 +302,7 @@ private:
   bool pause;
   bool skip_corrupt_events;
   bool skip_unbounded_events;
+  uint64_t replay_batch_events;
 
   std::set<uint64_t> major_segments;
   std::set<LogSegment*> expired_segments;
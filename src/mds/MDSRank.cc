@@ -3704,6 +3704,12 @@ void MDSRank::create_logger()
     mds_plb.add_u64(l_mds_load_cent, "load_cent", "Load per cent");
     mds_plb.add_u64_counter(l_mds_openino_dir_fetch, "openino_dir_fetch",
                             "OpenIno incomplete directory fetchings");
+    mds_plb.add_u64_counter(l_mds_lock_wait, "lock_wait",
+                            "Requests that waited to acquire locks");
+    mds_plb.add_time_avg(l_mds_lock_wait_latency, "lock_wait_latency",
+                         "Time requests spent waiting to acquire locks");
+    mds_plb.add_time_avg(l_mds_dir_fetch_latency, "dir_fetch_latency",
+                         "Dirfrag omap read latency");
 
     // low prio stats
     mds_plb.set_prio_default(PerfCountersBuilder::PRIO_DEBUGONLY);
@@ -4037,6 +4043,7 @@ const char** MDSRankDispatcher::get_tracked_conf_keys() const
     "mds_bal_fragment_dirs",
     "mds_bal_fragment_interval",
     "mds_bal_fragment_size_max",
+    "mds_bal_import_hold_time",
     "mds_cache_memory_limit",
     "mds_cache_mid",
     "mds_cache_reservation",
@@ -4058,6 +4065,7 @@ const char** MDSRankDispatcher::get_tracked_conf_keys() const
     "mds_export_ephemeral_random_max",
     "mds_extraordinary_events_dump_interval",
     "mds_forward_all_requests_to_auth",
+    "mds_getattr_trust_issued_caps",
     "mds_health_cache_threshold",
     "mds_heartbeat_grace",
     "mds_heartbeat_reset_grace",
@@ -4071,6 +4079,7 @@ const char** MDSRankDispatcher::get_tracked_conf_keys() const
     "mds_log_max_events",
     "mds_log_max_segments",
     "mds_log_pause",
+    "mds_log_replay_batch_events",
     "mds_log_skip_corrupt_events",
     "mds_log_skip_unbounded_events",
     "mds_max_caps_per_client",
@@ -4083,6 +4092,7 @@ const char** MDSRankDispatcher::get_tracked_conf_keys() const
     "mds_op_history_duration",
     "mds_op_history_size",
     "mds_op_log_threshold",
+    "mds_readdir_prefetch_next_frag",
     "mds_recall_max_decay_rate",
     "mds_recall_warning_decay_rate",
     "mds_request_load_average_decay_rate",
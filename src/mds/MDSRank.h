@@ -107,6 +107,9 @@ enum {
   l_mdss_handle_client_caps_dirty,
   l_mdss_handle_client_cap_release,
   l_mdss_process_request_cap_release,
+  l_mds_lock_wait,
+  l_mds_lock_wait_latency,
+  l_mds_dir_fetch_latency,
   l_mds_last,
 };
 
@@ -482,11 +482,16 @@ struct MDRequestImpl : public MutationImpl {
   // indicates how may retries of request have been made
   int retry = 0;
 
-  std::map<int, std::unique_ptr<BatchOp> > *batch_op_map = nullptr;
+  BatchOpMap *batch_op_map = nullptr;
 
   // indicator for vxattr osdmap update
   bool waited_for_osdmap = false;
 
+  // when this request first tried to acquire its current set of locks, and
+  // whether it has had to wait for them since
+  utime_t lock_wait_start;
+  bool lock_waited = false;
+
 protected:
   void _dump(ceph::Formatter *f) const override {
     _dump(f, false);
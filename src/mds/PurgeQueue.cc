@@ -149,6 +149,8 @@ void PurgeQueue::create_logger()
   pcb.add_u64(l_pq_executing, "pq_executing", "Purge queue tasks in flight");
   pcb.add_u64(l_pq_executing_high_water, "pq_executing_high_water", "Maximum number of executing file purges");
   pcb.add_u64(l_pq_item_in_journal, "pq_item_in_journal", "Purge item left in journal");
+  pcb.add_u64(l_pq_item_eta, "pq_item_eta",
+              "Estimated seconds until the purge items in journal are executed");
 
   logger.reset(pcb.create_perf_counters());
   g_ceph_context->get_perfcounters_collection()->add(logger.get());
@@ -740,6 +742,25 @@ void PurgeQueue::_execute_item_complete(
   logger->set(l_pq_item_in_journal, item_num);
   logger->inc(l_pq_executed_ops, executed_ops);
   logger->inc(l_pq_executed);
+
+  // estimate the time to drain the queue from the observed completion rate
+  auto now = ceph::coarse_mono_clock::now();
+  if (last_complete_stamp != ceph::coarse_mono_clock::zero()) {
+    double interval = std::chrono::duration<double>(now - last_complete_stamp).count();
+    if (avg_complete_interval == 0) {
+      avg_complete_interval = interval;
+    } else {
+      avg_complete_interval = 0.9 * avg_complete_interval + 0.1 * interval;
+    }
+  }
+  if (in_flight.empty() && item_num == 0) {
+    // drained; don't count idle time against the next batch of purges
+    last_complete_stamp = ceph::coarse_mono_clock::zero();
+    avg_complete_interval = 0;
+  } else {
+    last_complete_stamp = now;
+  }
+  logger->set(l_pq_item_eta, uint64_t(item_num * avg_complete_interval));
 }
 
 void PurgeQueue::update_op_limit(const MDSMap &mds_map)
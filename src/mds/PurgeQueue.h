@@ -92,6 +92,7 @@ enum {
   l_pq_executed_ops,
   l_pq_executed,
   l_pq_item_in_journal,
+  l_pq_item_eta,
   l_pq_last
 };
 
@@ -246,5 +247,9 @@ private:
 
   uint64_t ops_high_water = 0;
   uint64_t files_high_water = 0;
+
+  // smoothed interval between item completions, for the purge ETA
+  ceph::coarse_mono_time last_complete_stamp = ceph::coarse_mono_clock::zero();
+  double avg_complete_interval = 0;
 };
 #endif
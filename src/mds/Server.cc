@@ -181,6 +181,8 @@ void Server::create_logger()
   plb.add_u64_counter(l_mdss_cap_acquisition_throttle,
                       "cap_acquisition_throttle", "Cap acquisition throttle counter", "cat",
                       PerfCountersBuilder::PRIO_INTERESTING);
+  plb.add_u64_counter(l_mdss_readdir_prefetch, "readdir_prefetch",
+                      "Dirfrags prefetched ahead of readdir");
 
   // fop latencies are useful
   plb.set_prio_default(PerfCountersBuilder::PRIO_USEFUL);
@@ -263,6 +265,8 @@ Server::Server(MDSRank *m, MetricsHandler *metrics_handler) :
   metrics_handler(metrics_handler)
 {
   forward_all_requests_to_auth = g_conf().get_val<bool>("mds_forward_all_requests_to_auth");
+  getattr_trust_issued_caps = g_conf().get_val<bool>("mds_getattr_trust_issued_caps");
+  readdir_prefetch_next_frag = g_conf().get_val<bool>("mds_readdir_prefetch_next_frag");
   replay_unsafe_with_closed_session = g_conf().get_val<bool>("mds_replay_unsafe_with_closed_session");
   cap_revoke_eviction_timeout = g_conf().get_val<double>("mds_cap_revoke_eviction_timeout");
   max_snaps_per_dir = g_conf().get_val<uint64_t>("mds_max_snaps_per_dir");
@@ -1324,6 +1328,12 @@ void Server::handle_conf_change(const std::set<std::string>& changed) {
   if (changed.count("mds_forward_all_requests_to_auth")){
     forward_all_requests_to_auth = g_conf().get_val<bool>("mds_forward_all_requests_to_auth");
   }
+  if (changed.count("mds_getattr_trust_issued_caps")) {
+    getattr_trust_issued_caps = g_conf().get_val<bool>("mds_getattr_trust_issued_caps");
+  }
+  if (changed.count("mds_readdir_prefetch_next_frag")) {
+    readdir_prefetch_next_frag = g_conf().get_val<bool>("mds_readdir_prefetch_next_frag");
+  }
   if (changed.count("mds_cap_revoke_eviction_timeout")) {
     cap_revoke_eviction_timeout = g_conf().get_val<double>("mds_cap_revoke_eviction_timeout");
     dout(20) << __func__ << " cap revoke eviction timeout changed to "
@@ -1899,6 +1909,7 @@ std::pair<bool, uint64_t> Server::recall_client_state(MDSGatherBuilder* gather,
   const auto recall_max_caps = g_conf().get_val<Option::size_t>("mds_recall_max_caps");
   const auto recall_max_decay_threshold = g_conf().get_val<Option::size_t>("mds_recall_max_decay_threshold");
   const auto cache_liveness_magnitude = g_conf().get_val<Option::size_t>("mds_session_cache_liveness_magnitude");
+  const auto prioritize_responsive = g_conf().get_val<bool>("mds_recall_prioritize_responsive_clients");
 
   dout(7) << __func__ << ":"
            << " min=" << min_caps_per_client
@@ -1907,13 +1918,23 @@ std::pair<bool, uint64_t> Server::recall_client_state(MDSGatherBuilder* gather,
            << " flags=" << flags
            << dendl;
 
-  /* trim caps of sessions with the most caps first */
-  std::multimap<uint64_t, Session*> caps_session;
-  auto f = [&caps_session, enforce_max, enforce_liveness, trim, max_caps_per_client, cache_liveness_magnitude](auto& s) {
+  /* trim caps of sessions with the most caps first. Optionally, sessions
+   * that are keeping up with previous recalls go ahead of those that are
+   * not, so the global recall throttle is spent where caps are likely to
+   * actually be released. */
+  std::multimap<std::pair<bool, uint64_t>, Session*> caps_session;
+  auto f = [&caps_session, enforce_max, enforce_liveness, trim, max_caps_per_client, cache_liveness_magnitude, prioritize_responsive, recall_max_decay_threshold](auto& s) {
     auto num_caps = s->caps.size();
     auto cache_liveness = s->get_session_cache_liveness();
     if (trim || (enforce_max && num_caps > max_caps_per_client) || (enforce_liveness && cache_liveness < (num_caps>>cache_liveness_magnitude))) {
-      caps_session.emplace(std::piecewise_construct, std::forward_as_tuple(num_caps), std::forward_as_tuple(s));
+      bool responsive = true;
+      if (prioritize_responsive) {
+        const auto session_recall = s->get_recall_caps();
+        const auto session_release = s->get_release_caps();
+        responsive = !(2*session_release < session_recall &&
+                       2*session_recall > recall_max_decay_threshold);
+      }
+      caps_session.emplace(std::piecewise_construct, std::forward_as_tuple(responsive, num_caps), std::forward_as_tuple(s));
     }
   };
   mds->sessionmap.get_client_sessions(std::move(f));
@@ -1921,7 +1942,8 @@ std::pair<bool, uint64_t> Server::recall_client_state(MDSGatherBuilder* gather,
   std::pair<bool, uint64_t> result = {false, 0};
   auto& [throttled, caps_recalled] = result;
   last_recall_state = now;
-  for (const auto& [num_caps, session] : boost::adaptors::reverse(caps_session)) {
+  for (const auto& [key, session] : boost::adaptors::reverse(caps_session)) {
+    const auto num_caps = key.second;
     if (!session->is_open() ||
         !session->get_connection() ||
 	!session->info.inst.name.is_client())
@@ -4157,15 +4179,36 @@ void Server::handle_client_getattr(const MDRequestRef& mdr, bool is_lookup)
 	      mdr->snapid <= cap->client_follows))
     issued = cap->issued();
 
+  /*
+   * similarly, a stable lock that is readable by the client and whose shared
+   * cap is already issued to it cannot change underneath us: any writer
+   * would first have to revoke that cap. Such locks can be read without
+   * taking an rdlock. Locks already rdlocked by an earlier pass of this
+   * request are kept so that the set of locks cannot shrink between retries.
+   */
+  bool trust_issued = getattr_trust_issued_caps &&
+		      mdr->snapid == CEPH_NOSNAP;
+  auto need_rdlock = [&](SimpleLock *lock, int shared, int excl) {
+    if (!(mask & shared) || (issued & excl))
+      return false;
+    if (trust_issued && (issued & shared) && !mdr->is_rdlocked(lock) &&
+	lock->is_stable() && lock->can_read(client)) {
+      dout(20) << " skipping rdlock on " << *lock << ", client has "
+	       << ccap_string(issued) << dendl;
+      return false;
+    }
+    return true;
+  };
+
   // FIXME
   MutationImpl::LockOpVec lov;
-  if ((mask & CEPH_CAP_LINK_SHARED) && !(issued & CEPH_CAP_LINK_EXCL))
+  if (need_rdlock(&ref->linklock, CEPH_CAP_LINK_SHARED, CEPH_CAP_LINK_EXCL))
     lov.add_rdlock(&ref->linklock);
-  if ((mask & CEPH_CAP_AUTH_SHARED) && !(issued & CEPH_CAP_AUTH_EXCL))
+  if (need_rdlock(&ref->authlock, CEPH_CAP_AUTH_SHARED, CEPH_CAP_AUTH_EXCL))
     lov.add_rdlock(&ref->authlock);
-  if ((mask & CEPH_CAP_XATTR_SHARED) && !(issued & CEPH_CAP_XATTR_EXCL))
+  if (need_rdlock(&ref->xattrlock, CEPH_CAP_XATTR_SHARED, CEPH_CAP_XATTR_EXCL))
     lov.add_rdlock(&ref->xattrlock);
-  if ((mask & CEPH_CAP_FILE_SHARED) && !(issued & CEPH_CAP_FILE_EXCL)) {
+  if (need_rdlock(&ref->filelock, CEPH_CAP_FILE_SHARED, CEPH_CAP_FILE_EXCL)) {
     // Don't wait on unstable filelock if client is allowed to read file size.
     // This can reduce the response time of getattr in the case that multiple
     // clients do stat(2) and there are writers.
@@ -5119,9 +5162,37 @@ void Server::handle_client_readdir(const MDRequestRef& mdr)
   if (req_flags & CEPH_READDIR_REPLY_BITFLAGS) {
     flags |= CEPH_READDIR_HASH_ORDER | CEPH_READDIR_OFFSET_HASH;
   }
+  // the client moves on to the next frag once this one is exhausted; start
+  // loading it now so the fetch overlaps with the client consuming this reply
+  if (end && readdir_prefetch_next_frag && snapid == CEPH_NOSNAP)
+    prefetch_next_readdir_frag(diri, dir->get_frag());
   _finalize_readdir(mdr, diri, dir, start, end, flags, numfiles, dirbl, dnbl);
 }
 
+void Server::prefetch_next_readdir_frag(CInode *diri, frag_t fg)
+{
+  if (fg.is_rightmost())
+    return;
+
+  frag_t next_fg = diri->dirfragtree[fg.next().value()];
+  CDir *dir = diri->get_dirfrag(next_fg);
+  if (!dir) {
+    // only invent dirfrags we would be auth for
+    if (!diri->is_auth() || diri->is_frozen())
+      return;
+    dir = diri->get_or_open_dirfrag(mdcache, next_fg);
+  }
+
+  if (!dir->is_auth() || dir->is_complete() || dir->is_frozen() ||
+      dir->state_test(CDir::STATE_FETCHING))
+    return;
+
+  dout(10) << __func__ << " " << *dir << dendl;
+  dir->fetch(nullptr);
+  if (logger)
+    logger->inc(l_mdss_readdir_prefetch);
+}
+
 
 
 // ===============================================================================
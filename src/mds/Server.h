@@ -84,6 +84,7 @@ enum {
   l_mdss_cap_revoke_eviction,
   l_mdss_cap_acquisition_throttle,
   l_mdss_req_getvxattr_latency,
+  l_mdss_readdir_prefetch,
   l_mdss_last,
 };
 
@@ -490,6 +491,7 @@ private:
   void reply_client_request(const MDRequestRef& mdr, const ref_t<MClientReply> &reply);
   void flush_session(Session *session, MDSGatherBuilder& gather);
 
+  void prefetch_next_readdir_frag(CInode *diri, frag_t fg);
   void _finalize_readdir(const MDRequestRef& mdr,
                          CInode *diri,
                          CDir* dir,
@@ -544,6 +546,8 @@ private:
   feature_bitset_t required_client_features;
 
   bool forward_all_requests_to_auth = false;
+  bool getattr_trust_issued_caps = false;
+  bool readdir_prefetch_next_frag = false;
   bool replay_unsafe_with_closed_session = false;
   double cap_revoke_eviction_timeout = 0;
   uint64_t max_snaps_per_dir = 100;
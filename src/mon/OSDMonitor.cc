@@ -826,6 +826,9 @@ void OSDMonitor::update_from_paxos(bool *need_bootstrap)
     dout(7) << "update_from_paxos  applying incremental " << osdmap.epoch+1
 	    << dendl;
     OSDMap::Incremental inc(inc_bl);
+    // let the next mapping job skip pgs this epoch cannot have moved
+    std::set<pg_t> remapped_pgs;
+    bool only_remaps_pgs = inc.get_remapped_pgs(osdmap, &remapped_pgs);
     err = osdmap.apply_incremental(inc);
     ceph_assert(err == 0);
 
@@ -875,6 +878,7 @@ void OSDMonitor::update_from_paxos(bool *need_bootstrap)
 
 	osdmap = OSDMap();
 	osdmap.decode(orig_full_bl);
+	only_remaps_pgs = false;
 
 	dout(20) << __func__ << " canonical full osdmap:\n";
 	JSONFormatter jf(true);
@@ -889,6 +893,9 @@ void OSDMonitor::update_from_paxos(bool *need_bootstrap)
       put_version_full(t, osdmap.epoch, full_bl);
     }
     put_version_latest_full(t, osdmap.epoch);
+    if (only_remaps_pgs) {
+      mapping.note_remapped_pgs(osdmap.epoch, std::move(remapped_pgs));
+    }
 
     // share
     dout(1) << osdmap << dendl;
@@ -2494,7 +2494,8 @@ void PGMap::get_health_checks(
       const auto &pg_id = i.first;
       const auto &pg_info = i.second;
 
-      for (const auto &j : state_to_response) {
+      // only the responses some PG can actually trigger
+      for (const auto &j : possible_responses) {
         const auto &pg_response_state = j.first;
         const auto &pg_response = j.second;
 
@@ -20,6 +20,7 @@
 #include "include/buffer_fwd.h"
 #include "include/ceph_assert.h"
 #include "include/common_fwd.h"
+#include "include/msgr.h"
 #include "msg/MessageRef.h"
 
 class Messenger;
@@ -107,6 +108,32 @@ public:
     return ms_fast_preprocess(m.get());
   }
 
+  /**
+   * Supply the buffer a message's data payload is received into.
+   *
+   * Called on the network thread once the header of an incoming message is
+   * known and before its data is read, so that the payload can land
+   * directly in memory laid out the way its consumer wants it (e.g. aligned
+   * for direct I/O) instead of being copied there later. Only fast
+   * dispatchers are asked, and only where the transport can read the data
+   * in place (msgr2 crc mode without compression). The header has not been
+   * verified yet; use it to size and place the buffer, nothing more.
+   *
+   * Do not acquire locks in this method! It is considered "fast" delivery.
+   *
+   * @param con The Connection the message arrives on.
+   * @param header The header of the incoming message.
+   * @param len The length of its data payload.
+   * @param bp [out] A buffer of exactly len bytes.
+   * @return true if bp was filled in, false to let the messenger allocate.
+   */
+  virtual bool ms_get_data_buffer(Connection *con,
+				  const ceph_msg_header2 &header,
+				  uint32_t len,
+				  ceph::buffer::ptr *bp) {
+    return false;
+  }
+
   /**
    * The Messenger calls this function to deliver a single message.
    *
@@ -701,6 +701,22 @@ public:
       dispatcher->ms_fast_preprocess2(m);
     }
   }
+  /**
+   * Ask the fast dispatchers for a buffer to receive a message's data
+   * into; the first one that supplies it wins.
+   *
+   * @return true if bp was filled in.
+   */
+  bool ms_deliver_get_data_buffer(Connection *con,
+				  const ceph_msg_header2 &header,
+				  uint32_t len,
+				  ceph::buffer::ptr *bp) {
+    for (const auto &dispatcher : fast_dispatchers) {
+      if (dispatcher->ms_get_data_buffer(con, header, len, bp))
+	return true;
+    }
+    return false;
+  }
   /**
    *  Deliver a single Message. Send it to each Dispatcher
    *  in sequence until one of them handles it.
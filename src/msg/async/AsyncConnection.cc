@@ -82,6 +82,16 @@ class C_handle_write : public EventCallback {
   }
 };
 
+class C_coalesce_wakeup : public EventCallback {
+  AsyncConnectionRef conn;
+
+ public:
+  explicit C_coalesce_wakeup(AsyncConnectionRef c): conn(c) {}
+  void do_request(uint64_t id) override {
+    conn->coalesce_wakeup(id);
+  }
+};
+
 class C_handle_write_callback : public EventCallback {
   AsyncConnectionRef conn;
 
@@ -135,6 +145,7 @@ AsyncConnection::AsyncConnection(CephContext *cct, AsyncMessenger *m, DispatchQu
   write_callback_handler = new C_handle_write_callback(this);
   wakeup_handler = new C_time_wakeup(this);
   tick_handler = new C_tick_wakeup(this);
+  coalesce_handler = new C_coalesce_wakeup(this);
   // double recv_max_prefetch see "read_until"
   recv_buf = new char[2*recv_max_prefetch];
   if (local) {
@@ -299,6 +310,7 @@ ssize_t AsyncConnection::read_bulk(char *buf, unsigned len)
                               << cs.fd() << dendl;
     return -1;
   }
+  account_load(nread);
   return nread;
 }
 
@@ -332,6 +344,7 @@ ssize_t AsyncConnection::_try_send(bool more)
   // network block would make ::send return EAGAIN, that would make here looks
   // like do not call cs.send() and r = 0
   ssize_t r = 0;
+  uint64_t queued = outgoing_bl.length();
   if (likely(!inject_network_congestion())) {
     r = cs.send(outgoing_bl, more);
   }
@@ -339,6 +352,7 @@ ssize_t AsyncConnection::_try_send(bool more)
     ldout(async_msgr->cct, 1) << __func__ << " send error: " << cpp_strerror(r) << dendl;
     return r;
   }
+  account_load(queued - outgoing_bl.length());
 
   ldout(async_msgr->cct, 10) << __func__ << " sent bytes " << r
                              << " remaining bytes " << outgoing_bl.length() << dendl;
@@ -376,6 +390,11 @@ bool AsyncConnection::inject_network_congestion() const {
 
 void AsyncConnection::process() {
   std::lock_guard<std::mutex> l(lock);
+  if (!center->in_thread()) {
+    // queued before we moved to another worker; follow the connection
+    center->dispatch_event_external(read_handler);
+    return;
+  }
   last_active = ceph::coarse_mono_clock::now();
   recv_start_time = ceph::mono_clock::now();
 
@@ -414,6 +433,8 @@ void AsyncConnection::process() {
             opts.priority = SOCKET_PRIORITY_MIN_DELAY;
           }
       }
+      opts.busy_poll_us =
+	async_msgr->cct->_conf.get_val<uint64_t>("ms_tcp_busy_poll_us");
       opts.connect_bind_addr = msgr->get_myaddrs().front();
       ssize_t r = worker->connect(target_addr, opts, &cs);
       if (r < 0) {
@@ -489,6 +510,7 @@ void AsyncConnection::process() {
 
   logger->tinc(l_msgr_running_recv_time,
                ceph::mono_clock::now() - recv_start_time);
+  maybe_migrate();
 }
 
 bool AsyncConnection::is_connected() {
@@ -645,6 +667,10 @@ void AsyncConnection::shutdown_socket() {
     center->delete_time_event(last_tick_id);
     last_tick_id = 0;
   }
+  if (coalesce_timer_id) {
+    center->delete_time_event(coalesce_timer_id);
+    coalesce_timer_id = 0;
+  }
   if (cs) {
     center->delete_file_event(cs.fd(), EVENT_READABLE | EVENT_WRITABLE);
     cs.shutdown();
@@ -728,11 +754,24 @@ void AsyncConnection::mark_down()
 void AsyncConnection::handle_write()
 {
   ldout(async_msgr->cct, 10) << __func__ << dendl;
+  if (async_msgr->get_stack()->rebalance_interval.count()) {
+    // queued before we moved to another worker; follow the connection
+    std::lock_guard<std::mutex> l(write_lock);
+    if (!center->in_thread()) {
+      center->dispatch_event_external(write_handler);
+      return;
+    }
+  }
+  load_units++;
   protocol->write_event();
 }
 
 void AsyncConnection::handle_write_callback() {
   std::lock_guard<std::mutex> l(lock);
+  if (!center->in_thread()) {
+    center->dispatch_event_external(write_callback_handler);
+    return;
+  }
   last_active = ceph::coarse_mono_clock::now();
   recv_start_time = ceph::mono_clock::now();
   write_lock.lock();
@@ -761,6 +800,7 @@ void AsyncConnection::cleanup() {
   delete write_callback_handler;
   delete wakeup_handler;
   delete tick_handler;
+  delete coalesce_handler;
   if (delay_state) {
     delete delay_state;
     delay_state = NULL;
@@ -775,6 +815,132 @@ void AsyncConnection::wakeup_from(uint64_t id)
   process();
 }
 
+void AsyncConnection::arm_coalesce_timer(uint64_t us)
+{
+  ceph_assert(center->in_thread());
+  if (!coalesce_timer_id) {
+    coalesce_timer_id = center->create_time_event(us, coalesce_handler);
+  }
+}
+
+void AsyncConnection::coalesce_wakeup(uint64_t id)
+{
+  if (id != coalesce_timer_id) {
+    return;
+  }
+  coalesce_timer_id = 0;
+  handle_write();
+}
+
+bool AsyncConnection::can_migrate() const
+{
+  // timers and delayed deliveries live in the current worker's event
+  // center; only move connections that have none of those pending
+  return state == STATE_CONNECTION_ESTABLISHED && !is_loopback && cs &&
+         !delay_state && register_time_events.empty() && !coalesce_timer_id &&
+         protocol->is_connected();
+}
+
+void AsyncConnection::maybe_migrate()
+{
+  const auto& interval = async_msgr->get_stack()->rebalance_interval;
+  if (!interval.count()) {
+    return;
+  }
+  // process() just stamped recv_start_time, which saves a clock read
+  auto elapsed = recv_start_time - load_stamp;
+  load_units++;
+  if (elapsed < interval) {
+    return;
+  }
+  uint64_t rate = load_units * 1000000 /
+    std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+  load_units = 0;
+  load_stamp = recv_start_time;
+  if (recv_start_time < next_migrate || !can_migrate()) {
+    return;
+  }
+  Worker *target = async_msgr->get_stack()->get_rebalance_target(worker, rate);
+  if (!target) {
+    return;
+  }
+  // don't bounce between workers while their rates settle
+  next_migrate = recv_start_time + interval * 10;
+  // we hold lock here; do the move once this event is done
+  center->submit_to(center->get_id(),
+                    [conn = AsyncConnectionRef(this), target] {
+                      conn->migrate_to(target);
+                    }, true);
+}
+
+void AsyncConnection::migrate_to(Worker *new_worker)
+{
+  std::lock_guard<std::mutex> l(lock);
+  std::lock_guard<std::mutex> wl(write_lock);
+  if (!can_migrate() || new_worker == worker) {
+    return;
+  }
+  if (!center->in_thread()) {
+    // ProtocolV2::reuse_connection() moved us to another worker after
+    // maybe_migrate() queued this; that move wins
+    ldout(async_msgr->cct, 10) << __func__ << " already moved, skipping"
+                               << dendl;
+    return;
+  }
+  ldout(async_msgr->cct, 5) << __func__ << " worker " << worker->id
+                            << " -> " << new_worker->id << dendl;
+  center->delete_file_event(cs.fd(), EVENT_READABLE | EVENT_WRITABLE);
+  if (last_tick_id) {
+    center->delete_time_event(last_tick_id);
+    last_tick_id = 0;
+  }
+  worker->references--;
+  new_worker->references++;
+  logger->dec(l_msgr_active_connections);
+  logger = new_worker->get_perf_counter();
+  labeled_logger = new_worker->get_labeled_perf_counter();
+  logger->inc(l_msgr_active_connections);
+  worker = new_worker;
+  center = &new_worker->center;
+  // events queued on the old worker from now on bounce over here, see
+  // process() and handle_write()
+  center->submit_to(center->get_id(),
+                    [conn = AsyncConnectionRef(this)] {
+                      conn->finish_migrate();
+                    }, true);
+}
+
+void AsyncConnection::finish_migrate()
+{
+  std::lock_guard<std::mutex> l(lock);
+  if (state != STATE_CONNECTION_ESTABLISHED || !cs) {
+    // faulted or closed in between; whoever did it cleaned up
+    return;
+  }
+  if (!center->in_thread()) {
+    // moved on again (reuse_connection()) before this ran; the later
+    // move registers the events on its own worker
+    return;
+  }
+  center->create_file_event(cs.fd(), EVENT_READABLE, read_handler);
+  {
+    std::lock_guard<std::mutex> wl(write_lock);
+    if (open_write) {
+      center->create_file_event(cs.fd(), EVENT_WRITABLE, write_handler);
+    }
+  }
+  if (!last_tick_id) {
+    // migrate_to() cancelled the old tick; don't add a second one if
+    // somebody armed a new tick here in the meantime
+    last_tick_id = center->create_time_event(inactive_timeout_us, tick_handler);
+  }
+  // the socket is edge triggered, so pick up whatever arrived meanwhile
+  center->dispatch_event_external(read_handler);
+  if (open_write) {
+    center->dispatch_event_external(write_handler);
+  }
+}
+
 void AsyncConnection::tick(uint64_t id)
 {
   auto now = ceph::coarse_mono_clock::now();
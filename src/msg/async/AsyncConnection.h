@@ -195,6 +195,7 @@ private:
   EventCallbackRef write_callback_handler;
   EventCallbackRef wakeup_handler;
   EventCallbackRef tick_handler;
+  EventCallbackRef coalesce_handler;
   char *recv_buf;
   uint32_t recv_max_prefetch;
   uint32_t recv_start;
@@ -204,6 +205,9 @@ private:
   ceph::coarse_mono_clock::time_point last_active;
   ceph::mono_clock::time_point recv_start_time;
   uint64_t last_tick_id = 0;
+  // ends a write held back by ms_async_coalesce_delay_us; only touched in
+  // the center thread
+  uint64_t coalesce_timer_id = 0;
   const uint64_t connect_timeout_us;
   const uint64_t inactive_timeout_us;
 
@@ -221,6 +225,22 @@ private:
   Worker *worker;
   EventCenter *center;
 
+  // load this connection put on its worker since load_stamp, in
+  // Worker::load_units; used to move hot connections to idle workers
+  uint64_t load_units = 0;
+  ceph::mono_clock::time_point load_stamp;
+  ceph::mono_clock::time_point next_migrate;
+
+  void account_load(uint64_t bytes) {
+    uint64_t units = bytes / Worker::LOAD_UNIT_BYTES;
+    load_units += units;
+    worker->add_load(units);
+  }
+  bool can_migrate() const;
+  void maybe_migrate();
+  void migrate_to(Worker *new_worker);
+  void finish_migrate();
+
   std::unique_ptr<Protocol> protocol;
 
   std::optional<std::function<void(ssize_t)>> writeCallback;
@@ -234,6 +254,8 @@ private:
   void handle_write_callback();
   void process();
   void wakeup_from(uint64_t id);
+  void arm_coalesce_timer(uint64_t us);
+  void coalesce_wakeup(uint64_t id);
   void tick(uint64_t id);
   void stop(bool queue_reset);
   void cleanup();
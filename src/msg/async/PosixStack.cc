@@ -21,6 +21,7 @@
 #include <errno.h>
 
 #include <algorithm>
+#include <deque>
 
 #include "PosixStack.h"
 
@@ -33,6 +34,11 @@
 #include "include/compat.h"
 #include "include/sock_compat.h"
 
+#if defined(__linux__) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+#include <linux/errqueue.h>
+#define CEPH_HAVE_MSG_ZEROCOPY
+#endif
+
 #define dout_subsys ceph_subsys_ms
 #undef dout_prefix
 #define dout_prefix *_dout << "PosixStack "
@@ -43,10 +49,78 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   entity_addr_t sa;
   bool connected;
 
+  // MSG_ZEROCOPY sends: the kernel keeps referencing the pages of what
+  // was sent until it posts a completion on the socket error queue, so
+  // the sent buffers are held here until then.  Each successful
+  // zerocopy sendmsg() gets the next notification id; TCP completes
+  // them in order.
+  PerfCounters *logger;
+  uint64_t zerocopy_threshold = 0;  ///< 0: always copy
+  struct zerocopy_pending_t {
+    uint32_t calls;                 ///< sendmsg() calls not yet completed
+    ceph::buffer::list bl;
+  };
+  std::deque<zerocopy_pending_t> zerocopy_pending;
+
+  void reap_zerocopy() {
+#ifdef CEPH_HAVE_MSG_ZEROCOPY
+    while (!zerocopy_pending.empty()) {
+      char control[128];
+      struct msghdr msg;
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_control = control;
+      msg.msg_controllen = sizeof(control);
+      if (::recvmsg(_fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+	break;  // nothing completed yet
+      }
+      for (auto cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+	if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) &&
+	    !(cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)) {
+	  continue;
+	}
+	auto serr = reinterpret_cast<struct sock_extended_err*>(CMSG_DATA(cm));
+	if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+	  continue;
+	}
+	if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+	  // e.g. loopback or a device without scatter-gather: the pinning
+	  // is pure overhead, copy from now on
+	  zerocopy_threshold = 0;
+	  if (logger) {
+	    logger->inc(l_msgr_send_zerocopy_copied);
+	  }
+	}
+	uint32_t done = serr->ee_data - serr->ee_info + 1;
+	while (done > 0 && !zerocopy_pending.empty()) {
+	  auto& p = zerocopy_pending.front();
+	  uint32_t n = std::min(done, p.calls);
+	  p.calls -= n;
+	  done -= n;
+	  if (p.calls == 0) {
+	    zerocopy_pending.pop_front();
+	  }
+	}
+      }
+    }
+#endif
+  }
+
  public:
   explicit PosixConnectedSocketImpl(ceph::NetHandler &h, const entity_addr_t &sa,
-				    int f, bool connected)
-      : handler(h), _fd(f), sa(sa), connected(connected) {}
+				    int f, bool connected,
+				    CephContext *cct = nullptr,
+				    PerfCounters *logger = nullptr)
+      : handler(h), _fd(f), sa(sa), connected(connected), logger(logger) {
+#ifdef CEPH_HAVE_MSG_ZEROCOPY
+    uint64_t threshold = cct ?
+      cct->_conf.get_val<Option::size_t>("ms_async_zerocopy_send_threshold") : 0;
+    int on = 1;
+    if (threshold > 0 &&
+	::setsockopt(_fd, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)) == 0) {
+      zerocopy_threshold = threshold;
+    }
+#endif
+  }
 
   int is_connected() override {
     if (connected)
@@ -64,6 +138,8 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   }
 
   ssize_t read(char *buf, size_t len) override {
+    // an error queue notification wakes us up as readable
+    reap_zerocopy();
     #ifdef _WIN32
     ssize_t r = ::recv(_fd, buf, len, 0);
     #else
@@ -77,22 +153,38 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   // return the sent length
   // < 0 means error occurred
   #ifndef _WIN32
-  static ssize_t do_sendmsg(int fd, struct msghdr &msg, unsigned len, bool more)
+  // with zerocopy_calls, try MSG_ZEROCOPY and count the sendmsg() calls
+  // that used it
+  static ssize_t do_sendmsg(int fd, struct msghdr &msg, unsigned len, bool more,
+			    uint32_t *zerocopy_calls = nullptr)
   {
     size_t sent = 0;
+    int zerocopy = 0;
+#ifdef CEPH_HAVE_MSG_ZEROCOPY
+    if (zerocopy_calls) {
+      zerocopy = MSG_ZEROCOPY;
+    }
+#endif
     while (1) {
       MSGR_SIGPIPE_STOPPER;
       ssize_t r;
-      r = ::sendmsg(fd, &msg, MSG_NOSIGNAL | (more ? MSG_MORE : 0));
+      r = ::sendmsg(fd, &msg, MSG_NOSIGNAL | (more ? MSG_MORE : 0) | zerocopy);
       if (r < 0) {
         int err = ceph_sock_errno();
         if (err == EINTR) {
           continue;
         } else if (err == EAGAIN) {
           break;
+        } else if (err == ENOBUFS && zerocopy) {
+          // out of optmem for notifications; copy this time
+          zerocopy = 0;
+          continue;
         }
         return -err;
       }
+      if (zerocopy) {
+        ++*zerocopy_calls;
+      }
 
       sent += r;
       if (len == sent) break;
@@ -114,6 +206,9 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   }
 
   ssize_t send(ceph::buffer::list &bl, bool more) override {
+    reap_zerocopy();
+    bool zerocopy = zerocopy_threshold && bl.length() >= zerocopy_threshold;
+    uint32_t zerocopy_calls = 0;
     size_t sent_bytes = 0;
     auto pb = std::cbegin(bl.buffers());
     uint64_t left_pbrs = bl.get_num_buffers();
@@ -133,9 +228,10 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
 	msglen += pb->length();
 	++pb;
       }
-      ssize_t r = do_sendmsg(_fd, msg, msglen, left_pbrs || more);
+      ssize_t r = do_sendmsg(_fd, msg, msglen, left_pbrs || more,
+			     zerocopy ? &zerocopy_calls : nullptr);
       if (r < 0)
-        return r;
+        return r;  // the connection faults; nothing it sent matters anymore
 
       // "r" is the remaining length
       sent_bytes += r;
@@ -150,7 +246,14 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
         bl.splice(sent_bytes, bl.length()-sent_bytes, &swapped);
         bl.swap(swapped);
       } else {
-        bl.clear();
+        swapped.swap(bl);
+      }
+      if (zerocopy_calls) {
+        if (logger) {
+          logger->inc(l_msgr_send_zerocopy_bytes, sent_bytes);
+        }
+        // swapped now holds what was sent
+        zerocopy_pending.push_back({zerocopy_calls, std::move(swapped)});
       }
     }
 
@@ -261,8 +364,10 @@ int PosixServerSocketImpl::accept(ConnectedSocket *sock, const SocketOptions &op
   out->set_type(addr_type);
   out->set_sockaddr((sockaddr*)&ss);
   handler.set_priority(sd, opt.priority, out->get_family());
+  handler.set_busy_poll(sd, opt.busy_poll_us);
 
-  std::unique_ptr<PosixConnectedSocketImpl> csi(new PosixConnectedSocketImpl(handler, *out, sd, true));
+  std::unique_ptr<PosixConnectedSocketImpl> csi(
+    new PosixConnectedSocketImpl(handler, *out, sd, true, w->cct, w->perf_logger));
   *sock = ConnectedSocket(std::move(csi));
   return 0;
 }
@@ -330,8 +435,10 @@ int PosixWorker::connect(const entity_addr_t &addr, const SocketOptions &opts, C
   }
 
   net.set_priority(sd, opts.priority, addr.get_family());
+  net.set_busy_poll(sd, opts.busy_poll_us);
   *socket = ConnectedSocket(
-      std::unique_ptr<PosixConnectedSocketImpl>(new PosixConnectedSocketImpl(net, addr, sd, !opts.nonblock)));
+      std::unique_ptr<PosixConnectedSocketImpl>(
+        new PosixConnectedSocketImpl(net, addr, sd, !opts.nonblock, cct, perf_logger)));
   return 0;
 }
 
@@ -141,6 +141,7 @@ void ProtocolV2::discard_out_queue() {
   }
   out_queue.clear();
   write_in_progress = false;
+  coalesce_reset();
 }
 
 void ProtocolV2::reset_session() {
@@ -191,6 +192,7 @@ void ProtocolV2::fault() { _fault(); }
 
 void ProtocolV2::requeue_sent() {
   write_in_progress = false;
+  coalesce_reset();
   if (sent.empty()) {
     return;
   }
@@ -461,9 +463,16 @@ void ProtocolV2::send_message(Message *m) {
       out_queue_entry_t{is_prepared, m});
     ldout(cct, 15) << __func__ << " inline write is denied, reschedule m=" << m
                    << dendl;
+    coalesce_pending += m->get_payload().length() + m->get_middle().length() +
+                        m->get_data().length();
     if (((!replacing && can_write) || state == STANDBY) && !write_in_progress) {
       write_in_progress = true;
       connection->center->dispatch_event_external(connection->write_handler);
+    } else if (coalesce_waiting &&
+               coalesce_pending >= cct->_conf->ms_async_coalesce_bytes) {
+      // enough gathered, don't wait for the timer
+      coalesce_waiting = false;
+      connection->center->dispatch_event_external(connection->write_handler);
     }
   }
 }
@@ -560,18 +569,26 @@ ssize_t ProtocolV2::write_message(Message *m, bool more) {
                  << " off=" << header2.data_off
                  << dendl;
   ssize_t total_send_size = connection->outgoing_bl.length();
-  ssize_t rc = connection->_try_send(more);
-  if (rc < 0) {
-    ldout(cct, 1) << __func__ << " error sending " << m << ", "
-                  << cpp_strerror(rc) << dendl;
+  ssize_t rc = 0;
+  if (more &&
+      (uint64_t)total_send_size < cct->_conf->ms_async_coalesce_bytes) {
+    // the next message goes out in the same send call
+    ldout(cct, 20) << __func__ << " coalescing " << m << ", "
+                   << total_send_size << " bytes pending" << dendl;
   } else {
-    const auto sent_bytes = total_send_size - connection->outgoing_bl.length();
-    connection->logger->inc(l_msgr_send_bytes, sent_bytes);
-    if (session_stream_handlers.tx) {
-      connection->logger->inc(l_msgr_send_encrypted_bytes, sent_bytes);
+    rc = connection->_try_send(more);
+    if (rc < 0) {
+      ldout(cct, 1) << __func__ << " error sending " << m << ", "
+                    << cpp_strerror(rc) << dendl;
+    } else {
+      const auto sent_bytes = total_send_size - connection->outgoing_bl.length();
+      connection->logger->inc(l_msgr_send_bytes, sent_bytes);
+      if (session_stream_handlers.tx) {
+        connection->logger->inc(l_msgr_send_encrypted_bytes, sent_bytes);
+      }
+      ldout(cct, 10) << __func__ << " sending " << m
+                     << (rc ? " continuely." : " done.") << dendl;
     }
-    ldout(cct, 10) << __func__ << " sending " << m
-                   << (rc ? " continuely." : " done.") << dendl;
   }
 
 #if defined(WITH_EVENTTRACE)
@@ -637,6 +654,38 @@ void ProtocolV2::reset_compression() {
   session_compression_handlers.tx.reset(nullptr);
 }
 
+void ProtocolV2::coalesce_reset() {
+  coalesce_waiting = false;
+  coalesce_pending = 0;
+  coalesce_start = ceph::mono_time();
+}
+
+bool ProtocolV2::coalesce_wait() {
+  const uint64_t delay_us = cct->_conf->ms_async_coalesce_delay_us;
+  if (!delay_us || out_queue.empty() || connection->is_queued() ||
+      coalesce_pending >= cct->_conf->ms_async_coalesce_bytes) {
+    coalesce_reset();
+    return false;
+  }
+  auto now = ceph::mono_clock::now();
+  if (coalesce_start == ceph::mono_time()) {
+    coalesce_start = now;
+  }
+  auto waited = std::chrono::duration_cast<std::chrono::microseconds>(
+    now - coalesce_start).count();
+  if ((uint64_t)waited >= delay_us) {
+    coalesce_reset();
+    return false;
+  }
+  ldout(cct, 20) << __func__ << " holding " << coalesce_pending
+                 << " bytes for " << delay_us - waited << "us" << dendl;
+  // send_message() must not schedule another write meanwhile
+  write_in_progress = true;
+  coalesce_waiting = true;
+  connection->arm_coalesce_timer(delay_us - waited);
+  return true;
+}
+
 void ProtocolV2::write_event() {
   ldout(cct, 10) << __func__ << dendl;
   ssize_t r = 0;
@@ -656,10 +705,16 @@ void ProtocolV2::write_event() {
       keepalive = false;
     }
 
+    if (coalesce_wait()) {
+      connection->write_lock.unlock();
+      return;
+    }
+
     auto start = ceph::mono_clock::now();
     bool more;
     do {
-      if (connection->is_queued()) {
+      if (connection->is_queued() &&
+	  connection->outgoing_bl.length() >= cct->_conf->ms_async_coalesce_bytes) {
 	if (r = connection->_try_send(); r!= 0) {
 	  // either fails to send or not all queued buffer is sent
 	  break;
@@ -1190,22 +1245,64 @@ CtPtr ProtocolV2::read_frame_segment() {
   }
 
   rx_buffer_t rx_buffer;
-  uint16_t align = rx_frame_asm.get_segment_align(seg_idx);
-  try {
-    rx_buffer = ceph::buffer::ptr_node::create(ceph::buffer::create_aligned(
-        onwire_len, align));
-  } catch (const ceph::buffer::bad_alloc&) {
-    // Catching because of potential issues with satisfying alignment.
-    ldout(cct, 1) << __func__ << " can't allocate aligned rx_buffer"
-                  << " len=" << onwire_len
-                  << " align=" << align
-                  << dendl;
-    return _fault();
+  if (next_tag == Tag::MESSAGE && seg_idx == SegmentIndex::Msg::DATA &&
+      !session_stream_handlers.rx && !rx_frame_asm.is_compressed()) {
+    // in crc mode the data goes to the buffer untouched
+    rx_buffer = alloc_message_data_rx_buffer(onwire_len);
+  }
+  if (!rx_buffer) {
+    uint16_t align = rx_frame_asm.get_segment_align(seg_idx);
+    try {
+      rx_buffer = ceph::buffer::ptr_node::create(ceph::buffer::create_aligned(
+          onwire_len, align));
+    } catch (const ceph::buffer::bad_alloc&) {
+      // Catching because of potential issues with satisfying alignment.
+      ldout(cct, 1) << __func__ << " can't allocate aligned rx_buffer"
+                    << " len=" << onwire_len
+                    << " align=" << align
+                    << dendl;
+      return _fault();
+    }
   }
 
   return READ_RXBUF(std::move(rx_buffer), handle_read_frame_segment);
 }
 
+rx_buffer_t ProtocolV2::alloc_message_data_rx_buffer(uint32_t len)
+{
+  // the header segment is in already; its crc is only checked along with
+  // the epilogue, so use it for the buffer layout and nothing else
+  ceph_msg_header2 header;
+  const auto& header_bl = rx_segments_data[SegmentIndex::Msg::HEADER];
+  if (header_bl.length() < sizeof(header)) {
+    return {};
+  }
+  header_bl.begin().copy(sizeof(header), reinterpret_cast<char*>(&header));
+
+  ceph::bufferptr bp;
+  if (messenger->ms_deliver_get_data_buffer(connection, header, len, &bp)) {
+    if (bp.length() == len) {
+      ldout(cct, 20) << __func__ << " using dispatcher buffer len=" << len
+                     << dendl;
+      return ceph::buffer::ptr_node::create(std::move(bp));
+    }
+    ldout(cct, 1) << __func__ << " ignoring dispatcher buffer of "
+                  << bp.length() << " bytes for " << len << dendl;
+  }
+
+  // same layout as msgr1: the buffer's page boundaries match those of the
+  // data at data_off, so an unaligned write is aligned past its head
+  unsigned off = header.data_off & ~CEPH_PAGE_MASK;
+  unsigned head = off ? std::min<unsigned>(CEPH_PAGE_SIZE - off, len) : 0;
+  ceph::bufferptr ptr(ceph::buffer::create_small_page_aligned(
+    (head ? CEPH_PAGE_SIZE : 0) + len - head));
+  if (head) {
+    ptr.set_offset(CEPH_PAGE_SIZE - head);
+  }
+  ptr.set_length(len);
+  return ceph::buffer::ptr_node::create(std::move(ptr));
+}
+
 CtPtr ProtocolV2::handle_read_frame_segment(rx_buffer_t &&rx_buffer, int r) {
   ldout(cct, 20) << __func__ << " r=" << r << dendl;
 
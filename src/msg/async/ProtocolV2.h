@@ -122,6 +122,11 @@ private:
   bool keepalive;
   bool write_in_progress = false;
 
+  // small messages held back by ms_async_coalesce_delay_us; under write_lock
+  bool coalesce_waiting = false;
+  uint64_t coalesce_pending = 0;  // bytes queued since the last flush
+  ceph::mono_time coalesce_start;
+
   CompConnectionMeta comp_meta;
   std::ostream& _conn_prefix(std::ostream *_dout);
   void run_continuation(Ct<ProtocolV2> *pcontinuation);
@@ -151,6 +156,10 @@ private:
   void prepare_send_message(uint64_t features, Message *m);
   out_queue_entry_t _get_next_outgoing();
   ssize_t write_message(Message *m, bool more);
+  void coalesce_reset();
+  // hold the queued messages back for more to join them, see
+  // ms_async_coalesce_delay_us; true if the write was postponed
+  bool coalesce_wait();
   void handle_message_ack(uint64_t seq);
   void reset_compression();
 
@@ -180,6 +189,7 @@ private:
   Ct<ProtocolV2> *finish_server_auth();
   Ct<ProtocolV2> *handle_read_frame_preamble_main(rx_buffer_t &&buffer, int r);
   Ct<ProtocolV2> *read_frame_segment();
+  rx_buffer_t alloc_message_data_rx_buffer(uint32_t len);
   Ct<ProtocolV2> *handle_read_frame_segment(rx_buffer_t &&rx_buffer, int r);
   Ct<ProtocolV2> *_handle_read_frame_segment();
   Ct<ProtocolV2> *handle_read_frame_epilogue_main(rx_buffer_t &&buffer, int r);
@@ -39,6 +39,16 @@ std::function<void ()> NetworkStack::add_thread(Worker* w)
   return [this, w]() {
       rename_thread(w->id);
       const unsigned EventMaxWaitUs = 30000000;
+      const auto busy_poll = std::chrono::microseconds(
+        cct->_conf.get_val<uint64_t>("ms_async_busy_poll_us"));
+      // while now < spin_until we poll without sleeping; spin_start is
+      // when the current window began
+      ceph::mono_time spin_start, spin_until;
+      // an idle worker must still wake up to report its load
+      const unsigned wait_us = rebalance_interval.count() ?
+        std::min<unsigned>(EventMaxWaitUs, rebalance_interval.count() * 1000) :
+        EventMaxWaitUs;
+      ceph::mono_time load_stamp = ceph::mono_clock::now();
       w->center.set_owner();
       ldout(cct, 10) << __func__ << " starting" << dendl;
       w->initialize();
@@ -46,14 +56,47 @@ std::function<void ()> NetworkStack::add_thread(Worker* w)
       while (!w->done) {
         ldout(cct, 30) << __func__ << " calling event process" << dendl;
 
+        bool spinning = false;
+        if (busy_poll.count()) {
+          spinning = ceph::mono_clock::now() < spin_until;
+        }
         ceph::timespan dur;
-        int r = w->center.process_events(EventMaxWaitUs, &dur);
+        int r = w->center.process_events(spinning ? 0 : wait_us, &dur);
         if (r < 0) {
           ldout(cct, 20) << __func__ << " process events failed: "
                          << cpp_strerror(errno) << dendl;
           // TODO do something?
         }
         w->perf_logger->tinc(l_msgr_running_total_time, dur);
+
+        if (!busy_poll.count() && !rebalance_interval.count()) {
+          continue;
+        }
+        auto now = ceph::mono_clock::now();
+        if (rebalance_interval.count()) {
+          if (r > 0) {
+            w->add_load(r);
+          }
+          if (now - load_stamp >= rebalance_interval) {
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+              now - load_stamp).count();
+            w->load_rate = w->load_units * 1000000 / us;
+            w->load_units = 0;
+            load_stamp = now;
+          }
+        }
+        if (busy_poll.count()) {
+          if (r > 0) {
+            if (spinning) {
+              w->perf_logger->inc(l_msgr_busy_poll_hits);
+            }
+            spin_start = now;
+            spin_until = now + busy_poll;
+          } else if (spinning && now >= spin_until) {
+            w->perf_logger->inc(l_msgr_busy_poll_misses);
+            w->perf_logger->tinc(l_msgr_busy_poll_wasted_time, now - spin_start);
+          }
+        }
       }
       w->reset();
       w->destroy();
@@ -105,7 +148,9 @@ std::shared_ptr<NetworkStack> NetworkStack::create(CephContext *c,
 }
 
 NetworkStack::NetworkStack(CephContext *c)
-  : cct(c)
+  : rebalance_interval(
+      c->_conf.get_val<std::chrono::milliseconds>("ms_async_rebalance_interval")),
+    cct(c)
 {}
 
 void NetworkStack::start()
@@ -155,6 +200,37 @@ Worker* NetworkStack::get_worker()
   return current_best;
 }
 
+Worker* NetworkStack::get_rebalance_target(Worker *from, uint64_t conn_rate)
+{
+  uint64_t from_rate = from->load_rate.load();
+  uint64_t min_rate = from_rate;
+  Worker* target = nullptr;
+
+  pool_spin.lock();
+  for (Worker* worker : workers) {
+    uint64_t worker_rate = worker->load_rate.load();
+    if (worker_rate < min_rate) {
+      target = worker;
+      min_rate = worker_rate;
+    }
+  }
+  pool_spin.unlock();
+
+  // moving must narrow the gap rather than flip it, and the gap has to be
+  // worth a migration: at least a quarter of the busy worker's load
+  uint64_t gap = from_rate - min_rate;
+  if (!target || conn_rate == 0 || conn_rate >= gap || gap * 4 < from_rate) {
+    return nullptr;
+  }
+  ldout(cct, 10) << __func__ << " worker " << from->id << " (" << from_rate
+		 << ") -> " << target->id << " (" << min_rate << ") for "
+		 << conn_rate << dendl;
+  // account for the move right away so that other connections on the busy
+  // worker don't all pile onto the same target in this interval
+  target->load_rate += conn_rate;
+  return target;
+}
+
 void NetworkStack::stop()
 {
   std::lock_guard lk(pool_spin);
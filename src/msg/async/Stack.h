@@ -43,6 +43,7 @@ struct SocketOptions {
   bool nodelay = true;
   int rcbuf_size = 0;
   int priority = -1;
+  int busy_poll_us = 0;  ///< SO_BUSY_POLL, 0 leaves it unset
   entity_addr_t connect_bind_addr;
 };
 
@@ -213,6 +214,13 @@ enum {
   l_msgr_recv_encrypted_bytes,
   l_msgr_send_encrypted_bytes,
 
+  l_msgr_send_zerocopy_bytes,
+  l_msgr_send_zerocopy_copied,
+
+  l_msgr_busy_poll_hits,
+  l_msgr_busy_poll_misses,
+  l_msgr_busy_poll_wasted_time,
+
   l_msgr_last,
 };
 
@@ -241,6 +249,14 @@ class Worker {
   std::atomic_uint references;
   EventCenter center;
 
+  // load seen by this worker, for moving connections between workers; one
+  // unit is an event handled or LOAD_UNIT_BYTES moved.  load_units is only
+  // touched by the worker's own thread, load_rate (units per second over
+  // the last interval) is read by connections on other workers.
+  static constexpr uint64_t LOAD_UNIT_BYTES = 4096;
+  uint64_t load_units = 0;
+  std::atomic<uint64_t> load_rate = {0};
+
   Worker(const Worker&) = delete;
   Worker& operator=(const Worker&) = delete;
 
@@ -271,6 +287,13 @@ class Worker {
     plb.add_u64_counter(l_msgr_recv_encrypted_bytes, "msgr_recv_encrypted_bytes", "Network received encrypted bytes", NULL, 0, unit_t(UNIT_BYTES));
     plb.add_u64_counter(l_msgr_send_encrypted_bytes, "msgr_send_encrypted_bytes", "Network sent encrypted bytes", NULL, 0, unit_t(UNIT_BYTES));
 
+    plb.add_u64_counter(l_msgr_send_zerocopy_bytes, "msgr_send_zerocopy_bytes", "Network bytes sent with MSG_ZEROCOPY", NULL, 0, unit_t(UNIT_BYTES));
+    plb.add_u64_counter(l_msgr_send_zerocopy_copied, "msgr_send_zerocopy_copied", "Zerocopy sends the kernel completed by copying");
+
+    plb.add_u64_counter(l_msgr_busy_poll_hits, "msgr_busy_poll_hits", "Busy poll windows that found new events");
+    plb.add_u64_counter(l_msgr_busy_poll_misses, "msgr_busy_poll_misses", "Busy poll windows that ran out without events");
+    plb.add_time(l_msgr_busy_poll_wasted_time, "msgr_busy_poll_wasted_time", "Time spent in busy poll windows that found nothing");
+
     perf_logger = plb.create_perf_counters();
     cct->get_perfcounters_collection()->add(perf_logger);
 
@@ -317,6 +340,9 @@ class Worker {
     int oldref = references.fetch_sub(1);
     ceph_assert(oldref > 0);
   }
+  void add_load(uint64_t units) {
+    load_units += units;
+  }
   void init_done() {
     init_lock.lock();
     init = true;
@@ -361,6 +387,9 @@ class NetworkStack {
 
   explicit NetworkStack(CephContext *c);
  public:
+  /// how often load is sampled for rebalancing connections, 0 disables
+  const std::chrono::milliseconds rebalance_interval;
+
   NetworkStack(const NetworkStack &) = delete;
   NetworkStack& operator=(const NetworkStack &) = delete;
   virtual ~NetworkStack() {
@@ -383,6 +412,8 @@ class NetworkStack {
   void start();
   void stop();
   virtual Worker *get_worker();
+  /// worker a connection putting conn_rate on from should move to, if any
+  Worker *get_rebalance_target(Worker *from, uint64_t conn_rate);
   Worker *get_worker(unsigned worker_id) {
     return workers[worker_id];
   }
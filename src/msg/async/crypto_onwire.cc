@@ -105,6 +105,14 @@ void AES128GCM_OnWireTxHandler::reset_tx_handler(const uint32_t* first,
   }
 }
 
+// A frame's plaintext is often a long chain of small bufferptrs (message
+// header, footer, encoded op vectors...).  Feeding them to EVP one by one
+// keeps OpenSSL off its pipelined AES-NI/VAES GCM path, which only kicks
+// in for large updates.  Small pieces are therefore first copied into the
+// output buffer and encrypted in place with a single call per run; large
+// ones still go straight through.
+static constexpr const std::size_t AESGCM_COALESCE_MAX{4096};
+
 void AES128GCM_OnWireTxHandler::authenticated_encrypt_update(
   const ceph::bufferlist& plaintext)
 {
@@ -112,19 +120,37 @@ void AES128GCM_OnWireTxHandler::authenticated_encrypt_update(
               plaintext.length());
   auto filler = buffer.append_hole(plaintext.length());
 
-  for (const auto& plainbuf : plaintext.buffers()) {
+  // [0, pending) bytes at filler.c_str() are copied but not yet encrypted
+  unsigned pending = 0;
+  auto encrypt = [this, &filler](const char* in, unsigned len) {
     int update_len = 0;
 
     if(1 != EVP_EncryptUpdate(ectx.get(),
 	reinterpret_cast<unsigned char*>(filler.c_str()),
 	&update_len,
-	reinterpret_cast<const unsigned char*>(plainbuf.c_str()),
-	plainbuf.length())) {
+	reinterpret_cast<const unsigned char*>(in),
+	len)) {
       throw std::runtime_error("EVP_EncryptUpdate failed");
     }
     ceph_assert_always(update_len >= 0);
-    ceph_assert(static_cast<unsigned>(update_len) == plainbuf.length());
+    ceph_assert(static_cast<unsigned>(update_len) == len);
     filler.advance(update_len);
+  };
+
+  for (const auto& plainbuf : plaintext.buffers()) {
+    if (plainbuf.length() < AESGCM_COALESCE_MAX) {
+      ::memcpy(filler.c_str() + pending, plainbuf.c_str(), plainbuf.length());
+      pending += plainbuf.length();
+      continue;
+    }
+    if (pending) {
+      encrypt(filler.c_str(), pending);
+      pending = 0;
+    }
+    encrypt(plainbuf.c_str(), plainbuf.length());
+  }
+  if (pending) {
+    encrypt(filler.c_str(), pending);
   }
 
   ldout(cct, 15) << __func__
@@ -221,15 +247,35 @@ void AES128GCM_OnWireRxHandler::authenticated_decrypt_update(
 {
   // discard cached crcs as we will be writing through c_str()
   bl.invalidate_crc();
-  for (auto& buf : bl.buffers()) {
-    auto p = reinterpret_cast<unsigned char*>(const_cast<char*>(buf.c_str()));
+
+  // segments usually arrive through one large read, so neighbouring
+  // bufferptrs tend to be adjacent in memory; decrypt such runs at once
+  unsigned char* run = nullptr;
+  unsigned run_len = 0;
+  auto decrypt = [this](unsigned char* p, unsigned len) {
     int update_len = 0;
 
-    if (1 != EVP_DecryptUpdate(ectx.get(), p, &update_len, p, buf.length())) {
+    if (1 != EVP_DecryptUpdate(ectx.get(), p, &update_len, p, len)) {
       throw std::runtime_error("EVP_DecryptUpdate failed");
     }
     ceph_assert_always(update_len >= 0);
-    ceph_assert(static_cast<unsigned>(update_len) == buf.length());
+    ceph_assert(static_cast<unsigned>(update_len) == len);
+  };
+
+  for (auto& buf : bl.buffers()) {
+    auto p = reinterpret_cast<unsigned char*>(const_cast<char*>(buf.c_str()));
+    if (run && run + run_len == p) {
+      run_len += buf.length();
+      continue;
+    }
+    if (run_len) {
+      decrypt(run, run_len);
+    }
+    run = p;
+    run_len = buf.length();
+  }
+  if (run_len) {
+    decrypt(run, run_len);
   }
 }
 
@@ -317,6 +317,10 @@ public:
                             bufferlist segments_bls[], 
                             bufferlist& epilogue_bl) const;
 
+  bool is_compressed() const { 
+    return m_flags & FRAME_EARLY_DATA_COMPRESSED; 
+  }
+
 private:
   struct segment_desc_t {
     uint32_t logical_len;
@@ -332,10 +336,6 @@ private:
     return m_crypto->rx->get_extra_size_at_final();
   }
 
-  bool is_compressed() const { 
-    return m_flags & FRAME_EARLY_DATA_COMPRESSED; 
-  }
-
   void asm_compress(bufferlist segment_bls[]);
 
   bufferlist asm_crc_rev0(const preamble_block_t& preamble,
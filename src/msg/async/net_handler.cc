@@ -168,6 +168,21 @@ void NetHandler::set_priority(int sd, int prio, int domain)
 #endif	// SO_PRIORITY
 }
 
+void NetHandler::set_busy_poll(int sd, int usec)
+{
+#ifdef SO_BUSY_POLL
+  if (usec <= 0) {
+    return;
+  }
+  int r = ::setsockopt(sd, SOL_SOCKET, SO_BUSY_POLL, (SOCKOPT_VAL_TYPE)&usec, sizeof(usec));
+  if (r < 0) {
+    r = ceph_sock_errno();
+    ldout(cct, 0) << __func__ << " couldn't set SO_BUSY_POLL to " << usec
+		  << ": " << cpp_strerror(r) << dendl;
+  }
+#endif	// SO_BUSY_POLL
+}
+
 int NetHandler::generic_connect(const entity_addr_t& addr, const entity_addr_t &bind_addr, bool nonblock)
 {
   int ret;
@@ -941,10 +941,60 @@ Infiniband::MemoryManager::MemoryManager(CephContext *c, Device *d, ProtectionDo
 
 Infiniband::MemoryManager::~MemoryManager()
 {
+  reg_map.clear();
+  reg_lru.clear();
   if (send)
     delete send;
 }
 
+Infiniband::MemoryManager::Region::Region(ProtectionDomain *pd,
+                                          const ceph::buffer::ptr& p)
+  : bp(p),
+    // the whole raw is registered, so any later slice of it hits the cache
+    mr(ibv_reg_mr(pd->pd, const_cast<char*>(p.raw_c_str()), p.raw_length(), 0))
+{
+}
+
+Infiniband::MemoryManager::Region::~Region()
+{
+  if (mr)
+    ibv_dereg_mr(mr);
+}
+
+Infiniband::MemoryManager::RegionRef
+Infiniband::MemoryManager::get_region(const ceph::buffer::ptr& p, bool *hit)
+{
+  std::list<RegionRef> evicted;
+  std::lock_guard l{reg_lock};
+  auto it = reg_map.find(p.raw_c_str());
+  if (it != reg_map.end()) {
+    *hit = true;
+    reg_lru.splice(reg_lru.begin(), reg_lru, it->second);
+    return *it->second;
+  }
+  *hit = false;
+  auto region = std::make_shared<Region>(pd, p);
+  if (!region->mr) {
+    ldout(cct, 1) << __func__ << " failed to register " << p.raw_length()
+                  << " bytes: " << cpp_strerror(errno) << dendl;
+    return nullptr;
+  }
+  uint64_t max_bytes = cct->_conf->ms_async_rdma_reg_cache_size;
+  if (p.raw_length() > max_bytes)
+    return region;
+  reg_lru.push_front(region);
+  reg_map[p.raw_c_str()] = reg_lru.begin();
+  reg_bytes += p.raw_length();
+  while (reg_bytes > max_bytes) {
+    auto& victim = reg_lru.back();
+    reg_bytes -= victim->bp.raw_length();
+    reg_map.erase(victim->bp.raw_c_str());
+    // deregister outside of the lock
+    evicted.splice(evicted.begin(), reg_lru, std::prev(reg_lru.end()));
+  }
+  return region;
+}
+
 void* Infiniband::MemoryManager::huge_pages_malloc(size_t size)
 {
   size_t real_size = ALIGN_TO_PAGE_2MB(size) + HUGE_PAGE_SIZE_2MB;
@@ -1105,6 +1155,21 @@ void Infiniband::init()
   ldout(cct, 1) << __func__ << " device allow " << device->device_attr.max_cqe
                 << " completion entries" << dendl;
 
+  // zero-copy sends are not accounted in the tx pool, give them their
+  // own share of the send queue
+  if (cct->_conf->ms_async_rdma_zerocopy_threshold) {
+    tx_zc_queue_len = std::min<uint32_t>(
+      device->device_attr.max_qp_wr - 1 - tx_queue_len,
+      cct->_conf->ms_async_rdma_send_buffers);
+    if (tx_zc_queue_len) {
+      ldout(cct, 1) << __func__ << " reserving " << tx_zc_queue_len
+                    << " send WRs for zero-copy sends" << dendl;
+    } else {
+      ldout(cct, 0) << __func__ << " no send WRs left for zero-copy sends,"
+                    << " disabling them" << dendl;
+    }
+  }
+
   memory_manager = new MemoryManager(cct, device, pd);
   memory_manager->create_tx_pool(cct->_conf->ms_async_rdma_buffer_size, tx_queue_len);
 
@@ -1165,7 +1230,8 @@ Infiniband::QueuePair* Infiniband::create_queue_pair(CephContext *cct, Completio
     CompletionQueue* rx, ibv_qp_type type, struct rdma_cm_id *cm_id)
 {
   Infiniband::QueuePair *qp = new QueuePair(
-      cct, *this, type, ib_physical_port, srq, tx, rx, tx_queue_len, rx_queue_len, cm_id);
+      cct, *this, type, ib_physical_port, srq, tx, rx, tx_queue_len + tx_zc_queue_len,
+      rx_queue_len, cm_id);
   if (qp->init()) {
     delete qp;
     return NULL;
@@ -26,7 +26,10 @@
 
 #include <atomic>
 #include <functional>
+#include <list>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "include/common_fwd.h"
@@ -183,6 +186,9 @@ enum {
 
   l_msgr_rdma_tx_chunks,
   l_msgr_rdma_tx_bytes,
+  l_msgr_rdma_tx_zerocopy_bytes,
+  l_msgr_rdma_reg_cache_hit,
+  l_msgr_rdma_reg_cache_miss,
   l_msgr_rdma_rx_chunks,
   l_msgr_rdma_rx_bytes,
   l_msgr_rdma_pending_sent_conns,
@@ -339,6 +345,30 @@ class Infiniband {
       }
     };
 
+    /**
+     * registration of a bufferlist buffer sent without copying it into
+     * a tx chunk. The region keeps a reference to the buffer, so its
+     * memory can't be freed and handed out again while it is still
+     * registered.
+     */
+    class Region {
+     public:
+      Region(ProtectionDomain *pd, const ceph::buffer::ptr& p);
+      ~Region();
+
+      ceph::buffer::ptr bp;
+      ibv_mr *mr;
+    };
+    typedef std::shared_ptr<Region> RegionRef;
+
+    // wr_id of a zero-copy send is a heap RegionRef with the low bit set
+    static uint64_t region_to_wr_id(RegionRef *r) {
+      return reinterpret_cast<uint64_t>(r) | 1;
+    }
+    static RegionRef *wr_id_to_region(uint64_t wr_id) {
+      return (wr_id & 1) ? reinterpret_cast<RegionRef*>(wr_id & ~1ull) : nullptr;
+    }
+
     MemoryManager(CephContext *c, Device *d, ProtectionDomain *p);
     ~MemoryManager();
 
@@ -372,6 +402,9 @@ class Infiniband {
       rxbuf_pool_ctx.set_stat_logger(logger);
     }
 
+    /// look up or register the memory of p, hit tells if it was cached
+    RegionRef get_region(const ceph::buffer::ptr& p, bool *hit);
+
     CephContext  *cct;
    private:
     // TODO: Cluster -> TxPool txbuf_pool
@@ -383,6 +416,11 @@ class Infiniband {
     MemPoolContext rxbuf_pool_ctx;
     mem_pool     rxbuf_pool;
 
+    // regions of zero-copy sends, most recently used first
+    ceph::mutex reg_lock = ceph::make_mutex("MemoryManager::reg_lock");
+    std::list<RegionRef> reg_lru;
+    std::unordered_map<const char*, std::list<RegionRef>::iterator> reg_map;
+    uint64_t reg_bytes = 0;
 
     void* huge_pages_malloc(size_t size);
     void  huge_pages_free(void *ptr);
@@ -390,6 +428,7 @@ class Infiniband {
 
  private:
   uint32_t tx_queue_len = 0;
+  uint32_t tx_zc_queue_len = 0;       // send WRs left for zero-copy sends
   uint32_t rx_queue_len = 0;
   uint32_t max_sge = 0;
   uint8_t  ib_physical_port = 0;
@@ -586,6 +625,7 @@ class Infiniband {
   static const char* wc_status_to_string(int status);
   static const char* qp_state_string(int status);
   uint32_t get_rx_queue_len() const { return rx_queue_len; }
+  uint32_t get_tx_zc_queue_len() const { return tx_zc_queue_len; }
 };
 
 #endif
@@ -419,8 +419,38 @@ ssize_t RDMAConnectedSocketImpl::submit(bool more)
   auto it = std::cbegin(pending_bl.buffers());
   auto copy_start = it;
   size_t total_copied = 0, wait_copy_len = 0;
+  uint64_t zc_threshold = ib->get_tx_zc_queue_len() ?
+    (uint64_t)cct->_conf->ms_async_rdma_zerocopy_threshold : 0;
+  uint32_t max_wr_len = cct->_conf->ms_async_rdma_buffer_size;
   while (it != pending_bl.buffers().end()) {
-    if (ib->is_tx_buffer(it->raw_c_str())) {
+    if (zc_threshold && it->length() >= zc_threshold &&
+        !ib->is_tx_buffer(it->raw_c_str()) &&
+        dispatcher->reserve_zerocopy_wrs((it->length() + max_wr_len - 1) / max_wr_len)) {
+      // chunks gathered so far have to go out ahead of this buffer
+      if (wait_copy_len) {
+        size_t copied = tx_copy_chunk(tx_buffers, wait_copy_len, copy_start, it);
+        total_copied += copied;
+        if (copied < wait_copy_len) {
+          dispatcher->zc_inflight -= (it->length() + max_wr_len - 1) / max_wr_len;
+          goto sending;
+        }
+        wait_copy_len = 0;
+      }
+      if (!tx_buffers.empty()) {
+        int r = post_work_request(tx_buffers);
+        tx_buffers.clear();
+        if (r < 0) {
+          dispatcher->zc_inflight -= (it->length() + max_wr_len - 1) / max_wr_len;
+          return r;
+        }
+      }
+      ceph_assert(copy_start == it);
+      int r = post_zerocopy_request(*it);
+      if (r < 0)
+        return r;
+      total_copied += it->length();
+      ++copy_start;
+    } else if (ib->is_tx_buffer(it->raw_c_str())) {
       if (wait_copy_len) {
         size_t copied = tx_copy_chunk(tx_buffers, wait_copy_len, copy_start, it);
         total_copied += copied;
@@ -456,9 +486,11 @@ ssize_t RDMAConnectedSocketImpl::submit(bool more)
   ldout(cct, 20) << __func__ << " left bytes: " << pending_bl.length() << " in buffers "
                  << pending_bl.get_num_buffers() << " tx chunks " << tx_buffers.size() << dendl;
 
-  int r = post_work_request(tx_buffers);
-  if (r < 0)
-    return r;
+  if (!tx_buffers.empty()) {
+    int r = post_work_request(tx_buffers);
+    if (r < 0)
+      return r;
+  }
 
   ldout(cct, 20) << __func__ << " finished sending " << total_copied << " bytes." << dendl;
   return pending_bl.length() ? -EAGAIN : 0;
@@ -515,6 +547,64 @@ int RDMAConnectedSocketImpl::post_work_request(std::vector<Chunk*> &tx_buffers)
   return 0;
 }
 
+/*
+ * Send bp from its own memory, split into WRs that fit the peer's receive
+ * chunks. The WRs must already be reserved with the dispatcher, each one
+ * gives its reservation back on completion.
+ */
+int RDMAConnectedSocketImpl::post_zerocopy_request(const ceph::buffer::ptr& bp)
+{
+  uint32_t max_wr_len = cct->_conf->ms_async_rdma_buffer_size;
+  uint32_t num = (bp.length() + max_wr_len - 1) / max_wr_len;
+  bool hit = false;
+  auto region = ib->get_memory_manager()->get_region(bp, &hit);
+  worker->perf_logger->inc(hit ? l_msgr_rdma_reg_cache_hit : l_msgr_rdma_reg_cache_miss);
+  if (!region) {
+    dispatcher->zc_inflight -= num;
+    worker->perf_logger->inc(l_msgr_rdma_tx_failed);
+    return -ENOMEM;
+  }
+  ldout(cct, 20) << __func__ << " QP: " << local_qpn << " " << bp.length()
+                 << " bytes in " << num << " WRs" << dendl;
+
+  ibv_sge isge[num];
+  ibv_send_wr iswr[num];
+  // FIPS zeroization audit 20191115: these memsets are not security related.
+  memset(iswr, 0, sizeof(iswr));
+  memset(isge, 0, sizeof(isge));
+
+  for (uint32_t i = 0, off = 0; i < num; ++i, off += max_wr_len) {
+    isge[i].addr = reinterpret_cast<uint64_t>(bp.c_str() + off);
+    isge[i].length = std::min(max_wr_len, bp.length() - off);
+    isge[i].lkey = region->mr->lkey;
+
+    iswr[i].wr_id = Infiniband::MemoryManager::region_to_wr_id(
+      new Infiniband::MemoryManager::RegionRef(region));
+    iswr[i].next = i + 1 < num ? &iswr[i + 1] : NULL;
+    iswr[i].sg_list = &isge[i];
+    iswr[i].num_sge = 1;
+    iswr[i].opcode = IBV_WR_SEND;
+    iswr[i].send_flags = IBV_SEND_SIGNALED;
+  }
+
+  ibv_send_wr *bad_tx_work_request = nullptr;
+  if (ibv_post_send(qp->get_qp(), iswr, &bad_tx_work_request)) {
+    int r = -errno;
+    ldout(cct, 1) << __func__ << " failed to send data"
+                  << " (most probably should be peer not ready): "
+                  << cpp_strerror(r) << dendl;
+    // WRs from the bad one on were never posted and won't complete
+    for (auto wr = bad_tx_work_request; wr; wr = wr->next) {
+      delete Infiniband::MemoryManager::wr_id_to_region(wr->wr_id);
+      --dispatcher->zc_inflight;
+    }
+    worker->perf_logger->inc(l_msgr_rdma_tx_failed);
+    return r;
+  }
+  worker->perf_logger->inc(l_msgr_rdma_tx_zerocopy_bytes, bp.length());
+  return 0;
+}
+
 void RDMAConnectedSocketImpl::fin() {
   ibv_send_wr wr;
   // FIPS zeroization audit 20191115: this memset is not security related.
@@ -543,8 +543,12 @@ void RDMADispatcher::handle_tx_event(ibv_wc *cqe, int n)
     auto chunk = reinterpret_cast<Chunk *>(response->wr_id);
     //TX completion may come either from
     // 1) regular send message, WCE wr_id points to chunk
-    // 2) 'fin' message, wr_id points to the QP
-    if (ib->get_memory_manager()->is_valid_chunk(chunk)) {
+    // 2) zero-copy send, WCE wr_id is a tagged region reference
+    // 3) 'fin' message, wr_id points to the QP
+    if (auto region = Infiniband::MemoryManager::wr_id_to_region(response->wr_id)) {
+      delete region;
+      --zc_inflight;
+    } else if (ib->get_memory_manager()->is_valid_chunk(chunk)) {
       tx_chunks.push_back(chunk);
     } else if (reinterpret_cast<QueuePair*>(response->wr_id)->get_local_qp_number() == response->qp_num ) {
       ldout(cct, 1) << __func__ << " sending of the disconnect msg completed" << dendl;
@@ -558,6 +562,15 @@ void RDMADispatcher::handle_tx_event(ibv_wc *cqe, int n)
   post_tx_buffer(tx_chunks);
 }
 
+bool RDMADispatcher::reserve_zerocopy_wrs(uint32_t n)
+{
+  if (zc_inflight.fetch_add(n) + n > ib->get_tx_zc_queue_len()) {
+    zc_inflight -= n;
+    return false;
+  }
+  return true;
+}
+
 /**
  * Add the given Chunks to the given free queue.
  *
@@ -670,6 +683,9 @@ RDMAWorker::RDMAWorker(CephContext *c, unsigned worker_id)
 
   plb.add_u64_counter(l_msgr_rdma_tx_chunks, "tx_chunks", "The number of tx chunks transmitted");
   plb.add_u64_counter(l_msgr_rdma_tx_bytes, "tx_bytes", "The bytes of tx chunks transmitted", NULL, 0, unit_t(UNIT_BYTES));
+  plb.add_u64_counter(l_msgr_rdma_tx_zerocopy_bytes, "tx_zerocopy_bytes", "The bytes transmitted without copying into tx chunks", NULL, 0, unit_t(UNIT_BYTES));
+  plb.add_u64_counter(l_msgr_rdma_reg_cache_hit, "reg_cache_hit", "The count of zero-copy sends with cached memory registration");
+  plb.add_u64_counter(l_msgr_rdma_reg_cache_miss, "reg_cache_miss", "The count of zero-copy sends registering memory");
   plb.add_u64_counter(l_msgr_rdma_rx_chunks, "rx_chunks", "The number of rx chunks transmitted");
   plb.add_u64_counter(l_msgr_rdma_rx_bytes, "rx_bytes", "The bytes of rx chunks transmitted", NULL, 0, unit_t(UNIT_BYTES));
   plb.add_u64_counter(l_msgr_rdma_pending_sent_conns, "pending_sent_conns", "The count of pending sent conns");
@@ -110,6 +110,9 @@ class RDMADispatcher {
   void handle_rx_event(ibv_wc *cqe, int rx_number);
 
   std::atomic<uint64_t> inflight = {0};
+  // outstanding zero-copy send WRs, bounded by the ib's tx_zc_queue_len
+  std::atomic<uint32_t> zc_inflight = {0};
+  bool reserve_zerocopy_wrs(uint32_t n);
 
   void post_chunk_to_pool(Chunk* chunk);
   int post_chunks_to_rq(int num, QueuePair *qp = nullptr);
@@ -200,6 +203,7 @@ class RDMAConnectedSocketImpl : public ConnectedSocketImpl {
   void buffer_prefetch(void);
   ssize_t read_buffers(char* buf, size_t len);
   int post_work_request(std::vector<Chunk*>&);
+  int post_zerocopy_request(const ceph::buffer::ptr& bp);
   size_t tx_copy_chunk(std::vector<Chunk*> &tx_buffers, size_t req_copy_len,
       decltype(std::cbegin(pending_bl.buffers()))& start,
       const decltype(std::cbegin(pending_bl.buffers()))& end);
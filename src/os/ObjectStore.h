@@ -795,6 +795,10 @@ public:
   virtual bool has_builtin_csum() const {
     return false;
   }
+  /// whether Transaction::remove_range() is implemented
+  virtual bool supports_remove_range() const {
+    return false;
+  }
 };
 
 #endif
@@ -146,6 +146,18 @@ void Transaction::dump(ceph::Formatter *f)
 	f->dump_stream("oid") << oid;
       }
       break;
+
+    case Transaction::OP_REMOVE_RANGE:
+      {
+        coll_t cid = i.get_cid(op->cid);
+        ghobject_t first = i.get_oid(op->oid);
+        ghobject_t last = i.get_oid(op->dest_oid);
+	f->dump_string("op_name", "remove_range");
+	f->dump_stream("collection") << cid;
+	f->dump_stream("first_oid") << first;
+	f->dump_stream("last_oid") << last;
+      }
+      break;
       
     case Transaction::OP_SETATTR:
       {
@@ -153,6 +153,8 @@ public:
     OP_COLL_SET_BITS = 42, // cid, bits
 
     OP_MERGE_COLLECTION = 43, // cid, destination
+
+    OP_REMOVE_RANGE = 44, // cid, oid (first), dest_oid (last)
   };
 
   // Transaction hint type
@@ -435,6 +437,7 @@ public:
 
     case OP_CLONERANGE2:
     case OP_CLONE:
+    case OP_REMOVE_RANGE:
       ceph_assert(op->cid < cm.size());
       ceph_assert(op->oid < om.size());
       ceph_assert(op->dest_oid < om.size());
@@ -901,6 +904,21 @@ public:
     _op->oid = _get_object_id(oid);
     data.ops = data.ops + 1;
   }
+  /**
+   * Remove every object in the collection from first to last, inclusive,
+   * in bitwise sort order.
+   *
+   * Only valid if ObjectStore::supports_remove_range() is true.
+   */
+  void remove_range(const coll_t& cid, const ghobject_t& first,
+		    const ghobject_t& last) {
+    Op* _op = _get_next_op();
+    _op->op = OP_REMOVE_RANGE;
+    _op->cid = _get_coll_id(cid);
+    _op->oid = _get_object_id(first);
+    _op->dest_oid = _get_object_id(last);
+    data.ops = data.ops + 1;
+  }
   /// Set an xattr of an object
   void setattr(const coll_t& cid, const ghobject_t& oid, const char* name, ceph::buffer::list& val) {
     std::string n(name);
@@ -382,6 +382,16 @@ void BlueFS::_init_logger()
 		    "Bytes requested in prefetch read mode",
 		     NULL,
 		    PerfCountersBuilder::PRIO_USEFUL, unit_t(UNIT_BYTES));
+  b.add_u64_counter(l_bluefs_readahead_count, "readahead_count",
+		    "Asynchronous read-aheads issued for sequential reads");
+  b.add_u64_counter(l_bluefs_readahead_bytes, "readahead_bytes",
+		    "Bytes read ahead for sequential reads",
+		    NULL,
+		    PerfCountersBuilder::PRIO_USEFUL, unit_t(UNIT_BYTES));
+  b.add_u64_counter(l_bluefs_readahead_hit, "readahead_hit",
+		    "Buffer refills served by a read-ahead");
+  b.add_u64_counter(l_bluefs_readahead_miss, "readahead_miss",
+		    "Read-aheads dropped unused");
   b.add_u64_counter(l_bluefs_write_count, "write_count",
 		    "Write requests processed");
   b.add_u64_counter(l_bluefs_write_disk_count, "write_disk_count",
@@ -397,6 +407,10 @@ void BlueFS::_init_logger()
                     "Average lock duration while compacting bluefs log",
                     "c_lt",
                     PerfCountersBuilder::PRIO_INTERESTING);
+  b.add_time_avg   (l_bluefs_compaction_stall_lat, "compact_stall_lat",
+                    "Average wait for the log lock by log syncs while compacting bluefs log",
+                    "c_st",
+                    PerfCountersBuilder::PRIO_USEFUL);
   b.add_time_avg   (l_bluefs_fsync_lat, "fsync_lat",
                     "Average bluefs fsync latency",
                     "fs_t",
@@ -523,6 +537,7 @@ int BlueFS::add_block_device(unsigned id, const string& path, bool trim,
 	  << " size " << byte_u_t(b->get_size()) << dendl;
   bdev[id] = b;
   ioc[id] = new IOContext(cct, NULL);
+  ioc[id]->io_class = blk_io_class_t::KV;
   if (_shared_alloc) {
     ceph_assert(!shared_alloc);
     shared_alloc = _shared_alloc;
@@ -2277,6 +2292,13 @@ int64_t BlueFS::_read(
       buf->bl.reassign_to_mempool(mempool::mempool_bluefs_file_reader);
       if (off < buf->bl_off || off >= buf->get_buf_end()) {
         // if precondition hasn't changed during locking upgrade.
+        bool sequential = buf->bl.length() && off == buf->get_buf_end();
+        if (_read_take_readahead(h, off)) {
+          _read_start_readahead(h, true);
+          u_lock.unlock();
+          s_lock.lock();
+          continue;
+        }
         buf->bl.clear();
         buf->bl_off = off & super.block_mask();
         uint64_t x_off = 0;
@@ -2317,6 +2339,7 @@ int64_t BlueFS::_read(
 	logger->inc(l_bluefs_read_disk_bytes, l);
 
         ceph_assert(r == 0);
+        _read_start_readahead(h, sequential);
       }
       u_lock.unlock();
       s_lock.lock();
@@ -2362,6 +2385,94 @@ int64_t BlueFS::_read(
   return ret;
 }
 
+// Use the read-ahead of h, if one was issued, to serve off.  Must be
+// called with h->lock held exclusively.
+bool BlueFS::_read_take_readahead(FileReader *h, uint64_t off)
+{
+  FileReaderBuffer *buf = &(h->buf);
+  if (!buf->ra_ioc) {
+    return false;
+  }
+  bool in_range =
+    off >= buf->ra_off && off < buf->ra_off + buf->ra_bl.length();
+  if (!in_range && buf->ra_ioc->num_running.load()) {
+    // don't stall an unrelated read; collect it later
+    return false;
+  }
+  buf->ra_ioc->aio_wait();
+  int r = buf->ra_ioc->get_return_value();
+  bool hit = r == 0 && !buf->ra_stale && in_range;
+  dout(20) << __func__ << " 0x" << std::hex << off << " read-ahead 0x"
+	   << buf->ra_off << "~" << buf->ra_bl.length() << std::dec
+	   << (hit ? " hit" : " miss") << " r " << r << dendl;
+  buf->ra_ioc.reset();
+  buf->ra_stale = false;
+  if (hit) {
+    buf->bl.clear();
+    buf->bl.claim_append(buf->ra_bl);
+    buf->bl.reassign_to_mempool(mempool::mempool_bluefs_file_reader);
+    buf->bl_off = buf->ra_off;
+    logger->inc(l_bluefs_readahead_hit);
+  } else {
+    buf->ra_bl.clear();
+    logger->inc(l_bluefs_readahead_miss);
+  }
+  return hit;
+}
+
+// Issue an async read of the window following h's buffer if reads look
+// sequential.  Only done for direct I/O: with buffered I/O the page cache
+// does its own read-ahead, and mixing O_DIRECT reads with buffered writes
+// could return stale data.  Must be called with h->lock held exclusively.
+void BlueFS::_read_start_readahead(FileReader *h, bool sequential)
+{
+  FileReaderBuffer *buf = &(h->buf);
+  uint64_t ra_max = cct->_conf->bluefs_readahead_max;
+  if (!sequential) {
+    buf->ra_window = 0;
+    return;
+  }
+  if (!ra_max || buf->ra_ioc ||
+      h->ignore_eof || h->file->fnode.ino == 1 ||
+      cct->_conf->bluefs_buffered_io ||
+      cct->_conf->bluefs_check_for_zeros) {
+    return;
+  }
+  buf->ra_window = std::min(
+    std::max({buf->ra_window * 2, buf->max_prefetch,
+	      (uint64_t)super.block_size}),
+    ra_max);
+
+  uint64_t ra_off = buf->get_buf_end();
+  uint64_t eof_offset = round_up_to(h->file->fnode.size, super.block_size);
+  if (ra_off >= eof_offset) {
+    return;
+  }
+  uint64_t x_off = 0;
+  auto p = h->file->fnode.seek(ra_off, &x_off);
+  if (p == h->file->fnode.extents.end()) {
+    return;
+  }
+  uint64_t l = std::min({p->length - x_off, buf->ra_window,
+			 eof_offset - ra_off});
+  dout(20) << __func__ << " 0x" << std::hex << ra_off << "~" << l
+	   << " of " << *p << std::dec << dendl;
+  buf->ra_ioc = std::make_unique<IOContext>(cct, nullptr, true);
+  buf->ra_ioc->io_class = blk_io_class_t::COMPACTION;
+  buf->ra_off = ra_off;
+  int r = bdev[p->bdev]->aio_read(p->offset + x_off, l, &buf->ra_bl,
+				  buf->ra_ioc.get());
+  if (r < 0) {
+    dout(10) << __func__ << " aio_read failed: " << cpp_strerror(r) << dendl;
+    buf->ra_ioc.reset();
+    buf->ra_bl.clear();
+    return;
+  }
+  bdev[p->bdev]->aio_submit(buf->ra_ioc.get());
+  logger->inc(l_bluefs_readahead_count);
+  logger->inc(l_bluefs_readahead_bytes, l);
+}
+
 void BlueFS::invalidate_cache(FileRef f, uint64_t offset, uint64_t length)
 {
   std::lock_guard l(f->lock);
@@ -2474,11 +2585,21 @@ void BlueFS::_compact_log_dump_metadata_NF(uint64_t start_seq,
 					int bdev_update_flags,
                                         uint64_t capture_before_seq)
 {
-  dout(20) << __func__ << dendl;
-  t->seq = start_seq;
-  t->uuid = super.uuid;
+  metadata_snapshot_t snap;
+  _compact_log_capture_metadata_NF(&snap, bdev_update_flags,
+				   capture_before_seq);
+  _compact_log_encode_metadata(start_seq, snap, t);
+}
 
+// Copy out what _compact_log_encode_metadata needs; this is what runs
+// under log.lock during async compaction, so keep it to plain copies.
+void BlueFS::_compact_log_capture_metadata_NF(metadata_snapshot_t *snap,
+					      int bdev_update_flags,
+					      uint64_t capture_before_seq)
+{
+  dout(20) << __func__ << dendl;
   std::lock_guard nl(nodes.lock);
+  snap->fnodes.reserve(nodes.file_map.size());
 
   for (auto& [ino, file_ref] : nodes.file_map) {
     if (ino == 1)
@@ -2515,15 +2636,39 @@ void BlueFS::_compact_log_dump_metadata_NF(uint64_t start_seq,
       dout(20) << __func__ << " op_file_update just modified, dirty_seq="
                << file_ref->dirty_seq << " " << file_ref->fnode << dendl;
     }
-    t->op_file_update(file_ref->fnode);
+    snap->fnodes.push_back(file_ref->fnode);
+    // as op_file_update would: later deltas start from the captured state
+    file_ref->fnode.reset_delta();
   }
+  snap->dirs.reserve(nodes.dir_map.size());
   for (auto& [path, dir_ref] : nodes.dir_map) {
+    auto& [dir, links] = snap->dirs.emplace_back();
+    dir = path;
+    links.reserve(dir_ref->file_map.size());
+    for (auto& [fname, file_ref] : dir_ref->file_map) {
+      links.emplace_back(fname, file_ref->fnode.ino);
+    }
+  }
+}
+
+void BlueFS::_compact_log_encode_metadata(uint64_t start_seq,
+					  metadata_snapshot_t& snap,
+					  bluefs_transaction_t *t)
+{
+  dout(20) << __func__ << " " << snap.fnodes.size() << " files "
+	   << snap.dirs.size() << " dirs" << dendl;
+  t->seq = start_seq;
+  t->uuid = super.uuid;
+  for (auto& fnode : snap.fnodes) {
+    t->op_file_update(fnode);
+  }
+  for (auto& [path, links] : snap.dirs) {
     dout(20) << __func__ << " op_dir_create " << path << dendl;
     t->op_dir_create(path);
-    for (auto& [fname, file_ref] : dir_ref->file_map) {
+    for (auto& [fname, ino] : links) {
       dout(20) << __func__ << " op_dir_link " << path << "/" << fname
-	       << " to " << file_ref->fnode.ino << dendl;
-      t->op_dir_link(path, fname, file_ref->fnode.ino);
+	       << " to " << ino << dendl;
+      t->op_dir_link(path, fname, ino);
     }
   }
 }
@@ -2915,15 +3060,21 @@ void BlueFS::_compact_log_async_LD_LNF_D() //also locks FW for new_writer
   //
 
   // 2.1 Build full compacted meta transaction
-  bluefs_transaction_t compacted_meta_t;
-  _compact_log_dump_metadata_NF(starter_seq + 1, &compacted_meta_t, 0, seq_now);
+  //     Only copy the metadata out while holding the lock; encoding it,
+  //     which dominates with many files and extents, is done after.
+  metadata_snapshot_t meta_snap;
+  _compact_log_capture_metadata_NF(&meta_snap, 0, seq_now);
 
-  // now state is captured to compacted_meta_t,
+  // now state is captured to meta_snap,
   // current log can be used to write to,
   //ops in log will be continuation of captured state
   logger->tinc(l_bluefs_compaction_lock_lat, mono_clock::now() - t0);
   log.lock.unlock();
 
+  bluefs_transaction_t compacted_meta_t;
+  _compact_log_encode_metadata(starter_seq + 1, meta_snap, &compacted_meta_t);
+  meta_snap = metadata_snapshot_t();
+
   // 2.2 Allocate the space required for the compacted meta transaction
   uint64_t compacted_meta_need = _estimate_transaction_size(&compacted_meta_t);
   dout(20) << __func__ << " compacted_meta_need " << compacted_meta_need
@@ -3277,7 +3428,11 @@ void BlueFS::_release_pending_allocations(vector<interval_set<uint64_t>>& to_rel
 
 int BlueFS::_flush_and_sync_log_LD(uint64_t want_seq)
 {
+  auto t0 = mono_clock::now();
   log.lock.lock();
+  if (log_is_compacting.load()) {
+    logger->tinc(l_bluefs_compaction_stall_lat, mono_clock::now() - t0);
+  }
   dirty.lock.lock();
   if (want_seq && want_seq <= dirty.seq_stable) {
     dout(10) << __func__ << " want_seq " << want_seq << " <= seq_stable "
@@ -4150,6 +4305,12 @@ int BlueFS::open_for_write(
     }
   } else if (boost::algorithm::ends_with(filename, ".sst")) {
     (*h)->writer_type = BlueFS::WRITER_SST;
+    // ssts come from flushes and compaction; keep them behind the wal
+    for (auto i : (*h)->iocv) {
+      if (i) {
+	i->io_class = blk_io_class_t::COMPACTION;
+      }
+    }
     if (logger) {
       logger->inc(l_bluefs_files_written_sst);
     }
@@ -4165,6 +4326,7 @@ BlueFS::FileWriter *BlueFS::_create_writer(FileRef f)
   for (unsigned i = 0; i < MAX_BDEV; ++i) {
     if (bdev[i]) {
       w->iocv[i] = new IOContext(cct, NULL);
+      w->iocv[i]->io_class = blk_io_class_t::KV;
     }
   }
   return w;
@@ -66,11 +66,16 @@ enum {
   l_bluefs_read_disk_bytes_slow,
   l_bluefs_read_prefetch_count,
   l_bluefs_read_prefetch_bytes,
+  l_bluefs_readahead_count,
+  l_bluefs_readahead_bytes,
+  l_bluefs_readahead_hit,
+  l_bluefs_readahead_miss,
   l_bluefs_write_count,
   l_bluefs_write_disk_count,
   l_bluefs_write_bytes,
   l_bluefs_compaction_lat,
   l_bluefs_compaction_lock_lat,
+  l_bluefs_compaction_stall_lat,
   l_bluefs_fsync_lat,
   l_bluefs_flush_lat,
   l_bluefs_unlink_lat,
@@ -376,8 +381,20 @@ public:
     uint64_t pos = 0;       ///< current logical offset
     uint64_t max_prefetch;  ///< max allowed prefetch
 
+    // read-ahead of the window following bl, for sequential direct reads
+    uint64_t ra_window = 0;             ///< current window, grows while sequential
+    uint64_t ra_off = 0;                ///< logical offset of ra_bl
+    ceph::buffer::list ra_bl;           ///< read-ahead data (maybe in flight)
+    std::unique_ptr<IOContext> ra_ioc;  ///< set while a read-ahead is issued
+    bool ra_stale = false;              ///< invalidated while in flight
+
     explicit FileReaderBuffer(uint64_t mpf)
       : max_prefetch(mpf) {}
+    ~FileReaderBuffer() {
+      if (ra_ioc) {
+	ra_ioc->aio_wait();
+      }
+    }
 
     uint64_t get_buf_end() const {
       return bl_off + bl.length();
@@ -399,6 +416,9 @@ public:
 	bl.clear();
 	bl_off = 0;
       }
+      if (ra_ioc) {
+	ra_stale = true;
+      }
     }
   };
 
@@ -409,6 +429,7 @@ public:
     FileReaderBuffer buf;
     bool random;
     bool ignore_eof;        ///< used when reading our log file
+    bool sequential = false; ///< hinted sequential; read through buf
 
     ceph::shared_mutex lock {
      ceph::make_shared_mutex(std::string(), false, false, false)
@@ -581,10 +602,23 @@ private:
     RENAME_SLOW2DB = 4,
     RENAME_DB2SLOW = 8,
   };
+  /// in-memory metadata copied out for log compaction
+  struct metadata_snapshot_t {
+    std::vector<bluefs_fnode_t> fnodes;
+    /// (dir, [(name, ino)])
+    std::vector<std::pair<std::string,
+			  std::vector<std::pair<std::string, uint64_t>>>> dirs;
+  };
   void _compact_log_dump_metadata_NF(uint64_t start_seq,
                                      bluefs_transaction_t *t,
 				     int flags,
 				     uint64_t capture_before_seq);
+  void _compact_log_capture_metadata_NF(metadata_snapshot_t *snap,
+					int flags,
+					uint64_t capture_before_seq);
+  void _compact_log_encode_metadata(uint64_t start_seq,
+				    metadata_snapshot_t& snap,
+				    bluefs_transaction_t *t);
 
   void _compact_log_sync_LNF_LD();
   void _compact_log_async_LD_LNF_D();
@@ -611,6 +645,8 @@ private:
     size_t len,      ///< [in] this many bytes
     ceph::buffer::list *outbl,   ///< [out] optional: reference the result here
     char *out);      ///< [out] optional: or copy it here
+  bool _read_take_readahead(FileReader *h, uint64_t off);
+  void _read_start_readahead(FileReader *h, bool sequential);
   int64_t _read_random(
     FileReader *h,   ///< [in] read from here
     uint64_t offset, ///< [in] offset
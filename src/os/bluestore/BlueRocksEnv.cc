@@ -115,7 +115,13 @@ class BlueRocksRandomAccessFile : public rocksdb::RandomAccessFile {
   // Safe for concurrent use by multiple threads.
   rocksdb::Status Read(uint64_t offset, size_t n, rocksdb::Slice* result,
 		       char* scratch) const override {
-    int64_t r = fs->read_random(h, offset, n, scratch);
+    int64_t r;
+    if (h->sequential) {
+      // e.g. compaction input: go through the buffer and its read-ahead
+      r = fs->read(h, offset, n, nullptr, scratch);
+    } else {
+      r = fs->read_random(h, offset, n, scratch);
+    }
     ceph_assert(r >= 0);
     *result = rocksdb::Slice(scratch, r);
     return rocksdb::Status::OK();
@@ -150,10 +156,13 @@ class BlueRocksRandomAccessFile : public rocksdb::RandomAccessFile {
   //enum AccessPattern { NORMAL, RANDOM, SEQUENTIAL, WILLNEED, DONTNEED };
 
   void Hint(AccessPattern pattern) override {
-    if (pattern == RANDOM)
+    if (pattern == RANDOM) {
       h->buf.max_prefetch = 4096;
-    else if (pattern == SEQUENTIAL)
+      h->sequential = false;
+    } else if (pattern == SEQUENTIAL) {
       h->buf.max_prefetch = fs->cct->_conf->bluefs_max_prefetch;
+      h->sequential = fs->cct->_conf->bluefs_readahead_max > 0;
+    }
   }
 
   bool use_direct_io() const override {
@@ -41,6 +41,7 @@
 #include "common/PriorityCache.h"
 #include "common/url_escape.h"
 #include "Allocator.h"
+#include "CachingAllocator.h"
 #include "FreelistManager.h"
 #include "BlueFS.h"
 #include "BlueRocksEnv.h"
@@ -678,6 +679,8 @@ public:
 
   virtual bool valid() const = 0;
   virtual const ghobject_t &oid() const = 0;
+  virtual std::string key() const = 0;
+  virtual bufferlist value() = 0;
   virtual void lower_bound(const ghobject_t &oid) = 0;
   virtual void upper_bound(const ghobject_t &oid) = 0;
   virtual void next() = 0;
@@ -712,6 +715,18 @@ public:
     return m_oid;
   }
 
+  std::string key() const override {
+    ceph_assert(valid());
+
+    return m_it->key();
+  }
+
+  bufferlist value() override {
+    ceph_assert(valid());
+
+    return m_it->value();
+  }
+
   void lower_bound(const ghobject_t &oid) override {
     string key;
     get_object_key(m_cct, oid, &key);
@@ -764,8 +779,10 @@ private:
 
 class SortedCollectionListIterator : public CollectionListIterator {
 public:
-  SortedCollectionListIterator(const KeyValueDB::Iterator &it)
-    : CollectionListIterator(it), m_chunk_iter(m_chunk.end()) {
+  SortedCollectionListIterator(const KeyValueDB::Iterator &it,
+                               bool with_values = false)
+    : CollectionListIterator(it), m_chunk_iter(m_chunk.end()),
+      m_with_values(with_values) {
   }
 
   bool valid() const override {
@@ -778,6 +795,18 @@ public:
     return m_chunk_iter->first;
   }
 
+  std::string key() const override {
+    ceph_assert(valid());
+
+    return m_chunk_iter->second.first;
+  }
+
+  bufferlist value() override {
+    ceph_assert(valid());
+
+    return m_chunk_iter->second.second;
+  }
+
   void lower_bound(const ghobject_t &oid) override {
     std::string key;
     _key_encode_prefix(oid, &key);
@@ -830,8 +859,10 @@ public:
   }
 
 private:
-  std::map<ghobject_t, std::string> m_chunk;
-  std::map<ghobject_t, std::string>::iterator m_chunk_iter;
+  // values are only kept when requested (for onode prefetch)
+  std::map<ghobject_t, std::pair<std::string, bufferlist>> m_chunk;
+  std::map<ghobject_t, std::pair<std::string, bufferlist>>::iterator m_chunk_iter;
+  bool m_with_values;
 
   bool get_next_chunk() {
     while (m_it->valid() && is_extent_shard_key(m_it->key())) {
@@ -848,7 +879,8 @@ private:
 
     m_chunk.clear();
     while (true) {
-      m_chunk.insert({oid, m_it->key()});
+      m_chunk.insert({oid, {m_it->key(),
+                            m_with_values ? m_it->value() : bufferlist()}});
 
       do {
         m_it->next();
@@ -2002,6 +2034,12 @@ BlueStore::OnodeRef BlueStore::OnodeSpace::lookup(const ghobject_t& oid)
   return o;
 }
 
+bool BlueStore::OnodeSpace::contains(const ghobject_t& oid)
+{
+  std::lock_guard l(cache->lock);
+  return onode_map.count(oid) > 0;
+}
+
 void BlueStore::OnodeSpace::clear()
 {
   std::lock_guard l(cache->lock);
@@ -3211,6 +3249,17 @@ void BlueStore::ExtentMap::dup(BlueStore* b, TransContext* txc,
   uint32_t dirty_range_begin = 0;
   uint32_t dirty_range_end = 0;
   bool src_dirty = false;
+  {
+    vector<SharedBlobRef> sbs;
+    for (auto ep = oldo->extent_map.seek_lextent(srcoff);
+	 ep != oldo->extent_map.extent_map.end() && ep->logical_offset < end;
+	 ++ep) {
+      if (ep->blob->get_blob().is_shared() && !ep->blob->is_shared_loaded()) {
+	sbs.push_back(ep->blob->get_shared_blob());
+      }
+    }
+    c->load_shared_blobs(sbs);
+  }
   for (auto ep = oldo->extent_map.seek_lextent(srcoff);
     ep != oldo->extent_map.extent_map.end();
     ++ep) {
@@ -5036,6 +5085,48 @@ void BlueStore::Collection::load_shared_blob(SharedBlobRef sb)
   }
 }
 
+void BlueStore::Collection::load_shared_blobs(
+  const std::vector<SharedBlobRef>& sbs)
+{
+  vector<SharedBlobRef> todo;
+  vector<string> keys;
+  for (auto& sb : sbs) {
+    if (!sb->is_loaded()) {
+      todo.push_back(sb);
+      keys.emplace_back();
+      get_shared_blob_key(sb->get_sbid(), &keys.back());
+    }
+  }
+  if (todo.size() < 2) {
+    for (auto& sb : todo) {
+      load_shared_blob(sb);
+    }
+    return;
+  }
+  vector<bufferlist> vals;
+  vector<int> rvals;
+  store->db->get_batch(PREFIX_SHARED_BLOB, keys, &vals, &rvals);
+  for (size_t i = 0; i < todo.size(); ++i) {
+    auto& sb = todo[i];
+    if (sb->is_loaded()) {
+      continue;  // listed twice
+    }
+    auto sbid = sb->get_sbid();
+    if (rvals[i] < 0) {
+      lderr(store->cct) << __func__ << " sbid 0x" << std::hex << sbid
+			<< std::dec << " not found at key "
+			<< pretty_binary_string(keys[i]) << dendl;
+      ceph_abort_msg("uh oh, missing shared_blob");
+    }
+    sb->loaded = true;
+    sb->persistent = new bluestore_shared_blob_t(sbid);
+    auto p = vals[i].cbegin();
+    decode(*(sb->persistent), p);
+    ldout(store->cct, 10) << __func__ << " sbid 0x" << std::hex << sbid
+			  << std::dec << " loaded shared_blob " << *sb << dendl;
+  }
+}
+
 void BlueStore::Collection::make_blob_shared(uint64_t sbid, BlobRef b)
 {
   ldout(store->cct, 10) << __func__ << " " << *b << dendl;
@@ -5121,6 +5212,21 @@ BlueStore::OnodeRef BlueStore::Collection::get_onode(
   return onode_space.add_onode(oid, o);
 }
 
+bool BlueStore::Collection::prefetch_onode(
+  const ghobject_t& oid,
+  const string& key,
+  bufferlist& v)
+{
+  ceph_assert(ceph_mutex_is_locked(lock));
+  if (v.length() == 0 || onode_space.contains(oid)) {
+    return false;
+  }
+  ldout(store->cct, 20) << __func__ << " oid " << oid << dendl;
+  OnodeRef o(Onode::create_decode(this, oid, key, v, true));
+  onode_space.add_onode(oid, o);
+  return true;
+}
+
 void BlueStore::Collection::split_cache(
   Collection *dest)
 {
@@ -5273,6 +5379,7 @@ void *BlueStore::MempoolThread::entry()
   utime_t next_bin_rotation = ceph_clock_now();
   utime_t next_deferred_force_submit = ceph_clock_now();
   utime_t alloc_stats_dump_clock = ceph_clock_now();
+  utime_t next_deferred_adapt = ceph_clock_now();
 
   bool interval_stats_trim = false;
   while (!stop) {
@@ -5354,6 +5461,16 @@ void *BlueStore::MempoolThread::entry()
       next_deferred_force_submit += max_defer_interval/3;
     }
 
+    // adaptive deferred write cut-off
+    if (store->cct->_conf.get_val<bool>(
+	  "bluestore_prefer_deferred_size_adaptive") &&
+	next_deferred_adapt < ceph_clock_now()) {
+      store->_adapt_prefer_deferred_size();
+      next_deferred_adapt = ceph_clock_now();
+      next_deferred_adapt += store->cct->_conf.get_val<double>(
+	"bluestore_prefer_deferred_size_adaptive_interval");
+    }
+
     // Now Resize the shards 
     _resize_shards(interval_stats_trim);
     interval_stats_trim = false;
@@ -5702,6 +5819,7 @@ const char **BlueStore::get_tracked_conf_keys() const
     "bluestore_prefer_deferred_size",
     "bluestore_prefer_deferred_size_hdd",
     "bluestore_prefer_deferred_size_ssd",
+    "bluestore_prefer_deferred_size_adaptive",
     "bluestore_deferred_batch_ops",
     "bluestore_deferred_batch_ops_hdd",
     "bluestore_deferred_batch_ops_ssd",
@@ -5767,6 +5885,7 @@ void BlueStore::handle_conf_change(const ConfigProxy& conf,
   if (changed.count("bluestore_prefer_deferred_size") ||
       changed.count("bluestore_prefer_deferred_size_hdd") ||
       changed.count("bluestore_prefer_deferred_size_ssd") ||
+      changed.count("bluestore_prefer_deferred_size_adaptive") ||
       changed.count("bluestore_max_alloc_size") ||
       changed.count("bluestore_deferred_batch_ops") ||
       changed.count("bluestore_deferred_batch_ops_hdd") ||
@@ -6243,6 +6362,19 @@ void BlueStore::_init_logger()
 		    NULL,
 		    PerfCountersBuilder::PRIO_DEBUGONLY,
 		    unit_t(UNIT_BYTES));
+  b.add_time_avg(l_bluestore_direct_aio_wait_lat, "direct_aio_wait_lat",
+		 "Average aio wait latency of transactions with direct writes");
+  b.add_u64(l_bluestore_prefer_deferred_size, "prefer_deferred_size",
+	    "Current deferred write cut-off",
+	    NULL,
+	    PerfCountersBuilder::PRIO_DEBUGONLY,
+	    unit_t(UNIT_BYTES));
+  b.add_u64_counter(l_bluestore_prefer_deferred_size_raised,
+		    "prefer_deferred_size_raised",
+		    "Times the adaptive deferred write cut-off was raised");
+  b.add_u64_counter(l_bluestore_prefer_deferred_size_lowered,
+		    "prefer_deferred_size_lowered",
+		    "Times the adaptive deferred write cut-off was lowered");
 
   b.add_u64_counter(l_bluestore_write_big_skipped_blobs,
       "write_big_skipped_blobs",
@@ -6298,6 +6430,9 @@ void BlueStore::_init_logger()
   b.add_u64_counter(l_bluestore_onode_shard_misses,
 		    "onode_shard_misses",
 		    "Count of onode shard cache lookups misses");
+  b.add_u64_counter(l_bluestore_onode_list_prefetched,
+		    "onode_list_prefetched",
+		    "Onodes loaded into cache by sequential collection listing");
   b.add_u64(l_bluestore_extents, "onode_extents",
 	    "Number of extents in cache");
   b.add_u64(l_bluestore_blobs, "onode_blobs",
@@ -6627,6 +6762,8 @@ void BlueStore::_set_alloc_sizes(void)
     }
   }
 
+  logger->set(l_bluestore_prefer_deferred_size, prefer_deferred_size);
+
   dout(10) << __func__ << " min_alloc_size 0x" << std::hex << min_alloc_size
 	   << std::dec << " order " << (int)min_alloc_size_order
 	   << " max_alloc_size 0x" << std::hex << max_alloc_size
@@ -6636,6 +6773,47 @@ void BlueStore::_set_alloc_sizes(void)
 	   << dendl;
 }
 
+void BlueStore::_adapt_prefer_deferred_size()
+{
+  // A deferred write costs the client one (already paid) kv commit, while a
+  // direct write adds the data device aio on top.  When the data device is
+  // much slower than the DB device, deferring more is a win; when the device
+  // keeps up with the DB, or the deferred queue is backing up, it is not.
+  perf_tracker.update_deferred_from_perfcounters(*logger);
+  uint64_t direct_ns = perf_tracker.direct_aio_wait_latency_ns.current_avg();
+  uint64_t kv_ns = perf_tracker.kv_commit_latency_ns.current_avg();
+  bool backlog = throttle.should_submit_deferred();
+  if (!backlog && (direct_ns == 0 || kv_ns == 0)) {
+    // not enough samples in this period
+    return;
+  }
+
+  uint64_t lo = cct->_conf.get_val<Option::size_t>(
+    "bluestore_prefer_deferred_size_adaptive_min");
+  uint64_t hi = std::max<uint64_t>(lo, cct->_conf.get_val<Option::size_t>(
+    "bluestore_prefer_deferred_size_adaptive_max"));
+  uint64_t cur = prefer_deferred_size;
+  uint64_t next = cur;
+  if (backlog || direct_ns <= kv_ns) {
+    next = p2align(cur / 2, block_size);
+  } else if (direct_ns > kv_ns * 2) {
+    next = std::max(cur * 2, block_size);
+  }
+  next = std::clamp(next, lo, hi);
+  if (next == cur) {
+    return;
+  }
+  dout(10) << __func__ << " direct aio " << direct_ns << "ns"
+	   << " kv commit " << kv_ns << "ns"
+	   << (backlog ? " (deferred backlog)" : "")
+	   << ", prefer_deferred_size 0x" << std::hex << cur
+	   << " -> 0x" << next << std::dec << dendl;
+  prefer_deferred_size = next;
+  logger->set(l_bluestore_prefer_deferred_size, next);
+  logger->inc(next > cur ? l_bluestore_prefer_deferred_size_raised :
+			   l_bluestore_prefer_deferred_size_lowered);
+}
+
 int BlueStore::_open_bdev(bool create)
 {
   ceph_assert(bdev == NULL);
@@ -6874,17 +7052,26 @@ int BlueStore::_create_alloc()
   uint64_t alloc_size = min_alloc_size;
 
   std::string allocator_type = cct->_conf->bluestore_allocator;
+  auto cache_shards =
+    cct->_conf.get_val<uint64_t>("bluestore_allocator_cache_shards");
 
   alloc = Allocator::create(
     cct, allocator_type,
     bdev->get_size(),
     alloc_size,
-    "block");
+    cache_shards ? "" : "block");
   if (!alloc) {
     lderr(cct) << __func__ << " failed to create " << allocator_type << " allocator"
 	       << dendl;
     return -EINVAL;
   }
+  if (cache_shards) {
+    alloc = new CachingAllocator(
+      cct, alloc, cache_shards,
+      cct->_conf.get_val<Option::size_t>("bluestore_allocator_cache_size"),
+      cct->_conf.get_val<Option::size_t>("bluestore_allocator_cache_max_alloc"),
+      "block");
+  }
 
   // BlueFS will share the same allocator
   shared_alloc.set(alloc, alloc_size);
@@ -11574,8 +11761,9 @@ BlueStore::CollectionRef BlueStore::_get_collection_by_oid(const ghobject_t& oid
 void BlueStore::_queue_reap_collection(CollectionRef& c)
 {
   dout(10) << __func__ << " " << c << " " << c->cid << dendl;
-  // _reap_collections and this in the same thread,
-  // so no need a lock.
+  // with kv finalize lanes enabled this may race with _reap_collections
+  // running in another lane
+  std::lock_guard l(reap_lock);
   removed_collections.push_back(c);
 }
 
@@ -11584,8 +11772,7 @@ void BlueStore::_reap_collections()
 
   list<CollectionRef> removed_colls;
   {
-    // _queue_reap_collection and this in the same thread.
-    // So no need a lock.
+    std::lock_guard l(reap_lock);
     if (!removed_collections.empty())
       removed_colls.swap(removed_collections);
     else
@@ -11615,6 +11802,7 @@ void BlueStore::_reap_collections()
   if (removed_colls.empty()) {
     dout(10) << __func__ << " all reaped" << dendl;
   } else {
+    std::lock_guard l(reap_lock);
     removed_collections.splice(removed_collections.begin(), removed_colls);
   }
 }
@@ -11996,18 +12184,36 @@ int BlueStore::_generate_read_result_bl(
         *csum_error = true;
         return -EIO;
       }
-      bufferlist raw_bl;
-      auto r = _decompress(compressed_bl, &raw_bl);
+      interval_set<uint32_t> want;
+      for (auto& req : r2r) {
+        for (auto& r : req.regs) {
+          want.union_insert(r.blob_xoffset, r.length);
+        }
+      }
+      std::map<uint32_t, bufferlist> raw_bls;
+      auto r = _decompress(compressed_bl, want, &raw_bls);
       if (r < 0)
         return r;
       if (buffered) {
-        bptr->dirty_bc().did_read(bptr->get_cache(), 0,
-                                       raw_bl);
+        for (auto& [raw_off, raw_bl] : raw_bls) {
+          bptr->dirty_bc().did_read(bptr->get_cache(), raw_off, raw_bl);
+        }
       }
       for (auto& req : r2r) {
         for (auto& r : req.regs) {
+          auto q = raw_bls.upper_bound(r.blob_xoffset);
+          if (q != raw_bls.begin()) {
+            --q;
+          }
+          if (q == raw_bls.end() || q->first > r.blob_xoffset ||
+              q->first + q->second.length() < r.blob_xoffset + r.length) {
+            derr << __func__ << " decompressed data does not cover 0x"
+                 << std::hex << r.blob_xoffset << "~" << r.length << std::dec
+                 << " of " << *bptr << dendl;
+            return -EIO;
+          }
           ready_regions[r.logical_offset].substr_of(
-            raw_bl, r.blob_xoffset, r.length);
+            q->second, r.blob_xoffset - q->first, r.length);
         }
       }
     } else {
@@ -12235,6 +12441,19 @@ int BlueStore::_verify_csum(OnodeRef& o,
 }
 
 int BlueStore::_decompress(bufferlist& source, bufferlist* result)
+{
+  std::map<uint32_t, bufferlist> raw_bls;
+  int r = _decompress(source, interval_set<uint32_t>(), &raw_bls);
+  if (r >= 0 && !raw_bls.empty()) {
+    ceph_assert(raw_bls.size() == 1);
+    result->claim_append(raw_bls.begin()->second);
+  }
+  return r;
+}
+
+int BlueStore::_decompress(bufferlist& source,
+			   const interval_set<uint32_t>& want,
+			   std::map<uint32_t, bufferlist>* result)
 {
   int r = 0;
   auto start = mono_clock::now();
@@ -12255,12 +12474,60 @@ int BlueStore::_decompress(bufferlist& source, bufferlist* result)
     derr << __func__ << " can't load decompressor " << alg_name << dendl;
     _set_compression_alert(false, alg_name);
     r = -EIO;
-  } else {
-    r = cp->decompress(i, chdr.length, *result, chdr.compressor_message);
+  } else if (!chdr.chunk_size) {
+    r = cp->decompress(i, chdr.length, (*result)[0], chdr.compressor_message);
     if (r < 0) {
       derr << __func__ << " decompression failed with exit code " << r << dendl;
       r = -EIO;
     }
+  } else {
+    // chunked: decompress only the runs of chunks covering want
+    size_t num_chunks = chdr.chunk_lengths.size();
+    std::vector<uint32_t> chunk_offsets;
+    chunk_offsets.reserve(num_chunks);
+    uint64_t payload_len = 0;
+    for (auto l : chdr.chunk_lengths) {
+      chunk_offsets.push_back(payload_len);
+      payload_len += l;
+    }
+    if (payload_len != chdr.length ||
+	payload_len > source.length() - i.get_off()) {
+      derr << __func__ << " bad chunk index, 0x" << std::hex << payload_len
+	   << " bytes in chunks vs 0x" << chdr.length << std::dec << dendl;
+      r = -EIO;
+      num_chunks = 0;
+    }
+    interval_set<uint32_t> chunks;
+    if (want.empty()) {
+      if (num_chunks) {
+	chunks.insert(0, num_chunks);
+      }
+    } else if (num_chunks) {
+      for (auto p = want.begin(); p != want.end(); ++p) {
+	uint32_t first = p.get_start() / chdr.chunk_size;
+	uint32_t last = std::min<uint32_t>(
+	  (p.get_end() - 1) / chdr.chunk_size, num_chunks - 1);
+	if (first <= last) {
+	  chunks.union_insert(first, last - first + 1);
+	}
+      }
+    }
+    for (auto p = chunks.begin(); r == 0 && p != chunks.end(); ++p) {
+      bufferlist& raw_bl = (*result)[p.get_start() * chdr.chunk_size];
+      for (uint32_t c = p.get_start(); c < p.get_end(); ++c) {
+	auto ci = i;
+	ci += chunk_offsets[c];
+	r = cp->decompress(ci, chdr.chunk_lengths[c], raw_bl,
+			   chdr.compressor_message);
+	if (r < 0) {
+	  derr << __func__ << " decompression of chunk " << c
+	       << " failed with exit code " << r << dendl;
+	  r = -EIO;
+	  break;
+	}
+	r = 0;
+      }
+    }
   }
   log_latency(__func__,
     l_bluestore_decompress_lat,
@@ -12269,6 +12536,57 @@ int BlueStore::_decompress(bufferlist& source, bufferlist* result)
   return r;
 }
 
+int BlueStore::_compress_chunked(
+  CompressorRef& c,
+  const bufferlist& in,
+  uint32_t chunk_size,
+  bufferlist& out,
+  std::optional<int32_t>& compressor_message,
+  std::vector<uint32_t>* chunk_lengths)
+{
+  for (uint32_t off = 0; off < in.length(); off += chunk_size) {
+    bufferlist chunk, t;
+    chunk.substr_of(in, off, std::min(chunk_size, in.length() - off));
+    std::optional<int32_t> message;
+    int r = c->compress(chunk, t, message);
+    if (r != 0) {
+      return r;
+    }
+    if (off == 0) {
+      compressor_message = message;
+    } else if (message != compressor_message) {
+      // all chunks are decompressed with the one message from the header
+      dout(20) << __func__ << " compressor message differs between chunks,"
+	       << " compressing as a whole" << dendl;
+      out.clear();
+      chunk_lengths->clear();
+      compressor_message.reset();
+      return c->compress(in, out, compressor_message);
+    }
+    chunk_lengths->push_back(t.length());
+    out.claim_append(t);
+  }
+  return 0;
+}
+
+void BlueStore::_compress_blob(
+  CompressorRef& c,
+  const bufferlist& in,
+  blob_compression_t& result)
+{
+  auto start = mono_clock::now();
+  uint32_t chunk_size = cct->_conf->bluestore_compression_chunk_size;
+  if (chunk_size && in.length() > chunk_size) {
+    result.chunk_size = chunk_size;
+    result.r = _compress_chunked(c, in, chunk_size, result.out,
+				 result.compressor_message,
+				 &result.chunk_lengths);
+  } else {
+    result.r = c->compress(in, result.out, result.compressor_message);
+  }
+  result.lat = mono_clock::now() - start;
+}
+
 // this stores fiemap into interval_set, other variations
 // use it internally
 int BlueStore::_fiemap(
@@ -12798,6 +13116,27 @@ int BlueStore::_collection_list(
     ranges.push_back(std::tuple(std::move(coll_range_start), std::move(coll_range_end)));
   }
 
+  // a listing that resumes where the previous one stopped (backfill, scrub,
+  // bucket listing) is usually followed by per-object lookups; warm the
+  // onode cache from the values the iterator reads anyway.  only do so
+  // with no txc in flight: anything committing behind our iterator could
+  // otherwise leave a stale onode in the cache.  new txcs need c->lock
+  // exclusively and are held off by our caller.
+  uint64_t prefetch = 0;
+  if (uint64_t max_prefetch = cct->_conf->bluestore_collection_list_prefetch;
+      max_prefetch > 0) {
+    std::lock_guard l(c->list_hint_lock);
+    if (start == c->list_next_hint && c->osr->is_empty()) {
+      prefetch = max_prefetch;
+    }
+  }
+  auto update_hint = make_scope_guard([&] {
+    if (cct->_conf->bluestore_collection_list_prefetch > 0) {
+      std::lock_guard l(c->list_hint_lock);
+      c->list_next_hint = *pnext;
+    }
+  });
+
   for (const auto & [cur_range_start, cur_range_end] : ranges) {
     dout(30) << __func__ << " cur_range " << cur_range_start << " to " << cur_range_end << dendl;
 
@@ -12818,7 +13157,8 @@ int BlueStore::_collection_list(
               cct, db->get_iterator(PREFIX_OBJ, 0, std::move(bounds)));
     } else {
       it = std::make_unique<SortedCollectionListIterator>(
-              db->get_iterator(PREFIX_OBJ, 0, std::move(bounds)));
+              db->get_iterator(PREFIX_OBJ, 0, std::move(bounds)),
+              prefetch > 0);
     }
     it->lower_bound(low);
     while (it->valid()) {
@@ -12835,6 +13175,13 @@ int BlueStore::_collection_list(
       }
       dout(20) << __func__ << " oid " << it->oid() << dendl;
       ls->push_back(it->oid());
+      if (prefetch > 0) {
+        --prefetch;
+        bufferlist v = it->value();
+        if (c->prefetch_onode(it->oid(), it->key(), v)) {
+          logger->inc(l_bluestore_onode_list_prefetched);
+        }
+      }
       it->next();
     }
   }
@@ -13036,14 +13383,22 @@ int BlueStore::omap_get_values(
     const string& prefix = o->get_omap_prefix();
     o->get_omap_key(string(), &final_key);
     size_t base_key_len = final_key.size();
+    vector<string> final_keys;
+    final_keys.reserve(keys.size());
     for (set<string>::const_iterator p = keys.begin(); p != keys.end(); ++p) {
       final_key.resize(base_key_len); // keep prefix
       final_key += *p;
-      bufferlist val;
-      if (db->get(prefix, final_key, &val) >= 0) {
-	dout(30) << __func__ << "  got " << pretty_binary_string(final_key)
+      final_keys.push_back(final_key);
+    }
+    vector<bufferlist> vals;
+    vector<int> rvals;
+    db->get_batch(prefix, final_keys, &vals, &rvals);
+    size_t i = 0;
+    for (set<string>::const_iterator p = keys.begin(); p != keys.end(); ++p, ++i) {
+      if (rvals[i] >= 0) {
+	dout(30) << __func__ << "  got " << pretty_binary_string(final_keys[i])
 		 << " -> " << *p << dendl;
-	out->insert(make_pair(*p, val));
+	out->insert(make_pair(*p, std::move(vals[i])));
       }
     }
   }
@@ -13132,16 +13487,24 @@ int BlueStore::omap_check_keys(
     const string& prefix = o->get_omap_prefix();
     o->get_omap_key(string(), &final_key);
     size_t base_key_len = final_key.size();
+    vector<string> final_keys;
+    final_keys.reserve(keys.size());
     for (set<string>::const_iterator p = keys.begin(); p != keys.end(); ++p) {
       final_key.resize(base_key_len); // keep prefix
       final_key += *p;
-      bufferlist val;
-      if (db->get(prefix, final_key, &val) >= 0) {
-	dout(30) << __func__ << "  have " << pretty_binary_string(final_key)
+      final_keys.push_back(final_key);
+    }
+    vector<bufferlist> vals;
+    vector<int> rvals;
+    db->get_batch(prefix, final_keys, &vals, &rvals);
+    size_t i = 0;
+    for (set<string>::const_iterator p = keys.begin(); p != keys.end(); ++p, ++i) {
+      if (rvals[i] >= 0) {
+	dout(30) << __func__ << "  have " << pretty_binary_string(final_keys[i])
 		 << " -> " << *p << dendl;
 	out->insert(*p);
       } else {
-	dout(30) << __func__ << "  miss " << pretty_binary_string(final_key)
+	dout(30) << __func__ << "  miss " << pretty_binary_string(final_keys[i])
 		 << " -> " << *p << dendl;
       }
     }
@@ -13527,6 +13890,9 @@ void BlueStore::_txc_state_proc(TransContext *txc)
       {
 	mono_clock::duration lat = throttle.log_state_latency(
 	  *txc, logger, l_bluestore_state_aio_wait_lat);
+	if (txc->had_ios) {
+	  logger->tinc(l_bluestore_direct_aio_wait_lat, lat);
+	}
 	if (ceph::to_seconds<double>(lat) >= cct->_conf->bluestore_log_op_age) {
 	  logger->inc(l_bluestore_slow_aio_wait_count);
 	  dout(0) << __func__ << " slow aio_wait, txc = " << txc
@@ -13712,6 +14078,17 @@ void BlueStore::BSPerfTracker::update_from_perfcounters(
       l_bluestore_commit_lat));
 }
 
+void BlueStore::BSPerfTracker::update_deferred_from_perfcounters(
+  PerfCounters &logger)
+{
+  direct_aio_wait_latency_ns.consume_next(
+    logger.get_tavg_ns(
+      l_bluestore_direct_aio_wait_lat));
+  kv_commit_latency_ns.consume_next(
+    logger.get_tavg_ns(
+      l_bluestore_kv_commit_lat));
+}
+
 void BlueStore::_txc_finalize_kv(TransContext *txc, KeyValueDB::Transaction t)
 {
   dout(20) << __func__ << " txc " << txc << std::hex
@@ -14067,6 +14444,10 @@ void BlueStore::_osr_drain_all()
     std::lock_guard l(kv_finalize_lock);
     kv_finalize_cond.notify_one();
   }
+  for (auto& lane : kv_finalize_lanes) {
+    std::lock_guard l(lane->lock);
+    lane->cond.notify_one();
+  }
   for (auto osr : s) {
     dout(20) << __func__ << " drain " << osr << dendl;
     osr->drain();
@@ -14101,6 +14482,21 @@ void BlueStore::_kv_start()
   finisher.start();
   kv_sync_thread.create("bstore_kv_sync");
   kv_finalize_thread.create("bstore_kv_final");
+  ceph_assert(kv_finalize_lanes.empty());
+  unsigned lanes = cct->_conf->bluestore_kv_finalize_lanes;
+  for (unsigned i = 1; i < lanes; ++i) {
+    kv_finalize_lanes.emplace_back(std::make_unique<KVFinalizeLane>(this, i));
+    kv_finalize_lanes.back()->create(
+      ("bstore_kv_fin" + stringify(i)).c_str());
+  }
+  dout(10) << __func__ << " " << std::max(lanes, 1u) << " finalize lane(s)"
+	   << dendl;
+  ceph_assert(compress_threads.empty());
+  unsigned compressors = cct->_conf->bluestore_compression_threads;
+  for (unsigned i = 0; i < compressors; ++i) {
+    compress_threads.emplace_back(std::make_unique<CompressThread>(this));
+    compress_threads.back()->create("bstore_compress");
+  }
 }
 
 void BlueStore::_kv_stop()
@@ -14114,6 +14510,23 @@ void BlueStore::_kv_stop()
     kv_stop = true;
     kv_cond.notify_all();
   }
+  if (!kv_finalize_lanes.empty()) {
+    // lanes are only fed by the kv sync thread; stop it first so nothing
+    // is dispatched to a lane that has already exited
+    kv_sync_thread.join();
+    for (auto& lane : kv_finalize_lanes) {
+      std::unique_lock l{lane->lock};
+      while (!lane->started) {
+	lane->cond.wait(l);
+      }
+      lane->stop = true;
+      lane->cond.notify_all();
+    }
+    for (auto& lane : kv_finalize_lanes) {
+      lane->join();
+    }
+    kv_finalize_lanes.clear();
+  }
   {
     std::unique_lock l{kv_finalize_lock};
     while (!kv_finalize_started) {
@@ -14122,7 +14535,9 @@ void BlueStore::_kv_stop()
     kv_finalize_stop = true;
     kv_finalize_cond.notify_all();
   }
-  kv_sync_thread.join();
+  if (kv_sync_thread.is_started()) {
+    kv_sync_thread.join();
+  }
   kv_finalize_thread.join();
   ceph_assert(removed_collections.empty());
   {
@@ -14133,6 +14548,19 @@ void BlueStore::_kv_stop()
     std::lock_guard l(kv_finalize_lock);
     kv_finalize_stop = false;
   }
+  if (!compress_threads.empty()) {
+    {
+      std::lock_guard l(compress_lock);
+      compress_stop = true;
+      compress_cond.notify_all();
+    }
+    for (auto& t : compress_threads) {
+      t->join();
+    }
+    compress_threads.clear();
+    std::lock_guard l(compress_lock);
+    compress_stop = false;
+  }
   dout(10) << __func__ << " stopping finishers" << dendl;
   finisher.wait_for_empty();
   finisher.stop();
@@ -14342,6 +14770,9 @@ void BlueStore::_kv_sync_thread()
       }
 #endif
 
+      if (!kv_finalize_lanes.empty()) {
+	_kv_finalize_dispatch(kv_committing);
+      }
       {
 	std::unique_lock m{kv_finalize_lock};
 	if (kv_committing_to_finalize.empty()) {
@@ -14482,6 +14913,93 @@ void BlueStore::_kv_finalize_thread()
   kv_finalize_started = false;
 }
 
+void BlueStore::_kv_finalize_dispatch(deque<TransContext*>& committed)
+{
+  // route committed txcs to finalize lanes by sequencer; whatever maps to
+  // lane 0 stays in 'committed' for the main kv_finalize_thread.
+  unsigned num_lanes = kv_finalize_lanes.size() + 1;
+  std::vector<deque<TransContext*>> per_lane(num_lanes);
+  for (auto txc : committed) {
+    per_lane[txc->osr->get_sequencer_id() % num_lanes].push_back(txc);
+  }
+  committed.swap(per_lane[0]);
+  for (unsigned i = 1; i < num_lanes; ++i) {
+    if (per_lane[i].empty()) {
+      continue;
+    }
+    auto& lane = kv_finalize_lanes[i - 1];
+    std::lock_guard l(lane->lock);
+    lane->to_finalize.insert(lane->to_finalize.end(),
+			     per_lane[i].begin(), per_lane[i].end());
+    if (!lane->in_progress) {
+      lane->in_progress = true;
+      lane->cond.notify_one();
+    }
+  }
+}
+
+void BlueStore::_compress_thread()
+{
+  std::unique_lock l(compress_lock);
+  while (true) {
+    if (compress_queue.empty()) {
+      if (compress_stop)
+	break;
+      compress_cond.wait(l);
+    } else {
+      auto job = std::move(compress_queue.front());
+      compress_queue.pop_front();
+      l.unlock();
+      job();
+      l.lock();
+    }
+  }
+}
+
+void BlueStore::_kv_finalize_lane_thread(KVFinalizeLane *lane)
+{
+  deque<TransContext*> kv_committed;
+  dout(10) << __func__ << " lane " << lane->id << " start" << dendl;
+  std::unique_lock l(lane->lock);
+  ceph_assert(!lane->started);
+  lane->started = true;
+  lane->cond.notify_all();
+  while (true) {
+    ceph_assert(kv_committed.empty());
+    if (lane->to_finalize.empty()) {
+      if (lane->stop)
+	break;
+      dout(20) << __func__ << " lane " << lane->id << " sleep" << dendl;
+      lane->in_progress = false;
+      lane->cond.wait(l);
+      dout(20) << __func__ << " lane " << lane->id << " wake" << dendl;
+    } else {
+      kv_committed.swap(lane->to_finalize);
+      l.unlock();
+      dout(20) << __func__ << " lane " << lane->id
+	       << " kv_committed " << kv_committed << dendl;
+
+      auto start = mono_clock::now();
+      while (!kv_committed.empty()) {
+	TransContext *txc = kv_committed.front();
+	ceph_assert(txc->get_state() == TransContext::STATE_KV_SUBMITTED);
+	_txc_state_proc(txc);
+	kv_committed.pop_front();
+      }
+      _reap_collections();
+
+      log_latency("kv_final",
+	l_bluestore_kv_final_lat,
+	mono_clock::now() - start,
+	cct->_conf->bluestore_log_op_age);
+
+      l.lock();
+    }
+  }
+  dout(10) << __func__ << " lane " << lane->id << " finish" << dendl;
+  lane->started = false;
+}
+
 
 bluestore_deferred_op_t *BlueStore::_get_deferred_op(
   TransContext *txc, uint64_t len)
@@ -15048,6 +15566,16 @@ void BlueStore::_txc_add_transaction(TransContext *txc, Transaction *t)
       }
       break;
 
+    case Transaction::OP_REMOVE_RANGE:
+      {
+	const ghobject_t& first = i.get_oid(op->oid);
+	const ghobject_t& last = i.get_oid(op->dest_oid);
+	r = _remove_range(txc, c, first, last);
+	if (!r)
+	  continue;
+      }
+      break;
+
     case Transaction::OP_COLL_SETATTR:
       r = -EOPNOTSUPP;
       break;
@@ -16133,6 +16661,49 @@ void BlueStore::_do_write_big(
   }
 }
 
+void BlueStore::_compress_blobs(
+  CompressorRef& c,
+  WriteContext *wctx,
+  std::vector<blob_compression_t>& results)
+{
+  results.resize(wctx->writes.size());
+  std::vector<size_t> todo;
+  for (size_t i = 0; i < wctx->writes.size(); ++i) {
+    if (wctx->writes[i].blob_length > min_alloc_size) {
+      todo.push_back(i);
+    }
+  }
+  if (todo.size() < 2 || compress_threads.empty()) {
+    for (auto i : todo) {
+      _compress_blob(c, wctx->writes[i].bl, results[i]);
+    }
+    return;
+  }
+
+  // hand all but the first blob to the compression threads, and wait
+  // for them once the op thread is done with its own share
+  ceph::mutex done_lock = ceph::make_mutex("BlueStore::_compress_blobs");
+  ceph::condition_variable done_cond;
+  size_t pending = todo.size() - 1;
+  {
+    std::lock_guard l(compress_lock);
+    for (size_t j = 1; j < todo.size(); ++j) {
+      auto i = todo[j];
+      compress_queue.emplace_back([&, i] {
+	_compress_blob(c, wctx->writes[i].bl, results[i]);
+	std::lock_guard l(done_lock);
+	if (--pending == 0) {
+	  done_cond.notify_one();
+	}
+      });
+    }
+    compress_cond.notify_all();
+  }
+  _compress_blob(c, wctx->writes[todo[0]].bl, results[todo[0]]);
+  std::unique_lock l(done_lock);
+  done_cond.wait(l, [&pending] { return pending == 0; });
+}
+
 int BlueStore::_do_alloc_write(
   TransContext *txc,
   CollectionRef coll,
@@ -16213,18 +16784,26 @@ int BlueStore::_do_alloc_write(
   // and the condition is : (data_size < deferred).
 
   auto max_bsize = std::max(wctx->target_blob_size, min_alloc_size);
-  for (auto& wi : wctx->writes) {
+  std::vector<blob_compression_t> compressed;
+  if (c) {
+    _compress_blobs(c, wctx, compressed);
+  }
+  for (size_t i = 0; i < wctx->writes.size(); ++i) {
+    auto& wi = wctx->writes[i];
     if (c && wi.blob_length > min_alloc_size) {
-      auto start = mono_clock::now();
+      auto start = mono_clock::now() - compressed[i].lat;
 
       // compress
       ceph_assert(wi.b_off == 0);
       ceph_assert(wi.blob_length == wi.bl.length());
 
       // FIXME: memory alignment here is bad
-      bufferlist t;
-      std::optional<int32_t> compressor_message;
-      int r = c->compress(wi.bl, t, compressor_message);
+      bufferlist& t = compressed[i].out;
+      std::optional<int32_t>& compressor_message =
+	compressed[i].compressor_message;
+      std::vector<uint32_t>& chunk_lengths = compressed[i].chunk_lengths;
+      uint32_t chunk_size = compressed[i].chunk_size;
+      int r = compressed[i].r;
       uint64_t want_len_raw = wi.blob_length * crr;
       uint64_t want_len = p2roundup(want_len_raw, min_alloc_size);
       bool rejected = false;
@@ -16237,6 +16816,10 @@ int BlueStore::_do_alloc_write(
 	chdr.type = c->get_type();
 	chdr.length = t.length();
 	chdr.compressor_message = compressor_message;
+	if (!chunk_lengths.empty()) {
+	  chdr.chunk_size = chunk_size;
+	  chdr.chunk_lengths = std::move(chunk_lengths);
+	}
 	encode(chdr, wi.compressed_bl);
 	wi.compressed_bl.claim_append(t);
 
@@ -16478,6 +17061,17 @@ void BlueStore::_wctx_finish(
   WriteContext *wctx,
   set<SharedBlob*> *maybe_unshared_blobs)
 {
+  {
+    // fetch the shared blobs we are about to put refs on in one go
+    vector<SharedBlobRef> sbs;
+    for (auto& lo : wctx->old_extents) {
+      if (!lo.r.empty() && lo.e.blob->get_blob().is_shared() &&
+	  !lo.e.blob->is_shared_loaded()) {
+	sbs.push_back(lo.e.blob->get_shared_blob());
+      }
+    }
+    c->load_shared_blobs(sbs);
+  }
   auto oep = wctx->old_extents.begin();
   while (oep != wctx->old_extents.end()) {
     auto &lo = *oep;
@@ -16991,7 +17585,8 @@ int BlueStore::_truncate(TransContext *txc,
 int BlueStore::_do_remove(
   TransContext *txc,
   CollectionRef& c,
-  OnodeRef& o)
+  OnodeRef& o,
+  bool remove_keys)
 {
   set<SharedBlob*> maybe_unshared_blobs;
   bool is_gen = !o->oid.is_no_gen();
@@ -17001,17 +17596,19 @@ int BlueStore::_do_remove(
     _do_omap_clear(txc, o);
   }
   o->exists = false;
-  string key;
-  for (auto &s : o->extent_map.shards) {
-    dout(20) << __func__ << "  removing shard 0x" << std::hex
-	     << s.shard_info->offset << std::dec << dendl;
-    generate_extent_shard_key_and_apply(o->key, s.shard_info->offset, &key,
-      [&](const string& final_key) {
-        txc->t->rmkey(PREFIX_OBJ, final_key);
-      }
-    );
+  if (remove_keys) {
+    string key;
+    for (auto &s : o->extent_map.shards) {
+      dout(20) << __func__ << "  removing shard 0x" << std::hex
+	       << s.shard_info->offset << std::dec << dendl;
+      generate_extent_shard_key_and_apply(o->key, s.shard_info->offset, &key,
+	[&](const string& final_key) {
+	  txc->t->rmkey(PREFIX_OBJ, final_key);
+	}
+      );
+    }
+    txc->t->rmkey(PREFIX_OBJ, o->key.c_str(), o->key.size());
   }
-  txc->t->rmkey(PREFIX_OBJ, o->key.c_str(), o->key.size());
   txc->note_removed_object(o);
   o->extent_map.clear();
   o->onode = bluestore_onode_t();
@@ -17129,6 +17726,103 @@ int BlueStore::_remove(TransContext *txc,
   return r;
 }
 
+int BlueStore::_remove_range(TransContext *txc,
+			     CollectionRef& c,
+			     const ghobject_t& first,
+			     const ghobject_t& last)
+{
+  dout(15) << __func__ << " " << c->cid << " " << first << " to " << last
+	   << " txc " << txc << dendl;
+  auto start_time = mono_clock::now();
+  std::unique_lock l(c->lock);
+
+  // the key range must not reach into another collection (or from the
+  // temp objects of this one into its regular objects)
+  spg_t pgid;
+  if (!c->cid.is_pg(&pgid) ||
+      !c->contains(first) || !c->contains(last) ||
+      first.hobj.is_temp() != last.hobj.is_temp()) {
+    derr << __func__ << " " << first << " to " << last
+	 << " does not lie within " << c->cid << dendl;
+    return -EINVAL;
+  }
+
+  // every onode and extent shard key of the objects in [first, last]
+  // sorts in [start_key, end_key); the byte before the onode suffix
+  // ends a fixed width field, so bumping the suffix bounds it exactly.
+  string start_key, end_key;
+  get_object_key(cct, first, &start_key);
+  get_object_key(cct, last, &end_key);
+  ceph_assert(end_key.back() == ONODE_KEY_SUFFIX);
+  ++end_key.back();
+  if (end_key <= start_key) {
+    return -EINVAL;
+  }
+
+  // committed objects, plus those only written by txcs still in flight
+  std::set<ghobject_t> oids;
+  KeyValueDB::Iterator it = db->get_iterator(PREFIX_OBJ,
+					     KeyValueDB::ITERATOR_NOCACHE);
+  for (it->lower_bound(start_key);
+       it->valid() && it->key() < end_key;
+       it->next()) {
+    string key = it->key();
+    if (is_extent_shard_key(key)) {
+      continue;
+    }
+    ghobject_t oid;
+    int r = get_key_object(key, &oid);
+    if (r < 0) {
+      derr << __func__ << " bad object key " << pretty_binary_string(key)
+	   << dendl;
+      return -EIO;
+    }
+    oids.insert(oid);
+  }
+  c->onode_space.map_any([&](Onode* o) {
+    if (o->exists && o->oid >= first && o->oid <= last) {
+      oids.insert(o->oid);
+    }
+    return false;
+  });
+
+  int r = 0;
+  uint64_t num = 0;
+  for (auto& oid : oids) {
+    OnodeRef o = c->get_onode(oid, false);
+    if (!o || !o->exists) {
+      continue;
+    }
+    dout(20) << __func__ << "  removing " << oid << dendl;
+    r = _do_remove(txc, c, o, false);
+    if (r < 0) {
+      break;
+    }
+    ++num;
+  }
+  if (r == 0) {
+    // one tombstone for all onode and extent shard keys
+    txc->t->rm_range_keys(PREFIX_OBJ, start_key, end_key);
+  }
+
+  log_latency_fn(
+    __func__,
+    l_bluestore_remove_lat,
+    mono_clock::now() - start_time,
+    cct->_conf->bluestore_log_op_age,
+    [&](const ceph::timespan& lat) {
+      ostringstream ostr;
+      ostr << ", lat = " << timespan_str(lat)
+        << " cid =" << c->cid
+        << " objects =" << num;
+      return ostr.str();
+    }
+  );
+  dout(10) << __func__ << " " << c->cid << " " << first << " to " << last
+	   << " removed " << num << " objects = " << r << dendl;
+  return r;
+}
+
 int BlueStore::_setattr(TransContext *txc,
 			CollectionRef& c,
 			OnodeRef& o,
@@ -143,6 +143,10 @@ enum {
   l_bluestore_issued_deferred_write_bytes,
   l_bluestore_submitted_deferred_writes,
   l_bluestore_submitted_deferred_write_bytes,
+  l_bluestore_direct_aio_wait_lat,
+  l_bluestore_prefer_deferred_size,
+  l_bluestore_prefer_deferred_size_raised,
+  l_bluestore_prefer_deferred_size_lowered,
 
   l_bluestore_write_big_skipped_blobs,
   l_bluestore_write_big_skipped_bytes,
@@ -169,6 +173,7 @@ enum {
   l_bluestore_onode_misses,
   l_bluestore_onode_shard_hits,
   l_bluestore_onode_shard_misses,
+  l_bluestore_onode_list_prefetched,
   l_bluestore_extents,
   l_bluestore_blobs,
   //****************************************
@@ -1607,6 +1612,8 @@ private:
 
     OnodeRef add_onode(const ghobject_t& oid, OnodeRef& o);
     OnodeRef lookup(const ghobject_t& o);
+    /// like lookup() but neither pins the onode nor updates hit/miss stats
+    bool contains(const ghobject_t& o);
     void rename(OnodeRef& o, const ghobject_t& old_oid,
 		const ghobject_t& new_oid,
 		const mempool::bluestore_cache_meta::string& new_okey);
@@ -1643,10 +1650,19 @@ private:
     pool_opts_t pool_opts;
     ContextQueue *commit_queue;
 
+    /// where the last collection_list stopped; a listing resuming from
+    /// here is considered sequential and may prefetch onodes
+    ceph::mutex list_hint_lock =
+      ceph::make_mutex("BlueStore::Collection::list_hint_lock");
+    ghobject_t list_next_hint = ghobject_t::get_max();
+
     OnodeCacheShard* get_onode_cache() const {
       return onode_space.cache;
     }
     OnodeRef get_onode(const ghobject_t& oid, bool create, bool is_createop=false);
+    /// populate the onode cache from an already read PREFIX_OBJ value
+    bool prefetch_onode(const ghobject_t& oid, const std::string& key,
+			ceph::buffer::list& v);
 
     // the terminology is confusing here, sorry!
     //
@@ -1661,6 +1677,8 @@ private:
     //  loaded = SharedBlob::shared_blob_t is loaded from kv store
     void open_shared_blob(uint64_t sbid, BlobRef b);
     void load_shared_blob(SharedBlobRef sb);
+    /// load several shared blobs with one batched kv lookup
+    void load_shared_blobs(const std::vector<SharedBlobRef>& sbs);
     void make_blob_shared(uint64_t sbid, BlobRef b);
     uint64_t make_blob_unshared(SharedBlob *sb);
 
@@ -2102,7 +2120,9 @@ private:
     void _audit(CephContext *cct);
 
     DeferredBatch(CephContext *cct, OpSequencer *osr)
-      : osr(osr), ioc(cct, this) {}
+      : osr(osr), ioc(cct, this) {
+      ioc.io_class = blk_io_class_t::DEFERRED;
+    }
 
     /// prepare a write
     void prepare_write(CephContext *cct,
@@ -2164,6 +2184,11 @@ private:
       q.pop_back();
     }
 
+    bool is_empty() {
+      std::lock_guard l(qlock);
+      return q.empty();
+    }
+
     void drain() {
       std::unique_lock l(qlock);
       while (!q.empty())
@@ -2272,6 +2297,33 @@ private:
       return NULL;
     }
   };
+  /// extra finalize lane; committed txcs are routed here by OpSequencer so
+  /// completion order within a sequencer is preserved
+  struct KVFinalizeLane : public Thread {
+    BlueStore *store;
+    const unsigned id;
+    ceph::mutex lock = ceph::make_mutex("BlueStore::KVFinalizeLane::lock");
+    ceph::condition_variable cond;
+    std::deque<TransContext*> to_finalize;
+    bool started = false;
+    bool stop = false;
+    bool in_progress = false;
+    KVFinalizeLane(BlueStore *s, unsigned i) : store(s), id(i) {}
+    void *entry() override {
+      store->_kv_finalize_lane_thread(this);
+      return NULL;
+    }
+  };
+
+  /// compresses blobs of large writes for _do_alloc_write
+  struct CompressThread : public Thread {
+    BlueStore *store;
+    explicit CompressThread(BlueStore *s) : store(s) {}
+    void *entry() override {
+      store->_compress_thread();
+      return NULL;
+    }
+  };
 
   struct BigDeferredWriteContext {
     uint64_t off = 0;     // original logical offset
@@ -2368,9 +2420,18 @@ private:
   std::deque<TransContext*> kv_committing_to_finalize;   ///< pending finalization
   std::deque<DeferredBatch*> deferred_stable_to_finalize; ///< pending finalization
   bool kv_finalize_in_progress = false;
+  /// lanes [1, n); lane 0 is kv_finalize_thread itself
+  std::vector<std::unique_ptr<KVFinalizeLane>> kv_finalize_lanes;
+
+  ceph::mutex compress_lock = ceph::make_mutex("BlueStore::compress_lock");
+  ceph::condition_variable compress_cond;
+  std::deque<std::function<void()>> compress_queue;
+  bool compress_stop = false;
+  std::vector<std::unique_ptr<CompressThread>> compress_threads;
 
   PerfCounters *logger = nullptr;
 
+  ceph::mutex reap_lock = ceph::make_mutex("BlueStore::reap_lock");
   std::list<CollectionRef> removed_collections;
 
   ceph::shared_mutex debug_read_error_lock =
@@ -2703,6 +2764,7 @@ private:
   int _write_fsid();
   void _close_fsid();
   void _set_alloc_sizes();
+  void _adapt_prefer_deferred_size();
   void _set_blob_size();
   void _set_finisher_num();
   void _set_per_pool_omap();
@@ -2826,6 +2888,9 @@ private:
   void _kv_stop();
   void _kv_sync_thread();
   void _kv_finalize_thread();
+  void _kv_finalize_lane_thread(KVFinalizeLane *lane);
+  void _kv_finalize_dispatch(std::deque<TransContext*>& committed);
+  void _compress_thread();
 
   bluestore_deferred_op_t *_get_deferred_op(TransContext *txc, uint64_t len);
   void _deferred_queue(TransContext *txc);
@@ -3336,6 +3401,9 @@ public:
   struct BSPerfTracker {
     PerfCounters::avg_tracker<uint64_t> os_commit_latency_ns;
     PerfCounters::avg_tracker<uint64_t> os_apply_latency_ns;
+    // inputs for the adaptive prefer_deferred_size
+    PerfCounters::avg_tracker<uint64_t> direct_aio_wait_latency_ns;
+    PerfCounters::avg_tracker<uint64_t> kv_commit_latency_ns;
 
     objectstore_perf_stat_t get_cur_stats() const {
       objectstore_perf_stat_t ret;
@@ -3345,6 +3413,7 @@ public:
     }
 
     void update_from_perfcounters(PerfCounters &logger);
+    void update_deferred_from_perfcounters(PerfCounters &logger);
   } perf_tracker;
 
   objectstore_perf_stat_t get_cur_stats() override {
@@ -3410,6 +3479,9 @@ public:
   bool has_builtin_csum() const override {
     return true;
   }
+  bool supports_remove_range() const override {
+    return true;
+  }
   // a debug punch_hole function, to use internals of _wctx_finish
   // to remove old_extents from object
   void debug_punch_hole(
@@ -3508,6 +3580,28 @@ private:
     const ceph::buffer::list& bl,
     uint64_t logical_offset) const;
   int _decompress(ceph::buffer::list& source, ceph::buffer::list* result);
+  /// decompress only the raw blob ranges in want (all if empty); result
+  /// is keyed by raw blob offset
+  int _decompress(ceph::buffer::list& source,
+		  const interval_set<uint32_t>& want,
+		  std::map<uint32_t, ceph::buffer::list>* result);
+  int _compress_chunked(CompressorRef& c,
+			const ceph::buffer::list& in,
+			uint32_t chunk_size,
+			ceph::buffer::list& out,
+			std::optional<int32_t>& compressor_message,
+			std::vector<uint32_t>* chunk_lengths);
+  struct blob_compression_t {
+    int r = 0;
+    ceph::buffer::list out;
+    std::optional<int32_t> compressor_message;
+    std::vector<uint32_t> chunk_lengths;
+    uint32_t chunk_size = 0;
+    ceph::timespan lat;
+  };
+  void _compress_blob(CompressorRef& c,
+		      const ceph::buffer::list& in,
+		      blob_compression_t& result);
 
 
   // --------------------------------------------------------
@@ -3616,6 +3710,10 @@ private:
     uint64_t offset, uint64_t length,
     ceph::buffer::list::iterator& blp,
     WriteContext *wctx);
+  void _compress_blobs(
+    CompressorRef& c,
+    WriteContext *wctx,
+    std::vector<blob_compression_t>& results);
   int _do_alloc_write(
     TransContext *txc,
     CollectionRef c,
@@ -3688,7 +3786,12 @@ private:
 	      OnodeRef& o);
   int _do_remove(TransContext *txc,
 		 CollectionRef& c,
-		 OnodeRef& o);
+		 OnodeRef& o,
+		 bool remove_keys = true);
+  int _remove_range(TransContext *txc,
+		    CollectionRef& c,
+		    const ghobject_t& first,
+		    const ghobject_t& last);
   int _setattr(TransContext *txc,
 	       CollectionRef& c,
 	       OnodeRef& o,
@@ -0,0 +1,240 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "CachingAllocator.h"
+
+#include "common/debug.h"
+
+#define dout_context cct
+#define dout_subsys ceph_subsys_bluestore
+#undef  dout_prefix
+#define dout_prefix *_dout << "CachingAllocator(" << this << ") "
+
+namespace {
+  // threads pick a shard once, round robin, so that a thread keeps
+  // hitting the same shard (and its cache lines)
+  std::atomic<unsigned> next_thread_slot = {0};
+  thread_local unsigned thread_slot = next_thread_slot++;
+}
+
+CachingAllocator::CachingAllocator(CephContext* cct,
+				   Allocator* _backing,
+				   unsigned num_shards,
+				   uint64_t _shard_max,
+				   uint64_t _max_cached_alloc,
+				   std::string_view name)
+  : Allocator(name, _backing->get_capacity(), _backing->get_block_size()),
+    cct(cct),
+    backing(_backing),
+    max_cached_alloc(p2align(_max_cached_alloc, (uint64_t)block_size)),
+    shard_max(p2align(_shard_max, (uint64_t)block_size))
+{
+  ceph_assert(num_shards > 0);
+  shards.reserve(num_shards);
+  for (unsigned i = 0; i < num_shards; ++i) {
+    shards.emplace_back(std::make_unique<Shard>());
+  }
+  ldout(cct, 1) << __func__ << " " << backing->get_type()
+		<< " shards " << num_shards
+		<< std::hex << " shard_max 0x" << shard_max
+		<< " max_cached_alloc 0x" << max_cached_alloc << std::dec
+		<< dendl;
+}
+
+CachingAllocator::~CachingAllocator()
+{
+  flush();
+}
+
+CachingAllocator::Shard& CachingAllocator::get_shard()
+{
+  return *shards[thread_slot % shards.size()];
+}
+
+void CachingAllocator::_take(Shard& s, uint64_t want,
+			     uint64_t max_alloc_size,
+			     PExtentVector* extents)
+{
+  ceph_assert(s.bytes >= want);
+  size_t first = extents->size();
+  uint64_t left = want;
+  while (left > 0) {
+    ceph_assert(!s.free.empty());
+    auto& e = s.free.back();
+    uint64_t l = std::min<uint64_t>({left, e.length, max_alloc_size});
+    if (extents->size() > first &&
+	extents->back().end() == e.offset &&
+	extents->back().length + l <= max_alloc_size) {
+      extents->back().length += l;
+    } else {
+      extents->emplace_back(e.offset, l);
+    }
+    e.offset += l;
+    e.length -= l;
+    if (e.length == 0) {
+      s.free.pop_back();
+    }
+    left -= l;
+  }
+  s.bytes -= want;
+  cached_bytes -= want;
+}
+
+void CachingAllocator::_refill(Shard& s, uint64_t want, int64_t hint)
+{
+  uint64_t need = std::max(p2roundup(want, (uint64_t)block_size),
+			   shard_max / 2);
+  PExtentVector got;
+  int64_t r = backing->allocate(need, block_size, 0, hint, &got);
+  ldout(cct, 20) << __func__ << std::hex << " want 0x" << need
+		 << " got 0x" << r << std::dec << dendl;
+  if (r <= 0) {
+    return;
+  }
+  // extents are consumed from the back; keep the lower offsets for last
+  s.free.insert(s.free.begin(), got.begin(), got.end());
+  s.bytes += r;
+  cached_bytes += r;
+}
+
+int64_t CachingAllocator::allocate(
+  uint64_t want,
+  uint64_t unit,
+  uint64_t max_alloc_size,
+  int64_t hint,
+  PExtentVector *extents)
+{
+  if (max_alloc_size == 0) {
+    max_alloc_size = want;
+  }
+  max_alloc_size = p2align(max_alloc_size, (uint64_t)block_size);
+  if (want <= max_cached_alloc && unit == (uint64_t)block_size &&
+      max_alloc_size > 0) {
+    Shard& s = get_shard();
+    std::lock_guard l(s.lock);
+    if (s.bytes < want) {
+      _refill(s, want, hint);
+    }
+    if (s.bytes >= want) {
+      _take(s, want, max_alloc_size, extents);
+      return want;
+    }
+  }
+  size_t n = extents->size();
+  int64_t r = backing->allocate(want, unit, max_alloc_size, hint, extents);
+  if ((r < 0 || (uint64_t)r < want) && cached_bytes > 0) {
+    // space may be stuck in the shards; give it back and retry
+    ldout(cct, 10) << __func__ << std::hex << " 0x" << want << " got 0x" << r
+		   << std::dec << ", flushing shards" << dendl;
+    if (r > 0) {
+      interval_set<uint64_t> partial;
+      for (size_t i = n; i < extents->size(); ++i) {
+	partial.insert((*extents)[i].offset, (*extents)[i].length);
+      }
+      extents->resize(n);
+      backing->release(partial);
+    }
+    flush();
+    r = backing->allocate(want, unit, max_alloc_size, hint, extents);
+  }
+  return r;
+}
+
+void CachingAllocator::release(const interval_set<uint64_t>& release_set)
+{
+  interval_set<uint64_t> to_backing;
+  Shard& s = get_shard();
+  {
+    std::lock_guard l(s.lock);
+    for (auto p = release_set.begin(); p != release_set.end(); ++p) {
+      uint64_t off = p.get_start();
+      uint64_t len = p.get_len();
+      if (len <= max_cached_alloc &&
+	  s.bytes + len <= shard_max &&
+	  p2phase(off, (uint64_t)block_size) == 0 &&
+	  p2phase(len, (uint64_t)block_size) == 0) {
+	s.free.emplace_back(off, len);
+	s.bytes += len;
+	cached_bytes += len;
+      } else {
+	to_backing.insert(off, len);
+      }
+    }
+  }
+  if (!to_backing.empty()) {
+    backing->release(to_backing);
+  }
+}
+
+void CachingAllocator::flush()
+{
+  for (auto& s : shards) {
+    interval_set<uint64_t> to_backing;
+    {
+      std::lock_guard l(s->lock);
+      for (auto& e : s->free) {
+	to_backing.union_insert(e.offset, e.length);
+      }
+      cached_bytes -= s->bytes;
+      s->bytes = 0;
+      s->free.clear();
+    }
+    if (!to_backing.empty()) {
+      backing->release(to_backing);
+    }
+  }
+}
+
+void CachingAllocator::dump()
+{
+  ldout(cct, 0) << __func__ << " cached 0x" << std::hex << cached_bytes
+		<< std::dec << " in " << shards.size() << " shards" << dendl;
+  for (auto& s : shards) {
+    std::lock_guard l(s->lock);
+    for (auto& e : s->free) {
+      ldout(cct, 0) << "  cached 0x" << std::hex << e.offset << "~"
+		    << e.length << std::dec << dendl;
+    }
+  }
+  backing->dump();
+}
+
+void CachingAllocator::foreach(
+  std::function<void(uint64_t offset, uint64_t length)> notify)
+{
+  backing->foreach(notify);
+  for (auto& s : shards) {
+    std::lock_guard l(s->lock);
+    for (auto& e : s->free) {
+      notify(e.offset, e.length);
+    }
+  }
+}
+
+void CachingAllocator::init_add_free(uint64_t offset, uint64_t length)
+{
+  backing->init_add_free(offset, length);
+}
+
+void CachingAllocator::init_rm_free(uint64_t offset, uint64_t length)
+{
+  // the range may sit in a shard; start from a clean backing state
+  flush();
+  backing->init_rm_free(offset, length);
+}
+
+uint64_t CachingAllocator::get_free()
+{
+  return backing->get_free() + cached_bytes;
+}
+
+double CachingAllocator::get_fragmentation()
+{
+  return backing->get_fragmentation();
+}
+
+void CachingAllocator::shutdown()
+{
+  flush();
+  backing->shutdown();
+}
@@ -0,0 +1,82 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "Allocator.h"
+#include "common/ceph_mutex.h"
+#include "include/mempool.h"
+
+/*
+ * Front-end for another allocator that keeps a few sharded caches of
+ * free extents.  Threads are spread over the shards, so small
+ * allocations and releases of exactly the allocation unit mostly take
+ * an uncontended shard lock instead of the backing allocator's single
+ * lock.  Shards are refilled from the backing allocator in batches and
+ * hand space back to it once they hold more than their limit.
+ *
+ * Cached extents are still free space: get_free() and foreach() report
+ * them.  Allocation hints are ignored for requests served from a shard.
+ */
+class CachingAllocator : public Allocator {
+  struct Shard {
+    ceph::mutex lock = ceph::make_mutex("CachingAllocator::Shard::lock");
+    mempool::bluestore_alloc::vector<bluestore_pextent_t> free;
+    uint64_t bytes = 0;
+  };
+
+  CephContext* cct;
+  std::unique_ptr<Allocator> backing;
+  const uint64_t max_cached_alloc;  ///< larger requests bypass the shards
+  const uint64_t shard_max;         ///< bytes a shard may hold
+  std::vector<std::unique_ptr<Shard>> shards;
+  std::atomic<uint64_t> cached_bytes = {0};
+
+  Shard& get_shard();
+  /// take want bytes from s; s.lock must be held and s.bytes >= want
+  void _take(Shard& s, uint64_t want, uint64_t max_alloc_size,
+	     PExtentVector* extents);
+  void _refill(Shard& s, uint64_t want, int64_t hint);
+  /// hand every shard's extents back to the backing allocator
+  void flush();
+
+public:
+  /// takes ownership of backing
+  CachingAllocator(CephContext* cct,
+		   Allocator* backing,
+		   unsigned num_shards,
+		   uint64_t shard_max,
+		   uint64_t max_cached_alloc,
+		   std::string_view name);
+  ~CachingAllocator() override;
+
+  const char* get_type() const override {
+    return backing->get_type();
+  }
+  int64_t allocate(
+    uint64_t want,
+    uint64_t unit,
+    uint64_t max_alloc_size,
+    int64_t hint,
+    PExtentVector *extents) override;
+  void release(const interval_set<uint64_t>& release_set) override;
+
+  void dump() override;
+  void foreach(
+    std::function<void(uint64_t offset, uint64_t length)> notify) override;
+
+  void init_add_free(uint64_t offset, uint64_t length) override;
+  void init_rm_free(uint64_t offset, uint64_t length) override;
+
+  uint64_t get_free() override;
+  double get_fragmentation() override;
+  void shutdown() override;
+
+  uint64_t get_cached() const {
+    return cached_bytes;
+  }
+};
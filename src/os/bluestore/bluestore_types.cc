@@ -1286,6 +1286,14 @@ void bluestore_compression_header_t::dump(Formatter *f) const
   if (compressor_message) {
     f->dump_int("compressor_message", *compressor_message);
   }
+  if (chunk_size) {
+    f->dump_unsigned("chunk_size", chunk_size);
+    f->open_array_section("chunk_lengths");
+    for (auto l : chunk_lengths) {
+      f->dump_unsigned("length", l);
+    }
+    f->close_section();
+  }
 }
 
 void bluestore_compression_header_t::generate_test_instances(
@@ -1294,6 +1302,10 @@ void bluestore_compression_header_t::generate_test_instances(
   o.push_back(new bluestore_compression_header_t);
   o.push_back(new bluestore_compression_header_t(1));
   o.back()->length = 1234;
+  o.push_back(new bluestore_compression_header_t(1));
+  o.back()->length = 1234;
+  o.back()->chunk_size = 0x2000;
+  o.back()->chunk_lengths = {1000, 234};
 }
 
 // adds more salt to build a hash func input
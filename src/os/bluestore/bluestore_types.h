@@ -20,6 +20,7 @@
 #include <type_traits>
 #include <vector>
 #include <array>
+#include <boost/container/small_vector.hpp>
 #include "include/mempool.h"
 #include "include/types.h"
 #include "include/interval_set.h"
@@ -113,7 +114,12 @@ WRITE_CLASS_DENC(bluestore_pextent_t)
 
 std::ostream& operator<<(std::ostream& out, const bluestore_pextent_t& o);
 
-typedef mempool::bluestore_cache_other::vector<bluestore_pextent_t> PExtentVector;
+// The vast majority of blobs (and allocations) map to a single physical
+// extent; keep that one inline rather than paying a separate heap
+// allocation per blob.
+typedef boost::container::small_vector<
+  bluestore_pextent_t, 1,
+  mempool::bluestore_cache_other::pool_allocator<bluestore_pextent_t>> PExtentVector;
 
 template<>
 struct denc_traits<PExtentVector> {
@@ -1175,17 +1181,64 @@ struct bluestore_compression_header_t {
   uint8_t type = Compressor::COMP_ALG_NONE;
   uint32_t length = 0;
   std::optional<int32_t> compressor_message;
+  /// if non-zero, the payload is a sequence of independently compressed
+  /// chunks of chunk_size raw bytes each (the last may be shorter)
+  uint32_t chunk_size = 0;
+  std::vector<uint32_t> chunk_lengths;  ///< compressed length of each chunk
+
+  /// set in the encoded type of chunked headers.  DENC decoders don't
+  /// check compat, so this is what makes code that predates chunking
+  /// fail to find a decompressor instead of decompressing the chunks as
+  /// a single stream.
+  static constexpr uint8_t TYPE_CHUNKED = 0x80;
 
   bluestore_compression_header_t() {}
   bluestore_compression_header_t(uint8_t _type)
     : type(_type) {}
 
-  DENC(bluestore_compression_header_t, v, p) {
-    DENC_START(2, 1, p);
-    denc(v.type, p);
-    denc(v.length, p);
+  DENC_HELPERS
+  void bound_encode(size_t& p) const {
+    DENC_START(3, 3, p);
+    denc(type, p);
+    denc(length, p);
+    denc(compressor_message, p);
+    denc(chunk_size, p);
+    denc(chunk_lengths, p);
+    DENC_FINISH(p);
+  }
+  void encode(ceph::buffer::list::contiguous_appender& p) const {
+    // only chunked headers need v3; keep the others readable by older
+    // releases
+    if (!chunk_size) {
+      DENC_START(2, 1, p);
+      denc(type, p);
+      denc(length, p);
+      denc(compressor_message, p);
+      DENC_FINISH(p);
+    } else {
+      DENC_START(3, 3, p);
+      uint8_t t = type | TYPE_CHUNKED;
+      denc(t, p);
+      denc(length, p);
+      denc(compressor_message, p);
+      denc(chunk_size, p);
+      denc(chunk_lengths, p);
+      DENC_FINISH(p);
+    }
+  }
+  void decode(ceph::buffer::ptr::const_iterator& p) {
+    DENC_START(3, 1, p);
+    denc(type, p);
+    denc(length, p);
     if (struct_v >= 2) {
-      denc(v.compressor_message, p);
+      denc(compressor_message, p);
+    }
+    chunk_size = 0;
+    chunk_lengths.clear();
+    if (struct_v >= 3) {
+      denc(chunk_size, p);
+      denc(chunk_lengths, p);
+      type &= ~TYPE_CHUNKED;
     }
     DENC_FINISH(p);
   }
@@ -1549,6 +1549,8 @@ void ECBackend::objects_read_async(
 
   uint32_t flags = 0;
   extent_set es;
+  // data shards holding the requested bytes, before stripe alignment
+  set<int> want_to_read;
   for (list<pair<boost::tuple<uint64_t, uint64_t, uint32_t>,
 	 pair<bufferlist*, Context*> > >::const_iterator i =
 	 to_read.begin();
@@ -1560,6 +1562,19 @@ void ECBackend::objects_read_async(
 
     es.union_insert(tmp.first, tmp.second);
     flags |= i->first.get<2>();
+    read_pipeline.get_want_to_read_shards(
+      i->first.get<0>(), i->first.get<1>(), &want_to_read);
+  }
+
+  // a redundant fast read needs every data shard to race the parity ones
+  map<hobject_t, set<int>> partial_want;
+  if (!fast_read &&
+      !want_to_read.empty() &&
+      want_to_read.size() < ec_impl->get_data_chunk_count() &&
+      cct->_conf.get_val<bool>("osd_ec_partial_reads")) {
+    dout(20) << __func__ << " " << hoid << " partial read of shards "
+	     << want_to_read << dendl;
+    partial_want.emplace(hoid, std::move(want_to_read));
   }
 
   if (!es.empty()) {
@@ -1646,7 +1661,7 @@ void ECBackend::objects_read_async(
       to_read.clear();
     }
   };
-  objects_read_and_reconstruct(
+  read_pipeline.objects_read_and_reconstruct(
     reads,
     fast_read,
     make_gen_lambda_context<
@@ -1654,7 +1669,8 @@ void ECBackend::objects_read_async(
 	cb(this,
 	   hoid,
 	   to_read,
-	   on_complete)));
+	   on_complete)),
+    partial_want);
 }
 
 void ECBackend::objects_read_and_reconstruct(
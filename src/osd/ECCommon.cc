@@ -461,6 +461,18 @@ void ECCommon::ReadPipeline::get_want_to_read_shards(
   }
 }
 
+void ECCommon::ReadPipeline::get_want_to_read_shards(
+  uint64_t off,
+  uint64_t len,
+  std::set<int> *want_to_read) const
+{
+  const std::vector<int> &chunk_mapping = ec_impl->get_chunk_mapping();
+  for (int i : sinfo.offset_len_to_data_chunks(std::make_pair(off, len))) {
+    int chunk = (int)chunk_mapping.size() > i ? chunk_mapping[i] : i;
+    want_to_read->insert(chunk);
+  }
+}
+
 struct ClientReadCompleter : ECCommon::ReadCompleter {
   ClientReadCompleter(ECCommon::ReadPipeline &read_pipeline,
                       ECCommon::ClientAsyncReadStatus *status)
@@ -491,11 +503,21 @@ struct ClientReadCompleter : ECCommon::ReadCompleter {
 	   ++j) {
 	to_decode[j->first.shard] = std::move(j->second);
       }
-      int r = ECUtil::decode(
-	read_pipeline.sinfo,
-	read_pipeline.ec_impl,
-	to_decode,
-	&bl);
+      int r;
+      if (to_decode.size() < read_pipeline.ec_impl->get_data_chunk_count()) {
+	// partial read: every wanted shard was read directly
+	r = ECUtil::decode_data_chunks(
+	  read_pipeline.sinfo,
+	  read_pipeline.ec_impl,
+	  to_decode,
+	  &bl);
+      } else {
+	r = ECUtil::decode(
+	  read_pipeline.sinfo,
+	  read_pipeline.ec_impl,
+	  to_decode,
+	  &bl);
+      }
       if (r < 0) {
         res.r = r;
         goto out;
@@ -529,7 +551,8 @@ void ECCommon::ReadPipeline::objects_read_and_reconstruct(
     std::list<boost::tuple<uint64_t, uint64_t, uint32_t> >
   > &reads,
   bool fast_read,
-  GenContextURef<map<hobject_t,pair<int, extent_map> > &&> &&func)
+  GenContextURef<map<hobject_t,pair<int, extent_map> > &&> &&func,
+  const map<hobject_t, set<int>> &partial_want)
 {
   in_progress_client_reads.emplace_back(
     reads.size(), std::move(func));
@@ -544,10 +567,13 @@ void ECCommon::ReadPipeline::objects_read_and_reconstruct(
     
   map<hobject_t, read_request_t> for_read_op;
   for (auto &&to_read: reads) {
+    auto p = partial_want.find(to_read.first);
+    const set<int> &want =
+      p != partial_want.end() ? p->second : want_to_read;
     map<pg_shard_t, vector<pair<int, int>>> shards;
     int r = get_min_avail_to_read_shards(
       to_read.first,
-      want_to_read,
+      want,
       false,
       fast_read,
       &shards);
@@ -560,7 +586,7 @@ void ECCommon::ReadPipeline::objects_read_and_reconstruct(
 	  to_read.second,
 	  shards,
 	  false)));
-    obj_want_to_read.insert(make_pair(to_read.first, want_to_read));
+    obj_want_to_read.insert(make_pair(to_read.first, want));
   }
 
   start_read_op(
@@ -913,12 +939,20 @@ bool ECCommon::RMWPipeline::try_finish_rmw()
   }
 
   if (op->using_cache) {
-    cache.release_write_pin(op->pin);
+    // keep the committed stripes around for the next partial overwrite
+    cache.release_write_pin(
+      op->pin,
+      get_parent()->get_pool().allows_ecoverwrites() ?
+        cct->_conf.get_val<Option::size_t>("osd_ec_extent_cache_size") : 0);
   }
   tid_to_op_map.erase(op->tid);
 
   if (waiting_reads.empty() &&
       waiting_commit.empty()) {
+    if (pipeline_state.cache_invalid()) {
+      // writes bypassed the cache, what it retained may be stale
+      cache.discard_retained();
+    }
     pipeline_state.clear();
     dout(20) << __func__ << ": clearing pipeline_state "
 	     << pipeline_state
@@ -947,6 +981,7 @@ void ECCommon::RMWPipeline::on_change()
   for (auto &&op: tid_to_op_map) {
     cache.release_write_pin(op.second->pin);
   }
+  cache.discard_retained();
   tid_to_op_map.clear();
 }
 
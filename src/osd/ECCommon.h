@@ -364,11 +364,13 @@ struct ECCommon {
     ReadOp(ReadOp &&) = default;
   };
   struct ReadPipeline {
+    /// partial_want overrides the shards wanted for the listed objects
     void objects_read_and_reconstruct(
       const std::map<hobject_t, std::list<boost::tuple<uint64_t, uint64_t, uint32_t> >
       > &reads,
       bool fast_read,
-      GenContextURef<std::map<hobject_t,std::pair<int, extent_map> > &&> &&func);
+      GenContextURef<std::map<hobject_t,std::pair<int, extent_map> > &&> &&func,
+      const std::map<hobject_t, std::set<int>> &partial_want = {});
 
     template <class F, class G>
     void filter_read_op(
@@ -448,6 +450,11 @@ struct ECCommon {
     friend struct FinishReadOp;
 
     void get_want_to_read_shards(std::set<int> *want_to_read) const;
+    /// shards holding the data chunks of logical [off, off + len)
+    void get_want_to_read_shards(
+      uint64_t off,
+      uint64_t len,
+      std::set<int> *want_to_read) const;
 
     /// Returns to_read replicas sufficient to reconstruct want
     int get_min_avail_to_read_shards(
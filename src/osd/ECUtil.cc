@@ -47,6 +47,41 @@ int ECUtil::decode(
   return 0;
 }
 
+int ECUtil::decode_data_chunks(
+  const stripe_info_t &sinfo,
+  ErasureCodeInterfaceRef &ec_impl,
+  map<int, bufferlist> &to_decode,
+  bufferlist *out) {
+  ceph_assert(to_decode.size());
+
+  uint64_t total_data_size = to_decode.begin()->second.length();
+  ceph_assert(total_data_size % sinfo.get_chunk_size() == 0);
+
+  ceph_assert(out);
+  ceph_assert(out->length() == 0);
+
+  for (auto &&i : to_decode) {
+    ceph_assert(i.second.length() == total_data_size);
+  }
+
+  const vector<int> &chunk_mapping = ec_impl->get_chunk_mapping();
+  unsigned k = ec_impl->get_data_chunk_count();
+  for (uint64_t i = 0; i < total_data_size; i += sinfo.get_chunk_size()) {
+    for (unsigned j = 0; j < k; ++j) {
+      int shard = chunk_mapping.size() > j ? chunk_mapping[j] : j;
+      auto p = to_decode.find(shard);
+      if (p == to_decode.end()) {
+	out->append_zero(sinfo.get_chunk_size());
+      } else {
+	bufferlist bl;
+	bl.substr_of(p->second, i, sinfo.get_chunk_size());
+	out->claim_append(bl);
+      }
+    }
+  }
+  return 0;
+}
+
 int ECUtil::decode(
   const stripe_info_t &sinfo,
   ErasureCodeInterfaceRef &ec_impl,
@@ -120,6 +155,43 @@ int ECUtil::decode(
   return 0;
 }
 
+// encode all the stripes of in with a single encode_chunks() call
+static int encode_stripes(
+  const ECUtil::stripe_info_t &sinfo,
+  ErasureCodeInterfaceRef &ec_impl,
+  bufferlist &in,
+  const set<int> &want,
+  map<int, bufferlist> *out) {
+  const unsigned k = ec_impl->get_data_chunk_count();
+  const unsigned n = ec_impl->get_chunk_count();
+  const uint64_t chunk_size = sinfo.get_chunk_size();
+  const uint64_t stripes = in.length() / sinfo.get_stripe_width();
+  const auto &mapping = ec_impl->get_chunk_mapping();
+  auto chunk_index = [&mapping](unsigned i) {
+    return mapping.size() > i ? mapping[i] : (int)i;
+  };
+
+  map<int, bufferlist> chunks;
+  for (unsigned i = 0; i < n; i++) {
+    ceph::bufferptr buf(ceph::buffer::create_page_aligned(stripes * chunk_size));
+    if (i < k) {
+      for (uint64_t s = 0; s < stripes; s++) {
+	in.begin(s * sinfo.get_stripe_width() + i * chunk_size).copy(
+	  chunk_size, buf.c_str() + s * chunk_size);
+      }
+    }
+    chunks[chunk_index(i)].push_back(std::move(buf));
+  }
+  int r = ec_impl->encode_chunks(want, &chunks);
+  if (r < 0)
+    return r;
+  for (auto &&[shard, bl] : chunks) {
+    if (want.count(shard))
+      (*out)[shard] = std::move(bl);
+  }
+  return 0;
+}
+
 int ECUtil::encode(
   const stripe_info_t &sinfo,
   ErasureCodeInterfaceRef &ec_impl,
@@ -136,17 +208,24 @@ int ECUtil::encode(
   if (logical_size == 0)
     return 0;
 
-  for (uint64_t i = 0; i < logical_size; i += sinfo.get_stripe_width()) {
-    map<int, bufferlist> encoded;
-    bufferlist buf;
-    buf.substr_of(in, i, sinfo.get_stripe_width());
-    int r = ec_impl->encode(want, buf, &encoded);
+  if (logical_size > sinfo.get_stripe_width() &&
+      (ec_impl->get_supported_optimizations() &
+       ceph::ErasureCodeInterface::FLAG_EC_PLUGIN_MULTI_STRIPE_OPTIMIZATION)) {
+    int r = encode_stripes(sinfo, ec_impl, in, want, out);
     ceph_assert(r == 0);
-    for (map<int, bufferlist>::iterator i = encoded.begin();
-	 i != encoded.end();
-	 ++i) {
-      ceph_assert(i->second.length() == sinfo.get_chunk_size());
-      (*out)[i->first].claim_append(i->second);
+  } else {
+    for (uint64_t i = 0; i < logical_size; i += sinfo.get_stripe_width()) {
+      map<int, bufferlist> encoded;
+      bufferlist buf;
+      buf.substr_of(in, i, sinfo.get_stripe_width());
+      int r = ec_impl->encode(want, buf, &encoded);
+      ceph_assert(r == 0);
+      for (map<int, bufferlist>::iterator i = encoded.begin();
+	   i != encoded.end();
+	   ++i) {
+	ceph_assert(i->second.length() == sinfo.get_chunk_size());
+	(*out)[i->first].claim_append(i->second);
+      }
     }
   }
 
@@ -16,6 +16,7 @@
 #define ECUTIL_H
 
 #include <ostream>
+#include <set>
 #include "erasure-code/ErasureCodeInterface.h"
 #include "include/buffer_fwd.h"
 #include "include/ceph_assert.h"
@@ -77,6 +78,19 @@ public:
       (in.first - off) + in.second);
     return std::make_pair(off, len);
   }
+  /// data chunk positions (0 to k-1) holding logical [off, off + len)
+  std::set<int> offset_len_to_data_chunks(
+    std::pair<uint64_t, uint64_t> in) const {
+    std::set<int> chunks;
+    if (in.second == 0)
+      return chunks;
+    const uint64_t k = stripe_width / chunk_size;
+    uint64_t first = in.first / chunk_size;
+    uint64_t last = (in.first + in.second - 1) / chunk_size;
+    for (uint64_t c = first; c <= last && chunks.size() < k; ++c)
+      chunks.insert(c % k);
+    return chunks;
+  }
 };
 
 int decode(
@@ -91,6 +105,18 @@ int decode(
   std::map<int, ceph::buffer::list> &to_decode,
   std::map<int, ceph::buffer::list*> &out);
 
+/**
+ * Lay out whole stripes from the data shards in to_decode without
+ * decoding.  Data chunks that were not read are filled with zeros, so
+ * this is only meaningful when every byte the caller will look at
+ * lives on one of the shards that were read.
+ */
+int decode_data_chunks(
+  const stripe_info_t &sinfo,
+  ceph::ErasureCodeInterfaceRef &ec_impl,
+  std::map<int, ceph::buffer::list> &to_decode,
+  ceph::buffer::list *out);
+
 int encode(
   const stripe_info_t &sinfo,
   ceph::ErasureCodeInterfaceRef &ec_impl,
@@ -24,6 +24,7 @@ void ExtentCache::extent::_link_pin_state(pin_state &pin_state)
   ceph_assert(!parent_pin_state);
   parent_pin_state = &pin_state;
   pin_state.pin_list.push_back(*this);
+  pin_state.pinned_bytes += length;
 }
 
 void ExtentCache::extent::_unlink_pin_state()
@@ -32,6 +33,7 @@ void ExtentCache::extent::_unlink_pin_state()
   ceph_assert(parent_pin_state);
   auto liter = pin_state::list::s_iterator_to(*this);
   parent_pin_state->pin_list.erase(liter);
+  parent_pin_state->pinned_bytes -= length;
   parent_pin_state = nullptr;
 }
 
@@ -222,7 +224,7 @@ void ExtentCache::present_rmw_update(
 
 ostream &ExtentCache::print(ostream &out) const
 {
-  out << "ExtentCache(" << std::endl;
+  out << "ExtentCache(retained=" << retained.pinned_bytes << std::endl;
   for (auto esiter = per_object_caches.begin();
        esiter != per_object_caches.end();
        ++esiter) {
@@ -89,9 +89,19 @@
         state (all are possible).  Reads are not possible
 	in this state (or the others) due to 2).
 
+   3) Retained:
+      - This extent has the data of the last write which pinned it,
+        and that write has committed
+      - No op pins this extent, it is owned by the cache itself and
+        may be dropped at any time (least recently written first)
+      - The next write pinning it finds the data without a read
+
    All of the above suggests that there are 3 things users can
    ask of the cache corresponding to the 3 Write pipelines
-   states.
+   states.  Retained extents do not change this: the caller decides
+   how much to keep when releasing a write pin, and must discard them
+   whenever the object may have been modified other than through
+   pinned writes.
  */
 
 /// If someone wants these types, but not ExtentCache, move to another file
@@ -350,6 +360,7 @@ private:
     enum pin_type_t {
       NONE,
       WRITE,
+      RETAINED,
     };
     pin_type_t pin_type = NONE;
     bool is_write() const { return pin_type == WRITE; }
@@ -365,6 +376,7 @@ private:
       &extent::pin_list_member>;
     using list = boost::intrusive::list<extent, list_member_options>;
     list pin_list;
+    uint64_t pinned_bytes = 0;
     ~pin_state() {
       ceph_assert(pin_list.empty());
       ceph_assert(tid == 0);
@@ -378,20 +390,48 @@ private:
     }
   };
 
-  void release_pin(pin_state &p) {
+  /// extents kept after their last pin was released, oldest first
+  pin_state retained;
+
+  void destroy_extent(extent *e) {
+    std::unique_ptr<extent> extent(e); // we now own this
+    ceph_assert(extent->parent_extent_set);
+    auto &eset = *(extent->parent_extent_set);
+    extent->unlink();
+    remove_and_destroy_if_empty(eset);
+  }
+
+  void trim_retained(uint64_t max_retained) {
+    while (retained.pinned_bytes > max_retained) {
+      ceph_assert(!retained.pin_list.empty());
+      destroy_extent(&retained.pin_list.front());
+    }
+  }
+
+  void release_pin(pin_state &p, uint64_t max_retained) {
     for (auto iter = p.pin_list.begin(); iter != p.pin_list.end(); ) {
-      std::unique_ptr<extent> extent(&*iter); // we now own this
+      extent *ext = &*iter;
       iter++; // unlink will invalidate
-      ceph_assert(extent->parent_extent_set);
-      auto &eset = *(extent->parent_extent_set);
-      extent->unlink();
-      remove_and_destroy_if_empty(eset);
+      if (max_retained && ext->bl) {
+	ext->move(retained);
+      } else {
+	destroy_extent(ext);
+      }
     }
     p.tid = 0;
     p.pin_type = pin_state::NONE;
+    trim_retained(max_retained);
   }
 
 public:
+  ExtentCache() {
+    retained.pin_type = pin_state::RETAINED;
+  }
+  ~ExtentCache() {
+    discard_retained();
+    retained.pin_type = pin_state::NONE;
+  }
+
   class write_pin : private pin_state {
     friend class ExtentCache;
   private:
@@ -475,10 +515,24 @@ public:
 
   /**
    * Release all buffers pinned by pin
+   *
+   * Extents holding data are retained rather than freed, as long as
+   * the cache then holds at most max_retained bytes of retained
+   * extents.  The pin's write must have committed.
    */
   void release_write_pin(
-    write_pin &pin) {
-    release_pin(pin);
+    write_pin &pin,
+    uint64_t max_retained = 0) {
+    release_pin(pin, max_retained);
+  }
+
+  /// Drop every retained extent, pinned extents are unaffected
+  void discard_retained() {
+    trim_retained(0);
+  }
+
+  uint64_t get_retained_bytes() const {
+    return retained.pinned_bytes;
   }
 
   std::ostream &print(std::ostream &out) const;
@@ -57,6 +57,7 @@
 #include "common/pick_address.h"
 #include "common/blkdev.h"
 #include "common/numa.h"
+#include "common/Thread.h"
 
 #include "os/ObjectStore.h"
 #ifdef HAVE_LIBFUSE
@@ -293,6 +294,12 @@ OSDService::OSDService(OSD *osd, ceph::async::io_context_pool& poolctx) :
     auto fin = make_unique<Finisher>(osd->client_messenger->cct, str.str(), "finisher");
     objecter_finishers.push_back(std::move(fin));
   }
+  for (int i = 0; i < cct->_conf->osd_async_read_threads; i++) {
+    ostringstream str;
+    str << "async-read-" << i;
+    async_read_finishers.push_back(
+      make_unique<Finisher>(cct, str.str(), "async_read"));
+  }
 }
 
 #ifdef PG_DEBUG_REFS
@@ -511,6 +518,10 @@ void OSDService::shutdown()
     f->wait_for_empty();
     f->stop();
   }
+  for (auto& f : async_read_finishers) {
+    f->wait_for_empty();
+    f->stop();
+  }
 
   publish_map(OSDMapRef());
   next_osdmap = OSDMapRef();
@@ -531,6 +542,9 @@ void OSDService::init()
   for (auto& f : objecter_finishers) {
     f->start();
   }
+  for (auto& f : async_read_finishers) {
+    f->start();
+  }
   objecter->set_client_incarnation(0);
 
   // deprioritize objecter in daemonperf output
@@ -1725,6 +1739,31 @@ void OSDService::queue_recovery_context(
       e));
 }
 
+void OSDService::queue_async_read(
+  PG *pg,
+  Context *read,
+  GenContext<ThreadPool::TPHandle&> *on_done)
+{
+  ceph_assert(has_async_reads());
+  spg_t pgid = pg->get_pgid();
+  epoch_t e = get_osdmap_epoch();
+  auto& f = async_read_finishers[
+    pgid.hash_to_shard(async_read_finishers.size())];
+  logger->inc(l_osd_op_async_read);
+  f->queue(new LambdaContext([this, pgid, e, read, on_done](int) {
+    read->complete(0);
+    enqueue_back(
+      OpSchedulerItem(
+	unique_ptr<OpSchedulerItem::OpQueueable>(
+	  new PGReadCompletion(pgid, on_done, e)),
+	1,
+	CEPH_MSG_PRIO_HIGH,
+	ceph_clock_now(),
+	0,
+	e));
+  }));
+}
+
 void OSDService::queue_for_snap_trim(PG *pg, uint64_t cost_per_object)
 {
   dout(10) << "queueing " << *pg << " for snaptrim" << dendl;
@@ -2396,6 +2435,7 @@ OSD::OSD(CephContext *cct_,
                                            cct->_conf->osd_op_history_duration);
   op_tracker.set_history_slow_op_size_and_threshold(cct->_conf->osd_op_history_slow_op_size,
                                                     cct->_conf->osd_op_history_slow_op_threshold);
+  op_tracker.set_sample_rate(cct->_conf->osd_op_tracker_sample_rate);
   ObjectCleanRegions::set_max_num_intervals(cct->_conf->osd_object_clean_region_max_num_intervals);
 #ifdef WITH_BLKIN
   std::stringstream ss;
@@ -2555,7 +2595,26 @@ int OSD::set_numa_affinity()
     // this takes precedence over the automagic logic above
     numa_node = node;
   }
-  if (numa_node >= 0) {
+  if (auto cpus = g_conf().get_val<std::string>("osd_cpu_set"); !cpus.empty()) {
+    // an explicit cpu list takes precedence over any numa node
+    size_t cpu_set_size;
+    cpu_set_t cpu_set;
+    int r = parse_cpu_set_list(cpus.c_str(), &cpu_set_size, &cpu_set);
+    if (r < 0) {
+      derr << __func__ << " unable to parse osd_cpu_set '" << cpus << "': "
+	   << cpp_strerror(r) << dendl;
+    } else {
+      dout(1) << __func__ << " setting cpu affinity to "
+	      << cpu_set_to_str_list(cpu_set_size, &cpu_set) << dendl;
+      r = set_cpu_affinity_all_threads(cpu_set_size, &cpu_set);
+      if (r < 0) {
+	r = -errno;
+	derr << __func__ << " failed to set cpu affinity: " << cpp_strerror(r)
+	     << dendl;
+      }
+    }
+    numa_node = -1;
+  } else if (numa_node >= 0) {
     int r = get_numa_node_cpu_set(numa_node, &numa_cpu_set_size, &numa_cpu_set);
     if (r < 0) {
       dout(1) << __func__ << " unable to determine numa node " << numa_node
@@ -2574,12 +2633,53 @@ int OSD::set_numa_affinity()
 	numa_node = -1;
       }
     }
+  } else if (g_conf().get_val<bool>("osd_numa_shard_affinity")) {
+    set_shard_numa_affinity();
   } else {
     dout(1) << __func__ << " not setting numa affinity" << dendl;
   }
   return 0;
 }
 
+void OSD::set_shard_numa_affinity()
+{
+  // spread op shards over the numa nodes; each shard's threads bind
+  // themselves the next time they run (see ShardedOpWQ::_process).
+  std::set<int> nodes;
+  int r = get_numa_nodes(&nodes);
+  if (r < 0 || nodes.size() < 2) {
+    dout(1) << __func__ << " " << nodes.size() << " numa node(s)"
+	    << (r < 0 ? ": " + cpp_strerror(r) : "")
+	    << ", not binding op shards" << dendl;
+    return;
+  }
+  std::vector<int> node_list(nodes.begin(), nodes.end());
+  for (auto shard : shards) {
+    int node = node_list[shard->shard_id % node_list.size()];
+    r = get_numa_node_cpu_set(node, &shard->numa_cpu_set_size,
+			      &shard->numa_cpu_set);
+    if (r < 0) {
+      dout(1) << __func__ << " unable to determine numa node " << node
+	      << " CPUs for " << shard->shard_name << dendl;
+      continue;
+    }
+    dout(1) << __func__ << " " << shard->shard_name << " -> numa node " << node
+	    << " cpus "
+	    << cpu_set_to_str_list(shard->numa_cpu_set_size,
+				   &shard->numa_cpu_set)
+	    << dendl;
+    shard->numa_node = node;
+  }
+  // objectstore cache shards are picked by the same ps() % n hash, so
+  // they are only touched from one numa node if the counts line up.
+  if (get_num_cache_shards() % num_shards) {
+    dout(1) << __func__ << " osd_num_cache_shards " << get_num_cache_shards()
+	    << " is not a multiple of " << num_shards
+	    << " op shards; cache shards will be shared across numa nodes"
+	    << dendl;
+  }
+}
+
 // asok
 
 class OSDSocketHook : public AdminSocketHook {
@@ -2837,6 +2937,10 @@ will start to track new ops received afterwards.";
     f->open_object_section("pq");
     op_shardedwq.dump(f);
     f->close_section();
+  } else if (prefix == "dump_mclock_clients") {
+    f->open_object_section("mclock_clients");
+    op_shardedwq.dump_clients(f);
+    f->close_section();
   } else if (prefix == "dump_blocklist") {
     list<pair<entity_addr_t,utime_t> > bl;
     list<pair<entity_addr_t,utime_t> > rbl;
@@ -3972,6 +4076,11 @@ int OSD::init()
   objecter_messenger->add_dispatcher_head(service.objecter.get());
 
   service.init();
+  {
+    set<string> devnames;
+    store->get_devices(&devnames);
+    service.get_scrub_services().set_scrub_devices(devnames);
+  }
   service.publish_map(osdmap);
   service.publish_superblock(superblock);
 
@@ -4146,6 +4255,10 @@ void OSD::final_init()
 				     asok_hook,
 				     "dump op queue state");
   ceph_assert(r == 0);
+  r = admin_socket->register_command("dump_mclock_clients",
+				     asok_hook,
+				     "dump per client mclock QoS and usage");
+  ceph_assert(r == 0);
   r = admin_socket->register_command("dump_blocklist",
 				     asok_hook,
 				     "dump blocklisted clients and times");
@@ -5258,7 +5371,7 @@ void OSD::load_pgs()
     derr << "failed to list pgs: " << cpp_strerror(-r) << dendl;
   }
 
-  int num = 0;
+  vector<PGRef> pgs;
   for (vector<coll_t>::iterator it = ls.begin();
        it != ls.end();
        ++it) {
@@ -5311,37 +5424,72 @@ void OSD::load_pgs()
       recursive_remove_collection(cct, store.get(), pgid, *it);
       continue;
     }
+    pgs.push_back(pg);
+  }
 
-    // there can be no waiters here, so we don't call _wake_pg_slot
-
-    pg->lock();
-    pg->ch = store->open_collection(pg->coll);
-
-    // read pg state, log
-    pg->read_state(store.get());
-
-    if (pg->dne())  {
-      dout(10) << "load_pgs " << *it << " deleting dne" << dendl;
-      pg->ch = nullptr;
-      pg->unlock();
-      recursive_remove_collection(cct, store.get(), pgid, *it);
-      continue;
+  // reading pg state and logs is most of the startup time with many
+  // pgs; the pgs are not registered yet, so nothing else can reach them
+  vector<char> loaded(pgs.size(), false);
+  {
+    std::atomic<size_t> next = {0};
+    auto load = [&] {
+      for (size_t i = next++; i < pgs.size(); i = next++) {
+	loaded[i] = _load_pg_state(pgs[i]);
+      }
+    };
+    size_t num_threads = std::min<size_t>(
+      cct->_conf.get_val<uint64_t>("osd_load_pgs_threads"), pgs.size());
+    vector<std::thread> threads;
+    for (size_t i = 1; i < num_threads; ++i) {
+      threads.push_back(make_named_thread("osd_load_pgs", load));
     }
-    {
-      uint32_t shard_index = pgid.hash_to_shard(shards.size());
-      assert(NULL != shards[shard_index]);
-      store->set_collection_commit_queue(pg->coll, &(shards[shard_index]->context_queue));
+    load();
+    for (auto& t : threads) {
+      t.join();
     }
+  }
 
-    dout(10) << __func__ << " loaded " << *pg << dendl;
-    pg->unlock();
-
-    register_pg(pg);
+  int num = 0;
+  for (size_t i = 0; i < pgs.size(); ++i) {
+    if (!loaded[i]) {
+      dout(10) << "load_pgs " << pgs[i]->coll << " deleting dne" << dendl;
+      recursive_remove_collection(cct, store.get(), pgs[i]->get_pgid(),
+				  pgs[i]->coll);
+      continue;
+    }
+    // there can be no waiters here, so we don't call _wake_pg_slot
+    register_pg(pgs[i]);
     ++num;
   }
   dout(0) << __func__ << " opened " << num << " pgs" << dendl;
 }
 
+bool OSD::_load_pg_state(PGRef pg)
+{
+  auto start = ceph::mono_clock::now();
+  pg->lock();
+  pg->ch = store->open_collection(pg->coll);
+
+  // read pg state, log
+  pg->read_state(store.get());
+
+  if (pg->dne())  {
+    pg->ch = nullptr;
+    pg->unlock();
+    return false;
+  }
+  {
+    uint32_t shard_index = pg->get_pgid().hash_to_shard(shards.size());
+    assert(NULL != shards[shard_index]);
+    store->set_collection_commit_queue(pg->coll, &(shards[shard_index]->context_queue));
+  }
+
+  dout(10) << __func__ << " loaded " << *pg << dendl;
+  pg->unlock();
+  logger->tinc(l_osd_pg_load_lat, ceph::mono_clock::now() - start);
+  return true;
+}
+
 
 PGRef OSD::handle_pg_create_info(const OSDMapRef& osdmap,
 				 const PGCreateInfo *info)
@@ -6405,6 +6553,7 @@ void OSD::tick_without_osd_lock()
   if (is_active()) {
     service.get_scrub_services().initiate_scrub(service.is_recovery_active());
     service.promote_throttle_recalibrate();
+    maybe_estimate_max_osd_capacity_for_qos();
     resume_creating_pg();
     bool need_send_beacon = false;
     const auto now = ceph::coarse_mono_clock::now();
@@ -7088,6 +7237,16 @@ void OSD::_collect_metadata(map<string,string> *pm)
     (*pm)["numa_node"] = stringify(numa_node);
     (*pm)["numa_node_cpus"] = cpu_set_to_str_list(numa_cpu_set_size,
 						  &numa_cpu_set);
+  } else {
+    std::vector<int> shard_nodes;
+    for (auto shard : shards) {
+      if (shard->numa_node >= 0) {
+	shard_nodes.push_back(shard->numa_node);
+      }
+    }
+    if (!shard_nodes.empty()) {
+      (*pm)["op_shard_numa_nodes"] = stringify(shard_nodes);
+    }
   }
 
   set<string> devnames;
@@ -9826,6 +9985,7 @@ const char** OSD::get_tracked_conf_keys() const
     "osd_op_history_slow_op_size",
     "osd_op_history_slow_op_threshold",
     "osd_enable_op_tracker",
+    "osd_op_tracker_sample_rate",
     "osd_map_cache_size",
     "osd_pg_epoch_max_lag_factor",
     "osd_pg_epoch_persisted_max_stale",
@@ -9930,6 +10090,9 @@ void OSD::handle_conf_change(const ConfigProxy& conf,
   if (changed.count("osd_enable_op_tracker")) {
       op_tracker.set_tracking(cct->_conf->osd_enable_op_tracker);
   }
+  if (changed.count("osd_op_tracker_sample_rate")) {
+    op_tracker.set_sample_rate(cct->_conf->osd_op_tracker_sample_rate);
+  }
   if (changed.count("osd_map_cache_size")) {
     service.map_cache.set_size(cct->_conf->osd_map_cache_size);
     service.map_bl_cache.set_size(cct->_conf->osd_map_cache_size);
@@ -10108,6 +10271,78 @@ void OSD::maybe_override_max_osd_capacity_for_qos()
   }
 }
 
+void OSD::maybe_estimate_max_osd_capacity_for_qos()
+{
+  // Follow the device's IOPS capacity after the startup bench, using
+  // the work the mclock schedulers manage to hand out while backlogged.
+  double interval =
+    cct->_conf.get_val<double>("osd_mclock_capacity_estimate_interval");
+  if (interval <= 0 ||
+      op_queue_type_t::mClockScheduler != osd_op_queue_type()) {
+    capacity_estimator.reset();
+    last_capacity_sample = ceph::coarse_mono_clock::time_point();
+    return;
+  }
+  auto now = ceph::coarse_mono_clock::now();
+  if (last_capacity_sample == ceph::coarse_mono_clock::time_point()) {
+    // discard whatever piled up before estimation was enabled
+    capacity_sample_t discard;
+    op_shardedwq.take_capacity_sample(&discard);
+    last_capacity_sample = now;
+    return;
+  }
+  double elapsed = std::chrono::duration<double>(
+    now - last_capacity_sample).count();
+  if (elapsed < interval) {
+    return;
+  }
+  last_capacity_sample = now;
+
+  capacity_sample_t sample;
+  op_shardedwq.take_capacity_sample(&sample);
+
+  std::string max_capacity_iops_config;
+  uint64_t bandwidth;
+  mClockCapacityEstimator::config_t conf;
+  if (store_is_rotational) {
+    max_capacity_iops_config = "osd_mclock_max_capacity_iops_hdd";
+    bandwidth = cct->_conf.get_val<Option::size_t>(
+      "osd_mclock_max_sequential_bandwidth_hdd");
+    conf.max_iops = cct->_conf.get_val<double>(
+      "osd_mclock_iops_capacity_threshold_hdd");
+  } else {
+    max_capacity_iops_config = "osd_mclock_max_capacity_iops_ssd";
+    bandwidth = cct->_conf.get_val<Option::size_t>(
+      "osd_mclock_max_sequential_bandwidth_ssd");
+    conf.max_iops = cct->_conf.get_val<double>(
+      "osd_mclock_iops_capacity_threshold_ssd");
+  }
+  conf.min_backlog =
+    cct->_conf.get_val<double>("osd_mclock_capacity_estimate_min_backlog");
+  conf.hysteresis =
+    cct->_conf.get_val<double>("osd_mclock_capacity_estimate_hysteresis");
+  conf.samples =
+    cct->_conf.get_val<uint64_t>("osd_mclock_capacity_estimate_samples");
+  double cur_iops = cct->_conf.get_val<double>(max_capacity_iops_config);
+
+  auto iops = capacity_estimator.add_sample(
+    sample, elapsed, cur_iops, bandwidth, conf);
+  dout(20) << __func__ << " ops " << sample.ops
+	   << " bytes " << sample.bytes
+	   << " dequeues " << sample.dequeues
+	   << " backlogged " << sample.backlogged
+	   << " throttled " << sample.throttled
+	   << " estimate " << capacity_estimator.get_last_estimate()
+	   << " pending " << capacity_estimator.get_pending() << dendl;
+  if (iops) {
+    clog->info() << "osd." << whoami << " IOPS capacity estimated at "
+		 << std::fixed << std::setprecision(2) << *iops
+		 << " under load, was " << cur_iops << "; updating "
+		 << max_capacity_iops_config;
+    mon_cmd_set_config(max_capacity_iops_config, std::to_string(*iops));
+  }
+}
+
 bool OSD::maybe_override_options_for_qos(const std::set<std::string> *changed)
 {
   // Override options only if the scheduler enabled is mclock and the
@@ -10864,6 +11099,77 @@ void OSD::ShardedOpWQ::_add_slot_waiter(
   }
 }
 
+void OSD::ShardedOpWQ::_release_slot(
+  OSDShard *sdata,
+  OSDShardPGSlot *slot)
+{
+  ceph_assert(slot->owned);
+  slot->owned = false;
+  --slot->num_running;
+  if (slot->to_process.empty()) {
+    return;
+  }
+  // other threads left these to us; put them back ahead of anything newer
+  dout(20) << __func__ << " requeueing " << slot->to_process << dendl;
+  for (auto i = slot->to_process.rbegin();
+       i != slot->to_process.rend();
+       ++i) {
+    sdata->scheduler->enqueue_front(std::move(*i));
+  }
+  slot->to_process.clear();
+  ++slot->requeue_seq;
+  std::lock_guard l{sdata->sdata_wait_lock};
+  sdata->sdata_cond.notify_all();
+}
+
+bool OSD::ShardedOpWQ::is_batchable_read(const OpSchedulerItem &qi)
+{
+  std::optional<OpRequestRef> op = qi.maybe_get_op();
+  if (!op || (*op)->get_req()->get_type() != CEPH_MSG_OSD_OP) {
+    return false;
+  }
+  int flags = (*op)->get_req<MOSDOp>()->get_flags();
+  return (flags & CEPH_OSD_FLAG_READ) && !(flags & CEPH_OSD_FLAG_WRITE);
+}
+
+void OSD::ShardedOpWQ::_run_read_batch(
+  OSDShard *sdata,
+  spg_t token,
+  uint64_t requeue_seq,
+  unsigned max,
+  PGRef& pg,
+  OpRequestRef op,
+  ThreadPool::TPHandle &tp_handle)
+{
+  // Threads waiting for the pg lock behind us find their items gone and
+  // return.  Items are only ever taken from the front of to_process, and
+  // _enqueue_front puts requeued ops there, so the order is the same as
+  // if each op took the lock in turn.
+  for (unsigned n = 1; ; ++n) {
+    osd->dequeue_op(pg, op, tp_handle);
+    if (n >= max) {
+      break;
+    }
+    std::lock_guard l{sdata->shard_lock};
+    auto q = sdata->pg_slots.find(token);
+    if (q == sdata->pg_slots.end() || osd->is_stopping()) {
+      break;
+    }
+    OSDShardPGSlot *slot = q->second.get();
+    if (slot->pg != pg || slot->requeue_seq != requeue_seq ||
+	slot->to_process.empty() ||
+	!is_batchable_read(slot->to_process.front())) {
+      break;
+    }
+    op = *slot->to_process.front().maybe_get_op();
+    slot->to_process.pop_front();
+    dout(20) << __func__ << " " << token << " batching " << *(op->get_req()) << dendl;
+    osd->logger->inc(l_osd_op_read_batched);
+    tp_handle.reset_tp_timeout();
+  }
+  pg->unlock();
+}
+
 #undef dout_prefix
 #define dout_prefix *_dout << "osd." << osd->whoami << " op_wq(" << shard_index << ") "
 
@@ -10873,6 +11179,19 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
   auto& sdata = osd->shards[shard_index];
   ceph_assert(sdata);
 
+  // follow our shard's numa binding, if any (osd_numa_shard_affinity)
+  static thread_local int bound_numa_node = -1;
+  if (int node = sdata->numa_node.load(std::memory_order_acquire);
+      node >= 0 && node != bound_numa_node) {
+    if (sched_setaffinity(0, sdata->numa_cpu_set_size,
+			  &sdata->numa_cpu_set) < 0) {
+      dout(0) << __func__ << " failed to bind thread " << thread_index
+	      << " to numa node " << node << ": " << cpp_strerror(errno)
+	      << dendl;
+    }
+    bound_numa_node = node;
+  }
+
   // If all threads of shards do oncommits, there is a out-of-order
   // problem.  So we choose the thread which has the smallest
   // thread_index(thread_index < num_shards) of shard to do oncommit
@@ -10998,6 +11317,17 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
   dout(20) << __func__ << " " << slot->to_process.back()
 	   << " queued" << dendl;
 
+  // with osd_op_pg_handoff, the thread owning the slot runs its items to
+  // completion; leave this one to it rather than wait for the pg lock
+  if (slot->owned) {
+    dout(20) << __func__ << " " << token << " handed off" << dendl;
+    osd->logger->inc(l_osd_op_pg_handoff);
+    sdata->shard_lock.unlock();
+    handle_oncommits(oncommits);
+    return;
+  }
+  bool owner = false;
+
  retry_pg:
   PGRef pg = slot->pg;
 
@@ -11005,6 +11335,13 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
   if (pg) {
     // note the requeue seq now...
     uint64_t requeue_seq = slot->requeue_seq;
+    if (!owner && osd->cct->_conf->osd_op_pg_handoff) {
+      // the owner counts as running until it gives the slot up, so that
+      // it can't be pruned under the items handed to it
+      owner = true;
+      slot->owned = true;
+      ++slot->num_running;
+    }
     ++slot->num_running;
 
     sdata->shard_lock.unlock();
@@ -11030,6 +11367,9 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
       dout(20) << __func__ << " " << token
 	       << " nothing queued" << dendl;
       pg->unlock();
+      if (owner) {
+	_release_slot(sdata, slot);
+      }
       sdata->shard_lock.unlock();
       handle_oncommits(oncommits);
       return;
@@ -11040,6 +11380,9 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
 	       << requeue_seq << ", we raced with _wake_pg_slot"
 	       << dendl;
       pg->unlock();
+      if (owner) {
+	_release_slot(sdata, slot);
+      }
       sdata->shard_lock.unlock();
       handle_oncommits(oncommits);
       return;
@@ -11068,6 +11411,11 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
   set<pair<spg_t,epoch_t>> new_children;
   OSDMapRef osdmap;
 
+  if (!pg && owner) {
+    // the pg went away under us; no more running to completion
+    owner = false;
+    _release_slot(sdata, slot);
+  }
   while (!pg) {
     // should this pg shard exist on this osd in this (or a later) epoch?
     osdmap = sdata->shard_osdmap;
@@ -11152,12 +11500,18 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
     OSDMapRef osdmap = sdata->shard_osdmap;
     if (qi.get_map_epoch() > osdmap->get_epoch()) {
       _add_slot_waiter(token, slot, std::move(qi));
+      if (owner) {
+	_release_slot(sdata, slot);
+      }
       sdata->shard_lock.unlock();
       pg->unlock();
       handle_oncommits(oncommits);
       return;
     }
   }
+  const uint64_t batch_seq = slot->requeue_seq;
+  const unsigned read_batch = pg && is_batchable_read(qi) ?
+    osd->cct->_conf->osd_op_pg_read_batch : 0;
   sdata->shard_lock.unlock();
 
   if (!new_children.empty()) {
@@ -11189,7 +11543,12 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
   delete f;
   *_dout << dendl;
 
-  qi.run(osd, sdata, pg, tp_handle);
+  if (read_batch > 1) {
+    _run_read_batch(sdata, token, batch_seq, read_batch, pg,
+		    *qi.maybe_get_op(), tp_handle);
+  } else {
+    qi.run(osd, sdata, pg, tp_handle);
+  }
 
   {
 #ifdef WITH_LTTNG
@@ -11203,6 +11562,27 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
   }
 
   handle_oncommits(oncommits);
+
+  if (owner) {
+    sdata->shard_lock.lock();
+    auto q = sdata->pg_slots.find(token);
+    if (q == sdata->pg_slots.end()) {
+      // removed along with its items, see unprime_split_children
+      sdata->shard_lock.unlock();
+      return;
+    }
+    slot = q->second.get();
+    if (!slot->to_process.empty() && slot->pg == pg &&
+	!osd->is_stopping()) {
+      dout(20) << __func__ << " " << token << " continuing with "
+	       << slot->to_process.front() << dendl;
+      osd->cct->get_heartbeat_map()->reset_timeout(hb,
+        timeout_interval.load(), suicide_interval.load());
+      goto retry_pg;
+    }
+    _release_slot(sdata, slot);
+    sdata->shard_lock.unlock();
+  }
 }
 
 void OSD::ShardedOpWQ::_enqueue(OpSchedulerItem&& item) {
@@ -39,6 +39,7 @@
 #include "Session.h"
 
 #include "osd/scheduler/OpScheduler.h"
+#include "osd/scheduler/mClockCapacityEstimator.h"
 
 #include <atomic>
 #include <map>
@@ -422,6 +423,16 @@ public:
   int m_objecter_finishers;
   std::vector<std::unique_ptr<Finisher>> objecter_finishers;
 
+  // -- replicated pool reads off the op threads (osd_async_read_threads) --
+  std::vector<std::unique_ptr<Finisher>> async_read_finishers;
+  bool has_async_reads() const {
+    return !async_read_finishers.empty();
+  }
+  /// run read on pg's async read thread, then queue on_done for pg
+  void queue_async_read(PG *pg,
+			Context *read,
+			GenContext<ThreadPool::TPHandle&> *on_done);
+
   // -- Watch --
   ceph::mutex watch_lock = ceph::make_mutex("OSDService::watch_lock");
   SafeTimer watch_timer;
@@ -938,6 +949,8 @@ struct OSDShardPGSlot {
   PGRef pg;                      ///< pg reference
   std::deque<OpSchedulerItem> to_process; ///< order items for this slot
   int num_running = 0;          ///< _process threads doing pg lookup/lock
+  bool owned = false;           ///< a _process thread drains to_process
+                                ///  (osd_op_pg_handoff)
 
   std::deque<OpSchedulerItem> waiting;   ///< waiting for pg (or map + pg)
 
@@ -1041,6 +1054,12 @@ struct OSDShard {
   void update_scheduler_config();
   op_queue_type_t get_op_queue_type() const;
 
+  /// numa node our worker threads bind to (-1 for none); set once the
+  /// cpu set below is filled in
+  std::atomic<int> numa_node = {-1};
+  size_t numa_cpu_set_size = 0;
+  cpu_set_t numa_cpu_set;
+
   OSDShard(
     int id,
     CephContext *cct,
@@ -1558,6 +1577,15 @@ protected:
       spg_t token,
       OSDShardPGSlot *slot,
       OpSchedulerItem&& qi);
+    /// give up draining slot, requeueing what was left to us
+    void _release_slot(OSDShard *sdata, OSDShardPGSlot *slot);
+    /// read-only client op, see osd_op_pg_read_batch
+    static bool is_batchable_read(const OpSchedulerItem &qi);
+    /// run op and up to max - 1 batchable reads queued right behind it
+    /// under pg's lock, which is released at the end
+    void _run_read_batch(OSDShard *sdata, spg_t token, uint64_t requeue_seq,
+			 unsigned max, PGRef& pg, OpRequestRef op,
+			 ThreadPool::TPHandle &tp_handle);
 
     /// try to do some work
     void _process(uint32_t thread_index, ceph::heartbeat_handle_d *hb) override;
@@ -1604,6 +1632,31 @@ protected:
       }
     }
 
+    void dump_clients(ceph::Formatter *f) {
+      f->open_array_section("shards");
+      for(uint32_t i = 0; i < osd->num_shards; i++) {
+	auto &&sdata = osd->shards[i];
+	ceph_assert(NULL != sdata);
+
+	std::scoped_lock l{sdata->shard_lock};
+	f->open_object_section("shard");
+	f->dump_unsigned("shard_id", i);
+	sdata->scheduler->dump_clients(*f);
+	f->close_section();
+      }
+      f->close_section();
+    }
+
+    void take_capacity_sample(
+      ceph::osd::scheduler::capacity_sample_t *sample) {
+      for(uint32_t i = 0; i < osd->num_shards; i++) {
+	auto &&sdata = osd->shards[i];
+	ceph_assert(NULL != sdata);
+	std::scoped_lock l{sdata->shard_lock};
+	sdata->scheduler->take_capacity_sample(sample);
+      }
+    }
+
     bool is_shard_empty(uint32_t thread_index) override {
       uint32_t shard_index = thread_index % osd->num_shards;
       auto &&sdata = osd->shards[shard_index];
@@ -1617,7 +1670,11 @@ protected:
     }
 
     void handle_oncommits(std::list<Context*>& oncommits) {
-      for (auto p : oncommits) {
+      // take the list so a caller that loops (osd_op_pg_handoff) can't
+      // complete the same contexts twice
+      std::list<Context*> todo;
+      todo.swap(oncommits);
+      for (auto p : todo) {
 	p->complete(0);
       }
     }
@@ -1766,6 +1823,8 @@ protected:
   void resume_creating_pg();
 
   void load_pgs();
+  /// read pg state and log; false if the pg turned out not to exist
+  bool _load_pg_state(PGRef pg);
 
   epoch_t last_pg_create_epoch;
 
@@ -1833,6 +1892,11 @@ protected:
   std::vector<pg_t> min_last_epoch_clean_pgs;
   void send_beacon(const ceph::coarse_mono_clock::time_point& now);
 
+  // online estimate of osd_mclock_max_capacity_iops_[hdd|ssd]; only
+  // touched from tick_without_osd_lock()
+  ceph::osd::scheduler::mClockCapacityEstimator capacity_estimator;
+  ceph::coarse_mono_clock::time_point last_capacity_sample;
+
   ceph_tid_t get_tid() {
     return service.get_tid();
   }
@@ -1992,6 +2056,7 @@ private:
 
   int get_recovery_max_active();
   void maybe_override_max_osd_capacity_for_qos();
+  void maybe_estimate_max_osd_capacity_for_qos();
   void maybe_override_sleep_options_for_qos();
   bool maybe_override_options_for_qos(
     const std::set<std::string> *changed = nullptr);
@@ -2022,6 +2087,7 @@ public:
 
   int enable_disable_fuse(bool stop);
   int set_numa_affinity();
+  void set_shard_numa_affinity();
 
   void suicide(int exitcode);
   int shutdown();
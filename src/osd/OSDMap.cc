@@ -290,6 +290,76 @@ int OSDMap::Incremental::propagate_base_properties_to_tiers(CephContext *cct,
   return 0;
 }
 
+bool OSDMap::Incremental::may_remap_all_pgs(
+  const OSDMap& previous,
+  set<int64_t> *changed_pools) const
+{
+  if (fullmap.length() ||
+      crush.length() ||
+      new_max_osd >= 0 ||
+      !new_up_client.empty() ||
+      !new_weight.empty() ||
+      !new_primary_affinity.empty() ||
+      !new_crush_node_flags.empty() ||
+      !new_device_class_flags.empty()) {
+    return true;
+  }
+  for (auto& [osd, state] : new_state) {
+    // 0 is a legacy encoding of CEPH_OSD_UP; other bits (e.g. NOUP,
+    // NEW) do not affect placement
+    if (!state || (state & (CEPH_OSD_UP | CEPH_OSD_EXISTS))) {
+      return true;
+    }
+  }
+  changed_pools->insert(old_pools.begin(), old_pools.end());
+  // pools are rewritten for snaps, quotas and the like; only changes to
+  // where their pgs land matter here
+  for (auto& [poolid, pool] : new_pools) {
+    const pg_pool_t *p = previous.get_pg_pool(poolid);
+    if (!p ||
+	p->get_type() != pool.get_type() ||
+	p->get_size() != pool.get_size() ||
+	p->get_crush_rule() != pool.get_crush_rule() ||
+	p->get_pg_num() != pool.get_pg_num() ||
+	p->get_pgp_num() != pool.get_pgp_num() ||
+	p->has_flag(pg_pool_t::FLAG_HASHPSPOOL) !=
+	  pool.has_flag(pg_pool_t::FLAG_HASHPSPOOL)) {
+      changed_pools->insert(poolid);
+    }
+  }
+  return false;
+}
+
+bool OSDMap::Incremental::get_remapped_pgs(const OSDMap& previous,
+					   set<pg_t> *pgs) const
+{
+  ceph_assert(epoch == previous.get_epoch() + 1);
+  set<int64_t> changed_pools;
+  if (may_remap_all_pgs(previous, &changed_pools) ||
+      !changed_pools.empty()) {
+    return false;
+  }
+  for (auto& i : new_pg_temp) {
+    pgs->insert(i.first);
+  }
+  for (auto& i : new_primary_temp) {
+    pgs->insert(i.first);
+  }
+  for (auto& i : new_pg_upmap) {
+    pgs->insert(i.first);
+  }
+  for (auto& i : new_pg_upmap_items) {
+    pgs->insert(i.first);
+  }
+  for (auto& i : new_pg_upmap_primary) {
+    pgs->insert(i.first);
+  }
+  pgs->insert(old_pg_upmap.begin(), old_pg_upmap.end());
+  pgs->insert(old_pg_upmap_items.begin(), old_pg_upmap_items.end());
+  pgs->insert(old_pg_upmap_primary.begin(), old_pg_upmap_primary.end());
+  return true;
+}
+
 // ----------------------------------
 // OSDMap
 
@@ -2970,6 +3040,49 @@ void OSDMap::_pg_to_up_acting_osds(
     *acting_primary = _acting_primary;
 }
 
+void OSDMap::pgs_to_up_acting_osds(
+  int64_t poolid, unsigned ps_begin, unsigned ps_end,
+  vector<vector<int>> *up, vector<int> *up_primary,
+  vector<vector<int>> *acting, vector<int> *acting_primary) const
+{
+  const pg_pool_t *pool = get_pg_pool(poolid);
+  ceph_assert(pool);
+  ceph_assert(ps_begin <= ps_end && ps_end <= pool->get_pg_num());
+  unsigned n = ps_end - ps_begin;
+  vector<int> pps(n);
+  for (unsigned i = 0; i < n; ++i) {
+    pps[i] = pool->raw_pg_to_pps(pg_t(ps_begin + i, poolid));
+  }
+  vector<vector<int>> raw;
+  int ruleno = pool->get_crush_rule();
+  if (ruleno >= 0) {
+    crush->do_rule_many(ruleno, pps, raw, pool->get_size(), osd_weight, poolid);
+  } else {
+    raw.resize(n);
+  }
+
+  up->resize(n);
+  up_primary->resize(n);
+  acting->resize(n);
+  acting_primary->resize(n);
+  for (unsigned i = 0; i < n; ++i) {
+    // as _pg_to_up_acting_osds does for a single pg
+    pg_t pg(ps_begin + i, poolid);
+    _remove_nonexistent_osds(*pool, raw[i]);
+    _get_temp_osds(*pool, pg, &(*acting)[i], &(*acting_primary)[i]);
+    _apply_upmap(*pool, pg, &raw[i]);
+    _raw_to_up_osds(*pool, raw[i], &(*up)[i]);
+    (*up_primary)[i] = _pick_primary((*up)[i]);
+    _apply_primary_affinity(pps[i], *pool, &(*up)[i], &(*up_primary)[i]);
+    if ((*acting)[i].empty()) {
+      (*acting)[i] = (*up)[i];
+      if ((*acting_primary)[i] == -1) {
+	(*acting_primary)[i] = (*up_primary)[i];
+      }
+    }
+  }
+}
+
 int OSDMap::calc_pg_role_broken(int osd, const vector<int>& acting, int nrep)
 {
   // This implementation is broken for EC PGs since the osd may appear
@@ -5820,9 +5933,11 @@ int OSDMap::calc_pg_upmaps(
     // ready to go
     ceph_assert(new_stddev < stddev);
     stddev = new_stddev;
-    pgs_by_osd = temp_pgs_by_osd;
-    osd_deviation = temp_osd_deviation;
-    deviation_osd = temp_deviation_osd;
+    // the temp state is rebuilt from pgs_by_osd on the next pass, so
+    // hand it over instead of copying every OSD's pg set
+    pgs_by_osd = std::move(temp_pgs_by_osd);
+    osd_deviation = std::move(temp_osd_deviation);
+    deviation_osd = std::move(temp_deviation_osd);
     n_changes++;
 
 
@@ -484,6 +484,29 @@ public:
     /// propagate update pools' (snap and other) metadata to any of their tiers
     int propagate_base_properties_to_tiers(CephContext *cct, const OSDMap &base);
 
+    /**
+     * whether applying this incremental to previous may change the
+     * mapping of pgs other than those named by its pg_temp, primary_temp
+     * and upmap entries
+     *
+     * Pools that are removed, or whose placement parameters change, are
+     * added to changed_pools; other pool updates (snaps, quotas, ...)
+     * are ignored.
+     *
+     * @return true if crush or osd state changes may remap any PG
+     */
+    bool may_remap_all_pgs(const OSDMap& previous,
+			   std::set<int64_t> *changed_pools) const;
+
+    /**
+     * collect the PGs whose mapping may change when applying this
+     * incremental to previous
+     *
+     * @return false if any PG may be remapped (crush, osd state or pool
+     *         placement changes), in which case pgs is incomplete
+     */
+    bool get_remapped_pgs(const OSDMap& previous, std::set<pg_t> *pgs) const;
+
     /// filter out osds with any pending state changing
     size_t get_pending_state_osds(std::vector<int> *osds) {
       ceph_assert(osds);
@@ -1300,6 +1323,16 @@ public:
     int up_primary, acting_primary;
     pg_to_up_acting_osds(pg, &up, &up_primary, &acting, &acting_primary);
   }
+  /**
+   * pg_to_up_acting_osds for pgs [ps_begin, ps_end) of pool, with a
+   * single batched CRUSH call.  Entry i of each output describes pg
+   * ps_begin + i.
+   */
+  void pgs_to_up_acting_osds(int64_t pool, unsigned ps_begin, unsigned ps_end,
+			     std::vector<std::vector<int>> *up,
+			     std::vector<int> *up_primary,
+			     std::vector<std::vector<int>> *acting,
+			     std::vector<int> *acting_primary) const;
   bool pg_is_ec(pg_t pg) const {
     auto i = pools.find(pg.pool());
     ceph_assert(i != pools.end());
@@ -86,6 +86,52 @@ void OSDMapMapping::_build_rmap(const OSDMap& osdmap)
   }
 }
 
+// the pgs to recompute when only remapped_pgs changed since our
+// last complete update, or false if everything needs a recompute
+bool OSDMapMapping::_get_remapped_pgs(
+  const OSDMap& osdmap,
+  std::vector<pg_t> *pgs)
+{
+  // forget what the mapping already reflects
+  remapped_pgs.erase(remapped_pgs.begin(), remapped_pgs.upper_bound(epoch));
+  if (epoch == 0 || epoch > osdmap.get_epoch() ||
+      osdmap.get_pools().empty()) {
+    return false;
+  }
+  if (pools.size() != osdmap.get_pools().size()) {
+    return false;
+  }
+  for (auto& p : osdmap.get_pools()) {
+    auto q = pools.find(p.first);
+    if (q == pools.end() ||
+	q->second.pg_num != p.second.get_pg_num() ||
+	q->second.size != p.second.get_size()) {
+      return false;
+    }
+  }
+  std::set<pg_t> changed;
+  for (epoch_t e = epoch + 1; e <= osdmap.get_epoch(); ++e) {
+    auto p = remapped_pgs.find(e);
+    if (p == remapped_pgs.end()) {
+      return false;
+    }
+    changed.insert(p->second.begin(), p->second.end());
+  }
+  for (auto& pgid : changed) {
+    // pg_temp and upmap entries can outlive their pool or pg
+    auto p = pools.find(pgid.pool());
+    if (p != pools.end() && pgid.ps() < p->second.pg_num) {
+      pgs->push_back(pgid);
+    }
+  }
+  if (pgs->empty()) {
+    // still run a job, so that the mapping moves to the new epoch
+    auto& p = *osdmap.get_pools().begin();
+    pgs->push_back(pg_t(0, p.first));
+  }
+  return true;
+}
+
 void OSDMapMapping::_finish(const OSDMap& osdmap)
 {
   _build_rmap(osdmap);
@@ -114,14 +160,15 @@ void OSDMapMapping::_update_range(
   ceph_assert(i != pools.end());
   ceph_assert(pg_begin <= pg_end);
   ceph_assert(pg_end <= i->second.pg_num);
+  std::vector<std::vector<int>> up, acting;
+  std::vector<int> up_primary, acting_primary;
+  osdmap.pgs_to_up_acting_osds(
+    pool, pg_begin, pg_end,
+    &up, &up_primary, &acting, &acting_primary);
   for (unsigned ps = pg_begin; ps < pg_end; ++ps) {
-    std::vector<int> up, acting;
-    int up_primary, acting_primary;
-    osdmap.pg_to_up_acting_osds(
-      pg_t(ps, pool),
-      &up, &up_primary, &acting, &acting_primary);
-    i->second.set(ps, std::move(up), up_primary,
-		  std::move(acting), acting_primary);
+    unsigned j = ps - pg_begin;
+    i->second.set(ps, std::move(up[j]), up_primary[j],
+		  std::move(acting[j]), acting_primary[j]);
   }
 }
 
@@ -7,6 +7,7 @@
 
 #include <vector>
 #include <map>
+#include <set>
 
 #include "osd/osd_types.h"
 #include "common/WorkQueue.h"
@@ -256,6 +257,9 @@ private:
   epoch_t epoch = 0;
   uint64_t num_pgs = 0;
 
+  /// epoch -> pgs its incremental may have remapped, see note_remapped_pgs
+  std::map<epoch_t, std::set<pg_t>> remapped_pgs;
+
   void _init_mappings(const OSDMap& osdmap);
   void _update_range(
     const OSDMap& map,
@@ -263,6 +267,7 @@ private:
     unsigned pg_begin, unsigned pg_end);
 
   void _build_rmap(const OSDMap& osdmap);
+  bool _get_remapped_pgs(const OSDMap& osdmap, std::vector<pg_t> *pgs);
 
   void _start(const OSDMap& osdmap) {
     _init_mappings(osdmap);
@@ -279,7 +284,11 @@ private:
       : Job(osdmap), mapping(m) {
       mapping->_start(*osdmap);
     }
-    void process(const std::vector<pg_t>& pgs) override {}
+    void process(const std::vector<pg_t>& pgs) override {
+      for (auto& pgid : pgs) {
+	mapping->update(*osdmap, pgid);
+      }
+    }
     void process(int64_t pool, unsigned ps_begin, unsigned ps_end) override {
       mapping->_update_range(*osdmap, pool, ps_begin, ps_end);
     }
@@ -332,12 +341,26 @@ public:
 
   void update(const OSDMap& map, pg_t pgid);
 
+  /**
+   * Record that the map at epoch e differs from epoch e - 1 only in
+   * the mappings of pgs (see OSDMap::Incremental::get_remapped_pgs).
+   * When every epoch since the last complete update has been noted,
+   * start_update only recomputes those pgs.
+   */
+  void note_remapped_pgs(epoch_t e, std::set<pg_t>&& pgs) {
+    remapped_pgs[e] = std::move(pgs);
+  }
+
   std::unique_ptr<MappingJob> start_update(
     const OSDMap& map,
     ParallelPGMapper& mapper,
     unsigned pgs_per_item) {
+    std::vector<pg_t> pgs;
+    if (!_get_remapped_pgs(map, &pgs)) {
+      pgs.clear();
+    }
     std::unique_ptr<MappingJob> job(new MappingJob(&map, this));
-    mapper.queue(job.get(), pgs_per_item, {});
+    mapper.queue(job.get(), pgs_per_item, pgs);
     return job;
   }
 
@@ -2747,8 +2747,20 @@ std::pair<ghobject_t, bool> PG::do_delete_work(
 
   OSDriver::OSTransaction _t(osdriver.get_transaction(&t));
   int64_t num = 0;
+  // olist is sorted, so runs of it (split around pgmeta and between temp
+  // and regular objects) can go as ranges
+  bool remove_range = osd->store->supports_remove_range() &&
+    cct->_conf.get_val<bool>("osd_delete_remove_range");
+  const ghobject_t *range_first = nullptr, *range_last = nullptr;
+  auto flush_range = [&]() {
+    if (range_first) {
+      t.remove_range(coll, *range_first, *range_last);
+      range_first = nullptr;
+    }
+  };
   for (auto& oid : olist) {
     if (oid == pgmeta_oid) {
+      flush_range();
       continue;
     }
     if (oid.is_pgmeta()) {
@@ -2759,9 +2771,20 @@ std::pair<ghobject_t, bool> PG::do_delete_work(
     if (r != 0 && r != -ENOENT) {
       ceph_abort();
     }
-    t.remove(coll, oid);
+    if (remove_range) {
+      if (range_first && range_first->hobj.is_temp() != oid.hobj.is_temp()) {
+	flush_range();
+      }
+      if (!range_first) {
+	range_first = &oid;
+      }
+      range_last = &oid;
+    } else {
+      t.remove(coll, oid);
+    }
     ++num;
   }
+  flush_range();
   bool running = true;
   if (num) {
     dout(20) << __func__ << " deleting " << num << " objects" << dendl;
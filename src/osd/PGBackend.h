@@ -246,6 +246,15 @@ typedef std::shared_ptr<const OSDMap> OSDMapRef;
        GenContext<ThreadPool::TPHandle&> *c,
        uint64_t cost) = 0;
 
+     /**
+      * Run read on another thread, where it may block on the device,
+      * and then on_done with the pg locked.  read must not touch pg
+      * state.
+      */
+     virtual void schedule_async_read(
+       Context *read,
+       GenContext<ThreadPool::TPHandle&> *on_done) = 0;
+
      virtual pg_shard_t whoami_shard() const = 0;
      int whoami() const {
        return whoami_shard().osd;
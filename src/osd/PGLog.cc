@@ -873,20 +873,29 @@ void PGLog::_write_log_and_missing(
 		     << " write_from_dups=" << write_from_dups
 		     << " trimmed_dups.size()=" << trimmed_dups.size() << dendl;
   set<string> to_remove;
-  to_remove.swap(trimmed_dups);
-  for (auto& t : trimmed) {
-    string key = t.get_key_name();
+  if (touch_log)
+    t.touch(coll, log_oid);
+  // entries and dups are trimmed from the front, so what was trimmed is
+  // the oldest keys of each kind: drop them with one range delete
+  // instead of a key at a time
+  if (!trimmed.empty()) {
     if (log_keys_debug) {
-      auto it = log_keys_debug->find(key);
-      ceph_assert(it != log_keys_debug->end());
-      log_keys_debug->erase(it);
+      for (auto& v : trimmed) {
+	auto it = log_keys_debug->find(v.get_key_name());
+	ceph_assert(it != log_keys_debug->end());
+	log_keys_debug->erase(it);
+      }
     }
-    to_remove.emplace(std::move(key));
+    rm_key_range(t, coll, log_oid,
+		 trimmed.begin()->get_key_name(),
+		 trimmed.rbegin()->get_key_name());
+    trimmed.clear();
+  }
+  if (!trimmed_dups.empty()) {
+    rm_key_range(t, coll, log_oid,
+		 *trimmed_dups.begin(), *trimmed_dups.rbegin());
+    trimmed_dups.clear();
   }
-  trimmed.clear();
-
-  if (touch_log)
-    t.touch(coll, log_oid);
   if (dirty_to != eversion_t()) {
     t.omap_rmkeyrange(
       coll, log_oid,
@@ -22,6 +22,7 @@
 #include "osd_types.h"
 #include "os/ObjectStore.h"
 #include <list>
+#include <unordered_set>
 
 #ifdef WITH_SEASTAR
 #include <seastar/core/future.hh>
@@ -103,6 +104,115 @@
  *
  */
 
+/**
+ * pg_log_index_t
+ *
+ * An index of pointers into the log (or dups) keyed by a field of the
+ * entries themselves.  Unlike an unordered_map<key, T*> it doesn't keep
+ * a copy of the key next to each pointer; hobject_t and osd_reqid_t are
+ * larger than the pointer, and an hobject_t copy may allocate for the
+ * name on top of that.  Allocations are accounted to the osd_pglog
+ * mempool along with the log.
+ *
+ * The interface is the subset of unordered_map that the log uses, with
+ * set() replacing operator[] assignment.  Iterators yield
+ * (key, T*) pairs by value.
+ */
+template <typename T, auto Field>
+class pg_log_index_t {
+  using key_t = std::remove_cvref_t<decltype(std::declval<T&>().*Field)>;
+
+  struct hasher {
+    using is_transparent = void;
+    size_t operator()(const key_t &k) const {
+      return std::hash<key_t>()(k);
+    }
+    size_t operator()(const T *p) const {
+      return (*this)(p->*Field);
+    }
+  };
+  struct equal {
+    using is_transparent = void;
+    bool operator()(const T *l, const T *r) const {
+      return l->*Field == r->*Field;
+    }
+    bool operator()(const key_t &l, const T *r) const {
+      return l == r->*Field;
+    }
+    bool operator()(const T *l, const key_t &r) const {
+      return l->*Field == r;
+    }
+  };
+  using set_t = std::unordered_set<T*, hasher, equal,
+				   mempool::osd_pglog::pool_allocator<T*>>;
+  set_t s;
+
+public:
+  using value_type = std::pair<const key_t&, T*>;
+
+  class const_iterator {
+    typename set_t::const_iterator i;
+    struct arrow_t {
+      value_type v;
+      const value_type *operator->() const {
+	return &v;
+      }
+    };
+    friend class pg_log_index_t;
+  public:
+    explicit const_iterator(typename set_t::const_iterator i) : i(i) {}
+    value_type operator*() const {
+      return {(*i)->*Field, *i};
+    }
+    arrow_t operator->() const {
+      return {**this};
+    }
+    const_iterator &operator++() {
+      ++i;
+      return *this;
+    }
+    bool operator==(const const_iterator &rhs) const = default;
+  };
+  using iterator = const_iterator;
+
+  const_iterator begin() const {
+    return const_iterator(s.begin());
+  }
+  const_iterator end() const {
+    return const_iterator(s.end());
+  }
+  const_iterator find(const key_t &k) const {
+    return const_iterator(s.find(k));
+  }
+  size_t count(const key_t &k) const {
+    return s.count(k);
+  }
+  size_t size() const {
+    return s.size();
+  }
+  bool empty() const {
+    return s.empty();
+  }
+
+  /// index p under its key, replacing whatever was there
+  void set(T *p) {
+    if (auto i = s.find(p->*Field); i != s.end()) {
+      // reuse the node rather than free and allocate another
+      auto n = s.extract(i);
+      n.value() = p;
+      s.insert(std::move(n));
+    } else {
+      s.insert(p);
+    }
+  }
+  void erase(const_iterator i) {
+    s.erase(i.i);
+  }
+  void clear() {
+    s.clear();
+  }
+};
+
 constexpr auto PGLOG_INDEXED_OBJECTS          = 1 << 0;
 constexpr auto PGLOG_INDEXED_CALLER_OPS       = 1 << 1;
 constexpr auto PGLOG_INDEXED_EXTRA_CALLER_OPS = 1 << 2;
@@ -146,10 +256,11 @@ public:
    * plus some methods to manipulate it all.
    */
   struct IndexedLog : public pg_log_t {
-    mutable ceph::unordered_map<hobject_t,pg_log_entry_t*> objects;  // ptrs into log.  be careful!
-    mutable ceph::unordered_map<osd_reqid_t,pg_log_entry_t*> caller_ops;
+    // ptrs into log.  be careful!
+    mutable pg_log_index_t<pg_log_entry_t, &pg_log_entry_t::soid> objects;
+    mutable pg_log_index_t<pg_log_entry_t, &pg_log_entry_t::reqid> caller_ops;
     mutable ceph::unordered_multimap<osd_reqid_t,pg_log_entry_t*> extra_caller_ops;
-    mutable ceph::unordered_map<osd_reqid_t,pg_log_dup_t*> dup_index;
+    mutable pg_log_index_t<pg_log_dup_t, &pg_log_dup_t::reqid> dup_index;
 
     // recovery pointers
     std::list<pg_log_entry_t>::iterator complete_to; // not inclusive of referenced item
@@ -363,20 +474,20 @@ public:
       if (!(indexed_data & PGLOG_INDEXED_EXTRA_CALLER_OPS)) {
         index_extra_caller_ops();
       }
-      p = extra_caller_ops.find(r);
-      if (p != extra_caller_ops.end()) {
+      auto q = extra_caller_ops.find(r);
+      if (q != extra_caller_ops.end()) {
 	uint32_t idx = 0;
-	for (auto i = p->second->extra_reqids.begin();
-	     i != p->second->extra_reqids.end();
+	for (auto i = q->second->extra_reqids.begin();
+	     i != q->second->extra_reqids.end();
 	     ++idx, ++i) {
 	  if (i->first == r) {
-	    *version = p->second->version;
+	    *version = q->second->version;
 	    *user_version = i->second;
-	    *return_code = p->second->return_code;
-	    *op_returns = p->second->op_returns;
+	    *return_code = q->second->return_code;
+	    *op_returns = q->second->op_returns;
 	    if (*return_code >= 0) {
-	      auto it = p->second->extra_reqid_return_codes.find(idx);
-	      if (it != p->second->extra_reqid_return_codes.end()) {
+	      auto it = q->second->extra_reqid_return_codes.find(idx);
+	      if (it != q->second->extra_reqid_return_codes.end()) {
 		*return_code = it->second;
 	      }
 	    }
@@ -389,12 +500,12 @@ public:
       if (!(indexed_data & PGLOG_INDEXED_DUPS)) {
         index_dups();
       }
-      auto q = dup_index.find(r);
-      if (q != dup_index.end()) {
-	*version = q->second->version;
-	*user_version = q->second->user_version;
-	*return_code = q->second->return_code;
-	*op_returns = q->second->op_returns;
+      auto d = dup_index.find(r);
+      if (d != dup_index.end()) {
+	*version = d->second->version;
+	*user_version = d->second->user_version;
+	*return_code = d->second->return_code;
+	*op_returns = d->second->op_returns;
 	return true;
       }
 
@@ -459,7 +570,7 @@ public:
       if (to_index & PGLOG_INDEXED_DUPS) {
 	dup_index.clear();
 	for (auto& i : dups) {
-	  dup_index[i.reqid] = const_cast<pg_log_dup_t*>(&i);
+	  dup_index.set(const_cast<pg_log_dup_t*>(&i));
 	}
       }
 
@@ -472,13 +583,13 @@ public:
 	for (auto i = log.begin(); i != log.end(); ++i) {
 	  if (to_index & PGLOG_INDEXED_OBJECTS) {
 	    if (i->object_is_indexed()) {
-	      objects[i->soid] = const_cast<pg_log_entry_t*>(&(*i));
+	      objects.set(const_cast<pg_log_entry_t*>(&(*i)));
 	    }
 	  }
 
 	  if (to_index & PGLOG_INDEXED_CALLER_OPS) {
 	    if (i->reqid_is_indexed()) {
-	      caller_ops[i->reqid] = const_cast<pg_log_entry_t*>(&(*i));
+	      caller_ops.set(const_cast<pg_log_entry_t*>(&(*i)));
 	    }
 	  }
 
@@ -514,14 +625,15 @@ public:
 
     void index(pg_log_entry_t& e) {
       if ((indexed_data & PGLOG_INDEXED_OBJECTS) && e.object_is_indexed()) {
-        if (objects.count(e.soid) == 0 ||
-            objects[e.soid]->version < e.version)
-          objects[e.soid] = &e;
+        auto it = objects.find(e.soid);
+        if (it == objects.end() ||
+            it->second->version < e.version)
+          objects.set(&e);
       }
       if (indexed_data & PGLOG_INDEXED_CALLER_OPS) {
 	// divergent merge_log indexes new before unindexing old
         if (e.reqid_is_indexed()) {
-	  caller_ops[e.reqid] = &e;
+	  caller_ops.set(&e);
         }
       }
       if (indexed_data & PGLOG_INDEXED_EXTRA_CALLER_OPS) {
@@ -574,7 +686,7 @@ public:
 
     void index(pg_log_dup_t& e) {
       if (indexed_data & PGLOG_INDEXED_DUPS) {
-	dup_index[e.reqid] = &e;
+	dup_index.set(&e);
       }
     }
 
@@ -609,11 +721,11 @@ public:
 
       // to our index
       if ((indexed_data & PGLOG_INDEXED_OBJECTS) && e.object_is_indexed()) {
-        objects[e.soid] = &(log.back());
+        objects.set(&(log.back()));
       }
       if (indexed_data & PGLOG_INDEXED_CALLER_OPS) {
         if (e.reqid_is_indexed()) {
-	  caller_ops[e.reqid] = &(log.back());
+	  caller_ops.set(&(log.back()));
         }
       }
 
@@ -731,6 +843,15 @@ protected:
 	 log_keys_debug->erase(i++));
   }
 
+  /// remove the keys in [first, last] with a single range delete
+  static void rm_key_range(ObjectStore::Transaction& t,
+			   const coll_t& coll, const ghobject_t& log_oid,
+			   const std::string& first, const std::string& last) {
+    // omap_rmkeyrange() stops short of its end key, and last + '\0' is
+    // the smallest key that sorts after last
+    t.omap_rmkeyrange(coll, log_oid, first, last + '\0');
+  }
+
   void check();
   void undirty() {
     dirty_to = eversion_t();
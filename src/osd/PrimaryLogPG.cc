@@ -533,6 +533,13 @@ void PrimaryLogPG::schedule_recovery_work(
     recovery_state.get_recovery_op_priority());
 }
 
+void PrimaryLogPG::schedule_async_read(
+  Context *read,
+  GenContext<ThreadPool::TPHandle&> *on_done)
+{
+  osd->queue_async_read(this, read, on_done);
+}
+
 void PrimaryLogPG::replica_clear_repop_obc(
   const vector<pg_log_entry_t> &logv,
   ObjectStore::Transaction &t)
@@ -1768,6 +1775,8 @@ PrimaryLogPG::PrimaryLogPG(OSDService *o, OSDMapRef curmap,
     pgbackend->get_is_readable_predicate(),
     pgbackend->get_is_recoverable_predicate());
   snap_trimmer_machine.initiate();
+  object_contexts.set_max_bytes(
+    cct->_conf.get_val<Option::size_t>("osd_pg_object_context_cache_bytes"));
 
   m_scrubber = make_unique<PrimaryLogScrub>(this);
 }
@@ -4225,7 +4234,7 @@ void PrimaryLogPG::execute_ctx(OpContext *ctx)
   if (result == -EINPROGRESS || pending_async_reads) {
     // come back later.
     if (pending_async_reads) {
-      ceph_assert(pool.info.is_erasure());
+      ceph_assert(pool.info.is_erasure() || osd->has_async_reads());
       in_progress_async_reads.push_back(make_pair(op, ctx));
       ctx->start_async_reads(this);
     }
@@ -5381,6 +5390,43 @@ struct FillInVerifyExtent : public Context {
   }
 };
 
+/// the synchronous replicated read's checks, for async reads
+struct C_ReplicatedReadVerify : public Context {
+  PrimaryLogPG *pg;
+  OpContext *ctx;
+  OSDOp &osd_op;
+  C_ReplicatedReadVerify(PrimaryLogPG *pg, OpContext *ctx, OSDOp &osd_op)
+    : pg(pg), ctx(ctx), osd_op(osd_op) {}
+  void finish(int r) override {
+    auto& op = osd_op.op;
+    auto& oi = ctx->new_obs.oi;
+    // whole object?  can we verify the checksum?
+    if (r >= 0 && op.extent.offset == 0 &&
+        (uint64_t)r == oi.size && oi.is_data_digest()) {
+      uint32_t crc = osd_op.outdata.crc32c(-1);
+      if (oi.data_digest != crc) {
+        pg->osd->clog->error() << pg->info.pgid << std::hex
+			       << " full-object read crc 0x" << crc
+			       << " != expected 0x" << oi.data_digest
+			       << std::dec << " on " << oi.soid;
+        r = -EIO; // try repair later
+      }
+    }
+    if (r == -EIO) {
+      r = pg->rep_repair_primary_object(oi.soid, ctx);
+    }
+    if (r >= 0) {
+      op.extent.length = r;
+      osd_op.rval = 0;
+    } else {
+      if (r != -EAGAIN) {
+        op.extent.length = 0;
+      }
+      osd_op.rval = r;
+    }
+  }
+};
+
 struct ToSparseReadResult : public Context {
   int* result;
   bufferlist* data_bl;
@@ -5844,6 +5890,18 @@ int PrimaryLogPG::do_read(OpContext *ctx, OSDOp& osd_op) {
 					 osd, soid, op.flags))));
     dout(10) << " async_read noted for " << soid << dendl;
 
+    ctx->op_finishers[ctx->current_osd_subop_num].reset(
+      new ReadFinisher(osd_op));
+  } else if (osd->has_async_reads()) {
+    // let the op thread serve other pgs while the device works; see
+    // osd_async_read_threads
+    ctx->pending_async_reads.push_back(
+      make_pair(
+        boost::make_tuple(op.extent.offset, op.extent.length, op.flags),
+        make_pair(&osd_op.outdata,
+		  new C_ReplicatedReadVerify(this, ctx, osd_op))));
+    dout(10) << " async_read noted for " << soid << dendl;
+
     ctx->op_finishers[ctx->current_osd_subop_num].reset(
       new ReadFinisher(osd_op));
   } else {
@@ -11966,6 +12024,12 @@ ObjectContextRef PrimaryLogPG::get_object_context(
       }
     }
 
+    size_t charge = sizeof(ObjectContext) + bv.length();
+    for (const auto& [name, value] : obc->attr_cache) {
+      charge += name.size() + value.length();
+    }
+    object_contexts.set_charge(soid, charge);
+
     dout(10) << __func__ << ": creating obc from disk: " << *obc
 	     << dendl;
   }
@@ -13923,6 +13987,14 @@ uint64_t PrimaryLogPG::recover_backfill(
   }
   backfill_info.trim_to(last_backfill_started);
 
+  // small objects are pushed several to a recovery op: their pushes
+  // end up in the same MOSDPGPush and the same transaction on the target
+  const uint64_t small_object_size =
+    cct->_conf.get_val<Option::size_t>("osd_backfill_small_object_size");
+  const uint64_t small_object_batch = std::max<uint64_t>(
+    cct->_conf.get_val<uint64_t>("osd_backfill_small_object_batch"), 1);
+  uint64_t small_objects_in_op = 0;
+
   PGBackend::RecoveryHandle *h = pgbackend->open_recovery_op();
   while (ops < max) {
     if (backfill_info.begin <= earliest_peer_backfill() &&
@@ -14073,7 +14145,14 @@ uint64_t PrimaryLogPG::recover_backfill(
 	    dout(0) << __func__ << " Error " << r << " trying to backfill " << backfill_info.begin << dendl;
 	    break;
 	  }
-	  ops++;
+	  if (obc->obs.oi.size > small_object_size) {
+	    ops++;
+	  } else {
+	    if (small_objects_in_op == 0) {
+	      ops++;
+	    }
+	    small_objects_in_op = (small_objects_in_op + 1) % small_object_batch;
+	  }
 	} else {
 	  *work_started = true;
 	  dout(20) << "backfill blocking on " << backfill_info.begin
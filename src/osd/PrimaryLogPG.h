@@ -563,6 +563,9 @@ public:
   void schedule_recovery_work(
     GenContext<ThreadPool::TPHandle&> *c,
     uint64_t cost) override;
+  void schedule_async_read(
+    Context *read,
+    GenContext<ThreadPool::TPHandle&> *on_done) override;
 
   pg_shard_t whoami_shard() const override {
     return pg_whoami;
@@ -1413,6 +1416,8 @@ protected:
 
   friend struct C_ExtentCmpRead;
 
+  friend struct C_ReplicatedReadVerify;
+
   int do_read(OpContext *ctx, OSDOp& osd_op);
   int do_sparse_read(OpContext *ctx, OSDOp& osd_op);
   int do_writesame(OpContext *ctx, OSDOp& osd_op);
@@ -261,6 +261,7 @@ void ReplicatedBackend::on_change()
   }
   in_progress_ops.clear();
   clear_recovery_state();
+  ++async_read_gen;
 }
 
 int ReplicatedBackend::objects_read_sync(
@@ -294,7 +295,63 @@ void ReplicatedBackend::objects_read_async(
   Context *on_complete,
   bool fast_read)
 {
-  ceph_abort_msg("async read is not used by replica pool");
+  // The reads fill in buffers of their own on the async read thread;
+  // the caller's buffers and contexts are only touched with the pg
+  // locked, and not at all once the pg went through on_change().  The
+  // blessed completion holds a pg ref, which keeps this backend alive,
+  // and drops the completion if the pg was reset since.
+  struct async_read_t {
+    struct extent_t {
+      uint64_t off;
+      uint64_t len;
+      uint32_t flags;
+      bufferlist *out;
+      Context *on_extent;
+      bufferlist bl;
+      int r = 0;
+    };
+    vector<extent_t> extents;
+    Context *on_complete = nullptr;
+
+    ~async_read_t() {
+      for (auto& e : extents) {
+	delete e.on_extent;
+      }
+      delete on_complete;
+    }
+  };
+  auto read = std::make_shared<async_read_t>();
+  for (auto& [extent, out] : to_read) {
+    read->extents.push_back({extent.get<0>(), extent.get<1>(), extent.get<2>(),
+			     out.first, out.second});
+  }
+  read->on_complete = on_complete;
+
+  dout(20) << __func__ << " " << hoid << " " << to_read.size()
+	   << " extents" << dendl;
+  get_parent()->schedule_async_read(
+    new LambdaContext(
+      [store = store, c = ch, oid = ghobject_t(hoid), read](int) mutable {
+	for (auto& e : read->extents) {
+	  e.r = store->read(c, oid, e.off, e.len, e.bl, e.flags);
+	}
+      }),
+    get_parent()->bless_unlocked_gencontext(
+      make_gen_lambda_context<ThreadPool::TPHandle&>(
+	[this, gen = async_read_gen, read](ThreadPool::TPHandle&) {
+	  if (gen != async_read_gen) {
+	    dout(10) << "objects_read_async dropping reads from before "
+		     << "the last change" << dendl;
+	    return;
+	  }
+	  for (auto& e : read->extents) {
+	    if (e.r >= 0) {
+	      e.out->claim_append(e.bl);
+	    }
+	    std::exchange(e.on_extent, nullptr)->complete(e.r);
+	  }
+	  std::exchange(read->on_complete, nullptr)->complete(0);
+	}).release()));
 }
 
 class C_OSD_OnOpCommit : public Context {
@@ -653,6 +710,9 @@ int ReplicatedBackend::be_deep_scrub(
   if (!pos.data_done()) {
     if (pos.data_pos == 0) {
       pos.data_hash = bufferhash(-1);
+      // the store verifies its checksums on read; reading is the check
+      pos.data_csum_only = store->has_builtin_csum() &&
+	cct->_conf.get_val<bool>("osd_deep_scrub_csum_only");
     }
 
     const uint64_t stride = cct->_conf->osd_deep_scrub_stride;
@@ -671,7 +731,7 @@ int ReplicatedBackend::be_deep_scrub(
       o.read_error = true;
       return 0;
     }
-    if (r > 0) {
+    if (r > 0 && !pos.data_csum_only) {
       pos.data_hash << bl;
     }
     pos.data_pos += r;
@@ -682,10 +742,15 @@ int ReplicatedBackend::be_deep_scrub(
     }
     // done with bytes
     pos.data_pos = -1;
-    o.digest = pos.data_hash.digest();
-    o.digest_present = true;
-    dout(20) << __func__ << "  " << poid << " done with data, digest 0x"
-	     << std::hex << o.digest << std::dec << dendl;
+    if (pos.data_csum_only) {
+      dout(20) << __func__ << "  " << poid << " done with data, checksums ok"
+	       << dendl;
+    } else {
+      o.digest = pos.data_hash.digest();
+      o.digest_present = true;
+      dout(20) << __func__ << "  " << poid << " done with data, digest 0x"
+	       << std::hex << o.digest << std::dec << dendl;
+    }
   }
 
   // omap header
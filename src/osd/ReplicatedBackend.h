@@ -154,6 +154,9 @@ public:
                bool fast_read = false) override;
 
 private:
+  /// bumped by on_change(); async reads started before that are dropped
+  uint64_t async_read_gen = 0;
+
   // push
   struct push_info_t {
     ObjectRecoveryProgress recovery_progress;
@@ -203,6 +203,26 @@ int OSDriver::get_next_or_current(
     return -ENOENT;
   }
 }
+
+int OSDriver::get_next_batch(
+  const std::string &key,
+  unsigned max,
+  std::vector<std::pair<std::string, ceph::buffer::list>> *out)
+{
+  ObjectMap::ObjectMapIterator iter =
+    os->get_omap_iterator(ch, hoid);
+  if (!iter) {
+    ceph_abort();
+    return -EINVAL;
+  }
+  // one seek, then walk the iterator rather than seeking per key
+  for (iter->upper_bound(key);
+       iter->valid() && out->size() < max;
+       iter->next()) {
+    out->push_back(make_pair(iter->key(), iter->value()));
+  }
+  return out->empty() ? -ENOENT : 0;
+}
 #endif // WITH_SEASTAR
 
 string SnapMapper::get_prefix(int64_t pool, snapid_t snap)
@@ -585,22 +605,20 @@ vector<hobject_t> SnapMapper::get_objects_by_prefixes(
   /// maintain the prefix_itr between calls to avoid searching depleted prefixes
   for ( ; prefix_itr != prefixes.end(); prefix_itr++) {
     const string prefix(get_prefix(pool, snap) + *prefix_itr);
-    string pos = prefix;
-    while (out.size() < max) {
-      pair<string, ceph::buffer::list> next;
-      // access RocksDB (an expensive operation!)
-      int r = backend.get_next(pos, &next);
-      dout(20) << __func__ << " get_next(" << pos << ") returns " << r
-	       << " " << next.first << dendl;
-      if (r != 0) {
-	return out; // Done
-      }
+    // access RocksDB (an expensive operation!) once for the whole batch
+    vector<pair<string, ceph::buffer::list>> batch;
+    int r = backend.get_next_batch(prefix, max - out.size(), &batch);
+    dout(20) << __func__ << " get_next_batch(" << prefix << ") returns " << r
+	     << " with " << batch.size() << " entries" << dendl;
+    if (r != 0) {
+      return out; // Done
+    }
 
+    for (const auto& next : batch) {
       ceph_assert(is_mapping(next.first));
 
       if (auto next_prefix = next.first.substr(0, prefix.size());
           next_prefix != prefix) {
-	// TBD: we access the DB twice for the first object of each iterator...
 	dout(20) << fmt::format("{}: breaking, prefix expected {} got {}",
 	                        __func__, prefix, next_prefix)
 	         << dendl;
@@ -613,7 +631,6 @@ vector<hobject_t> SnapMapper::get_objects_by_prefixes(
       ceph_assert(check(next_decoded.second));
 
       out.push_back(next_decoded.second);
-      pos = next.first;
     }
 
     if (out.size() >= max) {
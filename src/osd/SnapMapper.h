@@ -95,6 +95,12 @@ public:
   int get_next_or_current(
     const std::string &key,
     std::pair<std::string, ceph::buffer::list> *next_or_current) override;
+#ifndef WITH_SEASTAR
+  int get_next_batch(
+    const std::string &key,
+    unsigned max,
+    std::vector<std::pair<std::string, ceph::buffer::list>> *out) override;
+#endif
 };
 
 /**
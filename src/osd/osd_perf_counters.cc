@@ -319,6 +319,21 @@ PerfCounters *build_osd_logger(CephContext *cct) {
   osd_plb.add_u64_counter(
     l_osd_pg_biginfo, "osd_pg_biginfo", "PG updated its biginfo attr");
 
+  osd_plb.add_u64_counter(
+    l_osd_op_pg_handoff, "op_pg_handoff",
+    "Queued items left to the thread owning their PG instead of waiting for "
+    "the PG lock");
+  osd_plb.add_u64_counter(
+    l_osd_op_read_batched, "op_read_batched",
+    "Read-only client ops run right after another one without dropping the "
+    "PG lock");
+  osd_plb.add_u64_counter(
+    l_osd_op_async_read, "op_async_read",
+    "Replicated pool reads done off the op threads");
+  osd_plb.add_time_avg(
+    l_osd_pg_load_lat, "pg_load_latency",
+    "Time to read a PG's state and log from the store at startup");
+
   /// scrub's replicas reservation time/#replicas histogram
   PerfHistogramCommon::axis_config_d rsrv_hist_x_axis_config{
       "number of replicas",
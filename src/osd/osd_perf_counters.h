@@ -132,6 +132,11 @@ enum {
   l_osd_pg_fastinfo,
   l_osd_pg_biginfo,
 
+  l_osd_op_pg_handoff,
+  l_osd_op_read_batched,
+  l_osd_op_async_read,
+  l_osd_pg_load_lat,
+
   // scrubber related. Here, as the rest of the scrub counters
   // are labeled, and histograms do not fully support labels.
   l_osd_scrub_reservation_dur_hist,
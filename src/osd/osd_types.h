@@ -5518,7 +5518,8 @@ class ObjectExtent {
   
   ObjectExtent() : objectno(0), offset(0), length(0), truncate_size(0) {}
   ObjectExtent(object_t o, uint64_t ono, uint64_t off, uint64_t l, uint64_t ts) :
-    oid(o), objectno(ono), offset(off), length(l), truncate_size(ts) { }
+    oid(std::move(o)), objectno(ono), offset(off), length(l),
+    truncate_size(ts) { }
 };
 
 inline std::ostream& operator<<(std::ostream& out, const ObjectExtent &ex)
@@ -6308,6 +6309,7 @@ struct ScrubMapBuilder {
   std::string omap_pos;
   int ret = 0;
   ceph::buffer::hash data_hash, omap_hash;  ///< accumulatinng hash value
+  bool data_csum_only = false;  ///< data left to the store's checksums
   uint64_t omap_keys = 0;
   uint64_t omap_bytes = 0;
 
@@ -27,6 +27,27 @@ namespace ceph::osd::scheduler {
 using client = uint64_t;
 using WorkItem = std::variant<std::monostate, OpSchedulerItem, double>;
 
+/**
+ * Work a scheduler handed out over some interval, used to estimate what
+ * the device actually sustains (see mClockCapacityEstimator).
+ */
+struct capacity_sample_t {
+  uint64_t ops = 0;         ///< items dequeued
+  uint64_t bytes = 0;       ///< their unscaled cost
+  uint64_t dequeues = 0;    ///< items dequeued from the QoS queue
+  uint64_t backlogged = 0;  ///< ... that left more work queued behind them
+  uint64_t throttled = 0;   ///< dequeues that had to wait for a limit
+
+  capacity_sample_t &operator+=(const capacity_sample_t &rhs) {
+    ops += rhs.ops;
+    bytes += rhs.bytes;
+    dequeues += rhs.dequeues;
+    backlogged += rhs.backlogged;
+    throttled += rhs.throttled;
+    return *this;
+  }
+};
+
 /**
  * Base interface for classes responsible for choosing
  * op processing order in the OSD.
@@ -49,6 +70,13 @@ public:
   // Dump formatted representation for the queue
   virtual void dump(ceph::Formatter &f) const = 0;
 
+  // Dump per-client QoS state, for schedulers that keep any
+  virtual void dump_clients(ceph::Formatter &f) const {}
+
+  // Add the work handed out since the last call to *sample and reset it,
+  // for schedulers that track it
+  virtual void take_capacity_sample(capacity_sample_t *sample) {}
+
   // Print human readable brief description with relevant parameters
   virtual void print(std::ostream &out) const = 0;
 
@@ -208,6 +208,16 @@ void PGRecoveryContext::run(
   pg->unlock();
 }
 
+void PGReadCompletion::run(
+  OSD *osd,
+  OSDShard *sdata,
+  PGRef& pg,
+  ThreadPool::TPHandle &handle)
+{
+  c.release()->complete(handle);
+  pg->unlock();
+}
+
 void PGDelete::run(
   OSD *osd,
   OSDShard *sdata,
@@ -552,6 +552,32 @@ public:
   }
 };
 
+/// finishes an op once the reads it handed off (see
+/// osd_async_read_threads) are done; the op already went through the
+/// scheduler, so this one doesn't wait behind others
+class PGReadCompletion : public PGOpQueueable {
+  std::unique_ptr<GenContext<ThreadPool::TPHandle&>> c;
+  epoch_t epoch;
+public:
+  PGReadCompletion(spg_t pgid,
+		   GenContext<ThreadPool::TPHandle&> *c, epoch_t epoch)
+    : PGOpQueueable(pgid), c(c), epoch(epoch) {}
+  std::ostream &print(std::ostream &rhs) const final {
+    return rhs << "PGReadCompletion(pgid=" << get_pgid()
+	       << " c=" << c.get() << " epoch=" << epoch
+	       << ")";
+  }
+  std::string print() const final {
+    return fmt::format(
+	"PGReadCompletion(pgid={} c={} epoch={})", get_pgid(), (void*)c.get(), epoch);
+  }
+  void run(
+    OSD *osd, OSDShard *sdata, PGRef& pg, ThreadPool::TPHandle &handle) final;
+  op_scheduler_class get_scheduler_class() const final {
+    return op_scheduler_class::immediate;
+  }
+};
+
 class PGDelete : public PGOpQueueable {
   epoch_t epoch_queued;
 public:
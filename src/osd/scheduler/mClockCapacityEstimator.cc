@@ -0,0 +1,75 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "osd/scheduler/mClockCapacityEstimator.h"
+
+
+namespace ceph::osd::scheduler {
+
+std::optional<double> mClockCapacityEstimator::add_sample(
+  const capacity_sample_t &sample,
+  double seconds,
+  double cur_iops,
+  uint64_t bandwidth,
+  const config_t &conf)
+{
+  if (seconds <= 0 || bandwidth == 0 || cur_iops <= 0 ||
+      sample.dequeues == 0 || sample.throttled > 0 ||
+      sample.backlogged < conf.min_backlog * sample.dequeues) {
+    // not saturated, or held back by a limit
+    pending.clear();
+    return std::nullopt;
+  }
+
+  // device time left for the per-io cost once transfers are accounted
+  // for; too little of it means the interval was bandwidth bound
+  double io_time = seconds - static_cast<double>(sample.bytes) / bandwidth;
+  if (io_time < seconds * 0.05) {
+    pending.clear();
+    return std::nullopt;
+  }
+  last_estimate = sample.ops / io_time;
+
+  if (std::abs(last_estimate / cur_iops - 1.0) <= conf.hysteresis) {
+    pending.clear();
+    return std::nullopt;
+  }
+  bool higher = last_estimate > cur_iops;
+  if (!pending.empty() && higher != pending_higher) {
+    pending.clear();
+  }
+  pending_higher = higher;
+  pending.push_back(last_estimate);
+  if (pending.size() < std::max(1u, conf.samples)) {
+    return std::nullopt;
+  }
+
+  double iops = std::accumulate(pending.begin(), pending.end(), 0.0) /
+    pending.size();
+  pending.clear();
+  if (conf.max_iops > 0) {
+    iops = std::min(iops, conf.max_iops);
+  }
+  iops = std::max(iops, 1.0);
+  if (std::abs(iops / cur_iops - 1.0) <= conf.hysteresis) {
+    // clamped back to about where we are
+    return std::nullopt;
+  }
+  return iops;
+}
+
+} // namespace ceph::osd::scheduler
@@ -0,0 +1,87 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "osd/scheduler/OpScheduler.h"
+
+
+namespace ceph::osd::scheduler {
+
+/**
+ * mClockCapacityEstimator
+ *
+ * Estimates the IOPS capacity of an OSD from the work its schedulers
+ * hand out, so that osd_mclock_max_capacity_iops_(hdd|ssd) can follow
+ * the device after the startup bench (firmware updates, a filling
+ * device, an SSD shared with other OSDs).
+ *
+ * mClock models an op as taking 1/iops + bytes/bandwidth seconds of
+ * device time.  Over an interval during which the queues stayed
+ * backlogged, and no limit held work back, the device was the
+ * bottleneck and that time adds up to the interval, which yields
+ *
+ *   iops = ops / (interval - bytes / bandwidth)
+ *
+ * Other intervals say nothing about capacity and are ignored.  A new
+ * capacity is only suggested once several consecutive estimates are
+ * all off by more than the hysteresis, in the same direction; it is
+ * their mean.
+ */
+class mClockCapacityEstimator {
+public:
+  struct config_t {
+    double min_backlog = 0.9;  ///< fraction of dequeues that left a backlog
+    double hysteresis = 0.2;   ///< relative difference that matters
+    unsigned samples = 5;      ///< consecutive estimates before adjusting
+    double max_iops = 0;       ///< upper bound for the result, 0 for none
+  };
+
+  /**
+   * add_sample
+   *
+   * Takes the work handed out over the last seconds and returns the
+   * capacity to switch to, if it is time to.  cur_iops is the configured
+   * capacity and bandwidth the sequential bandwidth in bytes/second.
+   */
+  std::optional<double> add_sample(
+    const capacity_sample_t &sample,
+    double seconds,
+    double cur_iops,
+    uint64_t bandwidth,
+    const config_t &conf);
+
+  /// last saturated estimate, 0 if there has not been any
+  double get_last_estimate() const {
+    return last_estimate;
+  }
+
+  /// number of consecutive estimates pointing the same way
+  size_t get_pending() const {
+    return pending.size();
+  }
+
+  void reset() {
+    pending.clear();
+  }
+
+private:
+  std::vector<double> pending;
+  bool pending_higher = false;
+  double last_estimate = 0;
+};
+
+} // namespace ceph::osd::scheduler
@@ -18,6 +18,8 @@
 
 #include "osd/scheduler/mClockScheduler.h"
 #include "common/dout.h"
+#include "common/strtol.h"
+#include "include/str_list.h"
 
 namespace dmc = crimson::dmclock;
 using namespace std::placeholders;
@@ -55,6 +57,7 @@ mClockScheduler::mClockScheduler(CephContext *cct,
   ceph_assert(num_shards > 0);
   set_osd_capacity_params_from_config();
   set_config_defaults_from_profile();
+  set_client_isolation_from_config();
   client_registry.update_from_config(
     cct->_conf, osd_bandwidth_capacity_per_shard);
 }
@@ -106,6 +109,29 @@ void mClockScheduler::ClientRegistry::update_from_config(
     wgt,
     get_lim(lim));
 
+  // Set per client and per pool overrides; clients without one get the
+  // default external client info above
+  std::map<client_profile_id_t, client_qos_t> overrides;
+  parse_client_qos(
+    conf.get_val<std::string>("osd_mclock_scheduler_client_qos"),
+    &overrides);
+  {
+    std::lock_guard l{external_client_lock};
+    for (auto& [id, info] : external_client_infos) {
+      if (!overrides.count(id)) {
+	info.update(
+	  default_external_client_info.reservation,
+	  default_external_client_info.weight,
+	  default_external_client_info.limit);
+      }
+    }
+    for (auto& [id, qos] : overrides) {
+      auto [res, wgt, lim] = qos;
+      auto it = external_client_infos.try_emplace(id, 1, 1, 1).first;
+      it->second.update(get_res(res), wgt, get_lim(lim));
+    }
+  }
+
   // Set background recovery client infos
   res = conf.get_val<double>(
     "osd_mclock_scheduler_background_recovery_res");
@@ -136,6 +162,7 @@ void mClockScheduler::ClientRegistry::update_from_config(
 const dmc::ClientInfo *mClockScheduler::ClientRegistry::get_external_client(
   const client_profile_id_t &client) const
 {
+  std::lock_guard l{external_client_lock};
   auto ret = external_client_infos.find(client);
   if (ret == external_client_infos.end())
     return &default_external_client_info;
@@ -143,6 +170,45 @@ const dmc::ClientInfo *mClockScheduler::ClientRegistry::get_external_client(
     return &(ret->second);
 }
 
+int mClockScheduler::parse_client_qos(
+  const std::string &s,
+  std::map<client_profile_id_t, client_qos_t> *out)
+{
+  int bad = 0;
+  for (auto &entry : get_str_vec(s, ", \t\n")) {
+    auto eq = entry.find('=');
+    if (eq == std::string::npos) {
+      ++bad;
+      continue;
+    }
+    std::string_view who(entry.data(), eq);
+    std::string err;
+    client_profile_id_t id;
+    if (who.starts_with("client.")) {
+      id.client_id = strict_strtoll(who.substr(7), 10, &err);
+    } else if (who.starts_with("pool.")) {
+      id.profile_id = strict_strtoll(who.substr(5), 10, &err) + 1;
+    } else {
+      err = "unknown entity";
+    }
+    auto params = get_str_vec(std::string_view(entry).substr(eq + 1), ":");
+    if (!err.empty() || params.size() != 3) {
+      ++bad;
+      continue;
+    }
+    double res = strict_strtod(params[0], &err);
+    long long wgt = strict_strtoll(params[1], 10, &err);
+    double lim = strict_strtod(params[2], &err);
+    if (!err.empty() || res < 0 || res > 1.0 || wgt <= 0 ||
+	lim < 0 || lim > 1.0) {
+      ++bad;
+      continue;
+    }
+    (*out)[id] = client_qos_t{res, static_cast<uint64_t>(wgt), lim};
+  }
+  return bad;
+}
+
 const dmc::ClientInfo *mClockScheduler::ClientRegistry::get_info(
   const scheduler_id_t &id) const {
   switch (id.class_id) {
@@ -157,6 +223,29 @@ const dmc::ClientInfo *mClockScheduler::ClientRegistry::get_info(
   }
 }
 
+void mClockScheduler::set_client_isolation_from_config()
+{
+  auto isolation = cct->_conf.get_val<std::string>(
+    "osd_mclock_scheduler_client_isolation");
+  if (isolation == "client") {
+    client_isolation = client_isolation_t::client;
+  } else if (isolation == "pool") {
+    client_isolation = client_isolation_t::pool;
+  } else {
+    client_isolation = client_isolation_t::none;
+  }
+  std::map<client_profile_id_t, client_qos_t> overrides;
+  int bad = parse_client_qos(
+    cct->_conf.get_val<std::string>("osd_mclock_scheduler_client_qos"),
+    &overrides);
+  if (bad) {
+    derr << __func__ << " ignoring " << bad << " malformed entries in"
+	 << " osd_mclock_scheduler_client_qos" << dendl;
+  }
+  dout(1) << __func__ << " client isolation: " << isolation
+	  << ", " << overrides.size() << " QoS overrides" << dendl;
+}
+
 void mClockScheduler::set_osd_capacity_params_from_config()
 {
   uint64_t osd_bandwidth_capacity;
@@ -383,6 +472,52 @@ void mClockScheduler::dump(ceph::Formatter &f) const
   f.close_section();
 }
 
+void mClockScheduler::dump_clients(ceph::Formatter &f) const
+{
+  const char *isolation[] = {"none", "client", "pool"};
+  f.dump_string("client_isolation",
+		isolation[static_cast<int>(client_isolation)]);
+  auto now = ceph::coarse_mono_clock::now();
+  f.open_array_section("clients");
+  for (auto &[id, stats] : client_stats) {
+    f.open_object_section("client");
+    if (id.client_id) {
+      f.dump_unsigned("client_id", id.client_id);
+    }
+    if (id.profile_id) {
+      f.dump_unsigned("pool", id.profile_id - 1);
+    }
+    auto info = client_registry.get_external_client(id);
+    f.dump_float("reservation", info->reservation);
+    f.dump_float("weight", info->weight);
+    f.dump_float("limit", info->limit);
+    f.dump_unsigned("queued", stats.queued);
+    f.dump_unsigned("reservation_ops", stats.reservation_ops);
+    f.dump_unsigned("priority_ops", stats.priority_ops);
+    f.dump_unsigned("cost", stats.cost);
+    f.dump_float("idle", std::chrono::duration<double>(
+		   now - stats.last_seen).count());
+    f.close_section();
+  }
+  f.close_section();
+}
+
+void mClockScheduler::prune_client_stats(ceph::coarse_mono_time now)
+{
+  if (now - last_stats_prune < std::chrono::minutes(1)) {
+    return;
+  }
+  last_stats_prune = now;
+  for (auto it = client_stats.begin(); it != client_stats.end(); ) {
+    if (!it->second.queued &&
+	now - it->second.last_seen > std::chrono::minutes(10)) {
+      it = client_stats.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
 void mClockScheduler::enqueue(OpSchedulerItem&& item)
 {
   auto id = get_scheduler_id(item);
@@ -401,6 +536,14 @@ void mClockScheduler::enqueue(OpSchedulerItem&& item)
              << " scaled_cost: " << cost
              << dendl;
 
+    if (id.class_id == op_scheduler_class::client) {
+      auto now = ceph::coarse_mono_clock::now();
+      auto &stats = client_stats[id.client_profile_id];
+      ++stats.queued;
+      stats.last_seen = now;
+      prune_client_stats(now);
+    }
+
     // Add item to scheduler queue
     scheduler.add_request(
       std::move(item),
@@ -460,11 +603,15 @@ WorkItem mClockScheduler::dequeue()
       // maintain invariant, high priority entries are never empty
       high_priority.erase(iter);
     }
-    ceph_assert(std::get_if<OpSchedulerItem>(&ret));
+    auto item = std::get_if<OpSchedulerItem>(&ret);
+    ceph_assert(item);
+    ++capacity_sample.ops;
+    capacity_sample.bytes += item->get_cost();
     return ret;
   } else {
     mclock_queue_t::PullReq result = scheduler.pull_request();
     if (result.is_future()) {
+      ++capacity_sample.throttled;
       return result.getTime();
     } else if (result.is_none()) {
       ceph_assert(
@@ -474,11 +621,35 @@ WorkItem mClockScheduler::dequeue()
       ceph_assert(result.is_retn());
 
       auto &retn = result.get_retn();
+      ++capacity_sample.ops;
+      capacity_sample.bytes += retn.request->get_cost();
+      ++capacity_sample.dequeues;
+      if (scheduler.request_count() > 0) {
+	++capacity_sample.backlogged;
+      }
+      if (retn.client.class_id == op_scheduler_class::client) {
+	auto it = client_stats.find(retn.client.client_profile_id);
+	if (it != client_stats.end()) {
+	  --it->second.queued;
+	  if (retn.phase == dmc::PhaseType::reservation) {
+	    ++it->second.reservation_ops;
+	  } else {
+	    ++it->second.priority_ops;
+	  }
+	  it->second.cost += retn.cost;
+	}
+      }
       return std::move(*retn.request);
     }
   }
 }
 
+void mClockScheduler::take_capacity_sample(capacity_sample_t *sample)
+{
+  *sample += capacity_sample;
+  capacity_sample = capacity_sample_t();
+}
+
 std::string mClockScheduler::display_queues() const
 {
   std::ostringstream out;
@@ -503,6 +674,8 @@ const char** mClockScheduler::get_tracked_conf_keys() const
     "osd_mclock_max_sequential_bandwidth_hdd",
     "osd_mclock_max_sequential_bandwidth_ssd",
     "osd_mclock_profile",
+    "osd_mclock_scheduler_client_isolation",
+    "osd_mclock_scheduler_client_qos",
     NULL
   };
   return KEYS;
@@ -529,6 +702,17 @@ void mClockScheduler::handle_conf_change(
     client_registry.update_from_config(
       conf, osd_bandwidth_capacity_per_shard);
   }
+  if (changed.count("osd_mclock_scheduler_client_isolation") ||
+      changed.count("osd_mclock_scheduler_client_qos")) {
+    // queued items keep the id they were queued with
+    set_client_isolation_from_config();
+    client_registry.update_from_config(
+      conf, osd_bandwidth_capacity_per_shard);
+    // the queue caches each client's ClientInfo pointer when it first
+    // sees the client; clients that just got or lost an override have
+    // to look theirs up again
+    scheduler.update_client_infos();
+  }
 
   auto get_changed_key = [&changed]() -> std::optional<std::string> {
     static const std::vector<std::string> qos_params = {
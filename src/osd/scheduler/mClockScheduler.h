@@ -16,6 +16,7 @@
 #pragma once
 
 #include <functional>
+#include <mutex>
 #include <ostream>
 #include <map>
 #include <vector>
@@ -25,6 +26,8 @@
 #include "dmclock/src/dmclock_server.h"
 
 #include "osd/scheduler/OpScheduler.h"
+#include "common/ceph_mutex.h"
+#include "common/ceph_time.h"
 #include "common/config.h"
 #include "common/ceph_context.h"
 #include "osd/scheduler/OpSchedulerItem.h"
@@ -43,14 +46,14 @@ constexpr double default_max = std::numeric_limits<double>::is_iec559 ?
  * client_id - global id (client.####) for client QoS
  * profile_id - id generated by client's QoS profile
  *
- * Currently (Reef and below), both members are set to
- * 0 which ensures that all external clients share the
- * mClock profile allocated reservation and limit
- * bandwidth.
+ * By default both members are set to 0 which ensures that
+ * all external clients share the mClock profile allocated
+ * reservation and limit bandwidth.
  *
- * Note: Post Reef, both members will be set to non-zero
- * values when the distributed feature of the mClock
- * algorithm is utilized.
+ * With osd_mclock_scheduler_client_isolation = client,
+ * client_id is the client's global id; with = pool,
+ * profile_id is the op's pool id + 1. Each of those then
+ * gets a queue and QoS parameters of its own.
  */
 struct client_profile_id_t {
   uint64_t client_id = 0;
@@ -153,11 +156,16 @@ class mClockScheduler : public OpScheduler, md_config_obs_t {
     };
 
     crimson::dmclock::ClientInfo default_external_client_info = {1, 1, 1};
+    /// osd_mclock_scheduler_client_qos overrides; entries are never erased
+    /// (only reset to the defaults) since the queue keeps pointers to them
     std::map<client_profile_id_t,
 	     crimson::dmclock::ClientInfo> external_client_infos;
+    mutable ceph::mutex external_client_lock =
+      ceph::make_mutex("mClockScheduler::ClientRegistry::external_client_lock");
+  public:
     const crimson::dmclock::ClientInfo *get_external_client(
       const client_profile_id_t &client) const;
-  public:
+
     /**
      * update_from_config
      *
@@ -192,12 +200,43 @@ class mClockScheduler : public OpScheduler, md_config_obs_t {
   SubQueue high_priority;
   priority_t immediate_class_priority = std::numeric_limits<priority_t>::max();
 
-  static scheduler_id_t get_scheduler_id(const OpSchedulerItem &item) {
-    return scheduler_id_t{
-      item.get_scheduler_class(),
-      client_profile_id_t()
-    };
+  enum class client_isolation_t {
+    none,
+    client,
+    pool
+  } client_isolation = client_isolation_t::none;
+
+  scheduler_id_t get_scheduler_id(const OpSchedulerItem &item) const {
+    auto class_id = item.get_scheduler_class();
+    if (class_id != op_scheduler_class::client) {
+      return scheduler_id_t{class_id, client_profile_id_t()};
+    }
+    switch (client_isolation) {
+    case client_isolation_t::client:
+      return scheduler_id_t{class_id, {item.get_owner(), 0}};
+    case client_isolation_t::pool:
+      return scheduler_id_t{
+	class_id,
+	{0, static_cast<uint64_t>(item.get_ordering_token().pool()) + 1}};
+    default:
+      return scheduler_id_t{class_id, client_profile_id_t()};
+    }
   }
+  void set_client_isolation_from_config();
+
+  /// what dump_clients() shows for each external client (or pool)
+  struct client_stats_t {
+    uint64_t queued = 0;           ///< in the mClock queue
+    uint64_t reservation_ops = 0;  ///< dequeued within the reservation
+    uint64_t priority_ops = 0;     ///< dequeued by weight
+    uint64_t cost = 0;             ///< total scaled cost dequeued
+    ceph::coarse_mono_time last_seen;
+  };
+  std::map<client_profile_id_t, client_stats_t> client_stats;
+  capacity_sample_t capacity_sample;
+  ceph::coarse_mono_time last_stats_prune;
+  /// forget clients that have been idle for a while
+  void prune_client_stats(ceph::coarse_mono_time now);
 
   /**
    * set_osd_capacity_params_from_config
@@ -217,6 +256,20 @@ class mClockScheduler : public OpScheduler, md_config_obs_t {
   void set_config_defaults_from_profile();
 
 public: 
+  /**
+   * parse_client_qos
+   *
+   * Parses osd_mclock_scheduler_client_qos: whitespace or comma
+   * separated client.<gid>=<res>:<wgt>:<lim> and pool.<id>=<res>:<wgt>:<lim>
+   * entries, res and lim being ratios of the OSD's capacity as in
+   * osd_mclock_scheduler_client_*.  Returns the number of entries that
+   * could not be parsed; those are skipped.
+   */
+  using client_qos_t = std::tuple<double, uint64_t, double>;
+  static int parse_client_qos(
+    const std::string &s,
+    std::map<client_profile_id_t, client_qos_t> *out);
+
   mClockScheduler(CephContext *cct, int whoami, uint32_t num_shards,
     int shard_id, bool is_rotational, unsigned cutoff_priority,
     MonClient *monc);
@@ -245,6 +298,11 @@ public:
   // Formatted output of the queue
   void dump(ceph::Formatter &f) const final;
 
+  // Formatted output of the external clients' QoS and usage
+  void dump_clients(ceph::Formatter &f) const final;
+
+  void take_capacity_sample(capacity_sample_t *sample) final;
+
   void print(std::ostream &ostream) const final {
     ostream << get_op_queue_type_name(get_type());
     ostream << ", cutoff=" << cutoff_priority;
@@ -3,6 +3,8 @@
 
 #include "./osd_scrub.h"
 
+#include <fstream>
+
 #include "osd/OSD.h"
 #include "osd/osd_perf_counters.h"
 #include "osdc/Objecter.h"
@@ -194,7 +196,9 @@ Scrub::OSDRestrictions OsdScrub::restrictions_on_scrubbing(
 
     // regular, i.e. non-high-priority scrubs are allowed
     env_conditions.time_permit = scrub_time_permit(scrub_clock_now);
-    env_conditions.load_is_low = m_load_tracker.scrub_load_below_threshold();
+    env_conditions.load_is_low =
+	m_load_tracker.scrub_load_below_threshold() &&
+	m_load_tracker.device_util_below_threshold();
     env_conditions.only_deadlined =
 	!env_conditions.time_permit || !env_conditions.load_is_low;
   }
@@ -319,6 +323,82 @@ bool OsdScrub::LoadTracker::scrub_load_below_threshold() const
   return false;
 }
 
+void OsdScrub::LoadTracker::set_devices(const std::set<std::string>& devices)
+{
+  m_devices.clear();
+  for (const auto& dev : devices) {
+    if (dev.starts_with("dm-")) {
+      // get_devices() also reports the underlying physical devices
+      continue;
+    }
+    m_devices.push_back(device_sample_t{dev});
+  }
+  m_last_device_sample = ceph::coarse_mono_time{};
+  m_device_util = 0.0;
+  dout(10) << fmt::format("tracking devices: {}", devices) << dendl;
+}
+
+static std::optional<uint64_t> read_device_io_ticks(const std::string& dev)
+{
+  // field 10 of the block layer statistics: milliseconds spent doing I/O
+  std::ifstream stat{fmt::format("/sys/block/{}/stat", dev)};
+  uint64_t field{0};
+  for (int i = 0; i < 10; ++i) {
+    if (!(stat >> field)) {
+      return std::nullopt;
+    }
+  }
+  return field;
+}
+
+void OsdScrub::LoadTracker::update_device_utilization()
+{
+  if (m_devices.empty()) {
+    return;
+  }
+  const auto now = ceph::coarse_mono_clock::now();
+  const bool have_prev = m_last_device_sample != ceph::coarse_mono_time{};
+  const double elapsed_ms =
+      std::chrono::duration<double, std::milli>(now - m_last_device_sample)
+	  .count();
+  m_last_device_sample = now;
+
+  double util{0.0};
+  for (auto& dev : m_devices) {
+    auto ticks = read_device_io_ticks(dev.name);
+    if (!ticks) {
+      continue;
+    }
+    if (have_prev && elapsed_ms > 0 && *ticks >= dev.io_ticks_ms) {
+      util = std::max(util, (*ticks - dev.io_ticks_ms) / elapsed_ms);
+    }
+    dev.io_ticks_ms = *ticks;
+  }
+  m_device_util = std::min(util, 1.0);
+}
+
+bool OsdScrub::LoadTracker::device_util_below_threshold() const
+{
+  const auto threshold =
+      conf.get_val<double>("osd_scrub_device_util_threshold");
+  if (threshold <= 0.0) {
+    return true;
+  }
+  const double util = m_device_util;
+  if (util < threshold) {
+    dout(20) << fmt::format(
+		    "device utilization {:.3f} < max {:.3f} = yes", util,
+		    threshold)
+	     << dendl;
+    return true;
+  }
+  dout(10) << fmt::format(
+		  "device utilization {:.3f} >= max {:.3f} = no", util,
+		  threshold)
+	   << dendl;
+  return false;
+}
+
 std::ostream& OsdScrub::LoadTracker::gen_prefix(
     std::ostream& out,
     std::string_view fn) const
@@ -328,9 +408,15 @@ std::ostream& OsdScrub::LoadTracker::gen_prefix(
 
 std::optional<double> OsdScrub::update_load_average()
 {
+  m_load_tracker.update_device_utilization();
   return m_load_tracker.update_load_average();
 }
 
+void OsdScrub::set_scrub_devices(const std::set<std::string>& devices)
+{
+  m_load_tracker.set_devices(devices);
+}
+
 // ////////////////////////////////////////////////////////////////////////// //
 
 // checks for half-closed ranges. Modify the (p<till)to '<=' to check for
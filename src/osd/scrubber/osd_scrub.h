@@ -2,6 +2,7 @@
 // vim: ts=8 sw=2 smarttab
 
 #pragma once
+#include <atomic>
 #include <string_view>
 
 #include "osd/osd_types_fmt.h"
@@ -170,6 +171,14 @@ class OsdScrub {
    */
   std::optional<double> update_load_average();
 
+  /**
+   * the block devices backing the object store. Their busy time is
+   * sampled together with the CPU load (see update_load_average()), and
+   * regular scrubs are not started while any of them is busier than
+   * osd_scrub_device_util_threshold.
+   */
+  void set_scrub_devices(const std::set<std::string>& devices);
+
    // the scrub performance counters collections
    // ---------------------------------------------------------------
   PerfCounters* get_perf_counters(int pool_type, scrub_level_t level);
@@ -237,6 +246,15 @@ class OsdScrub {
     const std::string log_prefix;
     double daily_loadavg{0.0};
 
+    struct device_sample_t {
+      std::string name;
+      uint64_t io_ticks_ms{0};  ///< from /sys/block/<dev>/stat
+    };
+    std::vector<device_sample_t> m_devices;
+    ceph::coarse_mono_time m_last_device_sample;
+    /// highest busy ratio (0..1) seen in the last sampling interval
+    std::atomic<double> m_device_util{0.0};
+
    public:
     explicit LoadTracker(
 	CephContext* cct,
@@ -247,6 +265,13 @@ class OsdScrub {
 
     [[nodiscard]] bool scrub_load_below_threshold() const;
 
+    void set_devices(const std::set<std::string>& devices);
+
+    /// sample the busy time of the devices. Called with the load update.
+    void update_device_utilization();
+
+    [[nodiscard]] bool device_util_below_threshold() const;
+
     std::ostream& gen_prefix(std::ostream& out, std::string_view fn) const;
   };
   LoadTracker m_load_tracker;
@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <cerrno>
+#include <limits>
 
 #include "Objecter.h"
 #include "osd/OSDMap.h"
@@ -220,6 +221,9 @@ const char** Objecter::get_tracked_conf_keys() const
     "crush_location",
     "rados_mon_op_timeout",
     "rados_osd_op_timeout",
+    "objecter_read_latency_aware",
+    "objecter_read_latency_decay",
+    "objecter_read_latency_spread",
     NULL
   };
   return config_keys;
@@ -238,6 +242,15 @@ void Objecter::handle_conf_change(const ConfigProxy& conf,
   if (changed.count("rados_osd_op_timeout")) {
     osd_timeout = conf.get_val<std::chrono::seconds>("rados_osd_op_timeout");
   }
+  if (changed.count("objecter_read_latency_aware")) {
+    read_latency_aware = conf.get_val<bool>("objecter_read_latency_aware");
+  }
+  if (changed.count("objecter_read_latency_decay")) {
+    read_latency_decay = conf.get_val<double>("objecter_read_latency_decay");
+  }
+  if (changed.count("objecter_read_latency_spread")) {
+    read_latency_spread = conf.get_val<double>("objecter_read_latency_spread");
+  }
 }
 
 void Objecter::update_crush_location()
@@ -1208,7 +1221,12 @@ void Objecter::handle_osd_map(MOSDMap *m)
 	  ldout(cct, 3) << "handle_osd_map decoding incremental epoch " << e
 			<< dendl;
 	  OSDMap::Incremental inc(m->incremental_maps[e]);
+	  std::set<int64_t> changed_pools;
+	  bool may_remap = _inc_may_remap_pgs(inc, &changed_pools);
 	  osdmap->apply_incremental(inc);
+	  if (!may_remap) {
+	    carry_forward_pg_mapping(e - 1, e, changed_pools);
+	  }
 
           emit_blocklist_events(inc);
 
@@ -2021,6 +2039,30 @@ void Objecter::maybe_request_map()
   _maybe_request_map();
 }
 
+/*
+ * Whether applying @inc to the current map can change the up/acting set
+ * of any pg.  Pools whose placement parameters change are added to
+ * @changed_pools; other pool updates (snaps, quotas, ...) are ignored.
+ */
+bool Objecter::_inc_may_remap_pgs(const OSDMap::Incremental& inc,
+				  std::set<int64_t> *changed_pools) const
+{
+  // rwlock is locked unique
+
+  // we don't track which pgs the temp and upmap entries name, so treat
+  // them like any other global change
+  return inc.epoch != osdmap->get_epoch() + 1 ||
+    !inc.new_pg_temp.empty() ||
+    !inc.new_primary_temp.empty() ||
+    !inc.new_pg_upmap.empty() ||
+    !inc.old_pg_upmap.empty() ||
+    !inc.new_pg_upmap_items.empty() ||
+    !inc.old_pg_upmap_items.empty() ||
+    !inc.new_pg_upmap_primary.empty() ||
+    !inc.old_pg_upmap_primary.empty() ||
+    inc.may_remap_all_pgs(*osdmap, changed_pools);
+}
+
 void Objecter::_maybe_request_map()
 {
   // rwlock is locked
@@ -2967,7 +3009,14 @@ int Objecter::_calc_target(op_target_t *t, Connection *con, bool any_change)
         !is_write && pi->is_replicated() && t->acting.size() > 1) {
       int osd;
       ceph_assert(is_read && t->acting[0] == acting_primary);
-      if (t->flags & CEPH_OSD_FLAG_BALANCE_READS) {
+      if ((t->flags & CEPH_OSD_FLAG_BALANCE_READS) && read_latency_aware) {
+	int p = _pick_fastest_replica(t->acting);
+	if (p)
+	  t->used_replica = true;
+	osd = t->acting[p];
+	ldout(cct, 10) << " chose fastest osd." << osd << " of " << t->acting
+		       << dendl;
+      } else if (t->flags & CEPH_OSD_FLAG_BALANCE_READS) {
 	int p = rand() % t->acting.size();
 	if (p)
 	  t->used_replica = true;
@@ -3211,6 +3260,7 @@ Objecter::MOSDOp *Objecter::_prepare_osd_op(Op *op)
 
   op->target.paused = false;
   op->stamp = ceph::coarse_mono_clock::now();
+  op->sent_stamp = ceph::mono_clock::now();
 
   hobject_t hobj = op->target.get_hobj();
   auto m = new MOSDOp(client_inc, op->tid,
@@ -3376,6 +3426,64 @@ int Objecter::take_linger_budget(LingerOp *info)
   return 1;
 }
 
+int Objecter::_pick_fastest_replica(const std::vector<int>& acting) const
+{
+  // rwlock is locked
+
+  // OSDs without a sample (no session yet, or no reads completed) sort as
+  // 0 so they get tried and measured.  Every OSD within
+  // objecter_read_latency_spread of the fastest one is an equally good
+  // choice, so pick among those at random rather than piling all reads
+  // onto whichever replica happens to be ahead by a few microseconds.
+  std::vector<uint64_t> lats(acting.size(), 0);
+  uint64_t best_lat = std::numeric_limits<uint64_t>::max();
+  for (unsigned i = 0; i < acting.size(); ++i) {
+    if (auto p = osd_sessions.find(acting[i]); p != osd_sessions.end()) {
+      lats[i] = p->second->read_latency_ns;
+    }
+    ldout(cct, 20) << __func__ << " rank " << i << " osd." << acting[i]
+		   << " read latency " << lats[i] << "ns" << dendl;
+    best_lat = std::min(best_lat, lats[i]);
+  }
+  uint64_t limit = best_lat + best_lat * read_latency_spread;
+  std::vector<int> candidates;
+  for (unsigned i = 0; i < acting.size(); ++i) {
+    if (lats[i] <= limit) {
+      candidates.push_back(i);
+    }
+  }
+  return candidates[rand() % candidates.size()];
+}
+
+void Objecter::_note_read_latency(OSDSession *s, ceph::timespan lat)
+{
+  // s->lock is locked
+
+  auto ns = std::max<uint64_t>(
+    1, std::chrono::duration_cast<std::chrono::nanoseconds>(lat).count());
+  uint64_t avg = s->read_latency_ns;
+  if (avg) {
+    double w = read_latency_decay;
+    ns = std::max<uint64_t>(1, w * ns + (1.0 - w) * avg);
+  }
+  s->read_latency_ns = ns;
+}
+
+bool Objecter::_op_reply_needs_resend(Op *op, MOSDOpReply *m) const
+{
+  // s->lock is locked
+
+  if (retry_writes_after_first_reply && op->attempts == 1 &&
+      (op->target.flags & CEPH_OSD_FLAG_WRITE)) {
+    return true;
+  }
+  if (m->get_retry_attempt() >= 0 &&
+      m->get_retry_attempt() != (op->attempts - 1)) {
+    return false; // stale reply, ignored
+  }
+  return m->is_redirect_reply() || m->get_result() == -EAGAIN;
+}
+
 /* This function DOES put the passed message before returning */
 void Objecter::handle_osd_op_reply(MOSDOpReply *m)
 {
@@ -3384,7 +3492,11 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
   // get pio
   ceph_tid_t tid = m->get_tid();
 
-  shunique_lock sul(rwlock, ceph::acquire_shared);
+  // Most replies just complete the op, which only needs the session
+  // lock. rwlock is taken (shared) only once we see that the op has to be
+  // resent, so replies don't contend with op_submit and map updates.
+  shunique_lock sul(rwlock, std::defer_lock);
+ retry:
   if (!initialized) {
     m->put();
     return;
@@ -3393,13 +3505,21 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
   ConnectionRef con = m->get_connection();
   auto priv = con->get_priv();
   auto s = static_cast<OSDSession*>(priv.get());
-  if (!s || s->con != con) {
+  if (!s) {
     ldout(cct, 7) << __func__ << " no session on con " << con << dendl;
     m->put();
     return;
   }
 
+  // _reopen_session() replaces s->con with s->lock held; we don't hold
+  // rwlock, so compare it under s->lock
   unique_lock sl(s->lock);
+  if (s->con != con) {
+    ldout(cct, 7) << __func__ << " no session on con " << con << dendl;
+    sl.unlock();
+    m->put();
+    return;
+  }
 
   map<ceph_tid_t, Op *>::iterator iter = s->ops.find(tid);
   if (iter == s->ops.end()) {
@@ -3420,6 +3540,14 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
 		<< " attempt " << m->get_retry_attempt()
 		<< dendl;
   Op *op = iter->second;
+
+  if (!sul && _op_reply_needs_resend(op, m)) {
+    // lock order is rwlock before s->lock; start over with both held
+    sl.unlock();
+    sul.lock_shared();
+    goto retry;
+  }
+
   op->trace.event("osd op reply");
 
   if (retry_writes_after_first_reply && op->attempts == 1 &&
@@ -3493,7 +3621,8 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
     return;
   }
 
-  sul.unlock();
+  if (sul)
+    sul.unlock();
 
   if (op->objver)
     *op->objver = m->get_user_version();
@@ -3617,6 +3746,10 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
   }
   logger->inc(l_osdc_op_reply);
   logger->tinc(l_osdc_op_latency, ceph::coarse_mono_time::clock::now() - op->stamp);
+  if ((op->target.flags & (CEPH_OSD_FLAG_READ | CEPH_OSD_FLAG_WRITE)) ==
+      CEPH_OSD_FLAG_READ) {
+    _note_read_latency(s, ceph::mono_clock::now() - op->sent_stamp);
+  }
   logger->set(l_osdc_op_inflight, num_in_flight);
 
   /* get it before we call _finish_op() */
@@ -5087,6 +5220,9 @@ Objecter::Objecter(CephContext *cct,
 {
   mon_timeout = cct->_conf.get_val<std::chrono::seconds>("rados_mon_op_timeout");
   osd_timeout = cct->_conf.get_val<std::chrono::seconds>("rados_osd_op_timeout");
+  read_latency_aware = cct->_conf.get_val<bool>("objecter_read_latency_aware");
+  read_latency_decay = cct->_conf.get_val<double>("objecter_read_latency_decay");
+  read_latency_spread = cct->_conf.get_val<double>("objecter_read_latency_spread");
 }
 
 Objecter::~Objecter()
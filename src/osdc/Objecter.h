@@ -1772,6 +1772,20 @@ private:
     ceph_assert(pg.ps() < mapping_array.size());
     mapping_array[pg.ps()] = std::move(pg_mapping);
   }
+  // re-stamp mappings valid at epoch @from as valid at @to, except for
+  // the pools in @skip.  only for epochs that don't change placement.
+  void carry_forward_pg_mapping(epoch_t from, epoch_t to,
+                                const std::set<int64_t>& skip) {
+    std::lock_guard l{pg_mapping_lock};
+    for (auto& [pool, mapping_array] : pg_mappings) {
+      if (skip.count(pool))
+        continue;
+      for (auto& pg_mapping : mapping_array) {
+        if (pg_mapping.epoch == from)
+          pg_mapping.epoch = to;
+      }
+    }
+  }
   void prune_pg_mapping(const mempool::osdmap::map<int64_t,pg_pool_t>& pools) {
     std::lock_guard l{pg_mapping_lock};
     for (auto& pool : pools) {
@@ -2040,6 +2054,8 @@ public:
     epoch_t *reply_epoch = nullptr;
 
     ceph::coarse_mono_time stamp;
+    /// precise send time, coarse_mono_time is too coarse for read latency
+    ceph::mono_time sent_stamp;
 
     epoch_t map_dne_bound = 0;
 
@@ -2499,6 +2515,8 @@ public:
 
     int incarnation;
     ConnectionRef con;
+    /// decaying average read latency in ns, or 0 until the first reply
+    std::atomic<uint64_t> read_latency_ns{0};
     int num_locks;
     std::unique_ptr<std::mutex[]> completion_locks;
 
@@ -2558,6 +2576,15 @@ public:
   ceph::timespan mon_timeout;
   ceph::timespan osd_timeout;
 
+  std::atomic<bool> read_latency_aware{false};
+  std::atomic<double> read_latency_decay{0.1};
+  std::atomic<double> read_latency_spread{0.2};
+
+  bool _inc_may_remap_pgs(const OSDMap::Incremental& inc,
+			  std::set<int64_t> *changed_pools) const;
+  int _pick_fastest_replica(const std::vector<int>& acting) const;
+  void _note_read_latency(OSDSession *s, ceph::timespan lat);
+
   MOSDOp *_prepare_osd_op(Op *op);
   void _send_op(Op *op);
   void _send_op_account(Op *op);
@@ -2774,6 +2801,7 @@ private:
     }
   }
 
+  bool _op_reply_needs_resend(Op *op, class MOSDOpReply *m) const;
   void handle_osd_op_reply(class MOSDOpReply *m);
   void handle_osd_backoff(class MOSDBackoff *m);
   void handle_watch_notify(class MWatchNotify *m);
@@ -130,15 +130,16 @@ void Striper::file_to_extents(CephContext *cct, const char *object_format,
                   &lightweight_object_extents);
 
   // convert lightweight object extents to heavyweight version
-  extents.reserve(lightweight_object_extents.size());
+  const auto oloc = OSDMap::file_to_object_locator(*layout);
+  extents.reserve(extents.size() + lightweight_object_extents.size());
   for (auto& lightweight_object_extent : lightweight_object_extents) {
     auto& object_extent = extents.emplace_back(
-      object_t(format_oid(object_format, lightweight_object_extent.object_no)),
+      format_oid(object_format, lightweight_object_extent.object_no),
       lightweight_object_extent.object_no,
       lightweight_object_extent.offset, lightweight_object_extent.length,
       lightweight_object_extent.truncate_size);
 
-    object_extent.oloc = OSDMap::file_to_object_locator(*layout);
+    object_extent.oloc = oloc;
     object_extent.buffer_extents.reserve(
       lightweight_object_extent.buffer_extents.size());
     object_extent.buffer_extents.insert(
@@ -161,14 +162,16 @@ void Striper::file_to_extents(
                   &lightweight_object_extents);
 
   // convert lightweight object extents to heavyweight version
+  const auto oloc = OSDMap::file_to_object_locator(*layout);
   for (auto& lightweight_object_extent : lightweight_object_extents) {
     auto oid = format_oid(object_format, lightweight_object_extent.object_no);
-    auto& object_extent = object_extents[oid].emplace_back(
-      oid, lightweight_object_extent.object_no,
+    auto& extents = object_extents[oid];
+    auto& object_extent = extents.emplace_back(
+      std::move(oid), lightweight_object_extent.object_no,
       lightweight_object_extent.offset, lightweight_object_extent.length,
       lightweight_object_extent.truncate_size);
 
-      object_extent.oloc = OSDMap::file_to_object_locator(*layout);
+      object_extent.oloc = oloc;
       object_extent.buffer_extents.reserve(
         lightweight_object_extent.buffer_extents.size());
       object_extent.buffer_extents.insert(
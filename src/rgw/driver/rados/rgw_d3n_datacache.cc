@@ -98,6 +98,7 @@ void D3nDataCache::init(CephContext *_cct) {
     eviction_policy = _eviction_policy::LRU;
   if (conf_eviction_policy == "random")
     eviction_policy = _eviction_policy::RANDOM;
+  admission_min_misses = cct->_conf.get_val<uint64_t>("rgw_d3n_l1_admission_min_misses");
 
 #if defined(HAVE_LIBAIO) && defined(__GLIBC__)
   // libaio setup
@@ -241,6 +242,20 @@ void D3nDataCache::put(bufferlist& bl, unsigned int len, std::string& oid)
       ldout(cct, 10) << "D3nDataCache: NOTE: data put in cache already issued, no rewrite" << dendl;
       return;
     }
+    if (admission_min_misses > 1) {
+      // the miss counts are reset whenever they outgrow the cache itself,
+      // so that only recent misses count towards admission
+      if (d3n_admission_misses.size() > std::max<size_t>(1024, 4 * d3n_cache_map.size())) {
+        d3n_admission_misses.clear();
+      }
+      auto mit = d3n_admission_misses.emplace(oid, 0).first;
+      if (++mit->second < admission_min_misses) {
+        ldout(cct, 20) << "D3nDataCache: " << __func__ << "(): not admitting oid=" << oid
+                       << ", misses=" << mit->second << dendl;
+        return;
+      }
+      d3n_admission_misses.erase(mit);
+    }
     d3n_outstanding_write_list.insert(oid);
   }
   {
@@ -63,6 +63,9 @@ struct D3nDataCache {
 private:
   std::unordered_map<std::string, D3nChunkDataInfo*> d3n_cache_map;
   std::set<std::string> d3n_outstanding_write_list;
+  // misses seen for chunks not yet admitted, protected by d3n_cache_lock
+  std::unordered_map<std::string, uint32_t> d3n_admission_misses;
+  uint32_t admission_min_misses = 1;
   std::mutex d3n_cache_lock;
   std::mutex d3n_eviction_lock;
 
@@ -352,6 +352,7 @@ class RGWGCIOManager {
     string oid;
     int index{-1};
     string tag;
+    ceph::mono_time start;
   };
 
   deque<IO> ios;
@@ -364,11 +365,41 @@ class RGWGCIOManager {
 #define MAX_AIO_DEFAULT 10
   size_t max_aio{MAX_AIO_DEFAULT};
 
+  /* with a latency target, max_aio is adjusted between 1 and
+   * rgw_gc_max_concurrent_io: grown by one for each window of tail
+   * removals that completed under the target, halved at most once per
+   * window when they didn't */
+  size_t max_aio_limit{MAX_AIO_DEFAULT};
+  ceph::timespan target_latency{0};
+  size_t window_ios{0};
+
+  void update_window(ceph::timespan latency) {
+    ++window_ios;
+    if (latency > target_latency) {
+      if (window_ios >= max_aio && max_aio > 1) {
+        max_aio = std::max<size_t>(1, max_aio / 2);
+        window_ios = 0;
+        ldpp_dout(dpp, 10) << "gc io latency " << latency <<
+          " above target, max_aio=" << max_aio << dendl;
+      }
+    } else if (window_ios >= max_aio) {
+      if (max_aio < max_aio_limit) {
+        ++max_aio;
+        ldpp_dout(dpp, 20) << "gc io latency under target, max_aio=" <<
+          max_aio << dendl;
+      }
+      window_ios = 0;
+    }
+  }
+
 public:
   RGWGCIOManager(const DoutPrefixProvider* _dpp, CephContext *_cct, RGWGC *_gc) : dpp(_dpp),
                                                                                   cct(_cct),
                                                                                   gc(_gc) {
     max_aio = cct->_conf->rgw_gc_max_concurrent_io;
+    max_aio_limit = max_aio;
+    target_latency = cct->_conf.get_val<std::chrono::milliseconds>(
+      "rgw_gc_target_io_latency");
     remove_tags.resize(min(static_cast<int>(cct->_conf->rgw_gc_max_objs), rgw_shards_max()));
     tag_io_size.resize(min(static_cast<int>(cct->_conf->rgw_gc_max_objs), rgw_shards_max()));
   }
@@ -397,7 +428,8 @@ public:
     if (ret < 0) {
       return ret;
     }
-    ios.push_back(IO{IO::TailIO, c.get(), oid, index, tag});
+    ios.push_back(IO{IO::TailIO, c.get(), oid, index, tag,
+                     ceph::mono_clock::now()});
     c.release();
 
     return 0;
@@ -410,6 +442,10 @@ public:
     int ret = io.c->get_return_value();
     io.c->release();
 
+    if (io.type == IO::TailIO && target_latency.count()) {
+      update_window(ceph::mono_clock::now() - io.start);
+    }
+
     if (ret == -ENOENT) {
       ret = 0;
     }
@@ -9524,23 +9524,33 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
   // to manage the iterators through each shard's list results
   struct ShardTracker {
     const size_t shard_idx;
-    rgw_cls_list_ret& result;
+    rgw_cls_list_ret* result;
     const std::string& oid_name;
     RGWRados::ent_map_t::iterator cursor;
     RGWRados::ent_map_t::iterator end;
+    uint32_t read_size;
 
     // manages an iterator through a shard and provides other
     // accessors
     ShardTracker(size_t _shard_idx,
 		 rgw_cls_list_ret& _result,
-		 const std::string& _oid_name):
+		 const std::string& _oid_name,
+		 uint32_t _read_size):
       shard_idx(_shard_idx),
-      result(_result),
+      result(&_result),
       oid_name(_oid_name),
       cursor(_result.dir.m.begin()),
-      end(_result.dir.m.end())
+      end(_result.dir.m.end()),
+      read_size(_read_size)
     {}
 
+    // switch to a later batch of results read from the same shard
+    void reset(rgw_cls_list_ret& _result) {
+      result = &_result;
+      cursor = _result.dir.m.begin();
+      end = _result.dir.m.end();
+    }
+
     inline const std::string& entry_name() const {
       return cursor->first;
     }
@@ -9548,7 +9558,7 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
       return cursor->second;
     }
     inline bool is_truncated() const {
-      return result.is_truncated;
+      return result->is_truncated;
     }
     inline ShardTracker& advance() {
       ++cursor;
@@ -9575,7 +9585,8 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
   std::vector<ShardTracker> results_trackers;
   results_trackers.reserve(shard_list_results.size());
   for (auto& r : shard_list_results) {
-    results_trackers.emplace_back(r.first, r.second, shard_oids[r.first]);
+    results_trackers.emplace_back(r.first, r.second, shard_oids[r.first],
+				  num_entries_per_shard);
 
     // if any *one* shard's result is truncated, the entire result is
     // truncated
@@ -9606,6 +9617,39 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     last_entry_visited = nullptr; // to set last_entry (marker)
   std::map<std::string, bufferlist> updates;
   uint32_t count = 0;
+
+  // when a truncated shard runs out before we have num_entries, we
+  // read more from just that shard rather than stopping early; the
+  // earlier results stay alive since entries may still point into them
+  constexpr uint32_t max_shard_rereads = 8;
+  uint32_t shard_rereads = 0;
+  std::list<std::map<int, rgw_cls_list_ret>> reread_results;
+  auto reread_shard = [&](ShardTracker& t, const cls_rgw_obj_key& after) {
+    if (!delimiter.empty() || shard_rereads >= max_shard_rereads) {
+      // common prefixes can't simply be resumed after
+      return false;
+    }
+    ++shard_rereads;
+    t.read_size = std::min(num_entries - count, 2 * t.read_size);
+    std::map<int, std::string> oid{{int(t.shard_idx), t.oid_name}};
+    auto& result = reread_results.emplace_back();
+    int ret = CLSRGWIssueBucketList(ioctx, after, prefix, delimiter,
+				    t.read_size, list_versions, oid, result,
+				    cct->_conf->rgw_bucket_index_max_aio)();
+    if (ret < 0 || result.empty()) {
+      ldpp_dout(dpp, 5) << "cls_bucket_list_ordered" << ": reread of shard " <<
+	t.shard_idx << " failed, r=" << ret << dendl;
+      return false;
+    }
+    auto& shard_result = result.begin()->second;
+    *cls_filtered = *cls_filtered && shard_result.cls_filtered;
+    t.reset(shard_result);
+    ldpp_dout(dpp, 20) << "cls_bucket_list_ordered" << ": reread " << t.read_size <<
+      " entries from shard " << t.shard_idx << " after " << after <<
+      dendl;
+    return true;
+  };
+
   while (count < num_entries && !candidates.empty()) {
     r = 0;
     // select the next entry in lexical order (first key in map);
@@ -9682,6 +9726,10 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
       auto& tracker_match = results_trackers.at(idx);
       tracker_match.advance();
       next_candidate(cct, tracker_match, candidates, idx);
+      if (tracker_match.at_end() && tracker_match.is_truncated() &&
+	  count < num_entries && reread_shard(tracker_match, dirent_key)) {
+	next_candidate(cct, tracker_match, candidates, idx);
+      }
       if (tracker_match.at_end() && tracker_match.is_truncated()) {
         need_to_stop = true;
         break;
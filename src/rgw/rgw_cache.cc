@@ -27,8 +27,9 @@ int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCa
     return -ENOENT;
   }
 
-  if (expiry.count() &&
-       (ceph::coarse_mono_clock::now() - iter->second.info.time_added) > expiry) {
+  const auto& entry_expiry = expiry_for(iter->second.info);
+  if (entry_expiry.count() &&
+       (ceph::coarse_mono_clock::now() - iter->second.info.time_added) > entry_expiry) {
     ldpp_dout(dpp, 10) << "cache get: name=" << name << " : expiry miss" << dendl;
     rl.unlock();
     wl.lock(); // write lock for expiration
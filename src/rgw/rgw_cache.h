@@ -171,6 +171,14 @@ class ObjectCache {
 
   bool enabled;
   ceph::timespan expiry;
+  ceph::timespan negative_expiry;
+
+  const ceph::timespan& expiry_for(const ObjectCacheInfo& info) const {
+    if (info.status == -ENOENT && negative_expiry.count()) {
+      return negative_expiry;
+    }
+    return expiry;
+  }
 
   void touch_lru(const DoutPrefixProvider *dpp, const std::string& name, ObjectCacheEntry& entry,
 		 std::list<std::string>::iterator& lru_iter);
@@ -195,7 +203,8 @@ public:
     if (enabled) {
       auto now  = ceph::coarse_mono_clock::now();
       for (const auto& [name, entry] : cache_map) {
-        if (expiry.count() && (now - entry.info.time_added) < expiry) {
+        const auto& entry_expiry = expiry_for(entry.info);
+        if (entry_expiry.count() && (now - entry.info.time_added) < entry_expiry) {
           f(name, entry);
         }
       }
@@ -209,6 +218,8 @@ public:
     lru_window = cct->_conf->rgw_cache_lru_size / 2;
     expiry = std::chrono::seconds(cct->_conf.get_val<uint64_t>(
 						"rgw_cache_expiry_interval"));
+    negative_expiry = std::chrono::seconds(cct->_conf.get_val<uint64_t>(
+					"rgw_cache_negative_expiry_interval"));
   }
   bool chain_cache_entry(const DoutPrefixProvider *dpp,
                          std::initializer_list<rgw_cache_entry_info*> cache_info_entries,
@@ -217,6 +217,11 @@ bool new_producer(connection_t* conn) {
   const auto message_timeout = std::max(min_message_timeout, conn->cct->_conf->rgw_kafka_message_timeout);
   if (rd_kafka_conf_set(conn->temp_conf, "message.timeout.ms", 
         std::to_string(message_timeout).c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) goto conf_error;
+  // set batching delay, if not set, librdkafka default is used
+  if (const auto linger_ms = conn->cct->_conf->rgw_kafka_linger_ms; linger_ms > 0) {
+    if (rd_kafka_conf_set(conn->temp_conf, "linger.ms",
+          std::to_string(linger_ms).c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) goto conf_error;
+  }
   // get list of brokers based on the bootstrap broker
   if (rd_kafka_conf_set(conn->temp_conf, "bootstrap.servers", conn->broker.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) goto conf_error;
   
@@ -2,6 +2,7 @@
 #include <lua.hpp>
 #include "common/ceph_context.h"
 #include "common/debug.h"
+#include "common/lru_map.h"
 #include "rgw_lua_utils.h"
 #include "rgw_lua_version.h"
 
@@ -91,6 +92,39 @@ void open_standard_libs(lua_State* L) {
   }
 }
 
+namespace {
+int bytecode_writer(lua_State* L, const void* p, std::size_t sz, void* ud) {
+  reinterpret_cast<std::string*>(ud)->append(reinterpret_cast<const char*>(p), sz);
+  return 0;
+}
+}
+
+int dostring(lua_State* L, CephContext* cct, const std::string& script) {
+  static const std::size_t cache_size =
+    cct->_conf.get_val<uint64_t>("rgw_lua_script_cache_size");
+  if (cache_size == 0) {
+    return luaL_dostring(L, script.c_str());
+  }
+  static lru_map<std::string, std::shared_ptr<const std::string>> cache(cache_size);
+
+  std::shared_ptr<const std::string> bytecode;
+  if (cache.find(script, bytecode)) {
+    // debug info is kept in the bytecode, so error messages are the same as for the source
+    if (const auto rc = luaL_loadbufferx(L, bytecode->data(), bytecode->size(), script.c_str(), "b"); rc != LUA_OK) {
+      return rc;
+    }
+  } else {
+    if (const auto rc = luaL_loadstring(L, script.c_str()); rc != LUA_OK) {
+      return rc;
+    }
+    auto dumped = std::make_shared<std::string>();
+    if (lua_dump(L, bytecode_writer, dumped.get(), 0) == 0) {
+      cache.add(script, std::move(dumped));
+    }
+  }
+  return lua_pcall(L, 0, LUA_MULTRET, 0);
+}
+
 // allocator function that verifies against maximum allowed memory value
 void* allocator(void* ud, void* ptr, std::size_t osize, std::size_t nsize) {
   auto mem = reinterpret_cast<std::size_t*>(ud); // remaining memory
@@ -77,6 +77,11 @@ public:
 
 int dostring(lua_State* L, const char* str);
 
+// load and run the script, same as luaL_dostring()
+// the compiled chunk is cached by script text (up to "rgw_lua_script_cache_size" entries)
+// so that the script is parsed only once, and later loads only need to undump the bytecode
+int dostring(lua_State* L, CephContext* cct, const std::string& script);
+
 constexpr const int MAX_LUA_VALUE_SIZE = 1000;
 constexpr const int MAX_LUA_KEY_ENTRIES = 100000;
 
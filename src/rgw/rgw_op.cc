@@ -21,6 +21,7 @@
 #include "common/utf8.h"
 #include "common/ceph_json.h"
 #include "common/static_ptr.h"
+#include "common/lru_map.h"
 #include "common/perf_counters_key.h"
 #include "rgw_tracer.h"
 
@@ -332,7 +333,22 @@ get_iam_policy_from_attr(CephContext* cct,
     // resource policy is not restricted to the current tenant
     const std::string* policy_tenant = nullptr;
 
-    return Policy(cct, policy_tenant, i->second.to_str(), false);
+    // parsing is deterministic for a given text, so the text itself is
+    // the cache key and a modified policy simply misses
+    static const size_t cache_size =
+      cct->_conf.get_val<uint64_t>("rgw_iam_policy_cache_size");
+    if (!cache_size) {
+      return Policy(cct, policy_tenant, i->second.to_str(), false);
+    }
+    static lru_map<std::string, std::shared_ptr<const Policy>> cache(cache_size);
+
+    std::string text = i->second.to_str();
+    std::shared_ptr<const Policy> policy;
+    if (!cache.find(text, policy)) {
+      policy = std::make_shared<const Policy>(cct, policy_tenant, text, false);
+      cache.add(text, policy);
+    }
+    return *policy;
   } else {
     return none;
   }
@@ -59,6 +59,11 @@ void add_rgw_frontend_counters(PerfCountersBuilder *pcb) {
   pcb->add_u64_counter(l_rgw_lua_script_ok, "lua_script_ok", "Successful executions of Lua scripts");
   pcb->add_u64_counter(l_rgw_lua_script_fail, "lua_script_fail", "Failed executions of Lua scripts");
   pcb->add_u64(l_rgw_lua_current_vms, "lua_current_vms", "Number of Lua VMs currently being executed");
+
+  pcb->add_time_avg(l_rgw_auth_lat, "auth_lat", "Request authentication latency");
+  pcb->add_time_avg(l_rgw_permission_lat, "permission_lat", "Request permission checks latency (including bucket and object metadata reads)");
+  pcb->add_time_avg(l_rgw_execute_lat, "execute_lat", "Op execution latency");
+  pcb->add_time_avg(l_rgw_complete_lat, "complete_lat", "Op completion latency (sending the response)");
 }
 
 void add_rgw_op_counters(PerfCountersBuilder *lpcb) {
@@ -49,6 +49,11 @@ enum {
   l_rgw_lua_script_ok,
   l_rgw_lua_script_fail,
 
+  l_rgw_auth_lat,
+  l_rgw_permission_lat,
+  l_rgw_execute_lat,
+  l_rgw_complete_lat,
+
   l_rgw_last,
 };
 
@@ -170,6 +170,7 @@ int rgw_process_authenticated(RGWHandler_REST * const handler,
                               rgw::sal::Driver* driver,
                               const bool skip_retarget)
 {
+  auto stage_start = ceph::mono_clock::now();
   ldpp_dout(op, 2) << "init permissions" << dendl;
   int ret = handler->init_permissions(op, y);
   if (ret < 0) {
@@ -225,6 +226,11 @@ int rgw_process_authenticated(RGWHandler_REST * const handler,
     ret = op->verify_permission(y);
     std::swap(span, s->trace);
   }
+  if (perfcounter) {
+    const auto now = ceph::mono_clock::now();
+    perfcounter->tinc(l_rgw_permission_lat, now - stage_start);
+    stage_start = now;
+  }
   if (ret < 0) {
     if (s->system_request) {
       dout(2) << "overriding permissions due to system operation" << dendl;
@@ -255,9 +261,17 @@ int rgw_process_authenticated(RGWHandler_REST * const handler,
     op->execute(y);
     std::swap(span, s->trace);
   }
+  if (perfcounter) {
+    const auto now = ceph::mono_clock::now();
+    perfcounter->tinc(l_rgw_execute_lat, now - stage_start);
+    stage_start = now;
+  }
 
   ldpp_dout(op, 2) << "completing" << dendl;
   op->complete();
+  if (perfcounter) {
+    perfcounter->tinc(l_rgw_complete_lat, ceph::mono_clock::now() - stage_start);
+  }
 
   return 0;
 }
@@ -356,7 +370,11 @@ int process_request(const RGWProcessEnv& penv,
 
   try {
     ldpp_dout(op, 2) << "verifying requester" << dendl;
+    const auto auth_start = ceph::mono_clock::now();
     ret = op->verify_requester(*penv.auth_registry, yield);
+    if (perfcounter) {
+      perfcounter->tinc(l_rgw_auth_lat, ceph::mono_clock::now() - auth_start);
+    }
     if (ret < 0) {
       dout(10) << "failed to authorize request" << dendl;
       abort_early(s, op, ret, handler, yield);
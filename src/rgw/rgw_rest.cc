@@ -794,7 +794,34 @@ int dump_body(req_state* const s,
 
 int dump_body(req_state* const s, /* const */ ceph::buffer::list& bl)
 {
-  return dump_body(s, bl.c_str(), bl.length());
+  return dump_body(s, bl, 0, bl.length());
+}
+
+/* Send the bufferlist segment by segment rather than flattening it with
+ * c_str(), which would copy the whole object chunk. */
+int dump_body(req_state* const s, const ceph::buffer::list& bl,
+              size_t ofs, const size_t len)
+{
+  int sent = 0;
+  size_t left = len;
+  for (const auto& bp : bl.buffers()) {
+    if (left == 0) {
+      break;
+    }
+    if (ofs >= bp.length()) {
+      ofs -= bp.length();
+      continue;
+    }
+    const size_t n = std::min<size_t>(bp.length() - ofs, left);
+    const int r = dump_body(s, bp.c_str() + ofs, n);
+    if (r < 0) {
+      return r;
+    }
+    sent += r;
+    left -= n;
+    ofs = 0;
+  }
+  return sent;
 }
 
 int dump_body(req_state* const s, const std::string& str)
@@ -12,6 +12,7 @@
      --test-map-pgs [--pool <poolid>] [--pg_num <pg_num>] [--range-first <first> --range-last <last>] map all pgs
      --test-map-pgs-dump [--pool <poolid>] [--range-first <first> --range-last <last>] map all pgs
      --test-map-pgs-dump-all [--pool <poolid>] [--range-first <first> --range-last <last>] map all pgs to osds
+     --test-map-pgs-diff <file> [--pool <poolid>] [--map-threads <n>] compare pg mappings with the osdmap in <file>
      --mark-up-in            mark osds up and in (but do not persist)
      --mark-out <osdid>      mark an osd as out (but do not persist)
      --mark-up <osdid>       mark an osd as up (but do not persist)
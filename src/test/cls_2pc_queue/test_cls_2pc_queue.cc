@@ -174,6 +174,69 @@ TEST_F(TestCls2PCQueue, Commit)
   ASSERT_EQ(reservations.size(), 0);
 }
 
+TEST_F(TestCls2PCQueue, CommitBatch)
+{
+  const std::string queue_name = __PRETTY_FUNCTION__;
+  const auto max_size = 1024*1024;
+  const auto number_of_ops = 17U;
+  const auto number_of_elements = 23U;
+  librados::ObjectWriteOperation op;
+  op.create(true);
+  cls_2pc_queue_init(op, queue_name, max_size);
+  ASSERT_EQ(0, ioctx.operate(queue_name, &op));
+
+  std::vector<std::pair<cls_2pc_reservation::id_t, std::vector<bufferlist>>> commits;
+  for (auto i = 0U; i < number_of_ops; ++i) {
+    const std::string element_prefix("op-" +to_string(i) + "-element-");
+    auto total_size = 0UL;
+    std::vector<bufferlist> data(number_of_elements);
+    // create vector of buffer lists
+    std::generate(data.begin(), data.end(), [j = 0, &element_prefix, &total_size] () mutable {
+          bufferlist bl;
+          bl.append(element_prefix + to_string(j++));
+          total_size += bl.length();
+          return bl;
+        });
+
+    cls_2pc_reservation::id_t res_id;
+    ASSERT_EQ(cls_2pc_queue_reserve(ioctx, queue_name, total_size, number_of_elements, res_id), 0);
+    ASSERT_NE(res_id, cls_2pc_reservation::NO_ID);
+    commits.emplace_back(res_id, std::move(data));
+  }
+
+  // a batch with an unknown reservation fails as a whole
+  {
+    auto invalid_commits = commits;
+    invalid_commits.emplace_back(commits.back().first+999, std::vector<bufferlist>{});
+    librados::ObjectWriteOperation wop;
+    cls_2pc_queue_commit_batch(wop, std::move(invalid_commits));
+    ASSERT_EQ(-ENOENT, ioctx.operate(queue_name, &wop));
+    cls_2pc_reservations reservations;
+    ASSERT_EQ(0, cls_2pc_queue_list_reservations(ioctx, queue_name, reservations));
+    ASSERT_EQ(reservations.size(), number_of_ops);
+  }
+
+  librados::ObjectWriteOperation wop;
+  cls_2pc_queue_commit_batch(wop, std::move(commits));
+  ASSERT_EQ(0, ioctx.operate(queue_name, &wop));
+
+  cls_2pc_reservations reservations;
+  ASSERT_EQ(0, cls_2pc_queue_list_reservations(ioctx, queue_name, reservations));
+  ASSERT_EQ(reservations.size(), 0);
+
+  const std::string marker;
+  bool truncated;
+  std::string end_marker;
+  std::vector<cls_queue_entry> entries;
+  ASSERT_EQ(0, cls_2pc_queue_list_entries(ioctx, queue_name, marker, number_of_ops*number_of_elements,
+            entries, &truncated, end_marker));
+  ASSERT_FALSE(truncated);
+  ASSERT_EQ(entries.size(), number_of_ops*number_of_elements);
+  // entries are enqueued in the order of the batch
+  ASSERT_EQ(entries.front().data.to_str(), "op-0-element-0");
+  ASSERT_EQ(entries.back().data.to_str(), "op-" + to_string(number_of_ops-1) + "-element-" + to_string(number_of_elements-1));
+}
+
 TEST_F(TestCls2PCQueue, Stats)
 {
   const std::string queue_name = __PRETTY_FUNCTION__;
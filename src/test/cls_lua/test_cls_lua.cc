@@ -818,6 +818,18 @@ TEST_F(ClsLua, RunError) {
   ASSERT_EQ(-EIO, clslua_exec(test_script, NULL, "runerr_c"));
 }
 
+TEST_F(ClsLua, CachedChunk) {
+  /* repeated runs of the same script see a fresh environment each time */
+  string script = "assert(n == nil); n = 1; "
+    "function h() return n end; objclass.register(h);";
+  for (int i = 0; i < 3; i++)
+    ASSERT_EQ(1, clslua_exec(script, NULL, "h"));
+
+  /* errors are reported the same way once the chunk is cached */
+  for (int i = 0; i < 3; i++)
+    ASSERT_EQ(-EIO, clslua_exec(test_script, NULL, "runerr_c"));
+}
+
 TEST_F(ClsLua, HandleNotFunc) {
   string script = "x = 1;";
   ASSERT_EQ(-EOPNOTSUPP, clslua_exec(script, NULL, "x"));
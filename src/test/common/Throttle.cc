@@ -165,6 +165,39 @@ TEST_F(ThrottleTest, get_or_fail) {
   }
 }
 
+TEST_F(ThrottleTest, get_put_concurrent) {
+  // get() and put() skip the lock when nobody waits; make sure a
+  // waiter is never left behind by a lockless put(), and that lockless
+  // and locked getters never push count over max together
+  int64_t throttle_max = 2;
+  Throttle throttle(g_ceph_context, "throttle", throttle_max);
+
+  std::atomic<bool> over_max = false;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; t++) {
+    threads.emplace_back([&throttle, &over_max, t] {
+      for (int i = 0; i < 10000; i++) {
+	if (t % 2 && (i % 3) == 0) {
+	  if (!throttle.get_or_fail(1)) {
+	    continue;
+	  }
+	} else {
+	  throttle.get(1);
+	}
+	if (throttle.get_current() > throttle.get_max()) {
+	  over_max = true;
+	}
+	throttle.put(1);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_FALSE(over_max);
+  ASSERT_EQ(throttle.get_current(), 0);
+}
+
 TEST_F(ThrottleTest, wait) {
   int64_t throttle_max = 10;
   Throttle throttle(g_ceph_context, "throttle");
@@ -0,0 +1,131 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include <string>
+#include "gtest/gtest.h"
+#include "kv/rocksdb_cache/BinnedLRUCache.h"
+
+using rocksdb_cache::BinnedLRUCacheShard;
+using rocksdb_cache::BinnedLRUHandle;
+
+namespace {
+
+constexpr size_t CHARGE = 10;
+
+void noop_deleter(const rocksdb::Slice&, void*) {}
+
+std::string key(unsigned i) {
+  return "k" + std::to_string(i);
+}
+
+void insert(BinnedLRUCacheShard& shard, unsigned i) {
+  ASSERT_TRUE(shard.Insert(key(i), i, nullptr, CHARGE, noop_deleter, nullptr,
+			   rocksdb::Cache::Priority::LOW).ok());
+}
+
+void hit(BinnedLRUCacheShard& shard, unsigned i) {
+  auto h = shard.Lookup(key(i), i);
+  ASSERT_NE(nullptr, h);
+  shard.Release(h);
+}
+
+// the unreferenced entry for key i, or nullptr if it is not on the LRU list
+BinnedLRUHandle* find(BinnedLRUCacheShard& shard, unsigned i) {
+  BinnedLRUHandle *lru, *lru_low_pri;
+  shard.TEST_GetLRUList(&lru, &lru_low_pri);
+  for (auto e = lru->next; e != lru; e = e->next) {
+    if (e->key() == key(i)) {
+      return e;
+    }
+  }
+  return nullptr;
+}
+
+} // anonymous namespace
+
+TEST(BinnedLRUCache, InsertIntoProbation) {
+  BinnedLRUCacheShard shard(nullptr, 100, false, 0.0, 0.5);
+  for (unsigned i = 0; i < 3; ++i) {
+    insert(shard, i);
+  }
+  for (unsigned i = 0; i < 3; ++i) {
+    auto e = find(shard, i);
+    ASSERT_NE(nullptr, e);
+    EXPECT_TRUE(e->InProbation());
+  }
+
+  // without a probation ratio the pool is a plain LRU
+  BinnedLRUCacheShard plain(nullptr, 100, false, 0.0, 0.0);
+  insert(plain, 0);
+  ASSERT_NE(nullptr, find(plain, 0));
+  EXPECT_FALSE(find(plain, 0)->InProbation());
+}
+
+TEST(BinnedLRUCache, PromoteOnSecondHit) {
+  BinnedLRUCacheShard shard(nullptr, 100, false, 0.0, 0.5);
+  insert(shard, 0);
+  insert(shard, 1);
+  hit(shard, 0);
+  ASSERT_NE(nullptr, find(shard, 0));
+  EXPECT_FALSE(find(shard, 0)->InProbation());
+  ASSERT_NE(nullptr, find(shard, 1));
+  EXPECT_TRUE(find(shard, 1)->InProbation());
+}
+
+TEST(BinnedLRUCache, EvictProbationFirst) {
+  BinnedLRUCacheShard shard(nullptr, 100, false, 0.0, 0.5);
+  // fill the protected part, then the probation segment
+  for (unsigned i = 0; i < 5; ++i) {
+    insert(shard, i);
+    hit(shard, i);
+  }
+  for (unsigned i = 5; i < 10; ++i) {
+    insert(shard, i);
+  }
+  ASSERT_EQ(100u, shard.GetUsage());
+
+  // the protected entries are older, but the scan is what gets evicted
+  for (unsigned i = 10; i < 15; ++i) {
+    insert(shard, i);
+  }
+  for (unsigned i = 0; i < 5; ++i) {
+    auto e = find(shard, i);
+    ASSERT_NE(nullptr, e);
+    EXPECT_FALSE(e->InProbation());
+  }
+  for (unsigned i = 5; i < 10; ++i) {
+    EXPECT_EQ(nullptr, find(shard, i));
+  }
+  for (unsigned i = 10; i < 15; ++i) {
+    EXPECT_NE(nullptr, find(shard, i));
+  }
+  EXPECT_EQ(100u, shard.GetUsage());
+}
+
+TEST(BinnedLRUCache, ShrinkDemotesToProbation) {
+  BinnedLRUCacheShard shard(nullptr, 100, false, 0.0, 0.5);
+  for (unsigned i = 0; i < 5; ++i) {
+    insert(shard, i);
+    hit(shard, i);
+  }
+  for (unsigned i = 0; i < 5; ++i) {
+    EXPECT_FALSE(find(shard, i)->InProbation());
+  }
+
+  // 60 bytes leave room for 30 protected ones: the two coldest protected
+  // entries move to probation, nothing is evicted
+  shard.SetCapacity(60);
+  EXPECT_EQ(50u, shard.GetUsage());
+  for (unsigned i = 0; i < 5; ++i) {
+    auto e = find(shard, i);
+    ASSERT_NE(nullptr, e);
+    EXPECT_EQ(i < 2, e->InProbation()) << key(i);
+  }
+
+  // and they are the first to go
+  insert(shard, 5);
+  insert(shard, 6);
+  EXPECT_EQ(nullptr, find(shard, 0));
+  EXPECT_NE(nullptr, find(shard, 1));
+  EXPECT_NE(nullptr, find(shard, 2));
+}
@@ -4,6 +4,8 @@
 #include "gtest/gtest.h"
 #include "common/numa.h"
 
+#include <set>
+
 TEST(cpu_set, parse_list) {
   cpu_set_t cpu_set;
   size_t size;
@@ -70,3 +72,19 @@ TEST(cpu_set, round_trip_list)
   }
 }
 
+
+TEST(numa, get_numa_nodes)
+{
+  std::set<int> nodes;
+  int r = get_numa_nodes(&nodes);
+  if (r == -ENOENT || r == -ENOTSUP) {
+    GTEST_SKIP() << "no numa node information";
+  }
+  ASSERT_EQ(0, r);
+  ASSERT_FALSE(nodes.empty());
+  for (auto node : nodes) {
+    size_t size;
+    cpu_set_t cpu_set;
+    ASSERT_EQ(0, get_numa_node_cpu_set(node, &size, &cpu_set));
+  }
+}
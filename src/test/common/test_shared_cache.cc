@@ -395,6 +395,41 @@ TEST(SharedCache_all, lru) {
   ASSERT_TRUE(cache.lookup(0).get());
 }
 
+TEST(SharedCache_all, max_bytes) {
+  const size_t SIZE = 10;
+  SharedLRU<int, int> cache(NULL, SIZE);
+  cache.set_max_bytes(100);
+
+  for (int i = 0; i < 4; ++i) {
+    cache.add(i, new int(i));
+    cache.set_charge(i, 30);
+  }
+  // 4 * 30 > 100: the oldest entry goes
+  ASSERT_EQ(3, cache.get_count());
+  ASSERT_EQ(90u, cache.get_bytes());
+  ASSERT_FALSE(cache.lookup(0));
+  ASSERT_TRUE(cache.lookup(1).get());
+
+  // a single entry larger than the budget is kept alone
+  cache.add(10, new int(10));
+  cache.set_charge(10, 200);
+  ASSERT_EQ(1, cache.get_count());
+  ASSERT_EQ(200u, cache.get_bytes());
+  ASSERT_TRUE(cache.lookup(10).get());
+
+  cache.set_charge(10, 50);
+  ASSERT_EQ(50u, cache.get_bytes());
+  cache.purge(10);
+  ASSERT_EQ(0u, cache.get_bytes());
+
+  // uncharged entries are limited by count only
+  cache.set_max_bytes(0);
+  for (size_t i = 0; i < 2 * SIZE; ++i) {
+    cache.add(100 + i, new int(i));
+  }
+  ASSERT_EQ((int)SIZE, cache.get_count());
+}
+
 // Local Variables:
 // compile-command: "cd ../.. ; make unittest_shared_cache && ./unittest_shared_cache # --gtest_filter=*.* --log-to-stderr=true"
 // End:
@@ -186,6 +186,26 @@ TEST_P(IndepTest, basic) {
   }
 }
 
+TEST_P(IndepTest, do_rule_many) {
+  std::unique_ptr<CrushWrapper> c(build_indep_map(cct, 3, 3, 3));
+  vector<__u32> weight(c->get_max_devices(), 0x10000);
+  weight[1] = 0;
+  weight[5] = 0x8000;
+
+  vector<int> xs;
+  for (int x = 0; x < 1000; ++x) {
+    xs.push_back(x % 300);
+  }
+  vector<vector<int>> outs;
+  c->do_rule_many(0, xs, outs, 5, weight, 0);
+  ASSERT_EQ(xs.size(), outs.size());
+  for (unsigned i = 0; i < xs.size(); ++i) {
+    vector<int> out;
+    c->do_rule(0, xs[i], out, 5, weight, 0);
+    ASSERT_EQ(out, outs[i]);
+  }
+}
+
 TEST_P(IndepTest, single_out_first) {
   std::unique_ptr<CrushWrapper> c(build_indep_map(cct, 3, 3, 3));
   c->dump_tree(&cout, nullptr);
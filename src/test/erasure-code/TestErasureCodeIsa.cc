@@ -368,6 +368,46 @@ TEST_F(IsaErasureCodeTest, encode)
   }
 }
 
+TEST_F(IsaErasureCodeTest, multi_stripe_encode)
+{
+  ErasureCodeIsaDefault Isa(tcache);
+  ErasureCodeProfile profile;
+  profile["k"] = "3";
+  profile["m"] = "2";
+  Isa.init(profile, &cerr);
+  EXPECT_TRUE(Isa.get_supported_optimizations() &
+	      ErasureCodeInterface::FLAG_EC_PLUGIN_MULTI_STRIPE_OPTIMIZATION);
+
+  unsigned chunk_size = Isa.get_chunk_size(4096);
+  set<int> want_to_encode = { 0, 1, 2, 3, 4 };
+  map<int, bufferlist> stripes[2];
+  for (unsigned s = 0; s < 2; s++) {
+    bufferlist in;
+    for (unsigned i = 0; i < chunk_size * 3; i++)
+      in.append((char)(i * (s + 3)));
+    ASSERT_EQ(0, Isa.encode(want_to_encode, in, &stripes[s]));
+  }
+
+  // encoding the concatenated chunks of both stripes at once gives the
+  // concatenated coding chunks
+  map<int, bufferlist> encoded;
+  for (int i = 0; i < 5; i++) {
+    bufferptr buf(buffer::create_page_aligned(chunk_size * 2));
+    if (i < 3) {
+      memcpy(buf.c_str(), stripes[0][i].c_str(), chunk_size);
+      memcpy(buf.c_str() + chunk_size, stripes[1][i].c_str(), chunk_size);
+    }
+    encoded[i].push_back(std::move(buf));
+  }
+  ASSERT_EQ(0, Isa.encode_chunks(want_to_encode, &encoded));
+  for (int i = 3; i < 5; i++) {
+    bufferlist expected;
+    expected.append(stripes[0][i]);
+    expected.append(stripes[1][i]);
+    EXPECT_TRUE(expected.contents_equal(encoded[i]));
+  }
+}
+
 TEST_F(IsaErasureCodeTest, sanity_check_k)
 {
   ErasureCodeIsaDefault Isa(tcache);
@@ -9,6 +9,8 @@
 #include "exporter/util.h"
 #include "exporter/DaemonMetricCollector.h"
 
+#include <boost/json/parse.hpp>
+
 #include <regex>
 #include <string>
 #include <vector>
@@ -760,3 +762,40 @@ TEST(Exporter, add_fixed_name_metrics) {
     EXPECT_EQ(new_metric.first, expected_labels);
     ASSERT_TRUE(new_metric.second == expected_metric_name);
 }
+
+TEST(Exporter, counter_schema_matches) {
+  auto schema = boost::json::parse(R"({
+    "osd": [{"labels": {}, "counters": {
+      "op_r": {"type": 10, "priority": 8},
+      "op_w": {"type": 10, "priority": 8}}}],
+    "rgw_op": [{"labels": {"bucket": "b1"}, "counters": {
+      "put_obj_ops": {"type": 10, "priority": 5}}}]
+  })").as_object();
+  auto dump = boost::json::parse(R"({
+    "osd": [{"labels": {}, "counters": {"op_r": 1, "op_w": 2}}],
+    "rgw_op": [{"labels": {"bucket": "b1"}, "counters": {"put_obj_ops": 3}}]
+  })").as_object();
+  ASSERT_TRUE(counter_schema_matches(dump, schema));
+
+  // a new labeled instance appeared
+  auto grown = boost::json::parse(R"({
+    "osd": [{"labels": {}, "counters": {"op_r": 1, "op_w": 2}}],
+    "rgw_op": [{"labels": {"bucket": "b1"}, "counters": {"put_obj_ops": 3}},
+               {"labels": {"bucket": "b2"}, "counters": {"put_obj_ops": 4}}]
+  })").as_object();
+  ASSERT_FALSE(counter_schema_matches(grown, schema));
+
+  // same shape but a different label value
+  auto relabeled = boost::json::parse(R"({
+    "osd": [{"labels": {}, "counters": {"op_r": 1, "op_w": 2}}],
+    "rgw_op": [{"labels": {"bucket": "b2"}, "counters": {"put_obj_ops": 3}}]
+  })").as_object();
+  ASSERT_FALSE(counter_schema_matches(relabeled, schema));
+
+  // a counter was renamed
+  auto renamed = boost::json::parse(R"({
+    "osd": [{"labels": {}, "counters": {"op_r": 1, "op_rw": 2}}],
+    "rgw_op": [{"labels": {"bucket": "b1"}, "counters": {"put_obj_ops": 3}}]
+  })").as_object();
+  ASSERT_FALSE(counter_schema_matches(renamed, schema));
+}
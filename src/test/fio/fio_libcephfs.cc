@@ -0,0 +1,367 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "include/cephfs/libcephfs.h"
+
+/* naughty fio.h leaks min and max as C macros--include it last */
+#include <fio.h>
+#include <optgroup.h>
+#undef min
+#undef max
+
+namespace {
+
+  /* per io_u request, handed to ceph_ll_io_submit() */
+  struct libcephfs_iou {
+    struct ceph_ll_io_info info;
+    struct iovec iov;
+  };
+
+  struct libcephfs_file {
+    Inode* in = nullptr;
+    Fh* fh = nullptr;
+  };
+
+  struct libcephfs_data {
+    struct ceph_mount_info* cmount = nullptr;
+    struct ceph_ll_io_queue* queue = nullptr;
+    Inode* root = nullptr;
+    UserPerm* perms = nullptr;
+
+    /* queued by ->queue(), submitted as one batch by ->commit() */
+    std::vector<ceph_ll_io_info*> pending;
+    /* reaped by ->getevents(), handed out by ->event() */
+    std::vector<ceph_ll_io_info*> events;
+
+    explicit libcephfs_data(thread_data* td)
+      : events(td->o.iodepth)
+      {
+	pending.reserve(td->o.iodepth);
+      }
+  };
+
+  struct opt_struct {
+    struct thread_data *td;
+
+    const char* config;
+    const char* client_id;
+    const char* init_args;
+    const char* root;
+  };
+
+/* borrowed from fio_ceph_objectstore */
+  template <class F>
+  fio_option make_option(F&& func)
+  {
+    // zero-initialize and set common defaults
+    auto o = fio_option{};
+    o.category = FIO_OPT_C_ENGINE;
+    o.group    = FIO_OPT_G_INVALID;
+    func(std::ref(o));
+    return o;
+  }
+
+  static std::vector<fio_option> options = {
+    make_option([] (fio_option& o) {
+		  o.name   = "ceph_conf";
+		  o.lname  = "ceph configuration file";
+		  o.type   = FIO_OPT_STR_STORE;
+		  o.help   = "Path to ceph.conf file";
+		  o.off1   = offsetof(opt_struct, config);
+		}),
+    make_option([] (fio_option& o) {
+		  o.name   = "ceph_client_id";
+		  o.lname  = "ceph client id";
+		  o.type   = FIO_OPT_STR_STORE;
+		  o.help   = "Client id to mount as, e.g. admin (default=admin)";
+		  o.off1   = offsetof(opt_struct, client_id);
+		}),
+    make_option([] (fio_option& o) {
+		  o.name   = "ceph_init_args";
+		  o.lname  = "ceph init args";
+		  o.type   = FIO_OPT_STR_STORE;
+		  o.help   = "Extra ceph arguments (e.g., --client_mds_namespace=a)";
+		  o.off1   = offsetof(opt_struct, init_args);
+		}),
+    make_option([] (fio_option& o) {
+		  o.name   = "cephfs_root";
+		  o.lname  = "cephfs mount root";
+		  o.type   = FIO_OPT_STR_STORE;
+		  o.help   = "Directory of the file system to mount (default=/)";
+		  o.off1   = offsetof(opt_struct, root);
+		}),
+    {} // fio expects a 'null'-terminated list
+  };
+
+/*
+ * Called once per job before the threads are started.  Like the other
+ * diskless engines we size the files ourselves.
+ */
+  static int fio_libcephfs_setup(struct thread_data* td)
+  {
+    dprint(FD_IO, "fio_libcephfs_setup\n");
+
+    const uint64_t file_size = td->o.size / std::max(1u, td->o.nr_files);
+    for (uint32_t i = 0; i < td->o.nr_files; i++) {
+      td->files[i]->real_file_size = file_size;
+    }
+    td->o.use_thread = 1;
+    return 0;
+  }
+
+/*
+ * Each job thread gets its own mount and completion queue, so jobs don't
+ * contend on a shared client.
+ */
+  static int fio_libcephfs_init(struct thread_data *td)
+  {
+    opt_struct& o = *(reinterpret_cast<opt_struct*>(td->eo));
+    auto data = new libcephfs_data(td);
+    int r;
+
+    dprint(FD_IO, "fio_libcephfs_init\n");
+
+    r = ceph_create(&data->cmount, o.client_id);
+    if (r < 0) {
+      log_err("ceph_create failed: %d\n", r);
+      goto out_free;
+    }
+    r = ceph_conf_read_file(data->cmount, o.config);
+    if (r < 0) {
+      log_err("ceph_conf_read_file failed: %d\n", r);
+      goto out_release;
+    }
+    if (o.init_args) {
+      std::istringstream is(o.init_args);
+      std::vector<std::string> args{std::istream_iterator<std::string>(is),
+				    std::istream_iterator<std::string>()};
+      std::vector<const char*> argv{"fio"}; // argv[0] is skipped
+      for (auto& a : args) {
+	argv.push_back(a.c_str());
+      }
+      r = ceph_conf_parse_argv(data->cmount, argv.size(), argv.data());
+      if (r < 0) {
+	log_err("parsing ceph_init_args failed: %d\n", r);
+	goto out_release;
+      }
+    }
+    r = ceph_mount(data->cmount, o.root ? o.root : "/");
+    if (r < 0) {
+      log_err("ceph_mount failed: %d\n", r);
+      goto out_release;
+    }
+    r = ceph_ll_lookup_root(data->cmount, &data->root);
+    if (r < 0) {
+      log_err("ceph_ll_lookup_root failed: %d\n", r);
+      goto out_unmount;
+    }
+    r = ceph_ll_io_queue_create(data->cmount, &data->queue);
+    if (r < 0) {
+      log_err("ceph_ll_io_queue_create failed: %d\n", r);
+      goto out_put_root;
+    }
+    data->perms = ceph_mount_perms(data->cmount);
+    td->io_ops_data = data;
+    return 0;
+
+  out_put_root:
+    ceph_ll_put(data->cmount, data->root);
+  out_unmount:
+    ceph_unmount(data->cmount);
+  out_release:
+    ceph_release(data->cmount);
+  out_free:
+    delete data;
+    return r;
+  }
+
+  static void fio_libcephfs_cleanup(struct thread_data *td)
+  {
+    dprint(FD_IO, "fio_libcephfs_cleanup\n");
+
+    libcephfs_data* data = static_cast<libcephfs_data*>(td->io_ops_data);
+    if (data) {
+      ceph_ll_io_queue_destroy(data->cmount, data->queue);
+      ceph_ll_put(data->cmount, data->root);
+      ceph_unmount(data->cmount);
+      ceph_release(data->cmount);
+      td->io_ops_data = nullptr;
+      delete data;
+    }
+  }
+
+  static int fio_libcephfs_open(struct thread_data *td, struct fio_file *f)
+  {
+    libcephfs_data* data = static_cast<libcephfs_data*>(td->io_ops_data);
+    int flags = td_write(td) ? O_RDWR | O_CREAT : O_RDONLY;
+    auto file = new libcephfs_file;
+
+    int r = ceph_ll_create(data->cmount, data->root, f->file_name, 0644,
+			   flags, &file->in, &file->fh, nullptr, 0, 0,
+			   data->perms);
+    if (r < 0) {
+      log_err("ceph_ll_create of %s failed: %d\n", f->file_name, r);
+      delete file;
+      return r;
+    }
+    f->engine_data = file;
+    return 0;
+  }
+
+  static int fio_libcephfs_close(struct thread_data *td, struct fio_file *f)
+  {
+    libcephfs_data* data = static_cast<libcephfs_data*>(td->io_ops_data);
+    auto file = static_cast<libcephfs_file*>(f->engine_data);
+    if (file) {
+      ceph_ll_close(data->cmount, file->fh);
+      ceph_ll_put(data->cmount, file->in);
+      f->engine_data = nullptr;
+      delete file;
+    }
+    return 0;
+  }
+
+  static struct io_u *fio_libcephfs_event(struct thread_data *td, int event)
+  {
+    libcephfs_data* data = static_cast<libcephfs_data*>(td->io_ops_data);
+    return static_cast<io_u*>(data->events[event]->priv);
+  }
+
+  static int fio_libcephfs_getevents(struct thread_data *td, unsigned int min,
+				     unsigned int max, const struct timespec *t)
+  {
+    libcephfs_data* data = static_cast<libcephfs_data*>(td->io_ops_data);
+    int64_t timeout_ms = -1;
+    if (t) {
+      timeout_ms = t->tv_sec * 1000 + t->tv_nsec / 1000000;
+    }
+
+    int r = ceph_ll_io_getevents(data->cmount, data->queue, min, max,
+				 data->events.data(), timeout_ms);
+    for (int i = 0; i < r; i++) {
+      auto info = data->events[i];
+      auto u = static_cast<io_u*>(info->priv);
+      if (info->result < 0) {
+	u->error = -info->result;
+      } else {
+	u->resid = u->xfer_buflen - info->result;
+      }
+    }
+    return r;
+  }
+
+  static enum fio_q_status fio_libcephfs_queue(struct thread_data *td,
+					       struct io_u *io_u)
+  {
+    libcephfs_data* data = static_cast<libcephfs_data*>(td->io_ops_data);
+    auto file = static_cast<libcephfs_file*>(io_u->file->engine_data);
+    auto iou = static_cast<libcephfs_iou*>(io_u->engine_data);
+
+    fio_ro_check(td, io_u);
+
+    if (io_u->ddir == DDIR_SYNC || io_u->ddir == DDIR_DATASYNC) {
+      int r = ceph_ll_fsync(data->cmount, file->fh,
+			    io_u->ddir == DDIR_DATASYNC);
+      if (r < 0) {
+	io_u->error = -r;
+      }
+      return FIO_Q_COMPLETED;
+    }
+    if (io_u->ddir != DDIR_READ && io_u->ddir != DDIR_WRITE) {
+      io_u->error = EINVAL;
+      return FIO_Q_COMPLETED;
+    }
+
+    iou->iov.iov_base = io_u->xfer_buf;
+    iou->iov.iov_len = io_u->xfer_buflen;
+    iou->info = {};
+    iou->info.priv = io_u;
+    iou->info.fh = file->fh;
+    iou->info.iov = &iou->iov;
+    iou->info.iovcnt = 1;
+    iou->info.off = io_u->offset;
+    iou->info.write = (io_u->ddir == DDIR_WRITE);
+    data->pending.push_back(&iou->info);
+    return FIO_Q_QUEUED;
+  }
+
+/*
+ * Everything queued since the last commit goes to the client in a single
+ * ceph_ll_io_submit() call.
+ */
+  static int fio_libcephfs_commit(struct thread_data *td)
+  {
+    libcephfs_data* data = static_cast<libcephfs_data*>(td->io_ops_data);
+    if (data->pending.empty()) {
+      return 0;
+    }
+    int r = ceph_ll_io_submit(data->cmount, data->queue, data->pending.data(),
+			      data->pending.size());
+    data->pending.clear();
+    return r < 0 ? r : 0;
+  }
+
+  static int fio_libcephfs_io_u_init(struct thread_data *td, struct io_u *u)
+  {
+    u->engine_data = new libcephfs_iou;
+    return 0;
+  }
+
+  static void fio_libcephfs_io_u_free(struct thread_data *td, struct io_u *u)
+  {
+    delete static_cast<libcephfs_iou*>(u->engine_data);
+    u->engine_data = nullptr;
+  }
+
+  struct libcephfs_ioengine : public ioengine_ops
+  {
+    libcephfs_ioengine() : ioengine_ops({}) {
+      name        = "libcephfs";
+      version     = FIO_IOOPS_VERSION;
+      flags       = FIO_DISKLESSIO;
+      setup       = fio_libcephfs_setup;
+      init        = fio_libcephfs_init;
+      queue       = fio_libcephfs_queue;
+      commit      = fio_libcephfs_commit;
+      getevents   = fio_libcephfs_getevents;
+      event       = fio_libcephfs_event;
+      cleanup     = fio_libcephfs_cleanup;
+      open_file   = fio_libcephfs_open;
+      close_file  = fio_libcephfs_close;
+      io_u_init   = fio_libcephfs_io_u_init;
+      io_u_free   = fio_libcephfs_io_u_free;
+      options     = ::options.data();
+      option_struct_size = sizeof(opt_struct);
+    }
+  };
+
+} // namespace
+
+extern "C" {
+// the exported fio engine interface
+  void get_ioengine(struct ioengine_ops** ioengine_ptr) {
+    static libcephfs_ioengine ioengine;
+    *ioengine_ptr = &ioengine;
+  }
+} // extern "C"
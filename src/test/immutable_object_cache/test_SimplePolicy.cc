@@ -97,6 +97,20 @@ TEST_F(TestSimplePolicy, test_lookup_miss_and_have_free) {
   ASSERT_TRUE(m_simple_policy->get_status("miss_but_have_free_space_file_name") == OBJ_CACHE_SKIP);
 }
 
+TEST_F(TestSimplePolicy, test_lookup_miss_below_promote_threshold) {
+  SimplePolicy policy(g_ceph_context, m_cache_size, 128, 0.9, 3);
+  std::string file_name = "read_three_times_file_name";
+  ASSERT_EQ(OBJ_CACHE_SKIP, policy.lookup_object(file_name));
+  ASSERT_EQ(OBJ_CACHE_NONE, policy.get_status(file_name));
+  ASSERT_EQ(OBJ_CACHE_SKIP, policy.lookup_object(file_name));
+  ASSERT_EQ(OBJ_CACHE_NONE, policy.get_status(file_name));
+
+  // third read starts the promotion
+  ASSERT_EQ(OBJ_CACHE_NONE, policy.lookup_object(file_name));
+  ASSERT_EQ(OBJ_CACHE_SKIP, policy.get_status(file_name));
+  policy.update_status(file_name, OBJ_CACHE_NONE);
+}
+
 TEST_F(TestSimplePolicy, test_lookup_hit_and_promoting) {
   ASSERT_TRUE(m_cache_size - m_promoted_lru.size() == m_simple_policy->get_free_size());
   insert_entry_into_promoting_lru("promoting_file_1");
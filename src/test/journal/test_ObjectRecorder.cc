@@ -271,6 +271,47 @@ TEST_F(TestObjectRecorder, AppendFlushByAge) {
   ASSERT_EQ(0U, object->get_pending_appends());
 }
 
+TEST_F(TestObjectRecorder, AppendAdaptiveLatencyTarget) {
+  std::string oid = get_temp_oid();
+  ASSERT_EQ(0, create(oid));
+  ASSERT_EQ(0, client_register(oid));
+  auto metadata = create_metadata(oid);
+  ASSERT_EQ(0, init_metadata(metadata));
+
+  ceph::mutex lock = ceph::make_mutex("object_recorder_lock");
+  ObjectRecorderFlusher flusher(m_ioctx, m_work_queue);
+  auto object = flusher.create_object(oid, 24, &lock);
+  lock.lock();
+  object->set_append_latency_target(10);
+  lock.unlock();
+
+  // idle object recorder should not hold back the append for batching
+  journal::AppendBuffer append_buffer1 = create_append_buffer(234, 123,
+                                                              "payload");
+  journal::AppendBuffers append_buffers;
+  append_buffers = {append_buffer1};
+  lock.lock();
+  ASSERT_FALSE(object->append(std::move(append_buffers)));
+  lock.unlock();
+  ASSERT_EQ(0U, object->get_pending_appends());
+
+  C_SaferCond cond;
+  append_buffer1.first->wait(&cond);
+  ASSERT_EQ(0, cond.wait());
+
+  journal::AppendBuffer append_buffer2 = create_append_buffer(234, 124,
+                                                              "payload");
+  append_buffers = {append_buffer2};
+  lock.lock();
+  ASSERT_FALSE(object->append(std::move(append_buffers)));
+  lock.unlock();
+  ASSERT_EQ(0U, object->get_pending_appends());
+
+  C_SaferCond cond2;
+  append_buffer2.first->wait(&cond2);
+  ASSERT_EQ(0, cond2.wait());
+}
+
 TEST_F(TestObjectRecorder, AppendFilledObject) {
   std::string oid = get_temp_oid();
   ASSERT_EQ(0, create(oid));
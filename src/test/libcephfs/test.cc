@@ -1293,6 +1293,79 @@ TEST(LibCephFS, LlreadvLlwritev) {
   ceph_shutdown(cmount);
 }
 
+TEST(LibCephFS, LlIoSubmitGetevents) {
+  struct ceph_mount_info *cmount;
+  ASSERT_EQ(ceph_create(&cmount, NULL), 0);
+  ASSERT_EQ(ceph_conf_read_file(cmount, NULL), 0);
+  ASSERT_EQ(0, ceph_conf_parse_env(cmount, NULL));
+  ASSERT_EQ(ceph_mount(cmount, NULL), 0);
+
+  int mypid = getpid();
+  char filename[256];
+
+  sprintf(filename, "test_lliosubmitfile%u", mypid);
+
+  Inode *root, *file;
+  ASSERT_EQ(ceph_ll_lookup_root(cmount, &root), 0);
+
+  Fh *fh;
+  struct ceph_statx stx;
+  UserPerm *perms = ceph_mount_perms(cmount);
+
+  ASSERT_EQ(ceph_ll_create(cmount, root, filename, 0666,
+		    O_RDWR|O_CREAT|O_TRUNC, &file, &fh, &stx, 0, 0, perms), 0);
+
+  struct ceph_ll_io_queue *queue;
+  ASSERT_EQ(ceph_ll_io_queue_create(cmount, &queue), 0);
+
+  char out0[] = "hello ";
+  char out1[] = "world\n";
+  struct iovec iov_out[2] = {
+	{out0, sizeof(out0)},
+	{out1, sizeof(out1)},
+  };
+  struct ceph_ll_io_info writes[2] = {};
+  struct ceph_ll_io_info *ios[2];
+  for (int i = 0; i < 2; i++) {
+    writes[i].fh = fh;
+    writes[i].iov = &iov_out[i];
+    writes[i].iovcnt = 1;
+    writes[i].off = i == 0 ? 0 : sizeof(out0);
+    writes[i].write = true;
+    ios[i] = &writes[i];
+  }
+  ASSERT_EQ(ceph_ll_io_submit(cmount, queue, ios, 2), 2);
+  // queue still owns unreaped completions
+  ASSERT_EQ(ceph_ll_io_queue_destroy(cmount, queue), -CEPHFS_EBUSY);
+
+  struct ceph_ll_io_info *events[2];
+  ASSERT_EQ(ceph_ll_io_getevents(cmount, queue, 2, 2, events, -1), 2);
+  for (int i = 0; i < 2; i++)
+    ASSERT_EQ(events[i]->result, (int64_t)events[i]->iov->iov_len);
+
+  char in[sizeof(out0) + sizeof(out1)];
+  struct iovec iov_in = {in, sizeof(in)};
+  struct ceph_ll_io_info read = {};
+  read.fh = fh;
+  read.iov = &iov_in;
+  read.iovcnt = 1;
+  read.off = 0;
+  ios[0] = &read;
+  ASSERT_EQ(ceph_ll_io_submit(cmount, queue, ios, 1), 1);
+  ASSERT_EQ(ceph_ll_io_getevents(cmount, queue, 1, 2, events, -1), 1);
+  ASSERT_EQ(events[0], &read);
+  ASSERT_EQ(read.result, (int64_t)sizeof(in));
+  ASSERT_EQ(0, memcmp(in, out0, sizeof(out0)));
+  ASSERT_EQ(0, memcmp(in + sizeof(out0), out1, sizeof(out1)));
+
+  // nothing left to reap
+  ASSERT_EQ(ceph_ll_io_getevents(cmount, queue, 0, 2, events, 0), 0);
+  ASSERT_EQ(ceph_ll_io_queue_destroy(cmount, queue), 0);
+
+  ceph_ll_close(cmount, fh);
+  ceph_shutdown(cmount);
+}
+
 TEST(LibCephFS, StripeUnitGran) {
   struct ceph_mount_info *cmount;
   ASSERT_EQ(ceph_create(&cmount, NULL), 0);
@@ -686,6 +686,56 @@ TEST_F(TestMockJournalReplay, PauseIO) {
   ASSERT_EQ(0, when_shut_down(mock_journal_replay, false));
 }
 
+TEST_F(TestMockJournalReplay, PauseIOMaxInFlight) {
+  REQUIRE_FEATURE(RBD_FEATURE_JOURNALING);
+
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+  ASSERT_EQ(0, ictx->config.set_val("rbd_journal_replay_max_in_flight_ios",
+                                    "8"));
+
+  MockReplayImageCtx mock_image_ctx(*ictx);
+
+  MockExclusiveLock mock_exclusive_lock;
+  mock_image_ctx.exclusive_lock = &mock_exclusive_lock;
+  expect_accept_ops(mock_exclusive_lock, true);
+
+  MockJournalReplay mock_journal_replay(mock_image_ctx);
+  MockIoImageRequest mock_io_image_request;
+  expect_op_work_queue(mock_image_ctx);
+
+  InSequence seq;
+  const size_t io_count = 8;
+  std::list<io::AioCompletion *> flush_comps;
+  C_SaferCond on_safes[io_count];
+  for (size_t i = 0; i < io_count; ++i) {
+    io::AioCompletion *aio_comp;
+    C_SaferCond on_ready;
+    expect_aio_write(mock_io_image_request, &aio_comp, 123, 456, "test");
+    if ((i + 1) % 4 == 0) {
+      flush_comps.push_back(nullptr);
+      expect_aio_flush(mock_io_image_request, &flush_comps.back());
+    }
+    when_process(mock_journal_replay,
+                 EventEntry{AioWriteEvent(123, 456, to_bl("test"))},
+                 &on_ready, &on_safes[i]);
+    when_complete(mock_image_ctx, aio_comp, 0);
+    if (i < io_count - 1) {
+      ASSERT_EQ(0, on_ready.wait());
+    } else {
+      for (auto flush_comp : flush_comps) {
+        when_complete(mock_image_ctx, flush_comp, 0);
+      }
+      ASSERT_EQ(0, on_ready.wait());
+    }
+  }
+  for (auto &on_safe : on_safes) {
+    ASSERT_EQ(0, on_safe.wait());
+  }
+
+  ASSERT_EQ(0, when_shut_down(mock_journal_replay, false));
+}
+
 TEST_F(TestMockJournalReplay, Flush) {
   REQUIRE_FEATURE(RBD_FEATURE_JOURNALING);
 
@@ -10877,6 +10877,53 @@ TEST_F(TestLibRBD, ImagePollIO)
 #endif
 }
 
+TEST_F(TestLibRBD, ImagePollIONoFd)
+{
+  rados_ioctx_t ioctx;
+  rados_ioctx_create(_cluster, m_pool_name.c_str(), &ioctx);
+
+  rbd_image_t image;
+  int order = 0;
+  std::string name = get_temp_image_name();
+  uint64_t size = 2 << 20;
+
+  ASSERT_EQ(0, create_image(ioctx, name.c_str(), size, &order));
+  ASSERT_EQ(0, rbd_open(ioctx, name.c_str(), &image, NULL));
+
+  ASSERT_EQ(0, rbd_set_image_notification(image, -1, EVENT_TYPE_POLL));
+
+  char test_data[TEST_IO_SIZE];
+  for (int i = 0; i < TEST_IO_SIZE; ++i)
+    test_data[i] = (char) (rand() % (126 - 33) + 33);
+
+  const int num_ios = 8;
+  for (int i = 0; i < num_ios; ++i) {
+    rbd_completion_t comp;
+    ASSERT_EQ(0, rbd_aio_create_completion(NULL, NULL, &comp));
+    ASSERT_EQ(0, rbd_aio_write(image, TEST_IO_SIZE * i, TEST_IO_SIZE,
+                               test_data, comp));
+  }
+
+  // reap everything from this thread without waiting on a descriptor
+  int reaped = 0;
+  while (reaped < num_ios) {
+    rbd_completion_t comps[num_ios];
+    int r = rbd_poll_io_events(image, comps, num_ios);
+    ASSERT_LE(0, r);
+    for (int i = 0; i < r; ++i) {
+      rbd_aio_wait_for_complete(comps[i]);
+      ASSERT_EQ(0, rbd_aio_get_return_value(comps[i]));
+      rbd_aio_release(comps[i]);
+    }
+    reaped += r;
+    if (r == 0)
+      usleep(1000);
+  }
+
+  ASSERT_EQ(0, rbd_close(image));
+  rados_ioctx_destroy(ioctx);
+}
+
 namespace librbd {
 
 static bool operator==(const image_spec_t &lhs, const image_spec_t &rhs) {
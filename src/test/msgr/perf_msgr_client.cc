@@ -16,6 +16,7 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <string>
 #include <unistd.h>
 #include <iostream>
@@ -118,9 +119,11 @@ class MessengerClient {
   DummyAuthClientServer dummy_auth;
 
  public:
-  MessengerClient(const string &t, const string &addr, int delay):
+  MessengerClient(const string &t, const string &addr, int delay,
+		  uint32_t con_mode):
       type(t), serveraddr(addr), think_time_us(delay),
       dummy_auth(g_ceph_context) {
+    dummy_auth.preferred_mode = con_mode;
   }
   ~MessengerClient() {
     for (uint64_t i = 0; i < clients.size(); ++i)
@@ -166,13 +169,16 @@ void MessengerClient::ClientDispatcher::ms_fast_dispatch(Message *m) {
 
 
 void usage(const string &name) {
-  cout << "Usage: " << name << " [server ip:port] [numjobs] [concurrency] [ios] [thinktime us] [msg length]" << std::endl;
+  cout << "Usage: " << name << " [server ip:port] [numjobs] [concurrency] [ios] [thinktime us] [msg length] [mode]" << std::endl;
   cout << "       [server ip:port]: connect to the ip:port pair" << std::endl;
   cout << "       [numjobs]: how much client threads spawned and do benchmark" << std::endl;
   cout << "       [concurrency]: the max inflight messages(like iodepth in fio)" << std::endl;
   cout << "       [ios]: how much messages sent for each client" << std::endl;
   cout << "       [thinktime]: sleep time when do fast dispatching(match client logic)" << std::endl;
   cout << "       [msg length]: message data bytes" << std::endl;
+  cout << "       [mode]: on-wire mode, crc (default) or secure" << std::endl;
+  cout << "       small message coalescing is tuned with --ms_async_coalesce_bytes" << std::endl;
+  cout << "       and --ms_async_coalesce_delay_us" << std::endl;
 }
 
 int main(int argc, char **argv)
@@ -195,6 +201,15 @@ int main(int argc, char **argv)
   int ios = atoi(args[3]);
   int think_time = atoi(args[4]);
   int len = atoi(args[5]);
+  uint32_t con_mode = CEPH_CON_MODE_CRC;
+  if (args.size() > 6) {
+    if (strcmp(args[6], "secure") == 0) {
+      con_mode = CEPH_CON_MODE_SECURE;
+    } else if (strcmp(args[6], "crc") != 0) {
+      usage(argv[0]);
+      return 1;
+    }
+  }
 
   std::string public_msgr_type = g_ceph_context->_conf->ms_public_type.empty() ? g_ceph_context->_conf.get_val<std::string>("ms_type") : g_ceph_context->_conf->ms_public_type;
 
@@ -205,8 +220,11 @@ int main(int argc, char **argv)
   cout << "       ios " << ios << std::endl;
   cout << "       thinktime(us) " << think_time << std::endl;
   cout << "       message data bytes " << len << std::endl;
+  cout << "       mode " << ceph_con_mode_name(con_mode) << std::endl;
+  cout << "       coalesce bytes " << g_ceph_context->_conf->ms_async_coalesce_bytes
+       << " delay(us) " << g_ceph_context->_conf->ms_async_coalesce_delay_us << std::endl;
 
-  MessengerClient client(public_msgr_type, args[0], think_time);
+  MessengerClient client(public_msgr_type, args[0], think_time, con_mode);
 
   client.ready(concurrent, numjobs, ios, len);
   Cycles::init();
@@ -19,6 +19,7 @@
 #include <list>
 #include <memory>
 #include <set>
+#include <thread>
 #include <stdlib.h>
 #include <time.h>
 #include <unistd.h>
@@ -976,6 +977,111 @@ TEST_P(MessengerTest, SimpleTest) {
   server_msgr->wait();
 }
 
+class DataBufferDispatcher : public FakeDispatcher {
+ public:
+  std::atomic<const char*> supplied = {nullptr};
+  std::atomic<const char*> received = {nullptr};
+  std::atomic<unsigned> data_off = {0};
+
+  DataBufferDispatcher() : FakeDispatcher(true) {}
+  bool ms_get_data_buffer(Connection *con,
+                          const ceph_msg_header2 &header,
+                          uint32_t len,
+                          bufferptr *bp) override {
+    data_off = header.data_off;
+    *bp = buffer::create_page_aligned(len);
+    supplied = bp->c_str();
+    return true;
+  }
+  void ms_fast_dispatch(Message *m) override {
+    if (m->get_data().length()) {
+      received = m->get_data().front().c_str();
+    }
+    FakeDispatcher::ms_fast_dispatch(m);
+  }
+};
+
+TEST_P(MessengerTest, DataBufferHookTest) {
+  FakeDispatcher cli_dispatcher(false);
+  DataBufferDispatcher srv_dispatcher;
+  entity_addr_t bind_addr;
+  bind_addr.parse("v2:127.0.0.1");
+  server_msgr->bind(bind_addr);
+  server_msgr->add_dispatcher_head(&srv_dispatcher);
+  server_msgr->start();
+
+  client_msgr->add_dispatcher_head(&cli_dispatcher);
+  client_msgr->start();
+
+  ConnectionRef conn = client_msgr->connect_to(server_msgr->get_mytype(),
+                                               server_msgr->get_myaddrs());
+  {
+    MPing *m = new MPing();
+    bufferlist bl;
+    bl.append_zero(3 * CEPH_PAGE_SIZE);
+    m->set_data(bl);
+    m->get_header().data_off = 512;
+    ASSERT_EQ(conn->send_message(m), 0);
+    std::unique_lock l{cli_dispatcher.lock};
+    cli_dispatcher.cond.wait(l, [&] { return cli_dispatcher.got_new; });
+    cli_dispatcher.got_new = false;
+  }
+  // the payload was read straight into the dispatcher's buffer
+  ASSERT_NE(nullptr, srv_dispatcher.supplied.load());
+  ASSERT_EQ(srv_dispatcher.supplied.load(), srv_dispatcher.received.load());
+  ASSERT_EQ(512u, srv_dispatcher.data_off.load());
+
+  client_msgr->shutdown();
+  client_msgr->wait();
+  server_msgr->shutdown();
+  server_msgr->wait();
+}
+
+TEST_P(MessengerTest, CoalesceTest) {
+  g_ceph_context->_conf.set_val("ms_async_coalesce_bytes", "65536");
+  g_ceph_context->_conf.set_val("ms_async_coalesce_delay_us", "2000");
+  FakeDispatcher cli_dispatcher(false), srv_dispatcher(true);
+  entity_addr_t bind_addr;
+  bind_addr.parse("v2:127.0.0.1");
+  server_msgr->bind(bind_addr);
+  server_msgr->add_dispatcher_head(&srv_dispatcher);
+  server_msgr->start();
+
+  client_msgr->add_dispatcher_head(&cli_dispatcher);
+  client_msgr->start();
+
+  ConnectionRef conn = client_msgr->connect_to(server_msgr->get_mytype(),
+                                               server_msgr->get_myaddrs());
+  {
+    ASSERT_EQ(conn->send_message(new MPing()), 0);
+    std::unique_lock l{cli_dispatcher.lock};
+    cli_dispatcher.cond.wait(l, [&] { return cli_dispatcher.got_new; });
+    cli_dispatcher.got_new = false;
+  }
+  // a burst of small messages is held back and sent together, a large
+  // one flushes right away; all of them still get through
+  for (int i = 0; i < 31; ++i) {
+    ASSERT_EQ(conn->send_message(new MPing()), 0);
+  }
+  {
+    MPing *m = new MPing();
+    bufferlist bl;
+    bl.append_zero(128 * 1024);
+    m->set_data(bl);
+    ASSERT_EQ(conn->send_message(m), 0);
+  }
+  Session *s = static_cast<Session*>(conn->get_priv().get());
+  CHECK_AND_WAIT_TRUE(s->get_count() == 33);
+  ASSERT_EQ(33u, s->get_count());
+
+  client_msgr->shutdown();
+  client_msgr->wait();
+  server_msgr->shutdown();
+  server_msgr->wait();
+  g_ceph_context->_conf.set_val("ms_async_coalesce_bytes", "0");
+  g_ceph_context->_conf.set_val("ms_async_coalesce_delay_us", "0");
+}
+
 TEST_P(MessengerTest, SimpleMsgr2Test) {
   FakeDispatcher cli_dispatcher(false), srv_dispatcher(true);
   entity_addr_t legacy_addr;
@@ -2389,6 +2495,151 @@ TEST_P(MessengerTest, MarkdownTest) {
   delete server_msgr2;
 }
 
+class SeqDispatcher : public Dispatcher {
+ public:
+  ceph::mutex lock = ceph::make_mutex("SeqDispatcher::lock");
+  ceph::condition_variable cond;
+  map<ConnectionRef, uint64_t> next_seq;
+  uint64_t received = 0;
+  uint64_t resets = 0;
+
+  explicit SeqDispatcher(CephContext *cct) : Dispatcher(cct) {}
+  bool ms_can_fast_dispatch_any() const override { return true; }
+  bool ms_can_fast_dispatch(const Message *m) const override {
+    return m->get_type() == CEPH_MSG_PING;
+  }
+  bool ms_dispatch(Message *m) override {
+    ceph_abort();
+  }
+  void ms_fast_dispatch(Message *m) override {
+    Payload pl;
+    auto p = m->get_data().cbegin();
+    decode(pl, p);
+    std::lock_guard l{lock};
+    // every connection carries its own 0, 1, 2, ... sequence
+    EXPECT_EQ(next_seq[m->get_connection()], pl.seq)
+      << " conn=" << m->get_connection();
+    next_seq[m->get_connection()] = pl.seq + 1;
+    ++received;
+    cond.notify_all();
+    m->put();
+  }
+  bool ms_handle_reset(Connection *con) override {
+    std::lock_guard l{lock};
+    ++resets;
+    return true;
+  }
+  void ms_handle_remote_reset(Connection *con) override {
+    std::lock_guard l{lock};
+    ++resets;
+  }
+  bool ms_handle_refused(Connection *con) override {
+    return false;
+  }
+  int ms_handle_fast_authentication(Connection *con) override {
+    return 1;
+  }
+};
+
+TEST_P(MessengerTest, RebalanceMigrationTest) {
+  // the network stack is shared by all messengers of a context and reads
+  // ms_async_rebalance_interval when it is created, so use our own
+  boost::intrusive_ptr<CephContext> cct{
+    new CephContext(CEPH_ENTITY_TYPE_CLIENT), false};
+  cct->_conf.set_val("auth_cluster_required", "none");
+  cct->_conf.set_val("auth_service_required", "none");
+  cct->_conf.set_val("auth_client_required", "none");
+  cct->_conf.set_val("keyring", "/dev/null");
+  cct->_conf.set_val("admin_socket", "");
+  cct->_conf.set_val("ms_die_on_bad_msg", "true");
+  cct->_conf.set_val("ms_async_op_threads", "3");
+  cct->_conf.set_val("ms_async_rebalance_interval", "10");
+  cct->_conf.apply_changes(nullptr);
+  DummyAuthClientServer auth(cct.get());
+  auth.auth_registry.refresh_config();
+
+  SeqDispatcher srv_dispatcher(cct.get()), cli_dispatcher(cct.get());
+  Messenger *server = Messenger::create(cct.get(), GetParam(),
+					entity_name_t::OSD(0), "server",
+					getpid());
+  server->set_default_policy(Messenger::Policy::stateful_server(0));
+  server->set_auth_client(&auth);
+  server->set_auth_server(&auth);
+  entity_addr_t bind_addr;
+  bind_addr.parse("v2:127.0.0.1");
+  server->bind(bind_addr);
+  server->add_dispatcher_head(&srv_dispatcher);
+  server->start();
+
+  // a few hot connections among mostly idle ones, so that the workers
+  // they land on get unbalanced and connections move while in use
+  const unsigned num_clients = 8, num_hot = 3;
+  const uint64_t hot_msgs = 20000, cold_msgs = 200;
+  vector<Messenger*> clients;
+  vector<ConnectionRef> conns;
+  for (unsigned i = 0; i < num_clients; ++i) {
+    Messenger *client = Messenger::create(cct.get(), GetParam(),
+					  entity_name_t::CLIENT(-1), "client",
+					  getpid() + 1 + i);
+    client->set_default_policy(Messenger::Policy::lossless_client(0));
+    client->set_auth_client(&auth);
+    client->set_auth_server(&auth);
+    client->add_dispatcher_head(&cli_dispatcher);
+    client->start();
+    clients.push_back(client);
+    conns.push_back(client->connect_to(server->get_mytype(),
+				       server->get_myaddrs()));
+  }
+
+  vector<std::thread> senders;
+  for (unsigned i = 0; i < num_clients; ++i) {
+    senders.emplace_back([&, i] {
+      const bool hot = i < num_hot;
+      bufferlist data;
+      data.append_zero(hot ? 16384 : 64);
+      for (uint64_t seq = 0; seq < (hot ? hot_msgs : cold_msgs); ++seq) {
+	Payload pl{Payload::PING, seq, data};
+	bufferlist bl;
+	encode(pl, bl);
+	MPing *m = new MPing();
+	m->set_data(bl);
+	ASSERT_EQ(0, conns[i]->send_message(m));
+	if (!hot) {
+	  usleep(1000);
+	}
+      }
+    });
+  }
+  for (auto& t : senders) {
+    t.join();
+  }
+
+  const uint64_t total = num_hot * hot_msgs +
+    (num_clients - num_hot) * cold_msgs;
+  {
+    std::unique_lock l{srv_dispatcher.lock};
+    ASSERT_TRUE(srv_dispatcher.cond.wait_for(l, std::chrono::seconds(120), [&] {
+      return srv_dispatcher.received >= total;
+    }));
+    ASSERT_EQ(total, srv_dispatcher.received);
+    ASSERT_EQ(num_clients, srv_dispatcher.next_seq.size());
+    for (auto& [con, next] : srv_dispatcher.next_seq) {
+      ASSERT_TRUE(next == hot_msgs || next == cold_msgs);
+    }
+    ASSERT_EQ(0u, srv_dispatcher.resets);
+  }
+
+  conns.clear();
+  for (auto client : clients) {
+    client->shutdown();
+    client->wait();
+    delete client;
+  }
+  server->shutdown();
+  server->wait();
+  delete server;
+}
+
 INSTANTIATE_TEST_SUITE_P(
   Messenger,
   MessengerTest,
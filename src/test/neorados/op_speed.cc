@@ -13,12 +13,60 @@
  *
  */
 
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
 #include "include/neorados/RADOS.hpp"
 
-constexpr int to_create = 10'000'000;
+#include "common/ceph_time.h"
+
+// Count heap allocations, so op construction that spills out of the
+// inline storage shows up in the results.
+static std::uint64_t allocations = 0;
+
+void* operator new(std::size_t size) {
+  ++allocations;
+  if (auto p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
 
-int main() {
+constexpr int default_to_create = 10'000'000;
+
+template<typename F>
+static void bench(const char* name, int to_create, F&& f) {
+  const auto start_allocs = allocations;
+  const auto start = ceph::mono_clock::now();
   for (int i = 0; i < to_create; ++i) {
+    f();
+  }
+  const auto elapsed = ceph::mono_clock::now() - start;
+  const auto allocs = allocations - start_allocs;
+  std::cout << name << ": "
+	    << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / to_create
+	    << " ns/op, "
+	    << static_cast<double>(allocs) / to_create << " allocations/op"
+	    << std::endl;
+}
+
+int main(int argc, char** argv) {
+  const int to_create = argc > 1 ? std::atoi(argv[1]) : default_to_create;
+  if (to_create <= 0) {
+    std::cerr << "usage: " << argv[0] << " [ops]" << std::endl;
+    return 1;
+  }
+
+  bench("ReadOp", to_create, [] {
     neorados::ReadOp op;
     bufferlist bl;
     std::uint64_t sz;
@@ -30,5 +78,14 @@ int main() {
     op.stat(&sz, &tm);
     op.get_xattrs(&xattrs);
     op.get_omap_vals(std::nullopt, std::nullopt, 1000, &omap, &trunc);
-  }
+  });
+
+  bufferlist data;
+  data.append(std::string(4096, 'a'));
+  bench("WriteOp", to_create, [&data] {
+    neorados::WriteOp op;
+    op.create(false);
+    op.write_full(data);
+    op.set_omap_header(data);
+  });
 }
@@ -5,6 +5,7 @@
  * Author: Igor Fedotov, ifedotov@suse.com
  */
 #include <iostream>
+#include <thread>
 #include <boost/scoped_ptr.hpp>
 #include <gtest/gtest.h>
 
@@ -13,6 +14,7 @@
 #include "include/stringify.h"
 #include "include/Context.h"
 #include "os/bluestore/Allocator.h"
+#include "os/bluestore/CachingAllocator.h"
 
 #include <boost/random/uniform_int.hpp>
 typedef boost::mt11213b gen_type;
@@ -362,6 +364,69 @@ TEST_P(AllocTest, mempoolAccounting)
   ASSERT_EQ(mempool::bluestore_alloc::allocated_items(), items);
 }
 
+static double run_threaded_alloc_release(Allocator* alloc,
+					 unsigned num_threads,
+					 uint64_t ops_per_thread,
+					 uint64_t alloc_unit)
+{
+  std::vector<std::thread> threads;
+  utime_t start = ceph_clock_now();
+  for (unsigned t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      gen_type rng(t);
+      boost::uniform_int<> u(1, 8);
+      std::vector<PExtentVector> held;
+      for (uint64_t i = 0; i < ops_per_thread; ++i) {
+	PExtentVector tmp;
+	uint64_t want = alloc_unit * u(rng);
+	EXPECT_EQ(static_cast<int64_t>(want),
+		  alloc->allocate(want, alloc_unit, 0, 0, &tmp));
+	held.emplace_back(std::move(tmp));
+	if (held.size() > 64) {
+	  alloc->release(held.front());
+	  held.erase(held.begin());
+	}
+      }
+      for (auto& e : held) {
+	alloc->release(e);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  return (double)(ceph_clock_now() - start);
+}
+
+TEST_P(AllocTest, test_alloc_bench_threads)
+{
+  uint64_t capacity = uint64_t(64) * 1024 * 1024 * 1024;
+  uint64_t alloc_unit = 4096;
+  uint64_t ops_per_thread = 100000;
+
+  for (unsigned num_threads : {1, 2, 4, 8, 16}) {
+    for (bool cached : {false, true}) {
+      Allocator* a = Allocator::create(g_ceph_context, GetParam(),
+				       capacity, alloc_unit);
+      ASSERT_NE(a, nullptr);
+      if (cached) {
+	a = new CachingAllocator(g_ceph_context, a, num_threads,
+				 4 * _1m, 64 * 1024, "");
+      }
+      alloc.reset(a);
+      alloc->init_add_free(0, capacity);
+      double secs = run_threaded_alloc_release(alloc.get(), num_threads,
+					       ops_per_thread, alloc_unit);
+      EXPECT_EQ(capacity, alloc->get_free());
+      std::cout << GetParam() << (cached ? " cached" : "")
+		<< " threads " << num_threads
+		<< " ops/s " << (uint64_t)(num_threads * ops_per_thread / secs)
+		<< std::endl;
+      init_close();
+    }
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(
   Allocator,
   AllocTest,
@@ -18,13 +18,18 @@
 #include <stdint.h>
 #include <string>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
 #include "common/ceph_argparse.h"
 #include "common/debug.h"
+#include "common/errno.h"
+#include "include/str_list.h"
 #include "common/Cycles.h"
 #include "global/global_init.h"
+#include "blk/BlockDevice.h"
 #include "os/ObjectStore.h"
 
 class Transaction {
@@ -234,9 +239,78 @@ const ghobject_t PerfCase::info_oid(hobject_t(sobject_t(object_t("infos"), 0)));
 Transaction::Tick Transaction::write_ticks, Transaction::setattr_ticks, Transaction::omap_setkeys_ticks, Transaction::omap_rmkey_ticks;
 Transaction::Tick Transaction::encode_ticks, Transaction::decode_ticks, Transaction::iterate_ticks;
 
+/*
+ * Drive a BlockDevice directly with threads doing synchronous aio
+ * write+read pairs, like OSD shard threads do through BlueStore.  Run it
+ * once against a kernel block device and once against an spdk: path to
+ * compare KernelDevice with NVMEDevice.
+ */
+static int bdev_bench(const string& path, uint64_t io_size, unsigned seconds,
+		      const vector<unsigned>& thread_counts)
+{
+  std::unique_ptr<BlockDevice> bdev(
+    BlockDevice::create(g_ceph_context, path, nullptr, nullptr,
+			nullptr, nullptr));
+  int r = bdev->open(path);
+  if (r < 0) {
+    cerr << "failed to open " << path << ": " << cpp_strerror(r) << std::endl;
+    return r;
+  }
+  map<string, string> meta;
+  bdev->collect_metadata("", &meta);
+  io_size = p2roundup<uint64_t>(io_size, bdev->get_block_size());
+  uint64_t slots = bdev->get_size() / io_size;
+  cerr << "bdev " << path << " driver " << meta["driver"]
+       << " size " << bdev->get_size() << " io_size " << io_size << std::endl;
+
+  bufferlist payload;
+  payload.append(buffer::create_small_page_aligned(io_size));
+  memset(payload.c_str(), 0x5a, io_size);
+
+  for (unsigned threads : thread_counts) {
+    std::atomic<uint64_t> ops = {0};
+    std::atomic<bool> stop = {false};
+    vector<std::thread> workers;
+    uint64_t start = Cycles::rdtsc();
+    for (unsigned i = 0; i < threads; ++i) {
+      workers.emplace_back([&, i] {
+	unsigned seed = i;
+	while (!stop) {
+	  uint64_t off = (rand_r(&seed) % slots) * io_size;
+	  IOContext ioc(g_ceph_context, nullptr);
+	  bufferlist bl = payload;
+	  bdev->aio_write(off, bl, &ioc, false);
+	  bdev->aio_submit(&ioc);
+	  ioc.aio_wait();
+	  bufferlist out;
+	  IOContext rioc(g_ceph_context, nullptr);
+	  bdev->aio_read(off, io_size, &out, &rioc);
+	  bdev->aio_submit(&rioc);
+	  rioc.aio_wait();
+	  ops += 2;
+	}
+      });
+    }
+    sleep(seconds);
+    stop = true;
+    for (auto& w : workers) {
+      w.join();
+    }
+    double us = Cycles::to_microseconds(Cycles::rdtsc() - start);
+    cerr << " threads " << threads << " ops " << ops
+	 << " iops " << (uint64_t)(ops * 1000000.0 / us)
+	 << " avg lat " << (us * threads / std::max<uint64_t>(ops, 1)) << "us"
+	 << std::endl;
+  }
+  bdev->close();
+  return 0;
+}
+
 void usage(const string &name) {
   cerr << "Usage: " << name << " [times] "
        << std::endl;
+  cerr << "       " << name << " bdev <path> [seconds] [io_size] [threads,...]"
+       << std::endl;
 }
 
 int main(int argc, char **argv)
@@ -256,6 +330,23 @@ int main(int argc, char **argv)
     return 1;
   }
 
+  if (string(args[0]) == "bdev") {
+    if (args.size() < 2) {
+      usage(argv[0]);
+      return 1;
+    }
+    unsigned seconds = args.size() > 2 ? atoi(args[2]) : 10;
+    uint64_t io_size = args.size() > 3 ? atoll(args[3]) : 4096;
+    vector<unsigned> thread_counts = {1, 2, 4, 8, 16};
+    if (args.size() > 4) {
+      thread_counts.clear();
+      for (auto& t : get_str_list(args[4], ",")) {
+	thread_counts.push_back(atoi(t.c_str()));
+      }
+    }
+    return bdev_bench(args[1], io_size, seconds, thread_counts) < 0 ? 1 : 0;
+  }
+
   uint64_t times = atoi(args[0]);
   PerfCase c;
   uint64_t ticks = c.rados_write_4k(times);
@@ -1285,6 +1285,13 @@ TEST_P(StoreTest, CompressionTest) {
   SetVal(g_conf(), "bluestore_compression_mode", "aggressive");
   g_ceph_context->_conf.apply_changes(nullptr);
   doCompressionTest();
+  SetVal(g_conf(), "bluestore_compression_algorithm", "snappy");
+  SetVal(g_conf(), "bluestore_compression_mode", "force");
+  SetVal(g_conf(), "bluestore_compression_chunk_size", "8192");
+  g_ceph_context->_conf.apply_changes(nullptr);
+  doCompressionTest();
+  SetVal(g_conf(), "bluestore_compression_chunk_size", "0");
+  g_ceph_context->_conf.apply_changes(nullptr);
 }
 
 TEST_P(StoreTest, SimpleObjectTest) {
@@ -3060,6 +3067,77 @@ TEST_P(StoreTest, SimpleListTest) {
   }
 }
 
+TEST_P(StoreTest, RemoveRangeTest) {
+  if (!store->supports_remove_range())
+    return;
+  int r;
+  coll_t cid(spg_t(pg_t(0, 1), shard_id_t(1)));
+  auto ch = store->create_new_collection(cid);
+  {
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    cerr << "Creating collection " << cid << std::endl;
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  bufferlist data;
+  data.append(std::string(0x3000, 'a'));
+  map<string, bufferlist> omap;
+  omap["key"] = data;
+  vector<ghobject_t> all;
+  {
+    ObjectStore::Transaction t;
+    for (int i=0; i<100; ++i) {
+      ghobject_t hoid(hobject_t(sobject_t("object_" + stringify(i),
+					  CEPH_NOSNAP)),
+		      ghobject_t::NO_GEN, shard_id_t(1));
+      hoid.hobj.pool = 1;
+      all.push_back(hoid);
+      t.write(cid, hoid, 0, data.length(), data);
+      t.omap_setkeys(cid, hoid, omap);
+    }
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  std::sort(all.begin(), all.end());
+  {
+    ObjectStore::Transaction t;
+    t.remove_range(cid, all[20], all[59]);
+    cerr << "Removing " << all[20] << " to " << all[59] << std::endl;
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  {
+    vector<ghobject_t> objects;
+    r = collection_list(store, ch, ghobject_t(), ghobject_t::get_max(),
+			INT_MAX, &objects, nullptr);
+    ASSERT_EQ(r, 0);
+    vector<ghobject_t> expected(all.begin(), all.begin() + 20);
+    expected.insert(expected.end(), all.begin() + 60, all.end());
+    ASSERT_EQ(expected, objects);
+    for (auto& oid : objects) {
+      bufferlist bl;
+      ASSERT_EQ((int)data.length(), store->read(ch, oid, 0, data.length(), bl));
+      ASSERT_TRUE(bl_eq(data, bl));
+    }
+    ASSERT_FALSE(store->exists(ch, all[20]));
+    ASSERT_FALSE(store->exists(ch, all[59]));
+  }
+  ch.reset();
+  EXPECT_EQ(store->umount(), 0);
+  ASSERT_EQ(store->fsck(false), 0);
+  EXPECT_EQ(store->mount(), 0);
+  ch = store->open_collection(cid);
+  {
+    ObjectStore::Transaction t;
+    t.remove_range(cid, all.front(), all.back());
+    t.remove_collection(cid);
+    cerr << "Cleaning" << std::endl;
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+}
+
 TEST_P(StoreTest, ListEndTest) {
   int r;
   coll_t cid(spg_t(pg_t(0, 1), shard_id_t(1)));
@@ -3769,6 +3847,77 @@ TEST_P(StoreTest, SimpleCloneRangeTest) {
 }
 
 #if defined(WITH_BLUESTORE)
+TEST_P(StoreTest, BlueStoreSequentialListPrefetch) {
+  if (string(GetParam()) != "bluestore")
+    return;
+  int r;
+  coll_t cid(spg_t(pg_t(0, 1), shard_id_t::NO_SHARD));
+  auto ch = store->create_new_collection(cid);
+  {
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    for (int i = 0; i < 20; ++i) {
+      ghobject_t hoid(hobject_t(sobject_t("object_" + stringify(i),
+					  CEPH_NOSNAP)));
+      hoid.hobj.pool = 1;
+      t.touch(cid, hoid);
+    }
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  // start with a cold onode cache
+  ch.reset();
+  r = store->umount();
+  ASSERT_EQ(0, r);
+  r = store->mount();
+  ASSERT_EQ(0, r);
+  ch = store->open_collection(cid);
+
+  SetVal(g_conf(), "bluestore_collection_list_prefetch", "8");
+  g_conf().apply_changes(nullptr);
+  const PerfCounters* logger = store->get_perf_counters();
+  uint64_t prefetched = logger->get(l_bluestore_onode_list_prefetched);
+
+  vector<ghobject_t> objects;
+  ghobject_t next;
+  r = collection_list(store, ch, ghobject_t(), ghobject_t::get_max(), 10,
+		      &objects, &next);
+  ASSERT_EQ(r, 0);
+  ASSERT_EQ(objects.size(), 10u);
+  // first listing is not sequential
+  ASSERT_EQ(logger->get(l_bluestore_onode_list_prefetched), prefetched);
+
+  objects.clear();
+  r = collection_list(store, ch, next, ghobject_t::get_max(), 10,
+		      &objects, &next);
+  ASSERT_EQ(r, 0);
+  ASSERT_EQ(objects.size(), 10u);
+  ASSERT_EQ(logger->get(l_bluestore_onode_list_prefetched), prefetched + 8);
+
+  uint64_t misses = logger->get(l_bluestore_onode_misses);
+  for (unsigned i = 0; i < 8; ++i) {
+    struct stat st;
+    ASSERT_EQ(0, store->stat(ch, objects[i], &st));
+  }
+  ASSERT_EQ(logger->get(l_bluestore_onode_misses), misses);
+
+  SetVal(g_conf(), "bluestore_collection_list_prefetch", "0");
+  g_conf().apply_changes(nullptr);
+  {
+    ObjectStore::Transaction t;
+    objects.clear();
+    r = collection_list(store, ch, ghobject_t(), ghobject_t::get_max(),
+			INT_MAX, &objects, nullptr);
+    ASSERT_EQ(r, 0);
+    for (auto& o : objects) {
+      t.remove(cid, o);
+    }
+    t.remove_collection(cid);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+}
+
 TEST_P(StoreTest, BlueStoreUnshareBlobSimple) {
   if (string(GetParam()) != "bluestore")
     return;
@@ -12,7 +12,10 @@
 #include "include/stringify.h"
 #include "common/errno.h"
 
+#include "include/scope_guard.h"
+
 #include "blk/BlockDevice.h"
+#include "blk/kernel/io_uring.h"
 
 using namespace std;
 
@@ -91,6 +94,111 @@ TEST(KernelDevice, Ticket45337) {
   b->close();
 }
 
+TEST(KernelDevice, ioring_fixed_buffers) {
+  if (!ioring_queue_t::supported()) {
+    GTEST_SKIP() << "io_uring not supported";
+  }
+  g_ceph_context->_conf.set_val("bdev_ioring", "true");
+  g_ceph_context->_conf.set_val("bdev_ioring_fixed_buffers", "4");
+  g_ceph_context->_conf.set_val("bdev_ioring_fixed_buffer_size", "8192");
+  auto restore = make_scope_guard([] {
+    g_ceph_context->_conf.rm_val("bdev_ioring");
+    g_ceph_context->_conf.rm_val("bdev_ioring_fixed_buffers");
+    g_ceph_context->_conf.rm_val("bdev_ioring_fixed_buffer_size");
+  });
+
+  uint64_t size = 1048576ull * 64;
+  TempBdev bdev{ size };
+  std::unique_ptr<BlockDevice> b(
+    BlockDevice::create(g_ceph_context, bdev.path, NULL, NULL,
+      [](void* handle, void* aio) {}, NULL));
+  ASSERT_EQ(0, b->open(bdev.path));
+
+  // 4k and 8k ios go through the registered buffers; 64k ios and more
+  // ios than there are buffers fall back to the caller's memory
+  std::vector<std::pair<uint64_t, bufferlist>> writes;
+  uint64_t off = 0;
+  for (unsigned i = 0; i < 16; ++i) {
+    uint64_t len = (i % 3 == 0) ? 65536 : (i % 3 == 1) ? 4096 : 8192;
+    bufferlist bl;
+    bl.append(buffer::create_page_aligned(len));
+    memset(bl.c_str(), 'a' + i, len);
+    writes.emplace_back(off, bl);
+    off += len;
+  }
+  {
+    IOContext ioc(g_ceph_context, NULL);
+    for (auto& [o, bl] : writes) {
+      bufferlist t = bl;
+      ASSERT_EQ(0, b->aio_write(o, t, &ioc, false));
+    }
+    b->aio_submit(&ioc);
+    ioc.aio_wait();
+    ASSERT_EQ(0, ioc.get_return_value());
+  }
+  {
+    IOContext ioc(g_ceph_context, NULL);
+    std::vector<bufferlist> reads(writes.size());
+    for (size_t i = 0; i < writes.size(); ++i) {
+      ASSERT_EQ(0, b->aio_read(writes[i].first, writes[i].second.length(),
+			       &reads[i], &ioc));
+    }
+    b->aio_submit(&ioc);
+    ioc.aio_wait();
+    ASSERT_EQ(0, ioc.get_return_value());
+    for (size_t i = 0; i < writes.size(); ++i) {
+      ASSERT_TRUE(writes[i].second.contents_equal(reads[i]));
+    }
+  }
+
+  b->close();
+}
+
+TEST(KernelDevice, io_class_max_inflight) {
+  g_ceph_context->_conf.set_val("bdev_io_class_max_inflight", "compaction=2");
+  g_ceph_context->_conf.set_val("bdev_io_class_ioprio", "compaction=idle");
+  auto restore = make_scope_guard([] {
+    g_ceph_context->_conf.rm_val("bdev_io_class_max_inflight");
+    g_ceph_context->_conf.rm_val("bdev_io_class_ioprio");
+  });
+
+  uint64_t size = 1048576ull * 16;
+  TempBdev bdev{ size };
+  std::unique_ptr<BlockDevice> b(
+    BlockDevice::create(g_ceph_context, bdev.path, NULL, NULL,
+      [](void* handle, void* aio) {}, NULL));
+  ASSERT_EQ(0, b->open(bdev.path));
+
+  bufferlist bl;
+  bl.append(buffer::create_page_aligned(4096));
+  memset(bl.c_str(), 'x', 4096);
+  // several contexts of the limited class, each above the limit on its own
+  std::vector<std::unique_ptr<IOContext>> iocs;
+  for (unsigned i = 0; i < 4; ++i) {
+    iocs.emplace_back(std::make_unique<IOContext>(g_ceph_context, nullptr));
+    iocs.back()->io_class = blk_io_class_t::COMPACTION;
+    for (unsigned j = 0; j < 4; ++j) {
+      bufferlist t = bl;
+      ASSERT_EQ(0, b->aio_write((i * 4 + j) * 4096, t, iocs.back().get(),
+				false));
+    }
+    b->aio_submit(iocs.back().get());
+  }
+  for (auto& ioc : iocs) {
+    ioc->aio_wait();
+    ASSERT_EQ(0, ioc->get_return_value());
+  }
+  for (unsigned i = 0; i < 16; ++i) {
+    bufferlist r;
+    IOContext ioc(g_ceph_context, nullptr);
+    ioc.io_class = blk_io_class_t::COMPACTION;
+    ASSERT_EQ(0, b->read(i * 4096, 4096, &r, &ioc, false));
+    ASSERT_TRUE(bl.contents_equal(r));
+  }
+
+  b->close();
+}
+
 int main(int argc, char **argv) {
   auto args = argv_to_vec(argc, argv);
   map<string,string> defaults = {
@@ -173,6 +173,52 @@ TEST(BlueFS, small_appends) {
   fs.umount();
 }
 
+TEST(BlueFS, sequential_readahead) {
+  uint64_t size = 1048576 * 128;
+  TempBdev bdev{size};
+  ConfSaver conf(g_ceph_context->_conf);
+  conf.SetVal("bluefs_buffered_io", "false");
+  conf.SetVal("bluefs_max_prefetch", "65536");
+  conf.SetVal("bluefs_readahead_max", "1048576");
+  conf.ApplyChanges();
+
+  BlueFS fs(g_ceph_context);
+  ASSERT_EQ(0, fs.add_block_device(BlueFS::BDEV_DB, bdev.path, false));
+  uuid_d fsid;
+  ASSERT_EQ(0, fs.mkfs(fsid, { BlueFS::BDEV_DB, false, false }));
+  ASSERT_EQ(0, fs.mount());
+  ASSERT_EQ(0, fs.maybe_verify_layout({ BlueFS::BDEV_DB, false, false }));
+  const unsigned file_size = 1048576 * 8;
+  std::string data(file_size, 0);
+  for (unsigned i = 0; i < file_size; ++i) {
+    data[i] = (char)(i / 4096 + i);
+  }
+  {
+    BlueFS::FileWriter *h;
+    ASSERT_EQ(0, fs.mkdir("dir"));
+    ASSERT_EQ(0, fs.open_for_write("dir", "file", &h, false));
+    h->append(data.c_str(), data.size());
+    fs.fsync(h);
+    fs.close_writer(h);
+  }
+  {
+    BlueFS::FileReader *h;
+    ASSERT_EQ(0, fs.open_for_read("dir", "file", &h));
+    const unsigned chunk = 16384;
+    char buf[chunk];
+    for (unsigned off = 0; off < file_size; off += chunk) {
+      ASSERT_EQ((int)chunk, fs.read(h, off, chunk, nullptr, buf));
+      ASSERT_EQ(0, memcmp(data.c_str() + off, buf, chunk));
+    }
+    // a jump backwards must not be served from the read-ahead
+    ASSERT_EQ((int)chunk, fs.read(h, 4096, chunk, nullptr, buf));
+    ASSERT_EQ(0, memcmp(data.c_str() + 4096, buf, chunk));
+    delete h;
+  }
+  ASSERT_GT(fs.get_perf_counters()->get(l_bluefs_readahead_hit), 0u);
+  fs.umount();
+}
+
 TEST(BlueFS, very_large_write) {
   // we'll write a ~5G file, so allocate more than that for the whole fs
   uint64_t size = 1048576 * 1024 * 6ull;
@@ -53,6 +53,27 @@ TEST(bluestore, sizeof) {
   cout << "map<char,char>\t" << sizeof(map<char,char>) << std::endl;
 }
 
+TEST(bluestore, pextent_vector_inline) {
+  size_t bytes = mempool::bluestore_cache_other::allocated_bytes();
+  {
+    PExtentVector v;
+    v.emplace_back(0x10000, 0x1000);
+    // a single extent is stored inline
+    ASSERT_EQ(bytes, mempool::bluestore_cache_other::allocated_bytes());
+    v.emplace_back(0x20000, 0x1000);
+    // more spill to the heap and are still accounted to the mempool
+    ASSERT_LT(bytes, mempool::bluestore_cache_other::allocated_bytes());
+
+    bufferlist bl;
+    encode(v, bl);
+    PExtentVector w;
+    auto p = bl.cbegin();
+    decode(w, p);
+    ASSERT_EQ(v, w);
+  }
+  ASSERT_EQ(bytes, mempool::bluestore_cache_other::allocated_bytes());
+}
+
 void dump_mempools()
 {
   ostringstream ostr;
@@ -1095,6 +1116,55 @@ TEST(Blob, legacy_decode)
   }
 }
 
+TEST(bluestore_compression_header_t, encode_decode)
+{
+  {
+    // unchunked headers stay v2 so that older releases can read them
+    bluestore_compression_header_t h(Compressor::COMP_ALG_SNAPPY);
+    h.length = 1234;
+    h.compressor_message = 7;
+    bufferlist bl;
+    encode(h, bl);
+    ASSERT_EQ(2, bl[0]);
+    ASSERT_EQ(1, bl[1]);
+    ASSERT_EQ(Compressor::COMP_ALG_SNAPPY, bl[6]);
+
+    bluestore_compression_header_t d;
+    d.chunk_size = 0x2000;
+    d.chunk_lengths = {1, 2};
+    auto p = bl.cbegin();
+    decode(d, p);
+    ASSERT_TRUE(p.end());
+    ASSERT_EQ(Compressor::COMP_ALG_SNAPPY, d.type);
+    ASSERT_EQ(1234u, d.length);
+    ASSERT_EQ(7, d.compressor_message);
+    ASSERT_EQ(0u, d.chunk_size);
+    ASSERT_TRUE(d.chunk_lengths.empty());
+  }
+  {
+    // chunked headers are v3 with compat 3, and their type is out of
+    // range for code that predates chunking
+    bluestore_compression_header_t h(Compressor::COMP_ALG_SNAPPY);
+    h.length = 1234;
+    h.chunk_size = 0x2000;
+    h.chunk_lengths = {1000, 234};
+    bufferlist bl;
+    encode(h, bl);
+    ASSERT_EQ(3, bl[0]);
+    ASSERT_EQ(3, bl[1]);
+    ASSERT_GE((uint8_t)bl[6], Compressor::COMP_ALG_LAST);
+
+    bluestore_compression_header_t d;
+    auto p = bl.cbegin();
+    decode(d, p);
+    ASSERT_TRUE(p.end());
+    ASSERT_EQ(Compressor::COMP_ALG_SNAPPY, d.type);
+    ASSERT_EQ(1234u, d.length);
+    ASSERT_EQ(0x2000u, d.chunk_size);
+    ASSERT_EQ(h.chunk_lengths, d.chunk_lengths);
+  }
+}
+
 TEST(ExtentMap, seek_lextent)
 {
   BlueStore store(g_ceph_context, "", 4096);
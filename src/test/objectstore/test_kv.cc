@@ -359,6 +359,48 @@ TEST_P(KVTest, ShardingRMRange) {
 }
 
 
+TEST_P(KVTest, GetBatch) {
+  ASSERT_EQ(0, db->create_and_open(cout));
+  {
+    KeyValueDB::Transaction t = db->get_transaction();
+    bufferlist value;
+    value.append("value");
+    t->set("prefix", "key1", value);
+    t->set("prefix", "key3", value);
+    t->set("other", "key2", value);
+    ASSERT_EQ(0, db->submit_transaction_sync(t));
+  }
+  {
+    std::vector<string> keys = {"key3", "key2", "key1", "key3"};
+    std::vector<bufferlist> values;
+    std::vector<int> rvals;
+    ASSERT_EQ(0, db->get_batch("prefix", keys, &values, &rvals));
+    ASSERT_EQ(keys.size(), values.size());
+    ASSERT_EQ(keys.size(), rvals.size());
+    ASSERT_EQ(0, rvals[0]);
+    ASSERT_EQ(-ENOENT, rvals[1]);
+    ASSERT_EQ(0, rvals[2]);
+    ASSERT_EQ(0, rvals[3]);
+    ASSERT_EQ("value", _bl_to_str(values[0]));
+    ASSERT_EQ(0u, values[1].length());
+    ASSERT_EQ("value", _bl_to_str(values[2]));
+    ASSERT_EQ("value", _bl_to_str(values[3]));
+
+    keys.clear();
+    ASSERT_EQ(0, db->get_batch("prefix", keys, &values, &rvals));
+    ASSERT_TRUE(values.empty());
+  }
+  {
+    std::set<string> keys = {"key1", "key2", "key3"};
+    std::map<string, bufferlist> out;
+    ASSERT_EQ(0, db->get("prefix", keys, &out));
+    ASSERT_EQ(2u, out.size());
+    ASSERT_EQ(1u, out.count("key1"));
+    ASSERT_EQ(1u, out.count("key3"));
+  }
+  fini();
+}
+
 TEST_P(KVTest, RocksDBColumnFamilyTest) {
   if(string(GetParam()) != "rocksdb")
     return;
@@ -413,6 +455,97 @@ TEST_P(KVTest, RocksDBColumnFamilyTest) {
   fini();
 }
 
+TEST_P(KVTest, RocksDBCFOptionsOverride) {
+  if(string(GetParam()) != "rocksdb")
+    return;
+
+  std::string cfs("p(3) O");
+  ASSERT_EQ(0, db->init(g_conf()->bluestore_rocksdb_options));
+  ASSERT_EQ(0, db->create_and_open(cout, cfs));
+  RocksDBStore* rdb = dynamic_cast<RocksDBStore*>(db.get());
+  ASSERT_NE(nullptr, rdb);
+  cout << "change mutable options of every shard" << std::endl;
+  ASSERT_EQ(0, rdb->apply_cf_options_override(""));
+  ASSERT_EQ(0, rdb->apply_cf_options_override(
+    "p=write_buffer_size=8388608;level0_file_num_compaction_trigger=8 "
+    "default=max_bytes_for_level_base=134217728"));
+  cout << "reject options that cannot change while open" << std::endl;
+  ASSERT_EQ(-EINVAL, rdb->apply_cf_options_override("O=compaction_style=kCompactionStyleUniversal"));
+  ASSERT_EQ(-EINVAL, rdb->apply_cf_options_override("O=block_cache=lru"));
+  ASSERT_EQ(-ENOENT, rdb->apply_cf_options_override("nosuchcf=write_buffer_size=8388608"));
+  {
+    KeyValueDB::Transaction t = db->get_transaction();
+    bufferlist value;
+    value.append("value");
+    t->set("p", "key", value);
+    ASSERT_EQ(0, db->submit_transaction_sync(t));
+  }
+  fini();
+
+  cout << "reopen with override set" << std::endl;
+  g_conf().set_val_or_die("rocksdb_cf_options_override",
+			  "p=level0_file_num_compaction_trigger=6");
+  init();
+  ASSERT_EQ(0, db->open(cout, cfs));
+  {
+    bufferlist v;
+    ASSERT_EQ(0, db->get("p", "key", &v));
+    ASSERT_EQ("value", _bl_to_str(v));
+  }
+  fini();
+  g_conf().set_val_or_die("rocksdb_cf_options_override", "");
+}
+
+TEST_P(KVTest, RocksDBKVProfile) {
+  if(string(GetParam()) != "rocksdb")
+    return;
+
+  g_conf().set_val_or_die("rocksdb_kv_profile_sample_rate", "1");
+  ASSERT_EQ(0, db->create_and_open(cout));
+  RocksDBStore* rdb = dynamic_cast<RocksDBStore*>(db.get());
+  ASSERT_NE(nullptr, rdb);
+  {
+    KeyValueDB::Transaction t = db->get_transaction();
+    bufferlist value;
+    value.append("value");
+    t->set("prefix", "key", value);
+    t->rmkey("prefix", "other");
+    ASSERT_EQ(0, db->submit_transaction_sync(t));
+  }
+  {
+    bufferlist v;
+    ASSERT_EQ(0, db->get("prefix", "key", &v));
+    v.clear();
+    ASSERT_EQ(-ENOENT, db->get("prefix", "missing", &v));
+  }
+  {
+    ceph::JSONFormatter f;
+    f.open_object_section("kv_profile");
+    rdb->dump_kv_profile(&f);
+    f.close_section();
+    std::ostringstream os;
+    f.flush(os);
+    cout << os.str() << std::endl;
+    ASSERT_NE(string::npos, os.str().find("\"prefix\":\"prefix\""));
+    ASSERT_NE(string::npos, os.str().find("\"get\":2"));
+    ASSERT_NE(string::npos, os.str().find("\"get_miss\":1"));
+    ASSERT_NE(string::npos, os.str().find("\"set\":1"));
+    ASSERT_NE(string::npos, os.str().find("\"rm\":1"));
+  }
+  rdb->reset_kv_profile();
+  {
+    ceph::JSONFormatter f;
+    f.open_object_section("kv_profile");
+    rdb->dump_kv_profile(&f);
+    f.close_section();
+    std::ostringstream os;
+    f.flush(os);
+    ASSERT_EQ(string::npos, os.str().find("\"prefix\":\"prefix\""));
+  }
+  fini();
+  g_conf().set_val_or_die("rocksdb_kv_profile_sample_rate", "0");
+}
+
 TEST_P(KVTest, RocksDBIteratorTest) {
   if(string(GetParam()) != "rocksdb")
     return;
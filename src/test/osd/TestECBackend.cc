@@ -60,3 +60,23 @@ TEST(ECUtil, stripe_info_t)
             make_pair((uint64_t)0, 2*swidth));
 }
 
+TEST(ECUtil, offset_len_to_data_chunks)
+{
+  const uint64_t swidth = 4096;
+  const uint64_t ssize = 4;
+
+  ECUtil::stripe_info_t s(ssize, swidth);
+  const uint64_t csize = s.get_chunk_size();
+
+  ASSERT_TRUE(s.offset_len_to_data_chunks(make_pair((uint64_t)0, (uint64_t)0)).empty());
+  ASSERT_EQ(s.offset_len_to_data_chunks(make_pair((uint64_t)0, (uint64_t)1)),
+	    set<int>({0}));
+  ASSERT_EQ(s.offset_len_to_data_chunks(make_pair(csize + 1, csize)),
+	    set<int>({1, 2}));
+  // wraps around into the next stripe
+  ASSERT_EQ(s.offset_len_to_data_chunks(make_pair(swidth - 10, (uint64_t)20)),
+	    set<int>({0, 3}));
+  ASSERT_EQ(s.offset_len_to_data_chunks(make_pair(swidth + 10, swidth)),
+	    set<int>({0, 1, 2, 3}));
+}
+
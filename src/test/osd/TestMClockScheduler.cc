@@ -7,7 +7,9 @@
 #include "global/global_context.h"
 #include "global/global_init.h"
 #include "common/common_init.h"
+#include "common/Formatter.h"
 
+#include "osd/scheduler/mClockCapacityEstimator.h"
 #include "osd/scheduler/mClockScheduler.h"
 #include "osd/scheduler/OpSchedulerItem.h"
 
@@ -261,3 +263,133 @@ TEST_F(mClockSchedulerTest, TestAllQueuesEnqueueDequeue) {
 
   ASSERT_TRUE(q.empty());
 }
+
+TEST_F(mClockSchedulerTest, TestParseClientQos) {
+  std::map<client_profile_id_t, mClockScheduler::client_qos_t> qos;
+  ASSERT_EQ(0, mClockScheduler::parse_client_qos(
+    "client.1001=0.1:2:0.5, pool.3=0:1:0", &qos));
+  ASSERT_EQ(2u, qos.size());
+  auto [res, wgt, lim] = qos[client_profile_id_t(1001, 0)];
+  ASSERT_EQ(0.1, res);
+  ASSERT_EQ(2u, wgt);
+  ASSERT_EQ(0.5, lim);
+  ASSERT_EQ(1u, qos.count(client_profile_id_t(0, 4)));
+
+  qos.clear();
+  ASSERT_EQ(3, mClockScheduler::parse_client_qos(
+    "client.x=0:1:0 osd.1=0:1:0 pool.1=2:1:0 client.7=0:1:0", &qos));
+  ASSERT_EQ(1u, qos.size());
+}
+
+TEST_F(mClockSchedulerTest, TestPerClientIsolation) {
+  g_ceph_context->_conf.set_val("osd_mclock_scheduler_client_isolation",
+				"client");
+  g_ceph_context->_conf.apply_changes(nullptr);
+
+  for (unsigned i = 100; i < 103; ++i) {
+    q.enqueue(create_item(i, client1, op_scheduler_class::client));
+    q.enqueue(create_item(i, client2, op_scheduler_class::client));
+  }
+  auto count = [](const std::string &s, const std::string &what) {
+    size_t n = 0;
+    for (auto p = s.find(what); p != std::string::npos;
+	 p = s.find(what, p + 1)) {
+      ++n;
+    }
+    return n;
+  };
+  {
+    JSONFormatter f;
+    f.open_object_section("q");
+    q.dump_clients(f);
+    f.close_section();
+    std::ostringstream out;
+    f.flush(out);
+    ASSERT_EQ(2u, count(out.str(), "\"client_id\""));
+    ASSERT_EQ(2u, count(out.str(), "\"queued\":3"));
+  }
+
+  for (unsigned i = 0; i < 6; ++i) {
+    ASSERT_FALSE(q.empty());
+    q.dequeue();
+  }
+  ASSERT_TRUE(q.empty());
+  {
+    JSONFormatter f;
+    f.open_object_section("q");
+    q.dump_clients(f);
+    f.close_section();
+    std::ostringstream out;
+    f.flush(out);
+    ASSERT_EQ(2u, count(out.str(), "\"queued\":0"));
+  }
+
+  g_ceph_context->_conf.set_val("osd_mclock_scheduler_client_isolation",
+				"none");
+  g_ceph_context->_conf.apply_changes(nullptr);
+}
+
+TEST_F(mClockSchedulerTest, TestCapacitySample) {
+  for (unsigned i = 0; i < 4; ++i) {
+    q.enqueue(create_item(i, client1, op_scheduler_class::client));
+  }
+  for (unsigned i = 0; i < 4; ++i) {
+    q.dequeue();
+  }
+  capacity_sample_t sample;
+  q.take_capacity_sample(&sample);
+  ASSERT_EQ(4u, sample.ops);
+  ASSERT_EQ(4u, sample.dequeues);
+  ASSERT_EQ(3u, sample.backlogged);
+
+  capacity_sample_t empty;
+  q.take_capacity_sample(&empty);
+  ASSERT_EQ(0u, empty.ops);
+}
+
+TEST(mClockCapacityEstimatorTest, TestEstimate) {
+  mClockCapacityEstimator e;
+  mClockCapacityEstimator::config_t conf;
+  conf.samples = 3;
+  const uint64_t bandwidth = 100 << 20;
+
+  // 10s, 40000 4KiB ops: ~1.56s of transfer, capacity ~4740 iops
+  capacity_sample_t busy;
+  busy.ops = busy.dequeues = busy.backlogged = 40000;
+  busy.bytes = busy.ops * 4096;
+
+  // close to the configured capacity: nothing to do
+  for (unsigned i = 0; i < 5; ++i) {
+    ASSERT_FALSE(e.add_sample(busy, 10, 4500, bandwidth, conf));
+  }
+  ASSERT_EQ(0u, e.get_pending());
+
+  // too far off, but only once enough samples agree
+  ASSERT_FALSE(e.add_sample(busy, 10, 1000, bandwidth, conf));
+  ASSERT_FALSE(e.add_sample(busy, 10, 1000, bandwidth, conf));
+  auto iops = e.add_sample(busy, 10, 1000, bandwidth, conf);
+  ASSERT_TRUE(iops);
+  ASSERT_NEAR(4740, *iops, 10);
+  ASSERT_EQ(0u, e.get_pending());
+
+  // an idle or throttled interval restarts the count
+  capacity_sample_t idle = busy;
+  idle.backlogged = idle.dequeues / 2;
+  capacity_sample_t throttled = busy;
+  throttled.throttled = 1;
+  ASSERT_FALSE(e.add_sample(busy, 10, 1000, bandwidth, conf));
+  ASSERT_FALSE(e.add_sample(idle, 10, 1000, bandwidth, conf));
+  ASSERT_EQ(0u, e.get_pending());
+  ASSERT_FALSE(e.add_sample(busy, 10, 1000, bandwidth, conf));
+  ASSERT_FALSE(e.add_sample(throttled, 10, 1000, bandwidth, conf));
+  ASSERT_EQ(0u, e.get_pending());
+
+  // the result never goes above the bench threshold
+  conf.max_iops = 2000;
+  for (unsigned i = 0; i < 2; ++i) {
+    ASSERT_FALSE(e.add_sample(busy, 10, 1000, bandwidth, conf));
+  }
+  iops = e.add_sample(busy, 10, 1000, bandwidth, conf);
+  ASSERT_TRUE(iops);
+  ASSERT_EQ(2000, *iops);
+}
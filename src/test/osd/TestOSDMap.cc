@@ -13,6 +13,7 @@
 
 #include <iostream>
 #include <cmath>
+#include <functional>
 
 using namespace std;
 
@@ -611,6 +612,121 @@ TEST_F(OSDMapTest, PrimaryTempRespected) {
   EXPECT_EQ(acting_primary, acting_osds[1]);
 }
 
+TEST_F(OSDMapTest, IncrementalMapping) {
+  set_up_map();
+
+  ThreadPool tp(g_ceph_context, "IncrementalMapping::tp", "mapping_tp", 2);
+  tp.start();
+  ParallelPGMapper mapper(g_ceph_context, &tp);
+  mapping.start_update(osdmap, mapper, 64)->wait();
+  ASSERT_EQ(osdmap.get_epoch(), mapping.get_epoch());
+
+  pg_t pgid = osdmap.raw_pg_to_pg(pg_t(0, my_rep_pool));
+  vector<int> up_osds, acting_osds;
+  int up_primary, acting_primary;
+  osdmap.pg_to_up_acting_osds(pgid, &up_osds, &up_primary,
+                              &acting_osds, &acting_primary);
+
+  // a pg_temp only remaps its own pg
+  OSDMap::Incremental pgtemp_inc(osdmap.get_epoch() + 1);
+  vector<int> new_acting_osds(acting_osds.rbegin(), acting_osds.rend());
+  pgtemp_inc.new_pg_temp[pgid] = mempool::osdmap::vector<int>(
+    new_acting_osds.begin(), new_acting_osds.end());
+  set<pg_t> remapped;
+  ASSERT_TRUE(pgtemp_inc.get_remapped_pgs(osdmap, &remapped));
+  ASSERT_EQ(set<pg_t>{pgid}, remapped);
+  osdmap.apply_incremental(pgtemp_inc);
+  mapping.note_remapped_pgs(osdmap.get_epoch(), std::move(remapped));
+
+  mapping.start_update(osdmap, mapper, 64)->wait();
+  ASSERT_EQ(osdmap.get_epoch(), mapping.get_epoch());
+  vector<int> acting2;
+  mapping.get(pgid, nullptr, nullptr, &acting2, nullptr);
+  ASSERT_EQ(new_acting_osds, acting2);
+
+  // marking an osd out may move any pg
+  OSDMap::Incremental out_inc(osdmap.get_epoch() + 1);
+  out_inc.new_weight[0] = CEPH_OSD_OUT;
+  remapped.clear();
+  ASSERT_FALSE(out_inc.get_remapped_pgs(osdmap, &remapped));
+  osdmap.apply_incremental(out_inc);
+
+  mapping.start_update(osdmap, mapper, 64)->wait();
+  ASSERT_EQ(osdmap.get_epoch(), mapping.get_epoch());
+  for (auto& [poolid, pool] : osdmap.get_pools()) {
+    for (unsigned ps = 0; ps < pool.get_pg_num(); ++ps) {
+      pg_t pg(ps, poolid);
+      osdmap.pg_to_up_acting_osds(pg, &up_osds, &up_primary,
+                                  &acting_osds, &acting_primary);
+      mapping.get(pg, nullptr, nullptr, &acting2, nullptr);
+      ASSERT_EQ(acting_osds, acting2);
+    }
+  }
+  tp.stop();
+}
+
+TEST_F(OSDMapTest, MayRemapAllPgs) {
+  set_up_map();
+  set<int64_t> changed_pools;
+
+  // pg_temp and upmap entries only remap the pgs they name
+  {
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    pg_t pgid = osdmap.raw_pg_to_pg(pg_t(0, my_rep_pool));
+    inc.new_pg_temp[pgid] = mempool::osdmap::vector<int>{0, 1, 2};
+    inc.old_pg_upmap_items.insert(pgid);
+    ASSERT_FALSE(inc.may_remap_all_pgs(osdmap, &changed_pools));
+    ASSERT_TRUE(changed_pools.empty());
+  }
+  // state bits other than UP and EXISTS do not affect placement
+  {
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_state[0] = CEPH_OSD_NOUP;
+    ASSERT_FALSE(inc.may_remap_all_pgs(osdmap, &changed_pools));
+    inc.new_state[1] = CEPH_OSD_UP;
+    ASSERT_TRUE(inc.may_remap_all_pgs(osdmap, &changed_pools));
+  }
+  for (auto inc_setup : std::initializer_list<
+	 std::function<void(OSDMap::Incremental&)>>{
+      [](auto& inc) { inc.new_weight[0] = CEPH_OSD_OUT; },
+      [](auto& inc) { inc.new_primary_affinity[0] = 0; },
+      [](auto& inc) { inc.new_max_osd = 12; },
+      [](auto& inc) { inc.new_crush_node_flags[-1] = CEPH_OSD_NOOUT; },
+      [](auto& inc) { inc.new_device_class_flags[0] = CEPH_OSD_NOOUT; }}) {
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc_setup(inc);
+    ASSERT_TRUE(inc.may_remap_all_pgs(osdmap, &changed_pools));
+  }
+  changed_pools.clear();
+
+  // pool updates only matter if they move the pool's pgs
+  {
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    pg_pool_t quota = *osdmap.get_pg_pool(my_ec_pool);
+    quota.quota_max_bytes = 1 << 20;
+    quota.set_flag(pg_pool_t::FLAG_FULL_QUOTA);
+    inc.new_pools[my_ec_pool] = quota;
+    pg_pool_t unhashed = *osdmap.get_pg_pool(my_rep_pool);
+    ASSERT_TRUE(unhashed.has_flag(pg_pool_t::FLAG_HASHPSPOOL));
+    unhashed.unset_flag(pg_pool_t::FLAG_HASHPSPOOL);
+    inc.new_pools[my_rep_pool] = unhashed;
+    ASSERT_FALSE(inc.may_remap_all_pgs(osdmap, &changed_pools));
+    ASSERT_EQ(set<int64_t>{my_rep_pool}, changed_pools);
+    set<pg_t> remapped;
+    ASSERT_FALSE(inc.get_remapped_pgs(osdmap, &remapped));
+  }
+  changed_pools.clear();
+  {
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.old_pools.insert(my_rep_pool);
+    pg_pool_t split = *osdmap.get_pg_pool(my_ec_pool);
+    split.set_pg_num(split.get_pg_num() * 2);
+    inc.new_pools[my_ec_pool] = split;
+    ASSERT_FALSE(inc.may_remap_all_pgs(osdmap, &changed_pools));
+    ASSERT_EQ((set<int64_t>{my_ec_pool, my_rep_pool}), changed_pools);
+  }
+}
+
 TEST_F(OSDMapTest, CleanTemps) {
   set_up_map();
 
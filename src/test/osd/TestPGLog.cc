@@ -2234,7 +2234,7 @@ TEST_F(PGLogTest, ErrorNotIndexedByObject) {
   log.add(modify);
 
   EXPECT_TRUE(log.logged_object(oid));
-  pg_log_entry_t *entry = log.objects[oid];
+  pg_log_entry_t *entry = log.objects.find(oid)->second;
   EXPECT_EQ(modify.op, entry->op);
   EXPECT_EQ(modify.version, entry->version);
   EXPECT_EQ(modify.prior_version, entry->prior_version);
@@ -2248,7 +2248,7 @@ TEST_F(PGLogTest, ErrorNotIndexedByObject) {
   log.add(del);
 
   EXPECT_TRUE(log.logged_object(oid));
-  entry = log.objects[oid];
+  entry = log.objects.find(oid)->second;
   EXPECT_EQ(del.op, entry->op);
   EXPECT_EQ(del.version, entry->version);
   EXPECT_EQ(del.prior_version, entry->prior_version);
@@ -2261,7 +2261,7 @@ TEST_F(PGLogTest, ErrorNotIndexedByObject) {
 		   utime_t(20,1), -ENOENT));
 
   EXPECT_TRUE(log.logged_object(oid));
-  entry = log.objects[oid];
+  entry = log.objects.find(oid)->second;
   EXPECT_EQ(del.op, entry->op);
   EXPECT_EQ(del.version, entry->version);
   EXPECT_EQ(del.prior_version, entry->prior_version);
@@ -2673,6 +2673,74 @@ TEST_F(PGLogMergeDupsTest, Superset) {
   check_index();
 }
 
+// trimmed entries and dups are removed from the store by key range,
+// which must leave every key that is still in the log behind
+TEST_F(PGLogMergeDupsTest, TrimByKeyRange) {
+  hobject_t hoid;
+  hoid.pool = 1;
+  hoid.oid = "log";
+  ghobject_t log_oid(hoid);
+  auto ch = store->open_collection(test_coll);
+  auto write = [&] {
+    ObjectStore::Transaction t;
+    map<string, bufferlist> km;
+    write_log_and_missing(t, &km, test_coll, log_oid, false);
+    if (!km.empty()) {
+      t.omap_setkeys(test_coll, log_oid, km);
+    }
+    ASSERT_EQ(0, store->queue_transaction(ch, std::move(t)));
+  };
+  auto count_keys = [&](unsigned *entries, unsigned *dups) {
+    set<string> keys;
+    ASSERT_EQ(0, store->omap_get_keys(ch, log_oid, &keys));
+    *entries = *dups = 0;
+    for (auto& k : keys) {
+      if (k.compare(0, 4, "dup_") == 0) {
+	++*dups;
+      } else if (isdigit(k[0])) {
+	++*entries;
+      }
+    }
+  };
+
+  log.tail = eversion_t(1, 0);
+  for (unsigned i = 1; i <= 20; ++i) {
+    add(pg_log_entry_t(pg_log_entry_t::MODIFY,
+		       hobject_t(object_t("obj"), "", i, i, 1, ""),
+		       eversion_t(1, i), eversion_t(1, i - 1), i,
+		       osd_reqid_t(entity_name_t::CLIENT(777), 8, i),
+		       utime_t(), 0));
+  }
+  log.skip_can_rollback_to_to_head();
+  write();
+
+  unsigned entries, dups;
+  count_keys(&entries, &dups);
+  EXPECT_EQ(20u, entries);
+  EXPECT_EQ(0u, dups);
+
+  pg_info_t info;
+  info.last_complete = log.head;
+  trim(eversion_t(1, 5), info);
+  trim(eversion_t(1, 12), info);
+  write();
+
+  count_keys(&entries, &dups);
+  EXPECT_EQ(8u, entries);
+  EXPECT_EQ(12u, dups);
+  EXPECT_EQ(log.log.size(), entries);
+
+  g_ceph_context->_conf.set_val_or_die("osd_pg_log_dups_tracked", "10");
+  trim(eversion_t(1, 15), info);
+  write();
+  g_ceph_context->_conf.rm_val("osd_pg_log_dups_tracked");
+
+  count_keys(&entries, &dups);
+  EXPECT_EQ(5u, entries);
+  EXPECT_EQ(log.dups.size(), dups);
+  EXPECT_EQ(eversion_t(1, 15), log.dups.back().version);
+}
+
 
 struct PGLogTrimTest :
   public ::testing::Test,
@@ -3027,6 +3095,58 @@ TEST_F(PGLogTrimTest, TestTrimDups) {
   EXPECT_EQ(4u, log.dups.size()) << log;
 }
 
+// The indexes refer to the keys stored in the entries and dups rather
+// than keeping copies of their own, so they stay small and are charged
+// to the osd_pglog mempool.
+TEST_F(PGLogTrimTest, TestIndexMemory) {
+  const unsigned num = 3000;
+  const unsigned keep = 100;
+  SetUp(num);
+  PGLog::IndexedLog log;
+  log.head = mk_evt(10, num);
+  log.skip_can_rollback_to_to_head();
+  log.tail = mk_evt(10, 0);
+  log.head = mk_evt(10, 0);
+
+  entity_name_t client = entity_name_t::CLIENT(777);
+  for (unsigned i = 1; i <= num; ++i) {
+    log.add(mk_ple_mod(mk_obj(i), mk_evt(10, i), mk_evt(10, i - 1),
+		       osd_reqid_t(client, 8, i)));
+  }
+
+  size_t before = mempool::osd_pglog::allocated_bytes();
+  log.index();
+  size_t index_bytes = mempool::osd_pglog::allocated_bytes() - before;
+  std::cout << "objects + caller_ops index: " << index_bytes / num
+	    << " bytes per entry" << std::endl;
+  EXPECT_EQ(num, log.objects.size());
+  EXPECT_EQ(num, log.caller_ops.size());
+  EXPECT_LT(index_bytes, num * 2 * 64);
+  EXPECT_EQ(mk_evt(10, num / 2), log.objects.find(mk_obj(num / 2))->second->version);
+
+  auto start = ceph::mono_clock::now();
+  log.trim(cct, mk_evt(10, num - keep), nullptr, nullptr, nullptr);
+  std::cout << "trim of " << num - keep << " entries took "
+	    << ceph::mono_clock::now() - start << std::endl;
+
+  EXPECT_EQ(keep, log.log.size());
+  EXPECT_EQ(keep, log.objects.size());
+  EXPECT_EQ(num - keep, log.dups.size());
+  EXPECT_EQ(log.dups.size(), log.dup_index.size());
+  EXPECT_EQ(0u, log.objects.count(mk_obj(1)));
+
+  eversion_t version;
+  version_t user_version;
+  int return_code;
+  std::vector<pg_log_op_return_item_t> op_returns;
+  EXPECT_TRUE(log.get_request(osd_reqid_t(client, 8, 1), &version,
+			      &user_version, &return_code, &op_returns));
+  EXPECT_EQ(mk_evt(10, 1), version);
+  EXPECT_TRUE(log.get_request(osd_reqid_t(client, 8, num), &version,
+			      &user_version, &return_code, &op_returns));
+  EXPECT_EQ(mk_evt(10, num), version);
+}
+
 // This tests trim() to make copies of
 // 4 log entries (107, 106, 105, 104) and 5 additional for a total
 // of 9 dups.  Only 1 of 2 existing dups are copied.
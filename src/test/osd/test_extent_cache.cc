@@ -280,3 +280,41 @@ TEST(extentcache, write_write_overlap2)
 
   c.release_write_pin(pin3);
 }
+
+TEST(extentcache, retained)
+{
+  hobject_t oid;
+
+  ExtentCache c;
+  ExtentCache::write_pin pin;
+  c.open_write_pin(pin);
+
+  auto to_write = iset_from_vector({{0, 10}, {20, 10}});
+  auto must_read = c.reserve_extents_for_rmw(
+    oid, pin, to_write, to_write);
+  ASSERT_EQ(must_read, to_write);
+  c.present_rmw_update(oid, pin, imap_from_iset(to_write));
+  c.release_write_pin(pin, 15);
+  // only the more recently written extent fits
+  ASSERT_EQ(c.get_retained_bytes(), 10u);
+
+  // a second write over the retained extent needs no read
+  ExtentCache::write_pin pin2;
+  c.open_write_pin(pin2);
+  auto to_write2 = iset_from_vector({{20, 20}});
+  auto to_read2 = iset_from_vector({{20, 20}});
+  must_read = c.reserve_extents_for_rmw(
+    oid, pin2, to_write2, to_read2);
+  ASSERT_EQ(must_read, iset_from_vector({{30, 10}}));
+  ASSERT_EQ(c.get_retained_bytes(), 0u);
+
+  auto pending = c.get_remaining_extents_for_rmw(
+    oid, pin2, iset_from_vector({{20, 10}}));
+  ASSERT_EQ(pending.get_interval_set(), iset_from_vector({{20, 10}}));
+  c.present_rmw_update(oid, pin2, imap_from_iset(to_write2));
+  c.release_write_pin(pin2, 100);
+  ASSERT_EQ(c.get_retained_bytes(), 20u);
+
+  c.discard_retained();
+  ASSERT_EQ(c.get_retained_bytes(), 0u);
+}
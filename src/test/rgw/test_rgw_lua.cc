@@ -266,6 +266,26 @@ TEST(TestRGWLua, URI)
   ASSERT_EQ(rc, 0);
 }
 
+TEST(TestRGWLua, CachedScript)
+{
+  const std::string script = R"(
+    assert(Request.DecodedURI == "http://hello.world/")
+  )";
+
+  // later executions run from the cached bytecode
+  // but must still see the request they run for
+  for (auto i = 0; i < 2; ++i) {
+    DEFINE_REQ_STATE;
+    s.decoded_uri = "http://hello.world/";
+    const auto rc = lua::request::execute(nullptr, nullptr, nullptr, &s, nullptr, script);
+    ASSERT_EQ(rc, 0);
+  }
+  DEFINE_REQ_STATE;
+  s.decoded_uri = "http://goodbye.world/";
+  const auto rc = lua::request::execute(nullptr, nullptr, nullptr, &s, nullptr, script);
+  ASSERT_EQ(rc, -1);
+}
+
 TEST(TestRGWLua, Response)
 {
   const std::string script = R"(
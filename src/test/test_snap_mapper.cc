@@ -373,6 +373,33 @@ public:
       cur = next.first;
     }
   }
+  void get_next_batch() {
+    string cur;
+    const unsigned max = 1 + (random_size() % 5);
+    while (true) {
+      vector<pair<string, bufferlist>> batch;
+      int r = cache->get_next_batch(cur, max, &batch);
+
+      vector<pair<string, bufferlist>> batch_truth;
+      for (auto i = truth.upper_bound(cur);
+	   i != truth.end() && batch_truth.size() < max;
+	   ++i) {
+	batch_truth.push_back(*i);
+      }
+      int r_truth = batch_truth.empty() ? -ENOENT : 0;
+
+      ASSERT_EQ(r, r_truth);
+      if (r == -ENOENT)
+	break;
+
+      ASSERT_EQ(batch.size(), batch_truth.size());
+      for (size_t i = 0; i < batch.size(); ++i) {
+	ASSERT_EQ(batch[i].first, batch_truth[i].first);
+	assert_bl_eq(batch[i].second, batch_truth[i].second);
+      }
+      cur = batch.back().first;
+    }
+  }
   void SetUp() override {
     driver.reset(new PausyAsyncMap());
     cache.reset(new MapCacher::MapCacher<string, bufferlist>(driver.get()));
@@ -427,7 +454,7 @@ TEST_F(MapCacherTest, Random)
     if (!(i % 50)) {
       std::cout << "On iteration " << i << std::endl;
     }
-    switch (rand() % 4) {
+    switch (rand() % 5) {
     case 0:
       get();
       break;
@@ -440,6 +467,9 @@ TEST_F(MapCacherTest, Random)
     case 3:
       remove();
       break;
+    case 4:
+      get_next_batch();
+      break;
     }
   }
 }
@@ -87,3 +87,25 @@ TEST(Striper, GetFileOffset)
           g_ceph_context, &l, object_no, object_off);
   ASSERT_EQ(26549568u, file_offset);
 }
+
+TEST(Striper, LightweightExtentsStayInline)
+{
+  file_layout_t l;
+
+  l.object_size = 262144;
+  l.stripe_unit = 4096;
+  l.stripe_count = 3;
+
+  // one full stripe touches every object once; the common case should
+  // fit in the small_vector storage without touching the heap
+  striper::LightweightObjectExtents ex;
+  auto inline_capacity = ex.capacity();
+  Striper::file_to_extents(g_ceph_context, &l, 4096 * 3, 4096 * 3, 0, 0, &ex);
+
+  ASSERT_EQ(3u, ex.size());
+  ASSERT_EQ(inline_capacity, ex.capacity());
+  for (auto& e : ex) {
+    ASSERT_EQ(1u, e.buffer_extents.size());
+    ASSERT_EQ(4096u, e.length);
+  }
+}
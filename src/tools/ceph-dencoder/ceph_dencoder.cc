@@ -21,6 +21,7 @@
 #include "ceph_ver.h"
 #include "include/types.h"
 #include "common/Formatter.h"
+#include "common/ceph_time.h"
 #include "common/ceph_argparse.h"
 #include "common/errno.h"
 #include "denc_plugin.h"
@@ -60,6 +61,9 @@ void usage(ostream &out)
   out << "  count_tests         print number of generated test objects (to stdout)\n";
   out << "  select_test <n>     select generated test object as in-memory object\n";
   out << "  is_deterministic    exit w/ success if type encodes deterministically\n";
+  out << "\n";
+  out << "  bench_encode <n>    time <n> encodes of the in-memory object (ns/op to stdout)\n";
+  out << "  bench_decode <n>    time <n> decodes of the encoded data (ns/op to stdout)\n";
 }
 
 vector<DencoderPlugin> load_plugins()
@@ -263,6 +267,39 @@ int main(int argc, const char **argv)
 	return 0;
       else
 	return 1;
+    } else if (*i == string("bench_encode") ||
+	       *i == string("bench_decode")) {
+      if (!den) {
+	cerr << "must first select type with 'type <name>'" << std::endl;
+	return 1;
+      }
+      bool is_encode = (*i == string("bench_encode"));
+      ++i;
+      if (i == args.end()) {
+	cerr << "expecting iteration count" << std::endl;
+	return 1;
+      }
+      long n = atol(*i);
+      if (n <= 0) {
+	cerr << "iteration count must be positive" << std::endl;
+	return 1;
+      }
+      auto start = ceph::mono_clock::now();
+      for (long j = 0; j < n && err.empty(); ++j) {
+	if (is_encode) {
+	  bufferlist bl;
+	  den->encode(bl, features | CEPH_FEATURE_RESERVED);
+	} else {
+	  err = den->decode(encbl, skip);
+	}
+      }
+      auto elapsed = ceph::mono_clock::now() - start;
+      if (err.empty()) {
+	cout << (is_encode ? "encode" : "decode") << ": " << n
+	     << " iterations, "
+	     << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / n
+	     << " ns/op" << std::endl;
+      }
     } else {
       cerr << "unknown option '" << *i << "'" << std::endl;
       return 1;
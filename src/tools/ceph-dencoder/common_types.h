@@ -144,6 +144,7 @@ TYPE(cls_queue_init_op)
 #include "cls/2pc_queue/cls_2pc_queue_ops.h"
 TYPE(cls_2pc_queue_abort_op)
 TYPE(cls_2pc_queue_commit_op)
+TYPE(cls_2pc_queue_commit_batch_op)
 TYPE(cls_2pc_queue_expire_op)
 TYPE_NONDETERMINISTIC(cls_2pc_queue_reservations_ret)
 TYPE(cls_2pc_queue_reserve_op)
@@ -109,10 +109,12 @@ po::options_description make_usage() {
      ": perform a chunk dedup---deduplicate only a chunk, which is a part of object.")
     ("op object-dedup --pool <POOL> --object <OID> --chunk-pool <POOL> --fingerprint-algorithm <FP> --dedup-cdc-chunk-size <CHUNK_SIZE> [--snap]",
      ": perform a object dedup---deduplicate the entire object, not a chunk. Related snapshots are also deduplicated if --snap is given")
+    ("op chunk-bench --chunk-size <CHUNK_SIZE> --chunk-algorithm <ALGO> --fingerprint-algorithm <FP_ALGO> [--bench-size <BYTES>]",
+     ": measure local chunking and fingerprinting throughput, without a cluster")
     ;
   po::options_description op_desc("Opational arguments");
   op_desc.add_options()
-    ("op", po::value<std::string>(), ": estimate|chunk-scrub|chunk-get-ref|chunk-put-ref|chunk-repair|dump-chunk-refs|chunk-dedup|object-dedup")
+    ("op", po::value<std::string>(), ": estimate|chunk-scrub|chunk-get-ref|chunk-put-ref|chunk-repair|dump-chunk-refs|chunk-dedup|object-dedup|chunk-bench")
     ("target-ref", po::value<std::string>(), ": set target object")
     ("target-ref-pool-id", po::value<uint64_t>(), ": set target pool id")
     ("object", po::value<std::string>(), ": set object name")
@@ -130,6 +132,7 @@ po::options_description make_usage() {
     ("source-off", po::value<uint64_t>(), ": set source offset")
     ("source-length", po::value<uint64_t>(), ": set source length")
     ("dedup-cdc-chunk-size", po::value<unsigned int>(), ": set dedup chunk size for cdc")
+    ("bench-size", po::value<int>()->default_value(64 << 20), ": bytes of generated data for chunk-bench")
     ("snap", ": deduplciate snapshotted object")
     ("debug", ": enable debug")
     ("pgid", ": set pgid")
@@ -657,6 +660,74 @@ int estimate_dedup_ratio(const po::variables_map &opts)
   return (ret < 0) ? 1 : 0;
 }
 
+int chunk_bench(const po::variables_map &opts)
+{
+  string chunk_algo = get_opts_chunk_algo(opts);
+  string fp_algo = get_opts_fp_algo(opts);
+  uint64_t chunk_size = 8192;
+  if (opts.count("chunk-size")) {
+    chunk_size = opts["chunk-size"].as<int>();
+  } else {
+    cout << "8192 is set as chunk size by default" << std::endl;
+  }
+  int bench_size = opts["bench-size"].as<int>();
+  if (bench_size <= 0) {
+    cerr << "bench-size must be positive" << std::endl;
+    return 1;
+  }
+
+  bufferlist bl;
+  generate_buffer(bench_size, &bl);
+  // calc_chunks and the digests want contiguous input, like reads from the OSD
+  bl.rebuild();
+
+  auto cdc = CDC::create(chunk_algo, cbits(chunk_size) - 1);
+  vector<pair<uint64_t, uint64_t>> chunks;
+  utime_t start = ceph_clock_now();
+  cdc->calc_chunks(bl, &chunks);
+  const double chunk_secs = (double)(ceph_clock_now() - start);
+
+  auto fingerprint = [&fp_algo](const bufferlist& chunk) -> string {
+    if (fp_algo == "sha1") {
+      return ceph::crypto::digest<ceph::crypto::SHA1>(chunk).to_str();
+    } else if (fp_algo == "sha256") {
+      return ceph::crypto::digest<ceph::crypto::SHA256>(chunk).to_str();
+    } else {
+      return ceph::crypto::digest<ceph::crypto::SHA512>(chunk).to_str();
+    }
+  };
+  set<string> fingerprints;
+  start = ceph_clock_now();
+  for (auto& [off, len] : chunks) {
+    bufferlist chunk;
+    chunk.substr_of(bl, off, len);
+    fingerprints.insert(fingerprint(chunk));
+  }
+  const double fp_secs = (double)(ceph_clock_now() - start);
+
+  auto mb_per_sec = [bench_size](double secs) {
+    return secs > 0 ? (double)bench_size / (1024 * 1024) / secs : 0.0;
+  };
+  auto f = Formatter::create("json-pretty");
+  f->open_object_section("chunk_bench");
+  f->dump_string("chunk_algo", chunk_algo);
+  f->dump_string("fingerprint_algo", fp_algo);
+  f->dump_unsigned("target_chunk_size", chunk_size);
+  f->dump_unsigned("bench_bytes", bench_size);
+  f->dump_unsigned("chunks", chunks.size());
+  f->dump_unsigned("unique_chunks", fingerprints.size());
+  f->dump_unsigned("chunk_size_average",
+		   chunks.empty() ? 0 : bench_size / chunks.size());
+  f->dump_float("chunking_mb_per_sec", mb_per_sec(chunk_secs));
+  f->dump_float("fingerprint_mb_per_sec", mb_per_sec(fp_secs));
+  f->dump_float("combined_mb_per_sec", mb_per_sec(chunk_secs + fp_secs));
+  f->close_section();
+  f->flush(cout);
+  cout << std::endl;
+  delete f;
+  return 0;
+}
+
 static void print_chunk_scrub()
 {
   uint64_t total_objects = 0;
@@ -1134,6 +1205,8 @@ int main(int argc, const char **argv)
      *
      */
     ret = make_dedup_object(opts);
+  } else if (op_name == "chunk-bench") {
+    ret = chunk_bench(opts);
   } else {
     cerr << "unrecognized op " << op_name << std::endl;
     exit(1);
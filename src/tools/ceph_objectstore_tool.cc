@@ -76,6 +76,7 @@ const ssize_t max_read = 1024 * 1024;
 const int fd_none = INT_MIN;
 bool outistty;
 bool dry_run;
+unsigned import_queue_depth = 1;
 
 struct action_on_object_t {
   virtual ~action_on_object_t() {}
@@ -554,6 +555,29 @@ void wait_until_done(ObjectStore::Transaction* txn, Func&& func)
   cond.wait(lock, [&] {return finished;});
 }
 
+// bounds how many per-object import transactions are queued but not yet
+// complete when --import-queue-depth is above 1
+struct import_window_t {
+  std::mutex m;
+  std::condition_variable cond;
+  unsigned in_flight = 0;
+
+  void get(unsigned max) {
+    std::unique_lock lock{m};
+    cond.wait(lock, [&] {return in_flight < max;});
+    ++in_flight;
+  }
+  void put() {
+    std::lock_guard lock{m};
+    --in_flight;
+    cond.notify_all();
+  }
+  void wait_all() {
+    std::unique_lock lock{m};
+    cond.wait(lock, [&] {return in_flight == 0;});
+  }
+} import_window;
+
 int initiate_new_remove_pg(ObjectStore *store, spg_t r_pgid)
 {
   if (!dry_run)
@@ -1626,10 +1650,20 @@ int ObjectStoreTool::get_object(ObjectStore *store,
     }
   }
   if (!dry_run) {
-    wait_until_done(t, [&] {
+    if (import_queue_depth > 1) {
+      // later objects may look at this one (clones before head), which
+      // works as queued writes are visible to readers of the collection
+      import_window.get(import_queue_depth);
+      t->register_on_complete(make_lambda_context([](int) {
+        import_window.put();
+      }));
       store->queue_transaction(ch, std::move(*t));
-      ch->flush();
-    });
+    } else {
+      wait_until_done(t, [&] {
+        store->queue_transaction(ch, std::move(*t));
+        ch->flush();
+      });
+    }
   }
   return 0;
 }
@@ -2202,6 +2236,7 @@ int ObjectStoreTool::do_import(ObjectStore *store, OSDSuperblock& sb,
       // make sure we flush onreadable items before mapper/driver are destroyed.
       ch->flush();
     });
+    import_window.wait_all();
   }
   return 0;
 }
@@ -3518,6 +3553,8 @@ int main(int argc, char **argv)
       "Threshold (in seconds) to consider omap listing slow (for op=list-slow-omap)")
     ("dump-data-dir", po::value<string>(&dump_data_dir),
      "Directory to dump object data (for op=dump-export)")
+    ("import-queue-depth", po::value<unsigned>(&import_queue_depth),
+     "Number of object transactions to keep queued during op=import (default 1, wait for each object)")
     ;
 
   po::options_description positional("Positional options");
@@ -646,8 +646,11 @@ int PeerReplayer::copy_to_remote(const std::string &dir_root,  const std::string
   dout(10) << ": dir_root=" << dir_root << ", epath=" << epath << dendl;
   int l_fd;
   int r_fd;
+  int p_fd = -1;
   void *ptr;
+  void *p_ptr = nullptr;
   struct iovec iov[NR_IOVECS];
+  uint64_t off = 0;
 
   int r = ceph_openat(m_local_mount, fh.c_fd, epath.c_str(), O_RDONLY | O_NOFOLLOW, 0);
   if (r < 0) {
@@ -657,20 +660,52 @@ int PeerReplayer::copy_to_remote(const std::string &dir_root,  const std::string
   }
 
   l_fd = r;
-  r = ceph_openat(m_remote_mount, fh.r_fd_dir_root, epath.c_str(),
-                  O_CREAT | O_TRUNC | O_WRONLY | O_NOFOLLOW, stx.stx_mode);
+
+  // when comparing against the previous local snapshot the remote file
+  // holds the previous snapshot's data, so only changed blocks need to
+  // be transferred.
+  if (fh.p_mnt == m_local_mount &&
+      g_ceph_context->_conf.get_val<bool>("cephfs_mirror_delta_sync")) {
+    struct ceph_statx pstx;
+    r = ceph_statxat(fh.p_mnt, fh.p_fd, epath.c_str(), &pstx, CEPH_STATX_MODE,
+                     AT_STATX_DONT_SYNC | AT_SYMLINK_NOFOLLOW);
+    if (r == 0 && S_ISREG(pstx.stx_mode)) {
+      r = ceph_openat(fh.p_mnt, fh.p_fd, epath.c_str(), O_RDONLY | O_NOFOLLOW, 0);
+      if (r >= 0) {
+        p_fd = r;
+      }
+    }
+  }
+
+  if (p_fd >= 0) {
+    r = ceph_openat(m_remote_mount, fh.r_fd_dir_root, epath.c_str(),
+                    O_WRONLY | O_NOFOLLOW, stx.stx_mode);
+    if (r == -ENOENT) {
+      dout(10) << ": remote file path=" << epath << " missing, doing full copy"
+               << dendl;
+      ceph_close(fh.p_mnt, p_fd);
+      p_fd = -1;
+    }
+  }
+  if (p_fd < 0) {
+    r = ceph_openat(m_remote_mount, fh.r_fd_dir_root, epath.c_str(),
+                    O_CREAT | O_TRUNC | O_WRONLY | O_NOFOLLOW, stx.stx_mode);
+  }
   if (r < 0) {
     derr << ": failed to create remote file path=" << epath << ": "
          << cpp_strerror(r) << dendl;
-    goto close_local_fd;
+    goto close_prev_fd;
   }
 
   r_fd = r;
   ptr = malloc(NR_IOVECS * IOVEC_SIZE);
-  if (!ptr) {
+  if (p_fd >= 0) {
+    p_ptr = malloc(NR_IOVECS * IOVEC_SIZE);
+  }
+  if (!ptr || (p_fd >= 0 && !p_ptr)) {
     r = -ENOMEM;
     derr << ": failed to allocate memory" << dendl;
-    goto close_remote_fd;
+    goto free_buffers;
   }
 
   while (true) {
@@ -701,12 +736,52 @@ int PeerReplayer::copy_to_remote(const std::string &dir_root,  const std::string
       ++iovs;
     }
 
-    r = ceph_pwritev(m_remote_mount, r_fd, iov, iovs, -1);
+    if (p_fd < 0) {
+      r = ceph_pwritev(m_remote_mount, r_fd, iov, iovs, -1);
+      if (r < 0) {
+        derr << ": failed to write remote file path=" << epath << ": "
+             << cpp_strerror(r) << dendl;
+        break;
+      }
+      continue;
+    }
+
+    uint64_t len = r;
+    r = ceph_read(fh.p_mnt, p_fd, (char*)p_ptr, len, off);
     if (r < 0) {
-      derr << ": failed to write remote file path=" << epath << ": "
+      derr << ": failed to read prev file path=" << epath << ": "
            << cpp_strerror(r) << dendl;
       break;
     }
+    uint64_t p_len = r;
+    for (int i = 0; i < iovs; ++i) {
+      uint64_t seg_off = IOVEC_SIZE * i;
+      uint64_t seg_len = iov[i].iov_len;
+      if (seg_off + seg_len <= p_len &&
+          memcmp(iov[i].iov_base, (char*)p_ptr + seg_off, seg_len) == 0) {
+        continue;
+      }
+      r = ceph_write(m_remote_mount, r_fd, (char*)iov[i].iov_base, seg_len,
+                     off + seg_off);
+      if (r < 0) {
+        derr << ": failed to write remote file path=" << epath << ": "
+             << cpp_strerror(r) << dendl;
+        break;
+      }
+    }
+    if (r < 0) {
+      break;
+    }
+    off += len;
+    r = 0;
+  }
+
+  if (r == 0 && p_fd >= 0) {
+    r = ceph_ftruncate(m_remote_mount, r_fd, stx.stx_size);
+    if (r < 0) {
+      derr << ": failed to truncate remote file path=" << epath << ": "
+           << cpp_strerror(r) << dendl;
+    }
   }
 
   if (r == 0) {
@@ -717,16 +792,23 @@ int PeerReplayer::copy_to_remote(const std::string &dir_root,  const std::string
     }
   }
 
+free_buffers:
   free(ptr);
+  free(p_ptr);
 
-close_remote_fd:
   if (ceph_close(m_remote_mount, r_fd) < 0) {
     derr << ": failed to close remote fd path=" << epath << ": " << cpp_strerror(r)
          << dendl;
-    return -EINVAL;
+    r = -EINVAL;
+  }
+
+close_prev_fd:
+  if (p_fd >= 0 && ceph_close(fh.p_mnt, p_fd) < 0) {
+    derr << ": failed to close prev fd path=" << epath << ": " << cpp_strerror(r)
+         << dendl;
+    r = -EINVAL;
   }
 
-close_local_fd:
   if (ceph_close(m_local_mount, l_fd) < 0) {
     derr << ": failed to close local fd path=" << epath << ": " << cpp_strerror(r)
          << dendl;
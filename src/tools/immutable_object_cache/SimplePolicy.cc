@@ -14,13 +14,15 @@ namespace ceph {
 namespace immutable_obj_cache {
 
 SimplePolicy::SimplePolicy(CephContext *cct, uint64_t cache_size,
-                           uint64_t max_inflight, double watermark)
+                           uint64_t max_inflight, double watermark,
+                           uint64_t promote_threshold)
   : cct(cct), m_watermark(watermark), m_max_inflight_ops(max_inflight),
-    m_max_cache_size(cache_size) {
+    m_max_cache_size(cache_size), m_promote_threshold(promote_threshold) {
 
   ldout(cct, 20) << "max cache size= " << m_max_cache_size
                  << " ,watermark= " << m_watermark
-                 << " ,max inflight ops= " << m_max_inflight_ops << dendl;
+                 << " ,max inflight ops= " << m_max_inflight_ops
+                 << " ,promote threshold= " << m_promote_threshold << dendl;
 
   m_cache_size = 0;
 
@@ -60,15 +62,38 @@ cache_status_t SimplePolicy::alloc_entry(std::string file_name) {
   return OBJ_CACHE_SKIP;
 }
 
+bool SimplePolicy::should_promote(const std::string& file_name) {
+  if (m_promote_threshold <= 1) {
+    return true;
+  }
+
+  std::lock_guard locker{m_miss_count_lock};
+  auto [it, inserted] = m_miss_count.try_emplace(file_name, 0);
+  if (++it->second < m_promote_threshold) {
+    // forget everything once the table gets large rather than tracking
+    // every object ever read; objects that are really hot recover quickly
+    if (inserted && m_miss_count.size() > MAX_TRACKED_MISSES) {
+      m_miss_count.clear();
+    }
+    return false;
+  }
+  m_miss_count.erase(it);
+  return true;
+}
+
 cache_status_t SimplePolicy::lookup_object(std::string file_name) {
   ldout(cct, 20) << "lookup: " << file_name << dendl;
 
   std::shared_lock rlocker{m_cache_map_lock};
 
   auto entry_it = m_cache_map.find(file_name);
-  // simply promote on first lookup
+  // promote once the object has been read often enough
   if (entry_it == m_cache_map.end()) {
       rlocker.unlock();
+      if (!should_promote(file_name)) {
+        ldout(cct, 20) << "not promoting yet: " << file_name << dendl;
+        return OBJ_CACHE_SKIP;
+      }
       return alloc_entry(file_name);
   }
 
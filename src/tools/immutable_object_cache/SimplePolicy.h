@@ -18,7 +18,7 @@ namespace immutable_obj_cache {
 class SimplePolicy : public Policy {
  public:
   SimplePolicy(CephContext *cct, uint64_t block_num, uint64_t max_inflight,
-               double watermark);
+               double watermark, uint64_t promote_threshold = 1);
   ~SimplePolicy();
 
   cache_status_t lookup_object(std::string file_name);
@@ -39,6 +39,7 @@ class SimplePolicy : public Policy {
 
  private:
   cache_status_t alloc_entry(std::string file_name);
+  bool should_promote(const std::string& file_name);
 
   class Entry : public LRUObject {
    public:
@@ -61,6 +62,13 @@ class SimplePolicy : public Policy {
   std::atomic<uint64_t> m_cache_size;
 
   LRU m_promoted_lru;
+
+  // reads seen for objects not yet promoted, if m_promote_threshold > 1
+  static constexpr size_t MAX_TRACKED_MISSES = 1 << 16;
+  uint64_t m_promote_threshold;
+  std::unordered_map<std::string, uint64_t> m_miss_count;
+  ceph::mutex m_miss_count_lock =
+    ceph::make_mutex("rbd::cache::SimplePolicy::m_miss_count_lock");
 };
 
 }  // namespace immutable_obj_cache
@@ -13,11 +13,13 @@
  */
 
 #include <string>
+#include <thread>
 #include <sys/stat.h>
 
 #include "common/ceph_argparse.h"
 #include "common/errno.h"
 #include "common/safe_io.h"
+#include "common/WorkQueue.h"
 #include "include/random.h"
 #include "mon/health_check.h"
 #include <time.h>
@@ -25,6 +27,7 @@
 
 #include "global/global_init.h"
 #include "osd/OSDMap.h"
+#include "osd/OSDMapMapping.h"
 
 using namespace std;
 
@@ -42,6 +45,7 @@ void usage()
   cout << "   --test-map-pgs [--pool <poolid>] [--pg_num <pg_num>] [--range-first <first> --range-last <last>] map all pgs" << std::endl;
   cout << "   --test-map-pgs-dump [--pool <poolid>] [--range-first <first> --range-last <last>] map all pgs" << std::endl;
   cout << "   --test-map-pgs-dump-all [--pool <poolid>] [--range-first <first> --range-last <last>] map all pgs to osds" << std::endl;
+  cout << "   --test-map-pgs-diff <file> [--pool <poolid>] [--map-threads <n>] compare pg mappings with the osdmap in <file>" << std::endl;
   cout << "   --mark-up-in            mark osds up and in (but do not persist)" << std::endl;
   cout << "   --mark-out <osdid>      mark an osd as out (but do not persist)" << std::endl;
   cout << "   --mark-up <osdid>       mark an osd as up (but do not persist)" << std::endl;
@@ -180,6 +184,8 @@ int main(int argc, const char **argv)
 
   int64_t pg_num = -1;
   bool test_map_pgs_dump_all = false;
+  std::string test_map_pgs_diff;
+  int map_threads = std::max(1u, std::thread::hardware_concurrency());
   bool save = false;
   bool vstart = false;
   bool osd_size_aware = false;
@@ -250,6 +256,17 @@ int main(int argc, const char **argv)
       test_map_pgs_dump = true;
     } else if (ceph_argparse_flag(args, i, "--test-map-pgs-dump-all", (char*)NULL)) {
       test_map_pgs_dump_all = true;
+    } else if (ceph_argparse_witharg(args, i, &val, "--test-map-pgs-diff", (char*)NULL)) {
+      test_map_pgs_diff = val;
+    } else if (ceph_argparse_witharg(args, i, &map_threads, err, "--map-threads", (char*)NULL)) {
+      if (!err.str().empty()) {
+	cerr << err.str() << std::endl;
+	exit(EXIT_FAILURE);
+      }
+      if (map_threads < 1) {
+	cerr << "--map-threads must be at least 1" << std::endl;
+	exit(EXIT_FAILURE);
+      }
     } else if (ceph_argparse_flag(args, i, "--test-random", (char*)NULL)) {
       test_random = true;
     } else if (ceph_argparse_flag(args, i, "--clobber", (char*)NULL)) {
@@ -755,7 +772,8 @@ skip_upmap:
          << ") acting (" << acting << ", p" << acting_primary << ")"
          << std::endl;
   }
-  if (test_map_pgs || test_map_pgs_dump || test_map_pgs_dump_all) {
+  if ((test_map_pgs || test_map_pgs_dump || test_map_pgs_dump_all) &&
+      test_map_pgs_diff.empty()) {
     if (pool != -1 && !osdmap.have_pg_pool(pool)) {
       cerr << "There is no pool " << pool << std::endl;
       exit(1);
@@ -882,6 +900,111 @@ skip_upmap:
         cout << "size " << i << "\t" << size[i] << std::endl;
     }
   }
+  if (!test_map_pgs_diff.empty()) {
+    OSDMap other;
+    bufferlist obl;
+    std::string error;
+    r = obl.read_file(test_map_pgs_diff.c_str(), &error);
+    if (r < 0) {
+      cerr << me << ": couldn't open " << test_map_pgs_diff << ": " << error
+	   << std::endl;
+      exit(1);
+    }
+    try {
+      other.decode(obl);
+    } catch (const buffer::error &e) {
+      cerr << me << ": error decoding osdmap '" << test_map_pgs_diff << "'"
+	   << std::endl;
+      exit(1);
+    }
+
+    // compute both full mappings on a thread pool
+    ThreadPool tp(g_ceph_context, "osdmaptool::map_tp", "osdmaptool_tp",
+		  map_threads);
+    tp.start();
+    ParallelPGMapper mapper(g_ceph_context, &tp);
+    OSDMapMapping before, after;
+    auto before_job = before.start_update(osdmap, mapper, 256);
+    auto after_job = after.start_update(other, mapper, 256);
+    before_job->wait();
+    after_job->wait();
+    tp.stop();
+
+    int n = std::max(osdmap.get_max_osd(), other.get_max_osd());
+    vector<int> moved_in(n, 0);
+    vector<int> moved_out(n, 0);
+    auto valid = [n](int osd) {
+      return osd >= 0 && osd != CRUSH_ITEM_NONE && osd < n;
+    };
+    uint64_t total_pgs = 0, moved_pgs = 0, moved_shards = 0;
+    for (auto& [poolid, pi] : osdmap.get_pools()) {
+      if (pool != -1 && poolid != pool)
+	continue;
+      const pg_pool_t *opi = other.get_pg_pool(poolid);
+      if (!opi) {
+	cout << "pool " << poolid << " not in " << test_map_pgs_diff
+	     << ", skipping" << std::endl;
+	continue;
+      }
+      if (opi->get_pg_num() != pi.get_pg_num()) {
+	cout << "pool " << poolid << " pg_num " << pi.get_pg_num()
+	     << " != " << opi->get_pg_num() << ", skipping" << std::endl;
+	continue;
+      }
+      uint64_t pool_moved = 0;
+      for (unsigned ps = 0; ps < pi.get_pg_num(); ++ps) {
+	pg_t pgid(ps, poolid);
+	vector<int> a, b;
+	before.get(pgid, nullptr, nullptr, &a, nullptr);
+	after.get(pgid, nullptr, nullptr, &b, nullptr);
+	++total_pgs;
+	if (a == b)
+	  continue;
+	++pool_moved;
+	if (pi.is_erasure()) {
+	  // shards are positional
+	  for (size_t i = 0; i < std::max(a.size(), b.size()); ++i) {
+	    int from = i < a.size() ? a[i] : CRUSH_ITEM_NONE;
+	    int to = i < b.size() ? b[i] : CRUSH_ITEM_NONE;
+	    if (from == to)
+	      continue;
+	    if (valid(to)) {
+	      moved_in[to]++;
+	      moved_shards++;
+	    }
+	    if (valid(from))
+	      moved_out[from]++;
+	  }
+	} else {
+	  for (auto osd : b) {
+	    if (valid(osd) && std::find(a.begin(), a.end(), osd) == a.end()) {
+	      moved_in[osd]++;
+	      moved_shards++;
+	    }
+	  }
+	  for (auto osd : a) {
+	    if (valid(osd) && std::find(b.begin(), b.end(), osd) == b.end())
+	      moved_out[osd]++;
+	  }
+	}
+	if (test_map_pgs_dump)
+	  cout << pgid << "\t" << a << "\t" << b << std::endl;
+      }
+      cout << "pool " << poolid << " pg_num " << pi.get_pg_num()
+	   << " moved " << pool_moved << std::endl;
+      moved_pgs += pool_moved;
+    }
+
+    cout << "#osd\tin\tout\n";
+    for (int i = 0; i < n; i++) {
+      if (moved_in[i] || moved_out[i])
+	cout << "osd." << i << "\t" << moved_in[i] << "\t" << moved_out[i]
+	     << std::endl;
+    }
+    cout << " moved pgs " << moved_pgs << "/" << total_pgs
+	 << " (" << (total_pgs ? 100.0 * moved_pgs / total_pgs : 0) << "%)"
+	 << " shards " << moved_shards << std::endl;
+  }
   if (test_crush) {
     int pass = 0;
     while (1) {
@@ -917,7 +1040,7 @@ skip_upmap:
       export_crush.empty() && import_crush.empty() && 
       test_map_pg.empty() && test_map_object.empty() &&
       !test_map_pgs && !test_map_pgs_dump && !test_map_pgs_dump_all &&
-      adjust_crush_weight.empty() && !upmap && !upmap_cleanup && !read) {
+      test_map_pgs_diff.empty() && adjust_crush_weight.empty() && !upmap && !upmap_cleanup && !read) {
     cerr << me << ": no action specified?" << std::endl;
     usage();
   }
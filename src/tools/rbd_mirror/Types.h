@@ -34,6 +34,8 @@ enum {
   l_rbd_mirror_snapshot_local_timestamp,
   l_rbd_mirror_snapshot_last_sync_time,
   l_rbd_mirror_snapshot_last_sync_bytes,
+  l_rbd_mirror_snapshot_sync_copied_objects,
+  l_rbd_mirror_snapshot_sync_total_objects,
   l_rbd_mirror_snapshot_last,
 };
 
@@ -1164,6 +1164,13 @@ void Replayer<I>::handle_copy_image_progress(uint64_t object_number,
     object_number, object_count);
   m_local_object_count = object_count;
 
+  if (m_perf_counters) {
+    m_perf_counters->set(l_rbd_mirror_snapshot_sync_copied_objects,
+                         m_local_mirror_snap_ns.last_copied_object_number);
+    m_perf_counters->set(l_rbd_mirror_snapshot_sync_total_objects,
+                         object_count);
+  }
+
   update_non_primary_snapshot(false);
 }
 
@@ -1606,6 +1613,11 @@ void Replayer<I>::register_perf_counters() {
   plb.add_u64(l_rbd_mirror_snapshot_last_sync_bytes, "last_sync_bytes",
               "Bytes synced for the last snapshot", nullptr, prio,
               unit_t(UNIT_BYTES));
+  plb.add_u64(l_rbd_mirror_snapshot_sync_copied_objects,
+              "sync_copied_objects",
+              "Objects copied for the snapshot being synced", nullptr, prio);
+  plb.add_u64(l_rbd_mirror_snapshot_sync_total_objects, "sync_total_objects",
+              "Objects to copy for the snapshot being synced", nullptr, prio);
 
   m_perf_counters = plb.create_perf_counters();
   g_ceph_context->get_perfcounters_collection()->add(m_perf_counters);
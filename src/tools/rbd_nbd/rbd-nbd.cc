@@ -34,6 +34,9 @@
 #include <unistd.h>
 
 #include <linux/nbd.h>
+#ifndef NBD_FLAG_CAN_MULTI_CONN
+#define NBD_FLAG_CAN_MULTI_CONN (1 << 8)
+#endif
 #include <linux/fs.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
@@ -100,6 +103,7 @@ struct Config {
   int max_part = 255;
   int io_timeout = -1;
   int reattach_timeout = 30;
+  int num_connections = 1;
 
   bool exclusive = false;
   bool notrim = false;
@@ -156,6 +160,7 @@ static void usage()
             << "  --encryption-passphrase-file  Path of file containing passphrase for unlocking image encryption\n"
             << "  --exclusive                   Forbid writes by other clients\n"
             << "  --notrim                      Turn off trim/discard\n"
+            << "  --num-connections <num>       Number of NBD connections (default: 1)\n"
             << "  --io-timeout <sec>            Set nbd IO timeout\n"
             << "  --max_part <limit>            Override for module param max_part\n"
             << "  --nbds_max <limit>            Override for module param nbds_max\n"
@@ -207,17 +212,15 @@ public:
   uint64_t quiesce_watch_handle = 0;
 
 private:
-  int fd;
+  std::vector<int> fds;
   librbd::Image &image;
   Config *cfg;
 
 public:
-  NBDServer(int fd, librbd::Image& image, Config *cfg)
-    : fd(fd)
+  NBDServer(const std::vector<int> &fds, librbd::Image& image, Config *cfg)
+    : fds(fds)
     , image(image)
     , cfg(cfg)
-    , reader_thread(*this, &NBDServer::reader_entry)
-    , writer_thread(*this, &NBDServer::writer_entry)
     , quiesce_thread(*this, &NBDServer::quiesce_entry)
   {
     std::vector<librbd::config_option_t> options;
@@ -244,10 +247,12 @@ private:
   std::atomic<bool> terminated = { false };
   std::atomic<bool> allow_internal_flush = { false };
 
+  class Connection;
+
   struct IOContext
   {
     xlist<IOContext*>::item item;
-    NBDServer *server = nullptr;
+    Connection *conn = nullptr;
     struct nbd_request request;
     struct nbd_reply reply;
     bufferlist data;
@@ -260,63 +265,276 @@ private:
 
   friend std::ostream &operator<<(std::ostream &os, const IOContext &ctx);
 
-  ceph::mutex lock = ceph::make_mutex("NBDServer::Locker");
-  ceph::condition_variable cond;
-  xlist<IOContext*> io_pending;
-  xlist<IOContext*> io_finished;
-
-  void io_start(IOContext *ctx)
+  template <typename T>
+  class ThreadHelper : public Thread
   {
-    std::lock_guard l{lock};
-    io_pending.push_back(&ctx->item);
-  }
+  public:
+    typedef void (T::*entry_func)();
+  private:
+    T &obj;
+    entry_func func;
+  public:
+    ThreadHelper(T &_obj, entry_func _func)
+      :obj(_obj)
+      ,func(_func)
+    {}
+  protected:
+    void* entry() override
+    {
+      (obj.*func)();
+      return NULL;
+    }
+  };
 
-  void io_finish(IOContext *ctx)
+  // a single NBD socket served by its own reader and writer threads
+  class Connection
   {
-    std::lock_guard l{lock};
-    ceph_assert(ctx->item.is_on_list());
-    ctx->item.remove_myself();
-    io_finished.push_back(&ctx->item);
-    cond.notify_all();
-  }
+  public:
+    Connection(NBDServer &server, int fd)
+      : server(server)
+      , fd(fd)
+      , reader_thread(*this, &Connection::reader_entry)
+      , writer_thread(*this, &Connection::writer_entry)
+    {}
 
-  IOContext *wait_io_finish()
-  {
-    std::unique_lock l{lock};
-    cond.wait(l, [this] {
-                   return !io_finished.empty() ||
-                          (io_pending.empty() && terminated);
-                 });
+    void start()
+    {
+      reader_thread.create("rbd_reader");
+      writer_thread.create("rbd_writer");
+    }
 
-    if (io_finished.empty())
-      return NULL;
+    void join()
+    {
+      reader_thread.join();
+      writer_thread.join();
+    }
 
-    IOContext *ret = io_finished.front();
-    io_finished.pop_front();
+    void io_finish(IOContext *ctx)
+    {
+      std::lock_guard l{lock};
+      ceph_assert(ctx->item.is_on_list());
+      ctx->item.remove_myself();
+      io_finished.push_back(&ctx->item);
+      cond.notify_all();
+    }
 
-    return ret;
-  }
+    void assert_clean()
+    {
+      std::unique_lock l{lock};
 
-  void wait_clean()
-  {
-    std::unique_lock l{lock};
-    cond.wait(l, [this] { return io_pending.empty(); });
+      ceph_assert(!reader_thread.is_started());
+      ceph_assert(!writer_thread.is_started());
+      ceph_assert(io_pending.empty());
+      ceph_assert(io_finished.empty());
+    }
 
-    while(!io_finished.empty()) {
-      std::unique_ptr<IOContext> free_ctx(io_finished.front());
+  private:
+    NBDServer &server;
+    int fd;
+
+    ceph::mutex lock = ceph::make_mutex("NBDServer::Connection::Locker");
+    ceph::condition_variable cond;
+    xlist<IOContext*> io_pending;
+    xlist<IOContext*> io_finished;
+    bool terminated = false;
+
+    ThreadHelper<Connection> reader_thread, writer_thread;
+
+    void io_start(IOContext *ctx)
+    {
+      std::lock_guard l{lock};
+      io_pending.push_back(&ctx->item);
+    }
+
+    IOContext *wait_io_finish()
+    {
+      std::unique_lock l{lock};
+      cond.wait(l, [this] {
+                     return !io_finished.empty() ||
+                            (io_pending.empty() && terminated);
+                   });
+
+      if (io_finished.empty())
+        return NULL;
+
+      IOContext *ret = io_finished.front();
       io_finished.pop_front();
+
+      return ret;
     }
-  }
 
-  void assert_clean()
-  {
-    std::unique_lock l{lock};
+    void wait_clean()
+    {
+      std::unique_lock l{lock};
+      cond.wait(l, [this] { return io_pending.empty(); });
 
-    ceph_assert(!reader_thread.is_started());
-    ceph_assert(!writer_thread.is_started());
-    ceph_assert(io_pending.empty());
-    ceph_assert(io_finished.empty());
-  }
+      while(!io_finished.empty()) {
+        std::unique_ptr<IOContext> free_ctx(io_finished.front());
+        io_finished.pop_front();
+      }
+    }
+
+    void reader_entry()
+    {
+      librbd::Image &image = server.image;
+
+      struct pollfd poll_fds[2];
+      memset(poll_fds, 0, sizeof(struct pollfd) * 2);
+      poll_fds[0].fd = fd;
+      poll_fds[0].events = POLLIN;
+      poll_fds[1].fd = server.terminate_event_fd;
+      poll_fds[1].events = POLLIN;
+
+      while (true) {
+        std::unique_ptr<IOContext> ctx(new IOContext());
+        ctx->conn = this;
+
+        dout(20) << __func__ << ": waiting for nbd request" << dendl;
+
+        int r = poll(poll_fds, 2, -1);
+        if (r == -1) {
+          if (errno == EINTR) {
+            continue;
+          }
+          r = -errno;
+          derr << "failed to poll nbd: " << cpp_strerror(r) << dendl;
+          goto error;
+        }
+
+        if ((poll_fds[1].revents & POLLIN) != 0) {
+          dout(0) << __func__ << ": terminate received" << dendl;
+          goto signal;
+        }
+
+        if ((poll_fds[0].revents & POLLIN) == 0) {
+          dout(20) << __func__ << ": nothing to read" << dendl;
+          continue;
+        }
+
+        r = safe_read_exact(fd, &ctx->request, sizeof(struct nbd_request));
+        if (r < 0) {
+	  derr << "failed to read nbd request header: " << cpp_strerror(r)
+	       << dendl;
+	  goto error;
+        }
+
+        if (ctx->request.magic != htonl(NBD_REQUEST_MAGIC)) {
+	  derr << "invalid nbd request header" << dendl;
+	  goto signal;
+        }
+
+        ctx->request.from = big_to_native(ctx->request.from);
+        ctx->request.type = big_to_native(ctx->request.type);
+        ctx->request.len = big_to_native(ctx->request.len);
+
+        ctx->reply.magic = native_to_big<uint32_t>(NBD_REPLY_MAGIC);
+        memcpy(ctx->reply.handle, ctx->request.handle, sizeof(ctx->reply.handle));
+
+        ctx->command = ctx->request.type & 0x0000ffff;
+
+        dout(20) << *ctx << ": start" << dendl;
+
+        switch (ctx->command)
+        {
+          case NBD_CMD_DISC:
+            // NBD_DO_IT will return when pipe is closed
+	    dout(0) << "disconnect request received" << dendl;
+            goto signal;
+          case NBD_CMD_WRITE:
+            bufferptr ptr(ctx->request.len);
+	    r = safe_read_exact(fd, ptr.c_str(), ctx->request.len);
+            if (r < 0) {
+	      derr << *ctx << ": failed to read nbd request data: "
+		   << cpp_strerror(r) << dendl;
+              goto error;
+	    }
+            ctx->data.push_back(ptr);
+            break;
+        }
+
+        IOContext *pctx = ctx.release();
+        io_start(pctx);
+        librbd::RBD::AioCompletion *c = new librbd::RBD::AioCompletion(pctx, aio_callback);
+        switch (pctx->command)
+        {
+          case NBD_CMD_WRITE:
+            image.aio_write(pctx->request.from, pctx->request.len, pctx->data, c);
+            break;
+          case NBD_CMD_READ:
+            image.aio_read(pctx->request.from, pctx->request.len, pctx->data, c);
+            break;
+          case NBD_CMD_FLUSH:
+            image.aio_flush(c);
+            server.allow_internal_flush = true;
+            break;
+          case NBD_CMD_TRIM:
+            image.aio_discard(pctx->request.from, pctx->request.len, c);
+            break;
+          default:
+	    derr << *pctx << ": invalid request command" << dendl;
+            c->release();
+            goto signal;
+        }
+      }
+  error:
+      {
+        int r = netlink_disconnect(nbd_index);
+        if (r == 1) {
+          ioctl(nbd, NBD_DISCONNECT);
+        }
+      }
+  signal:
+      {
+        std::lock_guard l{lock};
+        terminated = true;
+        cond.notify_all();
+      }
+      server.notify_terminated();
+
+      dout(20) << __func__ << ": terminated" << dendl;
+    }
+
+    void writer_entry()
+    {
+      while (true) {
+        dout(20) << __func__ << ": waiting for io request" << dendl;
+        std::unique_ptr<IOContext> ctx(wait_io_finish());
+        if (!ctx) {
+	  dout(20) << __func__ << ": no io requests, terminating" << dendl;
+          goto done;
+        }
+
+        dout(20) << __func__ << ": got: " << *ctx << dendl;
+
+        int r = safe_write(fd, &ctx->reply, sizeof(struct nbd_reply));
+        if (r < 0) {
+	  derr << *ctx << ": failed to write reply header: " << cpp_strerror(r)
+	       << dendl;
+          goto error;
+        }
+        if (ctx->command == NBD_CMD_READ && ctx->reply.error == htonl(0)) {
+	  r = ctx->data.write_fd(fd);
+          if (r < 0) {
+	    derr << *ctx << ": failed to write replay data: " << cpp_strerror(r)
+	         << dendl;
+            goto error;
+	  }
+        }
+        dout(20) << *ctx << ": finish" << dendl;
+      }
+    error:
+      wait_clean();
+    done:
+      ::shutdown(fd, SHUT_RDWR);
+
+      dout(20) << __func__ << ": terminated" << dendl;
+    }
+  };
+
+  std::vector<std::unique_ptr<Connection>> connections;
+
+  ceph::mutex lock = ceph::make_mutex("NBDServer::Locker");
+  ceph::condition_variable cond;
 
   static void aio_callback(librbd::completion_t cb, void *arg)
   {
@@ -348,163 +566,21 @@ private:
     } else {
       ctx->reply.error = native_to_big<uint32_t>(0);
     }
-    ctx->server->io_finish(ctx);
+    ctx->conn->io_finish(ctx);
 
     aio_completion->release();
   }
 
-  void reader_entry()
+  void notify_terminated()
   {
-    struct pollfd poll_fds[2];
-    memset(poll_fds, 0, sizeof(struct pollfd) * 2);
-    poll_fds[0].fd = fd;
-    poll_fds[0].events = POLLIN;
-    poll_fds[1].fd = terminate_event_fd;
-    poll_fds[1].events = POLLIN;
-
-    while (true) {
-      std::unique_ptr<IOContext> ctx(new IOContext());
-      ctx->server = this;
-
-      dout(20) << __func__ << ": waiting for nbd request" << dendl;
-
-      int r = poll(poll_fds, 2, -1);
-      if (r == -1) {
-        if (errno == EINTR) {
-          continue;
-        }
-        r = -errno;
-        derr << "failed to poll nbd: " << cpp_strerror(r) << dendl;
-        goto error;
-      }
-
-      if ((poll_fds[1].revents & POLLIN) != 0) {
-        dout(0) << __func__ << ": terminate received" << dendl;
-        goto signal;
-      }
-
-      if ((poll_fds[0].revents & POLLIN) == 0) {
-        dout(20) << __func__ << ": nothing to read" << dendl;
-        continue;
-      }
-
-      r = safe_read_exact(fd, &ctx->request, sizeof(struct nbd_request));
-      if (r < 0) {
-	derr << "failed to read nbd request header: " << cpp_strerror(r)
-	     << dendl;
-	goto error;
-      }
-
-      if (ctx->request.magic != htonl(NBD_REQUEST_MAGIC)) {
-	derr << "invalid nbd request header" << dendl;
-	goto signal;
-      }
-
-      ctx->request.from = big_to_native(ctx->request.from);
-      ctx->request.type = big_to_native(ctx->request.type);
-      ctx->request.len = big_to_native(ctx->request.len);
-
-      ctx->reply.magic = native_to_big<uint32_t>(NBD_REPLY_MAGIC);
-      memcpy(ctx->reply.handle, ctx->request.handle, sizeof(ctx->reply.handle));
-
-      ctx->command = ctx->request.type & 0x0000ffff;
-
-      dout(20) << *ctx << ": start" << dendl;
-
-      switch (ctx->command)
-      {
-        case NBD_CMD_DISC:
-          // NBD_DO_IT will return when pipe is closed
-	  dout(0) << "disconnect request received" << dendl;
-          goto signal;
-        case NBD_CMD_WRITE:
-          bufferptr ptr(ctx->request.len);
-	  r = safe_read_exact(fd, ptr.c_str(), ctx->request.len);
-          if (r < 0) {
-	    derr << *ctx << ": failed to read nbd request data: "
-		 << cpp_strerror(r) << dendl;
-            goto error;
-	  }
-          ctx->data.push_back(ptr);
-          break;
-      }
-
-      IOContext *pctx = ctx.release();
-      io_start(pctx);
-      librbd::RBD::AioCompletion *c = new librbd::RBD::AioCompletion(pctx, aio_callback);
-      switch (pctx->command)
-      {
-        case NBD_CMD_WRITE:
-          image.aio_write(pctx->request.from, pctx->request.len, pctx->data, c);
-          break;
-        case NBD_CMD_READ:
-          image.aio_read(pctx->request.from, pctx->request.len, pctx->data, c);
-          break;
-        case NBD_CMD_FLUSH:
-          image.aio_flush(c);
-          allow_internal_flush = true;
-          break;
-        case NBD_CMD_TRIM:
-          image.aio_discard(pctx->request.from, pctx->request.len, c);
-          break;
-        default:
-	  derr << *pctx << ": invalid request command" << dendl;
-          c->release();
-          goto signal;
-      }
-    }
-error:
     {
-      int r = netlink_disconnect(nbd_index);
-      if (r == 1) {
-        ioctl(nbd, NBD_DISCONNECT);
-      }
+      std::lock_guard l{lock};
+      terminated = true;
+      cond.notify_all();
     }
-signal:
-    std::lock_guard l{lock};
-    terminated = true;
-    cond.notify_all();
 
     std::lock_guard disconnect_l{disconnect_lock};
     disconnect_cond.notify_all();
-
-    dout(20) << __func__ << ": terminated" << dendl;
-  }
-
-  void writer_entry()
-  {
-    while (true) {
-      dout(20) << __func__ << ": waiting for io request" << dendl;
-      std::unique_ptr<IOContext> ctx(wait_io_finish());
-      if (!ctx) {
-	dout(20) << __func__ << ": no io requests, terminating" << dendl;
-        goto done;
-      }
-
-      dout(20) << __func__ << ": got: " << *ctx << dendl;
-
-      int r = safe_write(fd, &ctx->reply, sizeof(struct nbd_reply));
-      if (r < 0) {
-	derr << *ctx << ": failed to write reply header: " << cpp_strerror(r)
-	     << dendl;
-        goto error;
-      }
-      if (ctx->command == NBD_CMD_READ && ctx->reply.error == htonl(0)) {
-	r = ctx->data.write_fd(fd);
-        if (r < 0) {
-	  derr << *ctx << ": failed to write replay data: " << cpp_strerror(r)
-	       << dendl;
-          goto error;
-	}
-      }
-      dout(20) << *ctx << ": finish" << dendl;
-    }
-  error:
-    wait_clean();
-  done:
-    ::shutdown(fd, SHUT_RDWR);
-
-    dout(20) << __func__ << ": terminated" << dendl;
   }
 
   bool wait_quiesce() {
@@ -582,25 +658,7 @@ signal:
     dout(20) << __func__ << ": terminated" << dendl;
   }
 
-  class ThreadHelper : public Thread
-  {
-  public:
-    typedef void (NBDServer::*entry_func)();
-  private:
-    NBDServer &server;
-    entry_func func;
-  public:
-    ThreadHelper(NBDServer &_server, entry_func _func)
-      :server(_server)
-      ,func(_func)
-    {}
-  protected:
-    void* entry() override
-    {
-      (server.*func)();
-      return NULL;
-    }
-  } reader_thread, writer_thread, quiesce_thread;
+  ThreadHelper<NBDServer> quiesce_thread;
 
   bool started = false;
   bool quiesce = false;
@@ -619,8 +677,13 @@ public:
                                         EVENT_SOCKET_TYPE_EVENTFD);
       ceph_assert(r >= 0);
 
-      reader_thread.create("rbd_reader");
-      writer_thread.create("rbd_writer");
+      // every reader polls the same terminate event
+      for (auto fd : fds) {
+        connections.push_back(std::make_unique<Connection>(*this, fd));
+      }
+      for (auto &conn : connections) {
+        conn->start();
+      }
       if (cfg->quiesce) {
         quiesce_thread.create("rbd_quiesce");
       }
@@ -665,13 +728,17 @@ public:
 
       terminate_event_sock.notify();
 
-      reader_thread.join();
-      writer_thread.join();
+      for (auto &conn : connections) {
+        conn->join();
+      }
       if (cfg->quiesce) {
         quiesce_thread.join();
       }
 
-      assert_clean();
+      for (auto &conn : connections) {
+        conn->assert_clean();
+      }
+      connections.clear();
 
       close(terminate_event_fd);
       started = false;
@@ -1399,8 +1466,9 @@ static int netlink_connect_cb(struct nl_msg *msg, void *arg)
   return NL_OK;
 }
 
-static int netlink_connect(Config *cfg, struct nl_sock *sock, int nl_id, int fd,
-                           uint64_t size, uint64_t flags, bool reconnect)
+static int netlink_connect(Config *cfg, struct nl_sock *sock, int nl_id,
+                           const std::vector<int> &fds, uint64_t size,
+                           uint64_t flags, bool reconnect)
 {
   struct nlattr *sock_attr;
   struct nlattr *sock_opt;
@@ -1455,14 +1523,16 @@ static int netlink_connect(Config *cfg, struct nl_sock *sock, int nl_id, int fd,
     goto free_msg;
   }
 
-  sock_opt = nla_nest_start(msg, NBD_SOCK_ITEM);
-  if (!sock_opt) {
-    cerr << "rbd-nbd: Could not init sock in netlink message." << std::endl;
-    goto free_msg;
-  }
+  for (auto fd : fds) {
+    sock_opt = nla_nest_start(msg, NBD_SOCK_ITEM);
+    if (!sock_opt) {
+      cerr << "rbd-nbd: Could not init sock in netlink message." << std::endl;
+      goto free_msg;
+    }
 
-  NLA_PUT_U32(msg, NBD_SOCK_FD, fd);
-  nla_nest_end(msg, sock_opt);
+    NLA_PUT_U32(msg, NBD_SOCK_FD, fd);
+    nla_nest_end(msg, sock_opt);
+  }
   nla_nest_end(msg, sock_attr);
 
   ret = nl_send_sync(sock, msg);
@@ -1481,8 +1551,8 @@ free_msg:
   return -EIO;
 }
 
-static int try_netlink_setup(Config *cfg, int fd, uint64_t size, uint64_t flags,
-                             bool reconnect)
+static int try_netlink_setup(Config *cfg, const std::vector<int> &fds,
+                             uint64_t size, uint64_t flags, bool reconnect)
 {
   struct nl_sock *sock;
   int nl_id, ret;
@@ -1496,7 +1566,7 @@ static int try_netlink_setup(Config *cfg, int fd, uint64_t size, uint64_t flags,
 
   dout(10) << "netlink interface supported." << dendl;
 
-  ret = netlink_connect(cfg, sock, nl_id, fd, size, flags, reconnect);
+  ret = netlink_connect(cfg, sock, nl_id, fds, size, flags, reconnect);
   netlink_cleanup(sock);
 
   if (ret != 0)
@@ -1552,11 +1622,12 @@ static void handle_signal(int signum)
   terminate_event_sock.notify();
 }
 
-static NBDServer *start_server(int fd, librbd::Image& image, Config *cfg)
+static NBDServer *start_server(const std::vector<int> &fds,
+                               librbd::Image& image, Config *cfg)
 {
   NBDServer *server;
 
-  server = new NBDServer(fd, image, cfg);
+  server = new NBDServer(fds, image, cfg);
   server->start();
 
   init_async_signal_handler();
@@ -1682,7 +1753,10 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   unsigned long blksize = RBD_NBD_BLKSIZE;
   bool use_netlink = true;
 
-  int fd[2];
+  // socket pairs: the kernel end is at client_fds[i], the server end at
+  // server_fds[i]
+  std::vector<int> client_fds;
+  std::vector<int> server_fds;
 
   librbd::image_info_t info;
 
@@ -1723,9 +1797,14 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   common_init_finish(g_ceph_context);
   global_init_chdir(g_ceph_context);
 
-  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fd) == -1) {
-    r = -errno;
-    goto close_ret;
+  for (int i = 0; i < cfg->num_connections; ++i) {
+    int fd[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fd) == -1) {
+      r = -errno;
+      goto close_fd;
+    }
+    client_fds.push_back(fd[0]);
+    server_fds.push_back(fd[1]);
   }
 
   r = rados.init_with_context(g_ceph_context);
@@ -1834,6 +1913,11 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
     goto close_fd;
 
   flags = NBD_FLAG_SEND_FLUSH | NBD_FLAG_HAS_FLAGS;
+  if (cfg->num_connections > 1) {
+    // librbd keeps a single view of the image for all connections, so a
+    // flush on any connection covers writes completed on the others
+    flags |= NBD_FLAG_CAN_MULTI_CONN;
+  }
   if (!cfg->notrim) {
     flags |= NBD_FLAG_SEND_TRIM;
   }
@@ -1855,7 +1939,7 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   if (r < 0)
     goto close_fd;
 
-  server = start_server(fd[1], image, cfg);
+  server = start_server(server_fds, image, cfg);
 
   // generate when the cookie is not supplied at CLI
   if (!reconnect && cfg->cookie.empty()) {
@@ -1863,7 +1947,7 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
     uuid_gen.generate_random();
     cfg->cookie = uuid_gen.to_string();
   }
-  r = try_netlink_setup(cfg, fd[0], size, flags, reconnect);
+  r = try_netlink_setup(cfg, client_fds, size, flags, reconnect);
   if (r < 0) {
     goto free_server;
   } else if (r == 1) {
@@ -1871,7 +1955,13 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   }
 
   if (!use_netlink) {
-    r = try_ioctl_setup(cfg, fd[0], size, blksize, flags);
+    if (cfg->num_connections > 1) {
+      cerr << "rbd-nbd: multiple connections require the netlink interface"
+           << std::endl;
+      r = -EINVAL;
+      goto free_server;
+    }
+    r = try_ioctl_setup(cfg, client_fds[0], size, blksize, flags);
     if (r < 0)
       goto free_server;
   }
@@ -1940,9 +2030,13 @@ close_nbd:
 free_server:
   delete server;
 close_fd:
-  close(fd[0]);
-  close(fd[1]);
-close_ret:
+  for (auto fd : client_fds) {
+    close(fd);
+  }
+  for (auto fd : server_fds) {
+    close(fd);
+  }
+
   image.close();
   io_ctx.close();
   rados.shutdown();
@@ -2191,6 +2285,16 @@ static int parse_args(vector<const char*>& args, std::ostream *err_msg,
         *err_msg << "rbd-nbd: Invalid argument for reattach-timeout!";
         return -EINVAL;
       }
+    } else if (ceph_argparse_witharg(args, i, &cfg->num_connections, err,
+                                     "--num-connections", (char *)NULL)) {
+      if (!err.str().empty()) {
+        *err_msg << "rbd-nbd: " << err.str();
+        return -EINVAL;
+      }
+      if (cfg->num_connections < 1) {
+        *err_msg << "rbd-nbd: Invalid argument for num-connections!";
+        return -EINVAL;
+      }
     } else if (ceph_argparse_flag(args, i, "--exclusive", (char *)NULL)) {
       cfg->exclusive = true;
     } else if (ceph_argparse_flag(args, i, "--notrim", (char *)NULL)) {